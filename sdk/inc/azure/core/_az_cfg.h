@@ -65,6 +65,18 @@
 #define AZ_INLINE static inline
 #endif // _MSC_VER
 
+/**
+ * @brief Function which is never inlined, so that the stack it needs is only reserved when it is
+ * called.
+ */
+#ifdef _MSC_VER
+#define _az_NOINLINE static __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__) // !_MSC_VER
+#define _az_NOINLINE __attribute__((noinline)) static
+#else // !_MSC_VER !__GNUC__ !__clang__
+#define _az_NOINLINE static
+#endif // _MSC_VER
+
 #if defined(__GNUC__) && __GNUC__ >= 7
 #define _az_FALLTHROUGH __attribute__((fallthrough))
 #else // !__GNUC__ >= 7
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief An arena which hands out scratch memory from a buffer of the application, to the HTTP
+ * policies and transports sending a request.
+ *
+ * @details An #az_arena is attached to a request by creating the context of the request with
+ * #az_context_create_with_value(), with #az_arena_context_key as the key and the arena as the
+ * value. The policies and transports of the SDK then take the buffers they need while the request
+ * is sent (URL, headers, log messages, copies handed to the HTTP stack) out of the arena rather
+ * than from the heap or the stack. When the arena has no room left, they fall back to the heap or
+ * the stack, as they do without an arena.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_ARENA_H
+#define _az_ARENA_H
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+/**
+ * @brief A bump allocator over a buffer: each allocation takes the bytes which follow the previous
+ * one, and they are all released at once by #az_arena_reset().
+ *
+ * @remarks An #az_arena is not thread-safe. Each thread sending requests needs an arena of its own,
+ * which must stay valid until the requests it is attached to complete.
+ */
+typedef struct
+{
+  struct
+  {
+    uint8_t* buffer;
+    int32_t size;
+    int32_t used;
+    int32_t peak; // The most the arena was asked to hold at once, including what didn't fit.
+  } _internal;
+} az_arena;
+
+/**
+ * @brief A position of an #az_arena, which the arena can later be rolled back to, releasing what
+ * was allocated after it.
+ *
+ * @remarks Use #az_arena_get_mark() to create one, and #az_arena_rollback() to roll back to it.
+ */
+typedef struct
+{
+  struct
+  {
+    int32_t used;
+  } _internal;
+} az_arena_mark;
+
+/**
+ * @brief The key of the #az_context value which attaches an #az_arena to a request.
+ *
+ * @details Pass the address of this variable as the key and a pointer to the #az_arena as the
+ * value of #az_context_create_with_value().
+ */
+extern uint8_t const az_arena_context_key;
+
+/**
+ * @brief Initializes an #az_arena to allocate from a buffer.
+ *
+ * @param[out] out_arena The #az_arena to initialize.
+ * @param[in] buffer The buffer to allocate from, which must stay valid as long as the arena is
+ * used.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_arena_init(az_arena* out_arena, az_span buffer);
+
+/**
+ * @brief Allocates bytes from an #az_arena.
+ *
+ * @details The allocation is aligned on 8 bytes, for pointers and 64-bit integers, and its content
+ * is left as it was in the buffer.
+ *
+ * @param[in,out] ref_arena The #az_arena to allocate from.
+ * @param[in] size The number of bytes to allocate.
+ * @param[out] out_span The #az_span of \p size bytes allocated.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The arena doesn't have \p size bytes left.
+ */
+AZ_NODISCARD az_result az_arena_allocate(az_arena* ref_arena, int32_t size, az_span* out_span);
+
+/**
+ * @brief Gets the current position of an #az_arena, so that it can be rolled back to it.
+ *
+ * @param[in] arena The #az_arena.
+ *
+ * @return An #az_arena_mark for the current position of the \p arena.
+ */
+AZ_NODISCARD az_arena_mark az_arena_get_mark(az_arena const* arena);
+
+/**
+ * @brief Rolls back an #az_arena to a position returned by #az_arena_get_mark(), releasing what was
+ * allocated after it.
+ *
+ * @param[in,out] ref_arena The #az_arena the \p mark was taken from.
+ * @param[in] mark The #az_arena_mark to roll back to, which must not be after the current position
+ * of the arena.
+ */
+void az_arena_rollback(az_arena* ref_arena, az_arena_mark mark);
+
+/**
+ * @brief Releases everything allocated from an #az_arena, typically once a request completed.
+ *
+ * @param[in,out] ref_arena The #az_arena to reset.
+ */
+void az_arena_reset(az_arena* ref_arena);
+
+/**
+ * @brief Gets the most bytes an #az_arena was asked to hold at once since it was initialized,
+ * counting the allocations which did not fit, to size its buffer.
+ *
+ * @param[in] arena The #az_arena.
+ *
+ * @return The largest size the arena needed.
+ */
+AZ_NODISCARD int32_t az_arena_get_peak_size(az_arena const* arena);
+
+/**
+ * @brief Gets the #az_arena attached to an #az_context, or to any of its parents.
+ *
+ * @param[in] context __[nullable]__ The #az_context of a request.
+ *
+ * @return The #az_arena attached with #az_arena_context_key, or `NULL` when there is none.
+ */
+AZ_NODISCARD az_arena* az_arena_from_context(az_context const* context);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_ARENA_H
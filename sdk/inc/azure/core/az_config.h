@@ -30,6 +30,38 @@ enum
 
   /// The maximum buffer size for a log message.
   AZ_LOG_MESSAGE_BUFFER_SIZE = 1024,
+
+  /// The maximum number of headers an #az_http_response indexes. The headers of a response with
+  /// more headers are parsed again on each lookup.
+  AZ_HTTP_RESPONSE_HEADER_INDEX_SIZE = 16,
+
+  /// The size of the buffer on the stack which compressed HTTP response bodies are decompressed
+  /// into, before being written into the response.
+  AZ_HTTP_RESPONSE_DECODING_BUFFER_SIZE = 256,
+
+  /// The longest the retry policy sleeps at once while waiting to retry a request, before checking
+  /// whether the context of the request was canceled.
+  AZ_HTTP_POLICY_RETRY_CANCELLATION_CHECK_INTERVAL_MSEC = 100,
+
+  /// The number of endpoints whose failures an #az_http_policy_circuit_breaker tracks.
+  AZ_HTTP_CIRCUIT_BREAKER_ENDPOINT_COUNT = 4,
+
+  /// The number of recent latencies an #az_http_policy_hedging_options keeps to pick the delay
+  /// before a hedged request.
+  AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT = 32,
+
+  /// The number of buckets of the latency histograms of an #az_http_policy_metrics. Each power of
+  /// two microseconds is split into 4 buckets, so that 124 buckets measure up to about 71 minutes;
+  /// longer latencies are counted in the last bucket.
+  AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT = 124,
+
+  /// The number of finished spans an #az_http_policy_tracing holds until they are exported by
+  /// #az_http_policy_tracing_flush(). Must be a power of two.
+  AZ_HTTP_TRACING_SPAN_BUFFER_SIZE = 16,
+
+  /// The maximum number of policies in the HTTP pipeline of a client: its own policies and the
+  /// #az_http_custom_policy added to it. The Storage Blobs client uses 13 of its own.
+  AZ_HTTP_PIPELINE_POLICY_COUNT = 20,
 };
 
 #include <azure/core/_az_cfg_suffix.h>
@@ -79,6 +79,10 @@ az_context_create_with_value(az_context const* parent, void const* key, void con
 /**
  * @brief Cancels the specified #az_context node; this cancels all the child nodes as well.
  *
+ * @remarks A context can be canceled from another thread than the ones using it, for instance to
+ * stop a request waiting for its next retry: its expiration is written and read atomically. On
+ * compilers without lock-free 64-bit atomics, it must be canceled from the threads using it.
+ *
  * @param[in,out] ref_context A pointer to the #az_context node to be canceled.
  */
 void az_context_cancel(az_context* ref_context);
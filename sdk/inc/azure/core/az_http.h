@@ -114,6 +114,210 @@ typedef enum
   AZ_HTTP_STATUS_CODE_END_OF_LIST = -1,
 } az_http_status_code;
 
+/**
+ * @brief Defines the signature of the callback which reads the next part of an HTTP request body
+ * from an #az_http_request_body_provider.
+ *
+ * @param[in] user_context The user context of the #az_http_request_body_provider.
+ * @param[out] destination The #az_span to copy the next bytes of the body into.
+ * @param[out] out_bytes_read The number of bytes copied into \p destination. It is only `0` once
+ * the whole body has been read.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, which stops sending the request and is returned to the caller.
+ */
+typedef AZ_NODISCARD az_result (*az_http_request_body_read_fn)(
+    void* user_context,
+    az_span destination,
+    int32_t* out_bytes_read);
+
+/**
+ * @brief Defines the signature of the callback which moves an #az_http_request_body_provider back
+ * to the start of the body, so that the body can be sent again.
+ *
+ * @param[in] user_context The user context of the #az_http_request_body_provider.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, and the request is not sent again.
+ */
+typedef AZ_NODISCARD az_result (*az_http_request_body_rewind_fn)(void* user_context);
+
+/**
+ * @brief Provides the body of an HTTP request as it is being sent, so that the body does not have
+ * to be held in memory all at once.
+ *
+ * @remarks When the request has to be sent again, such as when the retry policy retries it, the
+ * body is rewound first. Requests whose body provider can't be rewound are not retried.
+ */
+typedef struct
+{
+  /// Reads the next part of the body.
+  az_http_request_body_read_fn read;
+
+  /// __[nullable]__ Moves back to the start of the body. `NULL` if the body can only be read once.
+  az_http_request_body_rewind_fn rewind;
+
+  /// The size of the body in bytes, or `-1` if it is not known before the body has been read.
+  int64_t length;
+
+  /// A pointer passed as is to the \p read and \p rewind callbacks.
+  void* user_context;
+} az_http_request_body_provider;
+
+/**
+ * @brief The content codings of HTTP bodies which an #az_http_content_codec can compress and
+ * decompress.
+ */
+typedef enum
+{
+  AZ_HTTP_CONTENT_CODING_IDENTITY = 0, ///< Not compressed.
+  AZ_HTTP_CONTENT_CODING_GZIP = 1, ///< `gzip`, a gzip stream (RFC 1952).
+  AZ_HTTP_CONTENT_CODING_DEFLATE = 2, ///< `deflate`, a zlib stream (RFC 1950).
+} az_http_content_coding;
+
+/**
+ * @brief Defines the signature of the callback which starts compressing or decompressing a body
+ * with an #az_http_content_codec.
+ *
+ * @param[in] user_context The user context of the #az_http_content_codec.
+ * @param[in] coding The #az_http_content_coding of the compressed body.
+ * @param[in] is_compressing `true` to compress a body, `false` to decompress it.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_SUPPORTED The codec does not support \p coding.
+ * @retval other Failure.
+ */
+typedef AZ_NODISCARD az_result (*az_http_content_codec_begin_fn)(
+    void* user_context,
+    az_http_content_coding coding,
+    bool is_compressing);
+
+/**
+ * @brief Defines the signature of the callback which compresses or decompresses the next part of
+ * a body with an #az_http_content_codec.
+ *
+ * @param[in] user_context The user context of the #az_http_content_codec.
+ * @param[in] source The next bytes of the body to compress or decompress.
+ * @param[out] destination The #az_span to write the compressed or decompressed bytes into.
+ * @param[in] is_last Whether \p source ends the body to compress. Ignored when decompressing.
+ * @param[out] out_source_used The number of bytes of \p source which were consumed.
+ * @param[out] out_destination_used The number of bytes written into \p destination.
+ * @param[out] out_is_end Whether the whole compressed body was written, or read.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success. The callback is called again while bytes of \p source are left, or while
+ * \p destination was filled.
+ * @retval #AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY The compressed body is invalid.
+ * @retval other Failure.
+ */
+typedef AZ_NODISCARD az_result (*az_http_content_codec_process_fn)(
+    void* user_context,
+    az_span source,
+    az_span destination,
+    bool is_last,
+    int32_t* out_source_used,
+    int32_t* out_destination_used,
+    bool* out_is_end);
+
+/**
+ * @brief Defines the signature of the callback which releases what an #az_http_content_codec
+ * holds for the body it compressed or decompressed.
+ *
+ * @param[in] user_context The user context of the #az_http_content_codec.
+ */
+typedef void (*az_http_content_codec_end_fn)(void* user_context);
+
+/**
+ * @brief Compresses and decompresses HTTP bodies for the compression policies, so that the SDK
+ * does not depend on a compression library.
+ *
+ * @remarks A codec compresses or decompresses a single body at a time. The `az_zlib` library
+ * provides a codec built on zlib (see `az_zlib.h`).
+ */
+typedef struct
+{
+  /// Starts compressing or decompressing a body.
+  az_http_content_codec_begin_fn begin;
+
+  /// Compresses or decompresses the next part of the body.
+  az_http_content_codec_process_fn process;
+
+  /// Releases what the codec holds for the body.
+  az_http_content_codec_end_fn end;
+
+  /// A pointer passed as is to the \p begin, \p process and \p end callbacks.
+  void* user_context;
+} az_http_content_codec;
+
+/**
+ * @brief Allows you to customize how SDK clients compress the bodies of their HTTP requests, and
+ * have the bodies of HTTP responses compressed.
+ *
+ * @details Compression is disabled unless a #az_http_content_codec is set.
+ */
+typedef struct
+{
+  /// __[nullable]__ The #az_http_content_codec which compresses and decompresses bodies.
+  az_http_content_codec const* codec;
+
+  /// Whether to ask for compressed (`gzip` or `deflate`) response bodies, which are decompressed
+  /// as they are received, into the response buffer or the #az_http_response_body_sink.
+  bool decompress_responses;
+
+  /// The size in bytes from which request bodies are compressed with `gzip`, or `-1` not to
+  /// compress them. Only bodies which aren't streamed from an #az_http_request_body_provider are
+  /// compressed.
+  int32_t request_compression_threshold;
+
+  /// The buffer which compressed request bodies are written into. Request bodies which don't get
+  /// smaller than it are sent uncompressed. Requests sent at once, from several threads, must not
+  /// share it.
+  az_span request_compression_buffer;
+} az_http_policy_compression_options;
+
+/**
+ * @brief A token bucket which limits the retries of every request sharing it to a fraction of
+ * these requests, so that retries don't multiply the load on a service which is already failing.
+ *
+ * @details Each request deposits a fraction of a token into the bucket, up to its capacity, and
+ * each retry takes a whole token out of it. A request is not retried while the bucket holds less
+ * than a token. The bucket starts full.
+ *
+ * @remarks The same budget can be shared by the retry options of several clients, used from
+ * several threads: it is updated atomically with GCC, Clang and MSVC.
+ */
+typedef struct
+{
+  struct
+  {
+    int32_t volatile tokens; // In hundredths of a token.
+    int32_t max_tokens;
+    int32_t deposit;
+  } _internal;
+} az_http_policy_retry_budget;
+
+/**
+ * @brief Initializes an #az_http_policy_retry_budget.
+ *
+ * @param[out] out_budget The #az_http_policy_retry_budget to initialize.
+ * @param[in] max_retries The number of retries the budget allows in a row, when it is full.
+ * @param[in] retry_percent The number of retries allowed for every hundred requests, once the
+ * budget is exhausted.
+ *
+ * @pre \p max_retries must be between 1 and 1000000.
+ * @pre \p retry_percent must be between 0 and 100.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The budget is initialized.
+ */
+AZ_NODISCARD az_result az_http_policy_retry_budget_init(
+    az_http_policy_retry_budget* out_budget,
+    int32_t max_retries,
+    int32_t retry_percent);
+
 /**
  * @brief Allows you to customize the retry policy used by SDK clients whenever they perform an I/O
  * operation.
@@ -121,6 +325,16 @@ typedef enum
  * @details Client libraries should acquire an initialized instance of this struct and then modify
  * any fields necessary before passing a pointer to this struct when initializing the specific
  * client.
+ *
+ * @remarks Besides the listed status codes, `GET`, `HEAD`, `PUT` and `DELETE` requests are retried
+ * when the transport reports #AZ_ERROR_HTTP_CONNECTION_INTERRUPTED. Other requests, such as `POST`,
+ * are not idempotent and may have reached the service before the connection was lost, so the
+ * error is returned as is. Requests whose #az_http_request_body_provider can't be rewound are not
+ * retried.
+ *
+ * @remarks Unless the response tells when to retry, the delay before each retry is drawn at random
+ * between #retry_delay_msec and three times the previous delay, up to #max_retry_delay_msec
+ * ("decorrelated jitter"), so that clients which failed together don't retry together.
  */
 typedef struct
 {
@@ -135,8 +349,401 @@ typedef struct
 
   /// Maximum number of retries.
   int32_t max_retries;
+
+  /// The retry budget shared by the requests of this client, and possibly of others, or _NULL_ to
+  /// retry every request up to #max_retries times.
+  az_http_policy_retry_budget* budget;
 } az_http_policy_retry_options;
 
+typedef enum
+{
+  _az_HTTP_CIRCUIT_BREAKER_STATE_CLOSED = 0,
+  _az_HTTP_CIRCUIT_BREAKER_STATE_OPEN = 1,
+  _az_HTTP_CIRCUIT_BREAKER_STATE_HALF_OPEN = 2,
+} _az_http_circuit_breaker_state;
+
+typedef struct
+{
+  uint32_t key; // A hash of the scheme and authority of the URL, or 0 for an unused entry.
+  _az_http_circuit_breaker_state state;
+  int32_t failure_count; // The failures since window_start, while the circuit is closed.
+  int64_t window_start;
+  int64_t opened_at;
+  int64_t last_used;
+  bool is_probe_pending; // A request was let through to the half-open endpoint.
+} _az_http_circuit_breaker_endpoint;
+
+/**
+ * @brief Allows you to customize an #az_http_policy_circuit_breaker, which fails requests right
+ * away with #AZ_ERROR_HTTP_CIRCUIT_OPEN while their endpoint keeps failing.
+ *
+ * @details The circuit of each endpoint (scheme, host and port) is closed at first: requests are
+ * sent, and the circuit opens once #failure_threshold requests failed within #failure_window_msec.
+ * After #open_duration_msec, the circuit is half-open: a single request is sent to probe the
+ * endpoint, and the circuit closes again if it succeeds, or opens again if it fails.
+ *
+ * @remarks A request fails when the rest of the pipeline, retries included, returns one of the
+ * #status_codes, or fails to reach the endpoint: #AZ_ERROR_HTTP_ADAPTER,
+ * #AZ_ERROR_HTTP_CONNECTION_INTERRUPTED, #AZ_ERROR_HTTP_RESPONSE_COULDNT_RESOLVE_HOST, or a corrupt
+ * response. Other errors, such as a response buffer too small for the response, say nothing about
+ * the endpoint and aren't counted.
+ */
+typedef struct
+{
+  /// An array of HTTP status codes which count as failures, terminated by
+  /// #AZ_HTTP_STATUS_CODE_END_OF_LIST.
+  az_http_status_code const* status_codes;
+
+  /// The number of failed requests which opens the circuit, or 0 to never open it.
+  int32_t failure_threshold;
+
+  /// The time, in milliseconds, over which failures are counted.
+  int32_t failure_window_msec;
+
+  /// The time, in milliseconds, the circuit stays open before a request probes the endpoint.
+  int32_t open_duration_msec;
+} az_http_policy_circuit_breaker_options;
+
+/**
+ * @brief Gets the default circuit breaker options.
+ *
+ * @details The circuit opens after 5 failures within 30 seconds, and stays open for 10 seconds,
+ * but #az_http_policy_circuit_breaker_options.failure_threshold is 0: the circuit never opens until
+ * it is set.
+ *
+ * @return The default #az_http_policy_circuit_breaker_options.
+ */
+AZ_NODISCARD az_http_policy_circuit_breaker_options
+az_http_policy_circuit_breaker_options_default();
+
+/**
+ * @brief The circuits of the endpoints which the clients sharing it send requests to, which fail
+ * requests right away with #AZ_ERROR_HTTP_CIRCUIT_OPEN while their endpoint keeps failing.
+ *
+ * @remarks The same circuit breaker can be shared by the options of several clients, so that the
+ * failures of their requests to the same endpoint add up. Up to
+ * #AZ_HTTP_CIRCUIT_BREAKER_ENDPOINT_COUNT endpoints are tracked at once; the endpoint used least
+ * recently makes room for a new one. It can also be shared by the threads sending the requests:
+ * its state is only updated under a lock, which is held for a few instructions and never while a
+ * request is sent. On compilers without atomics, it must not be used by several threads at a time.
+ */
+typedef struct
+{
+  struct
+  {
+    az_http_policy_circuit_breaker_options options;
+    _az_http_circuit_breaker_endpoint endpoints[AZ_HTTP_CIRCUIT_BREAKER_ENDPOINT_COUNT];
+    int32_t volatile lock; // 1 while a thread updates the endpoints.
+  } _internal;
+} az_http_policy_circuit_breaker;
+
+/**
+ * @brief Initializes an #az_http_policy_circuit_breaker, with all its circuits closed.
+ *
+ * @param[out] out_circuit_breaker The #az_http_policy_circuit_breaker to initialize.
+ * @param[in] options __[nullable]__ A reference to an #az_http_policy_circuit_breaker_options
+ * structure. If `NULL` is passed, the default options are used (i.e.
+ * #az_http_policy_circuit_breaker_options_default()), with which the circuits never open.
+ *
+ * @pre \p options status codes must not be `NULL`, and its failure threshold must not be negative.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The circuit breaker is initialized.
+ */
+AZ_NODISCARD az_result az_http_policy_circuit_breaker_init(
+    az_http_policy_circuit_breaker* out_circuit_breaker,
+    az_http_policy_circuit_breaker_options const* options);
+
+/**
+ * @brief An adaptive token bucket, which paces the requests sent to a service, such as a storage
+ * account, by the clients sharing it, to stay just under the rate the service throttles at.
+ *
+ * @details The bucket is refilled at the current rate, in requests per second, and holds up to a
+ * second of requests; a request waits for a token before it is sent. When the service answers with
+ * HTTP 429 or 503, the rate is halved, at most once per second and not below the minimum rate, and
+ * no request is sent until the `retry-after-ms`, `x-ms-retry-after-ms` or `Retry-After` delay of
+ * the response elapsed. Then, each time as many requests in a row succeeded as the rate, the rate
+ * is raised by one request per second, up to the maximum rate.
+ *
+ * @remarks The same rate limiter can be shared by the options of several clients, and by the
+ * threads sending their requests: its state is only updated under a lock, which is held for a few
+ * instructions and never while a request is sent or waits for a token. On compilers without
+ * atomics, it must not be used by several threads at a time.
+ */
+typedef struct
+{
+  struct
+  {
+    int64_t tokens; // In thousandths of a request, and negative while requests wait for tokens.
+    int64_t refilled_at; // 0 until the first request.
+    int64_t blocked_until;
+    int64_t decreased_at;
+    int32_t rate; // In requests per second.
+    int32_t min_rate;
+    int32_t max_rate;
+    int32_t success_count; // The requests which succeeded in a row, since the rate last changed.
+    int32_t volatile lock; // 1 while a thread updates the other fields.
+  } _internal;
+} az_http_policy_rate_limiter;
+
+/**
+ * @brief Initializes an #az_http_policy_rate_limiter.
+ *
+ * @param[out] out_rate_limiter The #az_http_policy_rate_limiter to initialize.
+ * @param[in] initial_rate The number of requests per second to start with.
+ * @param[in] min_rate The number of requests per second the rate is never lowered below.
+ * @param[in] max_rate The number of requests per second the rate is never raised above.
+ *
+ * @pre \p min_rate must be at least 1.
+ * @pre \p initial_rate must be between \p min_rate and \p max_rate.
+ * @pre \p max_rate must be at most 1000000.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The rate limiter is initialized.
+ */
+AZ_NODISCARD az_result az_http_policy_rate_limiter_init(
+    az_http_policy_rate_limiter* out_rate_limiter,
+    int32_t initial_rate,
+    int32_t min_rate,
+    int32_t max_rate);
+
+/**
+ * @brief The operations whose requests an #az_http_policy_metrics measures apart, which are told
+ * apart by the HTTP method of their requests.
+ */
+typedef enum
+{
+  AZ_HTTP_METRICS_OPERATION_GET = 0, ///< `GET` requests.
+  AZ_HTTP_METRICS_OPERATION_HEAD = 1, ///< `HEAD` requests.
+  AZ_HTTP_METRICS_OPERATION_PUT = 2, ///< `PUT` requests.
+  AZ_HTTP_METRICS_OPERATION_POST = 3, ///< `POST` requests.
+  AZ_HTTP_METRICS_OPERATION_DELETE = 4, ///< `DELETE` requests.
+  AZ_HTTP_METRICS_OPERATION_PATCH = 5, ///< `PATCH` requests.
+  AZ_HTTP_METRICS_OPERATION_OTHER = 6, ///< Requests with any other method.
+  _az_HTTP_METRICS_OPERATION_COUNT = 7, // The number of operations measured apart.
+} az_http_metrics_operation;
+
+/**
+ * @brief The measures of the requests of an operation, copied out of an #az_http_policy_metrics
+ * by #az_http_policy_metrics_get_snapshot().
+ */
+typedef struct
+{
+  /// The requests sent, each counted once whatever the number of retries.
+  int64_t request_count;
+
+  /// The requests which failed without a response, such as requests which were canceled.
+  int64_t failure_count;
+
+  /// The responses with a 1xx, 2xx, 3xx, 4xx and 5xx status code, in that order.
+  int64_t status_class_counts[5];
+
+  /// The retries the retry policy made, over all the requests.
+  int64_t retry_count;
+
+  /// The bytes of the request bodies sent, retries included.
+  int64_t bytes_sent;
+
+  /// The bytes of the responses received, headers included, retries excluded.
+  int64_t bytes_received;
+
+  /// The number of requests which completed in each latency bucket, from the time the request
+  /// entered the metrics policy to the time it left it. Use
+  /// #az_http_metrics_snapshot_get_latency_percentile() to read percentiles out of it.
+  int64_t latency_histogram[AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT];
+} az_http_metrics_snapshot;
+
+typedef struct
+{
+  int64_t volatile request_count;
+  int64_t volatile failure_count;
+  int64_t volatile status_class_counts[5];
+  int64_t volatile retry_count;
+  int64_t volatile bytes_sent;
+  int64_t volatile bytes_received;
+  int64_t volatile latency_histogram[AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT];
+} _az_http_metrics_counters;
+
+/**
+ * @brief The counters the metrics policy keeps for each #az_http_metrics_operation, which
+ * #az_http_policy_metrics_get_snapshot() copies out.
+ *
+ * @remarks The same metrics can be shared by the options of several clients, used from several
+ * threads: the counters are updated atomically with GCC, Clang and MSVC, without locks. A snapshot
+ * taken while requests complete may count some of their measures but not others yet.
+ */
+typedef struct
+{
+  struct
+  {
+    _az_http_metrics_counters operations[_az_HTTP_METRICS_OPERATION_COUNT];
+  } _internal;
+} az_http_policy_metrics;
+
+/**
+ * @brief Initializes an #az_http_policy_metrics, with every counter at zero.
+ *
+ * @param[out] out_metrics The #az_http_policy_metrics to initialize.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The metrics are initialized.
+ */
+AZ_NODISCARD az_result az_http_policy_metrics_init(az_http_policy_metrics* out_metrics);
+
+/**
+ * @brief Copies the measures of an operation out of an #az_http_policy_metrics.
+ *
+ * @param[in] metrics The #az_http_policy_metrics to read.
+ * @param[in] operation The #az_http_metrics_operation whose measures to copy.
+ * @param[out] out_snapshot The #az_http_metrics_snapshot to copy the measures to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The measures are copied.
+ */
+AZ_NODISCARD az_result az_http_policy_metrics_get_snapshot(
+    az_http_policy_metrics const* metrics,
+    az_http_metrics_operation operation,
+    az_http_metrics_snapshot* out_snapshot);
+
+/**
+ * @brief Gets a percentile of the latencies of an #az_http_metrics_snapshot, such as the median
+ * (50) or the 99th percentile (99).
+ *
+ * @param[in] snapshot The #az_http_metrics_snapshot to read.
+ * @param[in] percentile The percentile to get, between 0 and 100.
+ *
+ * @return The highest latency, in microseconds, of the bucket the percentile falls into, which is
+ * at most 25% more than the actual latency. 0 when the snapshot has no latencies.
+ */
+AZ_NODISCARD int64_t az_http_metrics_snapshot_get_latency_percentile(
+    az_http_metrics_snapshot const* snapshot,
+    int32_t percentile);
+
+/**
+ * @brief The W3C Trace Context (https://www.w3.org/TR/trace-context/) a request is part of, which
+ * the tracing policy reads from the #az_context of the request, under the key
+ * #az_http_tracing_context_key.
+ *
+ * @details An application which sends requests on behalf of a request it received, such as a
+ * gateway, gets the trace context of that request from its `traceparent` header with
+ * #az_http_tracing_context_parse(), and adds it to the context of the requests it sends with
+ * #az_context_create_with_value(), so that their spans are children of the span of its caller.
+ */
+typedef struct
+{
+  uint8_t trace_id[16]; ///< The ID of the whole trace.
+  uint8_t span_id[8]; ///< The ID of the span the requests are children of.
+  uint8_t trace_flags; ///< The trace flags. Bit 0 tells whether the trace is sampled (recorded).
+} az_http_tracing_context;
+
+/**
+ * @brief The key of the #az_http_tracing_context in an #az_context.
+ */
+extern uint8_t const az_http_tracing_context_key;
+
+/**
+ * @brief Parses the value of a W3C `traceparent` header, such as
+ * `00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01`.
+ *
+ * @param[in] traceparent The value of the header.
+ * @param[out] out_context The #az_http_tracing_context to write the parsed values to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR \p traceparent is not a valid `traceparent` of version `00`,
+ * or its trace ID or span ID is all zeros.
+ */
+AZ_NODISCARD az_result
+az_http_tracing_context_parse(az_span traceparent, az_http_tracing_context* out_context);
+
+/**
+ * @brief A finished span, which measures a request, or an attempt to send it, from the time it
+ * entered the tracing policy to the time it left it.
+ */
+typedef struct
+{
+  uint8_t trace_id[16]; ///< The ID of the trace the span is part of.
+  uint8_t span_id[8]; ///< The ID of the span.
+  uint8_t parent_span_id[8]; ///< The ID of the parent span, all zeros when there is none.
+  uint8_t trace_flags; ///< The trace flags sent with the request.
+  int32_t attempt; ///< 0 for the span of a request, 1 and up for the span of each attempt.
+  int64_t start_nsec; ///< When the span started, from #az_platform_clock_nsec().
+  int64_t end_nsec; ///< When the span ended, from #az_platform_clock_nsec().
+  az_result result; ///< The result returned by the rest of the pipeline.
+  az_http_status_code status_code; ///< The status code of the response, or 0 when there is none.
+} az_http_tracing_span;
+
+/**
+ * @brief Defines the callback signature invoked by #az_http_policy_tracing_flush() for each
+ * finished span.
+ *
+ * @param[in] span The finished #az_http_tracing_span, valid only during the call.
+ * @param[in] user_context The user context passed to #az_http_policy_tracing_init().
+ */
+typedef void (*az_http_tracing_export_fn)(az_http_tracing_span const* span, void* user_context);
+
+typedef struct
+{
+  uint32_t volatile sequence; // Tells whether the slot is free, or holds a span to export.
+  az_http_tracing_span span;
+} _az_http_tracing_slot;
+
+/**
+ * @brief Records a span for each request, and for each attempt to send it, and sends a W3C
+ * `traceparent` header with each attempt.
+ *
+ * @details The tracing policy runs ahead of the retry policy, and records the span of the request,
+ * while the tracing attempt policy runs after it and records the span of each attempt, which is a
+ * child of the span of the request. The span of the request is a child of the
+ * #az_http_tracing_context of the #az_context of the request, or starts a new trace when it has
+ * none. Spans are only recorded when the trace is sampled. Tracing is best-effort: an attempt
+ * whose request has no room left for the `traceparent` header is sent without it.
+ *
+ * @remarks Finished spans are queued into a lock-free ring buffer of
+ * #AZ_HTTP_TRACING_SPAN_BUFFER_SIZE spans, until the application hands them to its exporter by
+ * calling #az_http_policy_tracing_flush(), from any thread. Spans which finish while the buffer is
+ * full are dropped. The same tracing can be shared by the options of several clients, used from
+ * several threads, with GCC, Clang and MSVC.
+ */
+typedef struct
+{
+  struct
+  {
+    az_http_tracing_export_fn export_span;
+    void* user_context;
+    uint32_t volatile id_sequence; // Makes the IDs of spans which start at once differ.
+    uint32_t volatile dropped_count;
+    uint32_t volatile enqueue_position;
+    uint32_t volatile dequeue_position;
+    _az_http_tracing_slot slots[AZ_HTTP_TRACING_SPAN_BUFFER_SIZE];
+  } _internal;
+} az_http_policy_tracing;
+
+/**
+ * @brief Initializes an #az_http_policy_tracing.
+ *
+ * @param[out] out_tracing The #az_http_policy_tracing to initialize.
+ * @param[in] export_span The #az_http_tracing_export_fn to hand finished spans to.
+ * @param[in] user_context A pointer passed as is to \p export_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The tracing is initialized.
+ */
+AZ_NODISCARD az_result az_http_policy_tracing_init(
+    az_http_policy_tracing* out_tracing,
+    az_http_tracing_export_fn export_span,
+    void* user_context);
+
+/**
+ * @brief Hands the spans which finished so far to the exporter of an #az_http_policy_tracing, in
+ * the order they finished.
+ *
+ * @param[in,out] ref_tracing The #az_http_policy_tracing with the finished spans.
+ *
+ * @return The number of spans exported.
+ */
+int32_t az_http_policy_tracing_flush(az_http_policy_tracing* ref_tracing);
+
 typedef enum
 {
   _az_HTTP_RESPONSE_KIND_STATUS_LINE = 0,
@@ -145,13 +752,99 @@ typedef enum
   _az_HTTP_RESPONSE_KIND_EOF = 3,
 } _az_http_response_kind;
 
+typedef struct
+{
+  az_span remaining; // the remaining un-parsed portion of the original http_response.
+  _az_http_response_kind next_kind;
+  // After parsing an element, next_kind refers to the next expected element
+  int32_t next_header; // the position of the next header, counted from the first one.
+} _az_http_response_parser;
+
+typedef enum
+{
+  _az_HTTP_RESPONSE_HEADER_INDEX_NOT_BUILT = 0,
+  _az_HTTP_RESPONSE_HEADER_INDEX_BUILT = 1,
+  // The headers don't fit in the index, or are corrupt, and are parsed again on each use.
+  _az_HTTP_RESPONSE_HEADER_INDEX_UNAVAILABLE = 2,
+} _az_http_response_header_index_state;
+
+// Offsets are from the start of the http_response buffer.
+typedef enum
+{
+  _az_HTTP_RESPONSE_BODY_DECODING_NOT_STARTED = 0, // No byte of the body was received yet.
+  _az_HTTP_RESPONSE_BODY_DECODING_IDENTITY = 1, // The body isn't compressed.
+  _az_HTTP_RESPONSE_BODY_DECODING_STARTED = 2,
+  _az_HTTP_RESPONSE_BODY_DECODING_ENDED = 3,
+} _az_http_response_body_decoding_state;
+
+typedef struct
+{
+  uint32_t name_hash;
+  int32_t line_offset;
+  int32_t name_offset;
+  int32_t name_size;
+  int32_t value_offset;
+  int32_t value_size;
+} _az_http_response_header_index_entry;
+
+/**
+ * @brief Defines the signature of the callback which receives the next part of an HTTP response
+ * body from an #az_http_response_body_sink, as it arrives from the network.
+ *
+ * @param[in] user_context The user context of the #az_http_response_body_sink.
+ * @param[in] body_part The next bytes of the body. It is only valid until the callback returns.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, which stops receiving the response and is returned to the caller.
+ */
+typedef AZ_NODISCARD az_result (*az_http_response_body_write_fn)(
+    void* user_context,
+    az_span body_part);
+
+/**
+ * @brief Defines the signature of the callback which discards what an #az_http_response_body_sink
+ * received so far, before the request is sent again.
+ *
+ * @param[in] user_context The user context of the #az_http_response_body_sink.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, and the request is not sent again.
+ */
+typedef AZ_NODISCARD az_result (*az_http_response_body_reset_fn)(void* user_context);
+
+/**
+ * @brief Receives the body of a successful (2xx) HTTP response as it arrives, so that the body does
+ * not have to fit in the #az_http_response buffer.
+ *
+ * @remarks The status line and headers are still written into the #az_http_response buffer, and so
+ * is the body of any response which is not successful, such as an error the retry policy retries.
+ *
+ * @remarks When part of a body was received before the request has to be sent again, the sink is
+ * reset first. Requests whose response body sink received data and can't be reset are not retried.
+ */
+typedef struct
+{
+  /// Receives the next part of the body.
+  az_http_response_body_write_fn write;
+
+  /// __[nullable]__ Discards the body received so far. `NULL` if the body can only be received
+  /// once.
+  az_http_response_body_reset_fn reset;
+
+  /// A pointer passed as is to the \p write and \p reset callbacks.
+  void* user_context;
+} az_http_response_body_sink;
+
 /**
  * @brief Allows you to parse an HTTP response's status line, headers, and body.
  *
  * @details Users create an instance of this and pass it in to an Azure service client's operation
  * function. The function initializes the #az_http_response and application code can query the
  * response after the operation completes by calling the #az_http_response_get_status_line(),
- * #az_http_response_get_next_header() and #az_http_response_get_body() functions.
+ * #az_http_response_get_next_header(), #az_http_response_get_header() and
+ * #az_http_response_get_body() functions.
  */
 typedef struct
 {
@@ -159,12 +852,21 @@ typedef struct
   {
     az_span http_response;
     int32_t written;
+    az_http_response_body_sink const* body_sink; // Receives successful bodies when not NULL.
+    bool is_body_streamed; // Whether the body went to the body_sink rather than http_response.
     struct
     {
-      az_span remaining; // the remaining un-parsed portion of the original http_response.
-      _az_http_response_kind next_kind;
-      // After parsing an element, next_kind refers to the next expected element
-    } parser;
+      az_http_content_codec const* codec; // Decompresses the body when not NULL.
+      _az_http_response_body_decoding_state state;
+    } body_decoding;
+    _az_http_response_parser parser;
+    struct
+    {
+      _az_http_response_header_index_state state;
+      int32_t count;
+      int32_t headers_end; // The offset of the empty line which ends the headers.
+      _az_http_response_header_index_entry entries[AZ_HTTP_RESPONSE_HEADER_INDEX_SIZE];
+    } header_index; // Built on first use, and each time the http_response is appended to.
   } _internal;
 } az_http_response;
 
@@ -187,9 +889,19 @@ az_http_response_init(az_http_response* out_response, az_span buffer)
     ._internal = {
       .http_response = buffer,
       .written = 0,
+      .body_sink = NULL,
+      .is_body_streamed = false,
+      .body_decoding = {
+        .codec = NULL,
+        .state = _az_HTTP_RESPONSE_BODY_DECODING_NOT_STARTED,
+      },
       .parser = {
         .remaining = AZ_SPAN_EMPTY,
         .next_kind = _az_HTTP_RESPONSE_KIND_STATUS_LINE,
+        .next_header = 0,
+      },
+      .header_index = {
+        .state = _az_HTTP_RESPONSE_HEADER_INDEX_NOT_BUILT,
       },
     },
   };
@@ -197,6 +909,22 @@ az_http_response_init(az_http_response* out_response, az_span buffer)
   return AZ_OK;
 }
 
+/**
+ * @brief Streams the body of a successful response to an #az_http_response_body_sink, instead of
+ * writing it into the #az_http_response buffer.
+ *
+ * @param[in,out] ref_response The initialized #az_http_response to set the body sink of. The sink
+ * is kept until #az_http_response_init() is called again.
+ * @param[in] body_sink __[nullable]__ The #az_http_response_body_sink, which must stay valid until
+ * the response has been received. `NULL` writes the body into the buffer again.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_http_response_set_body_sink(
+    az_http_response* ref_response,
+    az_http_response_body_sink const* body_sink);
+
 /**
  * @brief Represents the result of making an HTTP request.
  * An application obtains this initialized structure by calling #az_http_response_get_status_line().
@@ -255,11 +983,34 @@ AZ_NODISCARD az_result az_http_response_get_next_header(
     az_span* out_name,
     az_span* out_value);
 
+/**
+ * @brief Returns the value of an HTTP response header.
+ *
+ * @details The headers are indexed the first time they are looked up or iterated over, so that
+ * later lookups and #az_http_response_get_next_header() do not parse them again. Looking a header
+ * up does not change which header #az_http_response_get_next_header() returns next.
+ *
+ * @param[in,out] ref_response A pointer to an #az_http_response instance.
+ * @param[in] name The name of the header, which is compared ignoring case.
+ * @param[out] out_value A pointer to an #az_span to receive the value of the first header named
+ * \p name.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The header value was returned.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The HTTP response has no header named \p name.
+ * @retval #AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER The HTTP response contains an unexpected invalid
+ * character or is incomplete.
+ * @retval other The HTTP response status line was not parsed.
+ */
+AZ_NODISCARD az_result
+az_http_response_get_header(az_http_response* ref_response, az_span name, az_span* out_value);
+
 /**
  * @brief Returns a span over the HTTP body within an HTTP response.
  *
  * @param[in,out] ref_response A pointer to an #az_http_response instance.
- * @param[out] out_body A pointer to an #az_span to receive the HTTP response's body.
+ * @param[out] out_body A pointer to an #az_span to receive the HTTP response's body. It is empty
+ * when the body was streamed to the #az_http_response_body_sink of the response.
  *
  * @return An #az_result value indicating the result of the operation.
  * @retval #AZ_OK An #az_span over the response body was returned.
@@ -55,6 +55,22 @@ AZ_INLINE az_http_method az_http_method_delete() { return AZ_SPAN_FROM_STR("DELE
  */
 AZ_INLINE az_http_method az_http_method_patch() { return AZ_SPAN_FROM_STR("PATCH"); }
 
+/**
+ * @brief Identifies the well-known HTTP request headers, whose position in an #az_http_request is
+ * kept in a table, so that they can be found and replaced without scanning the headers.
+ */
+typedef enum
+{
+  AZ_HTTP_HEADER_ID_NONE = 0, ///< Not a well-known header.
+  AZ_HTTP_HEADER_ID_AUTHORIZATION, ///< `Authorization`.
+  AZ_HTTP_HEADER_ID_CONTENT_LENGTH, ///< `Content-Length`.
+  AZ_HTTP_HEADER_ID_CONTENT_TYPE, ///< `Content-Type`.
+  AZ_HTTP_HEADER_ID_USER_AGENT, ///< `User-Agent`.
+  AZ_HTTP_HEADER_ID_X_MS_CLIENT_REQUEST_ID, ///< `x-ms-client-request-id`.
+  AZ_HTTP_HEADER_ID_X_MS_VERSION, ///< `x-ms-version`.
+  _az_HTTP_HEADER_ID_COUNT, // The size of the table of well-known headers.
+} az_http_header_id;
+
 /**
  * @brief Represents a name/value pair of #az_span instances.
  */
@@ -88,7 +104,11 @@ typedef struct
     int32_t headers_length;
     int32_t max_headers;
     int32_t retry_headers_start_byte_offset;
+    // 1 + the index of the first header with each #az_http_header_id, or 0 when it wasn't added.
+    int32_t well_known_headers[_az_HTTP_HEADER_ID_COUNT];
     az_span body;
+    az_http_request_body_provider const* body_provider; // Replaces the body when not NULL.
+    int32_t retry_count; // The retries the retry policy made, so far.
   } _internal;
 } az_http_request;
 
@@ -124,6 +144,67 @@ struct _az_http_policy
   } _internal;
 };
 
+/**
+ * @brief The policies of an HTTP pipeline. The process function of an #az_http_custom_policy is
+ * passed those which follow it, to call with #az_http_pipeline_next_policy().
+ */
+typedef _az_http_policy az_http_policy;
+
+/**
+ * @brief Defines the callback signature of the process function of an #az_http_custom_policy,
+ * which receives the #az_http_policy array which follows it, its options, an #az_http_request and
+ * an #az_http_response.
+ */
+typedef _az_http_policy_process_fn az_http_policy_process_fn;
+
+/**
+ * @brief Where an #az_http_custom_policy is added to the HTTP pipeline of a client.
+ */
+typedef enum
+{
+  /// Before the retry policy: the policy processes each request once, and gets its final
+  /// response, once the retries are over.
+  AZ_HTTP_POLICY_POSITION_PER_CALL = 0,
+
+  /// After the retry and authentication policies, right before the logging and transport
+  /// policies: the policy processes each attempt to send a request, retries included.
+  AZ_HTTP_POLICY_POSITION_PER_RETRY = 1,
+} az_http_policy_position;
+
+/**
+ * @brief A policy of the application, added to the HTTP pipeline of a client when it is
+ * initialized, such as a cache or a policy measuring the requests.
+ */
+typedef struct
+{
+  /// The function which processes the request, and calls #az_http_pipeline_next_policy() with the
+  /// policies it is passed, unless it produces the response itself.
+  az_http_policy_process_fn process;
+
+  /// The options passed to #process, which must stay valid as long as the client is used.
+  void* options;
+
+  /// Where the policy is added to the pipeline.
+  az_http_policy_position position;
+} az_http_custom_policy;
+
+/**
+ * @brief Sends a request to the policies which follow a policy in the HTTP pipeline, from the
+ * process function of an #az_http_custom_policy.
+ *
+ * @param[in] ref_policies The policies which the process function is passed.
+ * @param[in,out] ref_request The request to send.
+ * @param[in,out] ref_response The response to write.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure of the policies which follow.
+ */
+AZ_NODISCARD az_result az_http_pipeline_next_policy(
+    az_http_policy* ref_policies,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
 /**
  * @brief Gets the HTTP header by index.
  *
@@ -142,6 +223,22 @@ AZ_NODISCARD az_result az_http_request_get_header(
     az_span* out_name,
     az_span* out_value);
 
+/**
+ * @brief Gets the value of a well-known HTTP header of the request, without scanning its headers.
+ *
+ * @param[in] request HTTP request to get HTTP header from.
+ * @param[in] id The #az_http_header_id of the header, other than #AZ_HTTP_HEADER_ID_NONE.
+ * @param[out] out_value A pointer to an #az_span to write the header's value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_ITEM_NOT_FOUND The request has no such header.
+ */
+AZ_NODISCARD az_result az_http_request_get_header_by_id(
+    az_http_request const* request,
+    az_http_header_id id,
+    az_span* out_value);
+
 /**
  * @brief Get method of an HTTP request.
  *
@@ -185,6 +282,24 @@ AZ_NODISCARD az_result az_http_request_get_url(az_http_request const* request, a
  */
 AZ_NODISCARD az_result az_http_request_get_body(az_http_request const* request, az_span* out_body);
 
+/**
+ * @brief Get the body provider of an HTTP request, which streams the body instead of the #az_span
+ * returned by #az_http_request_get_body().
+ *
+ * @remarks This function is expected to be used by transport layer only.
+ *
+ * @param[in] request The HTTP request from which to get the body provider.
+ * @param[out] out_body_provider Pointer to write the #az_http_request_body_provider to, or `NULL`
+ * when the body of the request is an #az_span.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure.
+ */
+AZ_NODISCARD az_result az_http_request_get_body_provider(
+    az_http_request const* request,
+    az_http_request_body_provider const** out_body_provider);
+
 /**
  * @brief This function is expected to be used by transport adapters like curl. Use it to write
  * content from \p source to \p ref_response.
@@ -201,6 +316,132 @@ AZ_NODISCARD az_result az_http_request_get_body(az_http_request const* request,
  */
 AZ_NODISCARD az_result az_http_response_append(az_http_response* ref_response, az_span source);
 
+/**
+ * @brief This function is expected to be used by transport adapters like curl. Use it to write the
+ * body of the response from \p source, once the status line and headers were written with
+ * #az_http_response_append().
+ *
+ * @details When the response has an #az_http_response_body_sink and its status code is successful
+ * (2xx), \p source is passed to the sink. Otherwise, it is written into \p ref_response.
+ *
+ * @param[in,out] ref_response Pointer to an #az_http_response.
+ * @param[in] source This is an #az_span with the next part of the body.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The \p response buffer is not big enough to contain the \p
+ * source content.
+ * @retval other Any failure from the #az_http_response_body_sink.
+ */
+AZ_NODISCARD az_result
+az_http_response_append_body(az_http_response* ref_response, az_span source);
+
+typedef enum
+{
+  _az_HTTP_RESPONSE_DECODER_STATE_HEADERS = 0,
+  _az_HTTP_RESPONSE_DECODER_STATE_BODY = 1,
+  _az_HTTP_RESPONSE_DECODER_STATE_BODY_UNTIL_CLOSE = 2,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE = 3,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_EXTENSION = 4,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE_LF = 5,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA = 6,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_CR = 7,
+  _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_LF = 8,
+  _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE_START = 9,
+  _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE = 10,
+  _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LF = 11,
+  _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE = 12,
+} _az_http_response_decoder_state;
+
+/**
+ * @brief An incremental HTTP/1.1 response parser, which writes a response received from a
+ * connection into an #az_http_response, whatever the fragments it is received in.
+ *
+ * @details The status line and headers are written with #az_http_response_append(), and the body
+ * with #az_http_response_append_body(), so it can go to an #az_http_response_body_sink. A
+ * `Transfer-Encoding: chunked` body is decoded as it is received: only the chunk data is written,
+ * and the trailers are discarded. Interim (1xx) responses are discarded as well.
+ *
+ * @remarks This lets an HTTP transport adapter which reads from a socket itself, rather than
+ * through an HTTP stack, fill an #az_http_response.
+ */
+typedef struct
+{
+  struct
+  {
+    az_http_response* response;
+    _az_http_response_decoder_state state;
+    int64_t remaining; // The size of the body, or of the current chunk, left to receive.
+    int32_t headers_end_size; // The size of the "\r\n\r\n" ending the headers received so far.
+    int32_t chunk_size_digits;
+    bool is_head_request; // The response to a HEAD request has no body.
+  } _internal;
+} az_http_response_decoder;
+
+/**
+ * @brief Initializes an #az_http_response_decoder to parse the response to a request.
+ *
+ * @param[out] out_decoder The #az_http_response_decoder to initialize.
+ * @param[in,out] ref_response The initialized #az_http_response to write the response into. It
+ * must stay valid until the response was decoded.
+ * @param[in] method The HTTP method of the request the response is received for.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_http_response_decoder_init(
+    az_http_response_decoder* out_decoder,
+    az_http_response* ref_response,
+    az_http_method method);
+
+/**
+ * @brief Parses the next bytes received from the connection.
+ *
+ * @param[in,out] ref_decoder The #az_http_response_decoder.
+ * @param[in] received The bytes received, which can end anywhere in the response.
+ * @param[out] out_bytes_used The number of bytes of \p received which were part of the response.
+ * It is smaller than the size of \p received only when the response is complete, and the bytes
+ * left belong to the next response on the connection.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The bytes were parsed. Use #az_http_response_decoder_is_complete() to know
+ * whether the whole response was received.
+ * @retval #AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER The status line or the headers are invalid.
+ * @retval #AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY The chunked body is invalid.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The #az_http_response buffer is not big enough.
+ * @retval other Any failure from the #az_http_response_body_sink.
+ */
+AZ_NODISCARD az_result az_http_response_decoder_feed(
+    az_http_response_decoder* ref_decoder,
+    az_span received,
+    int32_t* out_bytes_used);
+
+/**
+ * @brief Tells the #az_http_response_decoder that the connection was closed, which ends a body
+ * with neither a `Content-Length` nor a chunked `Transfer-Encoding`.
+ *
+ * @param[in,out] ref_decoder The #az_http_response_decoder.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The whole response was received.
+ * @retval #AZ_ERROR_HTTP_CONNECTION_INTERRUPTED The connection was closed before the whole
+ * response was received.
+ */
+AZ_NODISCARD az_result az_http_response_decoder_end(az_http_response_decoder* ref_decoder);
+
+/**
+ * @brief Returns whether the whole response was received.
+ *
+ * @param[in] decoder The #az_http_response_decoder.
+ *
+ * @return `true` once the end of the response was parsed, `false` otherwise.
+ */
+AZ_NODISCARD AZ_INLINE bool az_http_response_decoder_is_complete(
+    az_http_response_decoder const* decoder)
+{
+  return decoder->_internal.state == _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE;
+}
+
 /**
  * @brief Returns the number of headers within the request.
  *
@@ -225,11 +466,239 @@ AZ_NODISCARD int32_t az_http_request_headers_count(az_http_request const* reques
  * response from the network.
  * @retval #AZ_ERROR_HTTP_RESPONSE_COULDNT_RESOLVE_HOST The URL from \p ref_request can't be
  * resolved by the HTTP stack and the request was not sent.
+ * @retval #AZ_ERROR_HTTP_CONNECTION_INTERRUPTED The connection, or the HTTP/2 stream, the request
+ * was sent over failed before the whole response was received. Sending the request again can
+ * succeed.
  * @retval #AZ_ERROR_HTTP_ADAPTER Any other issue from the transport adapter layer.
  */
 AZ_NODISCARD az_result
 az_http_client_send_request(az_http_request const* request, az_http_response* ref_response);
 
+/**
+ * @brief Defines the callback signature invoked by #az_http_client_async_poll() when a request
+ * submitted with #az_http_client_async_submit() completes.
+ *
+ * @param[in] request The #az_http_request which was submitted.
+ * @param[in,out] ref_response The #az_http_response the response was written into.
+ * @param[in] result The result of sending the request, with the same meaning as the result of
+ * #az_http_client_send_request(). It is #AZ_ERROR_CANCELED if the context of the request expired,
+ * or if the request was still in flight when #az_http_client_async_deinit() was called.
+ * @param[in] user_context The user context passed to #az_http_client_async_submit().
+ */
+typedef void (*az_http_client_async_callback)(
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_result result,
+    void* user_context);
+
+/**
+ * @brief Allows customization of how an #az_http_client_async connects to the services.
+ *
+ * @remarks These options only apply to the requests submitted to the #az_http_client_async, such
+ * as the copies sent by the hedging policy. The transport policy which ends the pipeline of the
+ * SDK clients sends requests with #az_http_client_send_request(), which doesn't multiplex them.
+ */
+typedef struct
+{
+  /**
+   * Negotiate HTTP/2 with the services over TLS, and multiplex the requests in flight to the same
+   * host over a single connection. Hosts which only support HTTP/1.1 keep using one connection per
+   * request in flight. Default is `false`.
+   */
+  bool enable_http2;
+
+  /**
+   * The maximum number of requests multiplexed over a single HTTP/2 connection, when HTTP/2 is
+   * enabled. Zero lets the service decide. Default is `100`.
+   */
+  int32_t max_concurrent_streams;
+
+  /**
+   * The maximum number of connections to a single host. Requests beyond the limit are queued
+   * until a connection, or an HTTP/2 stream, is available. Zero means no limit. Default is `0`.
+   */
+  int32_t max_host_connections;
+} az_http_client_async_options;
+
+/**
+ * @brief Gets the default #az_http_client_async_options, which send every request over HTTP/1.1.
+ *
+ * @details Call this to obtain an initialized #az_http_client_async_options structure that can be
+ * modified and passed to #az_http_client_async_init().
+ *
+ * @return The default #az_http_client_async_options.
+ */
+AZ_NODISCARD AZ_INLINE az_http_client_async_options az_http_client_async_options_default()
+{
+  return (az_http_client_async_options){
+    .enable_http2 = false,
+    .max_concurrent_streams = 100,
+    .max_host_connections = 0,
+  };
+}
+
+/**
+ * @brief Sends many HTTP requests at once from a single thread.
+ *
+ * @remarks Requests are submitted with #az_http_client_async_submit(), and sent while the thread
+ * calls #az_http_client_async_poll(), which invokes the callback of each request as it completes.
+ */
+typedef struct
+{
+  struct
+  {
+    void* multi_handle;
+    void* transfers; // Requests in flight.
+    int32_t transfer_count;
+    az_http_client_async_options options;
+  } _internal;
+} az_http_client_async;
+
+/**
+ * @brief Initializes an #az_http_client_async.
+ *
+ * @param[out] out_client The #az_http_client_async to initialize.
+ * @param[in] options __[nullable]__ A reference to an #az_http_client_async_options structure
+ * which defines how the client connects to the services. If `NULL` is passed, the client will use
+ * the default options (i.e. #az_http_client_async_options_default()).
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_HTTP_ADAPTER The HTTP stack could not be initialized.
+ * @retval #AZ_ERROR_DEPENDENCY_NOT_PROVIDED There is no HTTP stack which can send requests
+ * asynchronously.
+ */
+AZ_NODISCARD az_result az_http_client_async_init(
+    az_http_client_async* out_client,
+    az_http_client_async_options const* options);
+
+/**
+ * @brief Starts sending an HTTP request, without waiting for the response.
+ *
+ * @param[in,out] ref_client The #az_http_client_async to send the request with.
+ * @param[in] request The #az_http_request to send. The request, its buffers and its context must
+ * stay valid until its callback is invoked.
+ * @param[in,out] ref_response The #az_http_response to write the response into. It must stay valid
+ * until the callback is invoked.
+ * @param[in] callback The #az_http_client_async_callback to invoke once the request completes.
+ * @param[in] user_context A pointer passed as is to the \p callback.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The request was submitted, and \p callback will be invoked exactly once.
+ * @retval #AZ_ERROR_OUT_OF_MEMORY The request could not be submitted.
+ * @retval #AZ_ERROR_HTTP_INVALID_METHOD_VERB The HTTP method of \p request is not supported.
+ * @retval #AZ_ERROR_HTTP_ADAPTER Any other issue from the transport adapter layer.
+ *
+ * @remarks If submitting fails, the \p callback is not invoked.
+ */
+AZ_NODISCARD az_result az_http_client_async_submit(
+    az_http_client_async* ref_client,
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_http_client_async_callback callback,
+    void* user_context);
+
+/**
+ * @brief Sends and receives the data of every request in flight, waiting up to \p timeout_msec
+ * for the network when there is nothing to do, and invokes the callback of each request which
+ * completes.
+ *
+ * @param[in,out] ref_client The #az_http_client_async with the requests in flight.
+ * @param[in] timeout_msec The maximum time to wait for network activity, in milliseconds.
+ * @param[out] out_in_flight_count __[nullable]__ The number of requests still in flight, once the
+ * completed ones have been reported. Can be `NULL`.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success. Individual requests report their own result to their callback.
+ * @retval #AZ_ERROR_HTTP_ADAPTER The HTTP stack failed, and no request can make progress.
+ *
+ * @remarks Callbacks may submit more requests to \p ref_client.
+ */
+AZ_NODISCARD az_result az_http_client_async_poll(
+    az_http_client_async* ref_client,
+    int32_t timeout_msec,
+    int32_t* out_in_flight_count);
+
+/**
+ * @brief Releases the resources of an #az_http_client_async. The callback of every request still
+ * in flight is invoked with #AZ_ERROR_CANCELED, and must not submit more requests.
+ *
+ * @param[in,out] ref_client The #az_http_client_async to release.
+ */
+void az_http_client_async_deinit(az_http_client_async* ref_client);
+
+/**
+ * @brief Allows you to customize the hedging policy, which sends a second copy of a `GET` or
+ * `HEAD` request when the first one is slow to complete, and keeps the response which succeeds
+ * first.
+ *
+ * @details The copy is sent once the request has been in flight for longer than
+ * #latency_percentile percent of the recent requests, or than #hedge_delay_msec until enough of
+ * them were measured, and never sooner than #hedge_delay_msec. The request which loses the race
+ * is canceled. A response succeeds unless the request fails, or its status code is 5xx.
+ *
+ * @remarks Both copies of the request are sent by #client, without going through the policies
+ * which follow the hedging policy. The hedging policy is therefore the last policy of the
+ * pipeline of a client, right ahead of the transport policy it takes the place of, such as the
+ * Storage Blobs client does with its `hedging` option. Logging, for instance, comes before it and
+ * logs each request once. The options keep the recent latencies, so they must not be shared by
+ * requests sent from several threads at a time.
+ *
+ * @remarks Requests are hedged only when #client is set, the copy of the response fits in
+ * #hedge_response_buffer, and the response has neither an #az_http_response_body_sink nor a
+ * content codec. Other requests are passed on to the next policy. Each copy takes a retry from
+ * #budget, so that hedging can't multiply the load on a service which is already slow; a copy
+ * which could not be sent gives its retry back.
+ */
+typedef struct
+{
+  /// The #az_http_client_async which sends both copies of the request, or _NULL_ to disable
+  /// hedging.
+  az_http_client_async* client;
+
+  /// The buffer the response to the copy of the request is received into.
+  az_span hedge_response_buffer;
+
+  /// The shortest time, in milliseconds, to wait for the response before sending a copy of the
+  /// request.
+  int32_t hedge_delay_msec;
+
+  /// The percentile of the recent latencies after which a copy of the request is sent, or 0 to
+  /// always wait #hedge_delay_msec.
+  int32_t latency_percentile;
+
+  /// The retry budget each copy of a request is taken from, such as the budget of the retry
+  /// policy, or _NULL_ to send a copy of every slow request.
+  az_http_policy_retry_budget* budget;
+
+  struct
+  {
+    int32_t latencies[AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT]; // In milliseconds.
+    int32_t latency_count;
+    int32_t next_latency;
+  } _internal;
+} az_http_policy_hedging_options;
+
+/**
+ * @brief Gets the default hedging options, which send a copy of a request after 50 milliseconds,
+ * or after the 95th percentile of the recent latencies when it is longer.
+ *
+ * @details Hedging is disabled until #az_http_policy_hedging_options.client is set.
+ *
+ * @return The default #az_http_policy_hedging_options.
+ */
+AZ_NODISCARD AZ_INLINE az_http_policy_hedging_options az_http_policy_hedging_options_default()
+{
+  return (az_http_policy_hedging_options){
+    .client = NULL,
+    .hedge_response_buffer = AZ_SPAN_EMPTY,
+    .hedge_delay_msec = 50,
+    .latency_percentile = 95,
+    .budget = NULL,
+    ._internal = { .latencies = { 0 }, .latency_count = 0, .next_latency = 0 },
+  };
+}
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_TRANSPORT_H
@@ -297,6 +297,12 @@ AZ_NODISCARD AZ_INLINE az_json_writer_options az_json_writer_options_default()
  *
  * @remarks #az_json_writer builds the text sequentially with no caching and by default adheres to
  * the JSON RFC: https://tools.ietf.org/html/rfc8259.
+ *
+ * @remarks When the SDK is compiled with `AZ_NO_PRECONDITION_CHECKING`, the writer doesn't track
+ * the kind of the last token or the object/array nesting, and the caller is responsible for
+ * appending tokens in a valid order. The JSON text written is identical in both modes. The SDK and
+ * the application must be compiled with the same setting, since it changes the size of
+ * #az_json_writer.
  */
 typedef struct
 {
@@ -309,8 +315,13 @@ typedef struct
     az_span_allocator_fn allocator_callback;
     void* user_context;
     bool need_comma;
-    az_json_token_kind token_kind; // needed for validation, potentially #if/def with preconditions.
-    _az_json_bit_stack bit_stack; // needed for validation, potentially #if/def with preconditions.
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    az_json_token_kind token_kind; // needed for validation.
+    _az_json_bit_stack bit_stack; // needed for validation.
+#else
+    // Without preconditions, only the depth is tracked, to detect AZ_ERROR_JSON_NESTING_OVERFLOW.
+    int32_t current_depth;
+#endif // AZ_NO_PRECONDITION_CHECKING
     az_json_writer_options options;
   } _internal;
 } az_json_writer;
@@ -384,6 +395,70 @@ az_json_writer_get_bytes_used_in_destination(az_json_writer const* json_writer)
       json_writer->_internal.destination_buffer, 0, json_writer->_internal.bytes_written);
 }
 
+/**
+ * @brief Resets an #az_json_writer so that it can be reused to write new JSON text, from the start
+ * of its current destination buffer.
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to reset.
+ *
+ * @remarks The options and the allocator callback passed at initialization are kept, and the
+ * destination buffer is not cleared. For a writer initialized with #az_json_writer_chunked_init(),
+ * writing starts over at the beginning of the last buffer provided by the allocator callback.
+ */
+void az_json_writer_reset(az_json_writer* ref_json_writer);
+
+/**
+ * @brief A position within the JSON text written by an #az_json_writer, which the writer can
+ * later be rolled back to, discarding everything written after it.
+ *
+ * @remarks Use #az_json_writer_get_mark() to create one, and #az_json_writer_rollback() to roll
+ * back to it.
+ */
+typedef struct
+{
+  struct
+  {
+    uint8_t* destination_ptr;
+    int32_t bytes_written;
+    int32_t total_bytes_written;
+    bool need_comma;
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    az_json_token_kind token_kind;
+    _az_json_bit_stack bit_stack;
+#else
+    int32_t current_depth;
+#endif // AZ_NO_PRECONDITION_CHECKING
+  } _internal;
+} az_json_writer_mark;
+
+/**
+ * @brief Gets the current position of the #az_json_writer, so that it can be rolled back to it.
+ *
+ * @param[in] json_writer A pointer to an #az_json_writer instance.
+ *
+ * @return An #az_json_writer_mark for the current position of the \p json_writer.
+ */
+AZ_NODISCARD az_json_writer_mark az_json_writer_get_mark(az_json_writer const* json_writer);
+
+/**
+ * @brief Rolls back the #az_json_writer to a position returned by #az_json_writer_get_mark(),
+ * discarding the JSON text written after it.
+ *
+ * @param[in,out] ref_json_writer A pointer to the #az_json_writer instance the \p mark was taken
+ * from.
+ * @param[in] mark A pointer to the #az_json_writer_mark to roll back to.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The writer was rolled back successfully.
+ * @retval #AZ_ERROR_JSON_INVALID_STATE The writer has moved on to another destination buffer,
+ * provided by the allocator callback, since the \p mark was taken, so it cannot be rolled back.
+ *
+ * @remarks This is useful to discard a partially written JSON value, for example, when the
+ * destination doesn't have enough space to hold it, and continue writing from the mark.
+ */
+AZ_NODISCARD az_result
+az_json_writer_rollback(az_json_writer* ref_json_writer, az_json_writer_mark const* mark);
+
 /**
  * @brief Appends the UTF-8 text value (as a JSON string) into the buffer.
  *
@@ -421,7 +496,8 @@ AZ_NODISCARD az_result az_json_writer_append_string(az_json_writer* ref_json_wri
  * @retval #AZ_OK The provided \p json_text was appended successfully.
  * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The destination is too small for the provided \p json_text.
  * @retval #AZ_ERROR_JSON_INVALID_STATE The \p ref_json_writer is in a state where the \p json_text
- * cannot be appended because it would result in invalid JSON.
+ * cannot be appended because it would result in invalid JSON. This is not checked when the SDK is
+ * compiled with `AZ_NO_PRECONDITION_CHECKING`.
  * @retval #AZ_ERROR_UNEXPECTED_END The provided \p json_text is invalid because it is incomplete
  * and ends too early.
  * @retval #AZ_ERROR_UNEXPECTED_CHAR The provided \p json_text is invalid because of an unexpected
@@ -430,6 +506,26 @@ AZ_NODISCARD az_result az_json_writer_append_string(az_json_writer* ref_json_wri
 AZ_NODISCARD az_result
 az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_text);
 
+/**
+ * @brief Appends the JSON text written by another #az_json_writer into the buffer, useful for
+ * appending nested JSON that was built separately.
+ *
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance containing the buffer to
+ * append the nested JSON text to.
+ * @param[in] nested_json_writer A pointer to an #az_json_writer instance, initialized with
+ * #az_json_writer_init(), that contains a single, complete, JSON value.
+ *
+ * @remarks Unlike #az_json_writer_append_json_text(), the JSON text is copied without being
+ * validated, since it was already written by an #az_json_writer.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The nested JSON text was appended successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The buffer is too small.
+ */
+AZ_NODISCARD az_result az_json_writer_append_nested_writer(
+    az_json_writer* ref_json_writer,
+    az_json_writer const* nested_json_writer);
+
 /**
  * @brief Appends the UTF-8 property name (as a JSON string) which is the first part of a name/value
  * pair of a JSON object.
@@ -732,6 +828,122 @@ AZ_NODISCARD az_result az_json_reader_next_token(az_json_reader* ref_json_reader
  */
 AZ_NODISCARD az_result az_json_reader_skip_children(az_json_reader* ref_json_reader);
 
+/************************************ JSON TRANSCODING ******************/
+
+/**
+ * @brief Defines the layout of the JSON text written by #az_json_transcode().
+ */
+typedef enum
+{
+  AZ_JSON_TRANSCODE_MINIFY, ///< The JSON text is written without any insignificant white space.
+  AZ_JSON_TRANSCODE_PRETTY_PRINT, ///< Each array value and object property is written on its own
+                                  ///< line, indented by two spaces per nesting level.
+} az_json_transcode_format;
+
+/**
+ * @brief Reads all of the JSON text from an #az_json_reader and writes it to an #az_json_writer,
+ * changing only the white space between tokens.
+ *
+ * @param[in,out] ref_json_reader A pointer to an #az_json_reader instance containing the JSON to
+ * read, which must not have read any token yet.
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to write the JSON text
+ * into.
+ * @param[in] format The #az_json_transcode_format of the JSON text to write.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The JSON text was transcoded successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The destination of the \p ref_json_writer is too small.
+ * @retval #AZ_ERROR_UNEXPECTED_END The JSON text being read is incomplete.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR The JSON text being read is invalid.
+ *
+ * @remarks The bytes of string, property name, number, and literal tokens are copied as is, without
+ * unescaping or escaping them again.
+ *
+ * @remarks Both the reader and the writer can be chunked (i.e. initialized with
+ * #az_json_reader_chunked_init() or #az_json_writer_chunked_init()), so that neither the input, nor
+ * the output, needs to be in a single contiguous buffer.
+ */
+AZ_NODISCARD az_result az_json_transcode(
+    az_json_reader* ref_json_reader,
+    az_json_writer* ref_json_writer,
+    az_json_transcode_format format);
+
+/************************************ JSON MERGE PATCH ******************/
+
+/**
+ * @brief Writes the JSON merge patch (RFC 7386) which turns one JSON document into another.
+ *
+ * @param[in] original_json The JSON document before the changes.
+ * @param[in] modified_json The JSON document after the changes.
+ * @param[in] scratch_buffer A buffer used to index the properties of the original objects while
+ * comparing them. Nothing is allocated outside of this buffer.
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to write the merge patch
+ * into.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The merge patch was written successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Either the \p scratch_buffer or the destination of the \p
+ * ref_json_writer is too small.
+ * @retval #AZ_ERROR_UNEXPECTED_END Either JSON document is incomplete.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR Either JSON document is invalid.
+ * @retval #AZ_ERROR_NOT_IMPLEMENTED A property name contains a character escaped as `\\uXXXX`.
+ *
+ * @remarks Properties which were added or whose value changed are written with their new value,
+ * and properties which were removed are written as `null`. Objects are compared property by
+ * property, while any other value (including arrays) is written whole when it changed. If both
+ * documents aren't objects, the patch is the \p modified_json itself.
+ *
+ * @remarks The \p scratch_buffer needs room for the unescaped names of the properties of the
+ * original objects being compared at once, plus an index entry (the size of a few pointers) per
+ * property.
+ *
+ * @remarks This is used, for instance, to build the payload for the topic returned by
+ * `az_iot_hub_client_twin_patch_get_publish_topic()` from the previous and current reported
+ * properties of a device, so that only what changed is sent.
+ */
+AZ_NODISCARD az_result az_json_merge_patch_create(
+    az_span original_json,
+    az_span modified_json,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer);
+
+/**
+ * @brief Writes the JSON document which results from applying a JSON merge patch (RFC 7386) to
+ * another JSON document.
+ *
+ * @param[in] target_json The JSON document to apply the patch to.
+ * @param[in] patch_json The JSON merge patch.
+ * @param[in] scratch_buffer A buffer used to index the properties of the patch objects while
+ * applying them. Nothing is allocated outside of this buffer.
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to write the patched
+ * document into.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The patched document was written successfully.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Either the \p scratch_buffer or the destination of the \p
+ * ref_json_writer is too small.
+ * @retval #AZ_ERROR_UNEXPECTED_END Either JSON document is incomplete.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR Either JSON document is invalid.
+ * @retval #AZ_ERROR_NOT_IMPLEMENTED A property name contains a character escaped as `\\uXXXX`.
+ *
+ * @remarks Properties of the patch whose value is `null` are removed, objects are merged property
+ * by property, and any other value (including arrays) replaces the value in \p target_json. The
+ * properties of \p target_json keep their order, and new properties are written after them.
+ *
+ * @remarks The destination of \p ref_json_writer must not overlap \p target_json or \p patch_json,
+ * which are only read. To keep a patched document in the same place, write it into a second buffer
+ * and swap the two buffers.
+ *
+ * @remarks The \p scratch_buffer needs room for the unescaped names of the properties of the
+ * patch objects being applied at once, plus an index entry (the size of a few pointers) per
+ * property.
+ */
+AZ_NODISCARD az_result az_json_merge_patch_apply(
+    az_span target_json,
+    az_span patch_json,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_JSON_H
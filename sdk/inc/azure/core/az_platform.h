@@ -27,12 +27,33 @@
  *
  * @remark The moment of time where clock starts is undefined, but if this function is getting
  * called twice with one second interval, the difference between the values returned should be equal
- * to 1000.
+ * to 1000. The clock is monotonic: it keeps counting while the application is blocked, and isn't
+ * affected by changes to the system time.
  *
  * @return Platform clock in milliseconds.
  */
 AZ_NODISCARD int64_t az_platform_clock_msec();
 
+/**
+ * @brief Gets the platform clock in microseconds.
+ *
+ * @remark The clock is the same as the one of #az_platform_clock_msec(), with a finer resolution
+ * for measuring short durations.
+ *
+ * @return Platform clock in microseconds.
+ */
+AZ_NODISCARD int64_t az_platform_clock_usec();
+
+/**
+ * @brief Gets the platform clock in nanoseconds.
+ *
+ * @remark The clock is the same as the one of #az_platform_clock_msec(). Its actual resolution
+ * depends on the platform.
+ *
+ * @return Platform clock in nanoseconds.
+ */
+AZ_NODISCARD int64_t az_platform_clock_nsec();
+
 /**
  * @brief Tells the platform to sleep for a given number of milliseconds.
  *
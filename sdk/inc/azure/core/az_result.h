@@ -126,6 +126,16 @@ typedef enum
   /// Generic error in the HTTP transport adapter implementation.
   AZ_ERROR_HTTP_ADAPTER = _az_RESULT_MAKE_ERROR(_az_FACILITY_HTTP, 9),
 
+  /// The connection was lost, or the HTTP/2 stream was reset, before the response was received.
+  AZ_ERROR_HTTP_CONNECTION_INTERRUPTED = _az_RESULT_MAKE_ERROR(_az_FACILITY_HTTP, 10),
+
+  /// Error while decoding the HTTP response body, such as an invalid chunk of a chunked body.
+  AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY = _az_RESULT_MAKE_ERROR(_az_FACILITY_HTTP, 11),
+
+  /// The request wasn't sent, because the circuit breaker of its endpoint is open after too many
+  /// failures.
+  AZ_ERROR_HTTP_CIRCUIT_OPEN = _az_RESULT_MAKE_ERROR(_az_FACILITY_HTTP, 12),
+
   // === IoT error codes ===
   /// The IoT topic is not matching the expected format.
   AZ_ERROR_IOT_TOPIC_NO_MATCH = _az_RESULT_MAKE_ERROR(_az_FACILITY_IOT, 1),
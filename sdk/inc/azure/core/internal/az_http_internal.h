@@ -14,7 +14,7 @@
 enum
 {
   /// The maximum number of HTTP pipeline policies allowed.
-  _az_MAXIMUM_NUMBER_OF_POLICIES = 10,
+  _az_MAXIMUM_NUMBER_OF_POLICIES = AZ_HTTP_PIPELINE_POLICY_COUNT,
 };
 
 /**
@@ -78,23 +78,82 @@ _az_http_policy_apiversion_options_default()
   };
 }
 
+/**
+ * @brief Initialize az_http_policy_compression_options with default values, which disable
+ * compression.
+ */
+AZ_NODISCARD AZ_INLINE az_http_policy_compression_options
+_az_http_policy_compression_options_default()
+{
+  return (az_http_policy_compression_options){
+    .codec = NULL,
+    .decompress_responses = true,
+    .request_compression_threshold = -1,
+    .request_compression_buffer = AZ_SPAN_EMPTY,
+  };
+}
+
 /**
  * @brief Initialize az_http_policy_retry_options with default values
  *
  */
 AZ_NODISCARD az_http_policy_retry_options _az_http_policy_retry_options_default();
 
+/**
+ * @brief Gets the bucket of the latency histograms of an #az_http_policy_metrics which counts a
+ * latency. Each power of two is split into 4 buckets, as in an HDR histogram.
+ *
+ * @param[in] latency_usec The latency, in microseconds.
+ */
+AZ_NODISCARD AZ_INLINE int32_t _az_http_metrics_get_latency_bucket(int64_t latency_usec)
+{
+  if (latency_usec < 4)
+  {
+    return latency_usec < 0 ? 0 : (int32_t)latency_usec;
+  }
+
+  int32_t highest_bit = 2;
+  while (highest_bit < 62 && (latency_usec >> (highest_bit + 1)) != 0)
+  {
+    ++highest_bit;
+  }
+
+  int32_t const bucket = (highest_bit - 1) * 4 + (int32_t)((latency_usec >> (highest_bit - 2)) & 3);
+  return bucket < AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT ? bucket
+                                                       : AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT - 1;
+}
+
+/**
+ * @brief Gets the highest latency, in microseconds, counted by a bucket of the latency histograms
+ * of an #az_http_policy_metrics.
+ *
+ * @param[in] bucket The bucket, as returned by #_az_http_metrics_get_latency_bucket().
+ */
+AZ_NODISCARD AZ_INLINE int64_t _az_http_metrics_get_bucket_max_latency(int32_t bucket)
+{
+  if (bucket < 4)
+  {
+    return bucket;
+  }
+
+  int32_t const shift = bucket / 4 - 1;
+  return ((int64_t)(4 + bucket % 4 + 1) << shift) - 1;
+}
+
 // PipelinePolicies
 //   Policies are non-allocating caveat the TransportPolicy
 //   Transport policies can only allocate if the transport layer they call allocates
 // Client ->
 //  ===HttpPipelinePolicies===
 //    UniqueRequestID
+//    Distributed Tracing (span of the request)
+//    Custom (per call)
 //    Retry
 //    Authentication
+//    Distributed Tracing (span of each attempt, traceparent)
+//    Custom (per retry)
 //    Logging
 //    Buffer Response
-//    Distributed Tracing
 //    TransportPolicy
 //  ===Transport Layer===
 // PipelinePolicies must implement the process function
@@ -106,6 +165,42 @@ AZ_NODISCARD az_result az_http_pipeline_process(
     az_http_request* ref_request,
     az_http_response* ref_response);
 
+/**
+ * @brief Adds a policy after the policies of a pipeline, which starts out zero-initialized.
+ *
+ * @param[in,out] ref_pipeline The pipeline to add the policy to.
+ * @param[in] process The process function of the policy.
+ * @param[in] options The options passed to \p process.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The pipeline already has #AZ_HTTP_PIPELINE_POLICY_COUNT
+ * policies.
+ */
+AZ_NODISCARD az_result _az_http_pipeline_add_policy(
+    _az_http_pipeline* ref_pipeline,
+    _az_http_policy_process_fn process,
+    void* options);
+
+/**
+ * @brief Adds the custom policies at a \p position after the policies of a pipeline, in the order
+ * of \p policies.
+ *
+ * @param[in,out] ref_pipeline The pipeline to add the policies to.
+ * @param[in] policies The custom policies of a client, of all positions.
+ * @param[in] policies_length The number of \p policies.
+ * @param[in] position The position of the policies to add, skipping the others.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The pipeline can't hold all the policies.
+ */
+AZ_NODISCARD az_result _az_http_pipeline_add_custom_policies(
+    _az_http_pipeline* ref_pipeline,
+    az_http_custom_policy const* policies,
+    int32_t policies_length,
+    az_http_policy_position position);
+
 AZ_NODISCARD az_result az_http_pipeline_policy_apiversion(
     _az_http_policy* ref_policies,
     void* ref_options,
@@ -118,6 +213,54 @@ AZ_NODISCARD az_result az_http_pipeline_policy_telemetry(
     az_http_request* ref_request,
     az_http_response* ref_response);
 
+AZ_NODISCARD az_result az_http_pipeline_policy_compression(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_decompression(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_circuit_breaker(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_hedging(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_metrics(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_rate_limiter(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_tracing(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+AZ_NODISCARD az_result az_http_pipeline_policy_tracing_attempt(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
 AZ_NODISCARD az_result az_http_pipeline_policy_retry(
     _az_http_policy* ref_policies,
     void* ref_options,
@@ -239,6 +382,41 @@ AZ_NODISCARD az_result az_http_request_set_query_parameter(
 AZ_NODISCARD az_result
 az_http_request_append_header(az_http_request* ref_request, az_span name, az_span value);
 
+/**
+ * @brief Sets the value of a well-known HTTP header of the request, replacing the value it had, or
+ * appending the header when the request doesn't have it yet.
+ *
+ * @remarks The name of the header is the interned one of \p id, so it isn't validated again.
+ * Policies which run on each attempt of the retry policy can set a header without adding it again
+ * on every attempt.
+ *
+ * @param ref_request HTTP request to set the header of.
+ * @param id The #az_http_header_id of the header, other than #AZ_HTTP_HEADER_ID_NONE.
+ * @param value Header value.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE There isn't enough space in the \p ref_request to add a
+ * header.
+ */
+AZ_NODISCARD az_result
+az_http_request_set_header(az_http_request* ref_request, az_http_header_id id, az_span value);
+
+/**
+ * @brief Streams the body of the request from an #az_http_request_body_provider, instead of the
+ * body #az_span the request was initialized with.
+ *
+ * @param ref_request HTTP request to set the body provider of.
+ * @param body_provider __[nullable]__ The #az_http_request_body_provider, which must stay valid
+ * until the request has been sent. `NULL` sends the body #az_span again.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ */
+AZ_NODISCARD az_result az_http_request_set_body_provider(
+    az_http_request* ref_request,
+    az_http_request_body_provider const* body_provider);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_INTERNAL_H
@@ -19,6 +19,33 @@ _az_retry_calc_delay(int32_t attempt, int32_t retry_delay_msec, int32_t max_retr
                                                         : exponential_retry_after;
 }
 
+// xorshift32: not for cryptography, but enough to keep clients from retrying in lockstep.
+AZ_NODISCARD AZ_INLINE uint32_t _az_retry_random(uint32_t* ref_state)
+{
+  uint32_t x = *ref_state == 0 ? 1 : *ref_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *ref_state = x;
+  return x;
+}
+
+// Decorrelated jitter: a delay drawn between the minimum and three times the previous delay.
+AZ_NODISCARD AZ_INLINE int32_t _az_retry_calc_decorrelated_delay(
+    int32_t previous_delay_msec,
+    int32_t retry_delay_msec,
+    int32_t max_retry_delay_msec,
+    uint32_t random)
+{
+  int64_t const upper_bound = (previous_delay_msec > retry_delay_msec ? previous_delay_msec
+                                                                       : retry_delay_msec)
+      * (int64_t)3;
+  int64_t const delay
+      = retry_delay_msec + (int64_t)(random % (uint64_t)(upper_bound - retry_delay_msec + 1));
+
+  return delay > max_retry_delay_msec ? max_retry_delay_msec : (int32_t)delay;
+}
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_RETRY_INTERNAL_H
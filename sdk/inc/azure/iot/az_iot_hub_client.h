@@ -17,6 +17,7 @@
 #ifndef _az_IOT_HUB_CLIENT_H
 #define _az_IOT_HUB_CLIENT_H
 
+#include <azure/core/az_json.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
 #include <azure/iot/az_iot_common.h>
@@ -459,6 +460,43 @@ AZ_NODISCARD az_result az_iot_hub_client_twin_patch_get_publish_topic(
     size_t mqtt_topic_size,
     size_t* out_mqtt_topic_length);
 
+/**
+ * @brief Applies a desired properties patch, received on the
+ * #AZ_IOT_HUB_CLIENT_TWIN_PATCH_SUBSCRIBE_TOPIC topic, to a locally cached copy of the desired
+ * properties.
+ *
+ * @param[in] client The #az_iot_hub_client to use for this call.
+ * @param[in] desired_properties The cached desired properties JSON object, i.e. the `desired`
+ * object of the twin document returned for a Twin GET request, or the result of a previous call.
+ * @param[in] patch The desired properties patch JSON object, which is the payload of the message.
+ * @param[in] scratch_buffer A buffer used while applying the patch. See
+ * #az_json_merge_patch_apply().
+ * @param[in,out] ref_json_writer A pointer to an #az_json_writer instance to write the updated
+ * desired properties into. Its destination must not overlap \p desired_properties or \p patch.
+ * @param[out] out_is_applied Set to `true` if the patch was applied and written to \p
+ * ref_json_writer. Set to `false` if the patch is not newer than \p desired_properties, in which
+ * case nothing is written and the cached desired properties are still current.
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK The patch was applied, or skipped because it is outdated.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE Either the \p scratch_buffer or the destination of the \p
+ * ref_json_writer is too small.
+ * @retval #AZ_ERROR_UNEXPECTED_END Either JSON document is incomplete.
+ * @retval #AZ_ERROR_UNEXPECTED_CHAR Either JSON document is invalid, or has a `$version` that isn't
+ * an integer.
+ *
+ * @remark Patches are ordered by their `$version` property. A patch whose `$version` is lower than,
+ * or equal to, the `$version` of \p desired_properties is skipped, so that patches delivered late
+ * or more than once don't revert newer values. The `$version` of the updated desired properties is
+ * the one of the patch. If either document has no `$version`, the patch is always applied.
+ */
+AZ_NODISCARD az_result az_iot_hub_client_twin_desired_properties_apply_patch(
+    az_iot_hub_client const* client,
+    az_span desired_properties,
+    az_span patch,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer,
+    bool* out_is_applied);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_IOT_HUB_CLIENT_H
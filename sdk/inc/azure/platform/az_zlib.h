@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file
+ *
+ * @brief Defines the #az_http_content_codec of the `az_zlib` library, which compresses and
+ * decompresses HTTP bodies with zlib.
+ *
+ * @note You MUST NOT use any symbols (macros, functions, structures, enums, etc.)
+ * prefixed with an underscore ('_') directly in your application code. These symbols
+ * are part of Azure SDK's internal implementation; we do not document these symbols
+ * and they are subject to change in future versions of the SDK which would break your code.
+ */
+
+#ifndef _az_ZLIB_H
+#define _az_ZLIB_H
+
+#include <azure/core/az_http.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+
+#include <azure/core/_az_cfg_prefix.h>
+
+enum
+{
+  /// The size of the work buffer an #az_http_content_codec from #az_zlib_codec_init() needs to
+  /// decompress any body, and to compress bodies.
+  AZ_ZLIB_CODEC_WORK_BUFFER_SIZE = 48 * 1024,
+};
+
+/**
+ * @brief Initializes an #az_http_content_codec which compresses and decompresses `gzip` and
+ * `deflate` bodies with zlib.
+ *
+ * @remarks zlib allocates its state out of \p work_buffer instead of the heap. Bodies are
+ * compressed with a 4 KiB window, which keeps the memory needed small, and decompressed with any
+ * window.
+ *
+ * @param[out] out_codec The #az_http_content_codec to initialize.
+ * @param[in] work_buffer The buffer the codec keeps its state in, of at least
+ * #AZ_ZLIB_CODEC_WORK_BUFFER_SIZE bytes. It must stay valid as long as the codec is used, and the
+ * codec must not be used by several requests at once.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE \p work_buffer is smaller than
+ * #AZ_ZLIB_CODEC_WORK_BUFFER_SIZE.
+ */
+AZ_NODISCARD az_result az_zlib_codec_init(az_http_content_codec* out_codec, az_span work_buffer);
+
+#include <azure/core/_az_cfg_suffix.h>
+
+#endif // _az_ZLIB_H
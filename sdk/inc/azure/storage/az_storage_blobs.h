@@ -41,6 +41,44 @@ typedef struct
   /// Optional values used to override the default retry policy options.
   az_http_policy_retry_options retry_options;
 
+  /// Optional values used to compress request bodies and have response bodies compressed, which
+  /// is disabled unless an #az_http_content_codec is set.
+  az_http_policy_compression_options compression_options;
+
+  /// The circuit breaker which fails requests with #AZ_ERROR_HTTP_CIRCUIT_OPEN, without retrying
+  /// them, while the endpoint of the client keeps failing, shared with the other clients of the
+  /// application, or _NULL_ to always send requests.
+  az_http_policy_circuit_breaker* circuit_breaker;
+
+  /// The rate limiter which paces the requests of this client, shared with the other clients of
+  /// the same storage account, or _NULL_ to send requests as soon as they are made. Each attempt,
+  /// retries included, waits for its turn.
+  az_http_policy_rate_limiter* rate_limiter;
+
+  /// The metrics which count the requests of this client, their bytes and their latencies, and
+  /// which can be shared with other clients, or _NULL_ to measure nothing.
+  az_http_policy_metrics* metrics;
+
+  /// The tracing which records a span for each request of this client and each attempt to send
+  /// it, and sends their `traceparent` header, or _NULL_ to trace nothing.
+  az_http_policy_tracing* tracing;
+
+  /// The hedging options which send a copy of a slow `GET` or `HEAD` request of this client, or
+  /// _NULL_ to wait for the response to each request. They are added right ahead of the transport,
+  /// after the logging policy and the per retry #custom_policies, and must not be shared by
+  /// requests sent from several threads at a time.
+  az_http_policy_hedging_options* hedging;
+
+  /// The policies of the application to add to the pipeline of the client, each at its position,
+  /// in the order of the array, or _NULL_. The array is only read by
+  /// #az_storage_blobs_blob_client_init(), but the options of the policies must stay valid as long
+  /// as the client is used.
+  az_http_custom_policy const* custom_policies;
+
+  /// The number of #custom_policies. The pipeline holds up to #AZ_HTTP_PIPELINE_POLICY_COUNT
+  /// policies.
+  int32_t custom_policies_length;
+
   struct
   {
     /// Services pass API versions in the header or in query parameters used by the API Version
@@ -81,6 +119,7 @@ typedef struct
  *
  * @return An #az_result value indicating the result of the operation.
  * @retval #AZ_OK Success.
+ * @retval #AZ_ERROR_NOT_ENOUGH_SPACE The custom policies don't fit in the pipeline.
  * @retval other Failure.
  */
 AZ_NODISCARD az_result az_storage_blobs_blob_client_init(
@@ -148,6 +187,28 @@ AZ_NODISCARD az_result az_storage_blobs_blob_upload(
     az_storage_blobs_blob_upload_options const* options,
     az_http_response* ref_response);
 
+/**
+ * @brief Uploads the contents read from a body provider to blob storage, without holding the
+ * whole blob in memory.
+ *
+ * @param[in,out] ref_client An #az_storage_blobs_blob_client structure.
+ * @param[in] body_provider The #az_http_request_body_provider to read the blob content from. Its
+ * length must be known. If it can't be rewound, the upload is not retried.
+ * @param[in] options __[nullable]__ A reference to an #az_storage_blobs_blob_upload_options
+ * structure which defines custom behavior for uploading the blob. If `NULL` is passed, the client
+ * will use the default options (i.e. #az_storage_blobs_blob_upload_options_default()).
+ * @param[in,out] ref_response An initialized #az_http_response where to write HTTP response into.
+ *
+ * @return An #az_result value indicating the result of the operation.
+ * @retval #AZ_OK Success.
+ * @retval other Failure, including any failure of the \p body_provider callbacks.
+ */
+AZ_NODISCARD az_result az_storage_blobs_blob_upload_stream(
+    az_storage_blobs_blob_client* ref_client,
+    az_http_request_body_provider const* body_provider,
+    az_storage_blobs_blob_upload_options const* options,
+    az_http_response* ref_response);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_STORAGE_BLOBS_H
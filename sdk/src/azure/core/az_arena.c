@@ -0,0 +1,102 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_arena.h>
+#include <azure/core/az_context.h>
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// What an arena allocates is aligned on this size.
+#define _az_ARENA_ALIGNMENT 8
+
+uint8_t const az_arena_context_key = 0;
+
+AZ_NODISCARD az_result az_arena_init(az_arena* out_arena, az_span buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_arena);
+
+  *out_arena = (az_arena){
+    ._internal = {
+      .buffer = az_span_ptr(buffer),
+      .size = az_span_size(buffer),
+      .used = 0,
+      .peak = 0,
+    },
+  };
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_arena_allocate(az_arena* ref_arena, int32_t size, az_span* out_span)
+{
+  _az_PRECONDITION_NOT_NULL(ref_arena);
+  _az_PRECONDITION_NOT_NULL(out_span);
+  _az_PRECONDITION(size >= 0);
+
+  // The padding aligns the address of the allocation, whatever the alignment of the buffer.
+  uintptr_t const address = (uintptr_t)(ref_arena->_internal.buffer + ref_arena->_internal.used);
+  int32_t const padding
+      = (int32_t)((_az_ARENA_ALIGNMENT - address % _az_ARENA_ALIGNMENT) % _az_ARENA_ALIGNMENT);
+  int64_t const needed = (int64_t)ref_arena->_internal.used + padding + size;
+  if (needed > ref_arena->_internal.peak)
+  {
+    ref_arena->_internal.peak = needed < INT32_MAX ? (int32_t)needed : INT32_MAX;
+  }
+
+  if (needed > ref_arena->_internal.size)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  *out_span
+      = az_span_create(ref_arena->_internal.buffer + ref_arena->_internal.used + padding, size);
+  ref_arena->_internal.used = (int32_t)needed;
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_arena_mark az_arena_get_mark(az_arena const* arena)
+{
+  _az_PRECONDITION_NOT_NULL(arena);
+
+  return (az_arena_mark){ ._internal = { .used = arena->_internal.used } };
+}
+
+void az_arena_rollback(az_arena* ref_arena, az_arena_mark mark)
+{
+  _az_PRECONDITION_NOT_NULL(ref_arena);
+  _az_PRECONDITION_RANGE(0, mark._internal.used, ref_arena->_internal.used);
+
+  ref_arena->_internal.used = mark._internal.used;
+}
+
+void az_arena_reset(az_arena* ref_arena)
+{
+  _az_PRECONDITION_NOT_NULL(ref_arena);
+
+  ref_arena->_internal.used = 0;
+}
+
+AZ_NODISCARD int32_t az_arena_get_peak_size(az_arena const* arena)
+{
+  _az_PRECONDITION_NOT_NULL(arena);
+
+  return arena->_internal.peak;
+}
+
+AZ_NODISCARD az_arena* az_arena_from_context(az_context const* context)
+{
+  void const* value = NULL;
+  if (context == NULL
+      || az_result_failed(az_context_get_value(context, &az_arena_context_key, &value)))
+  {
+    return NULL;
+  }
+
+  // The arena is attached as a value of the context, which only holds pointers to const.
+  return (az_arena*)(uintptr_t)value;
+}
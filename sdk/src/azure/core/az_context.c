@@ -5,9 +5,38 @@
 #include <azure/core/internal/az_precondition_internal.h>
 
 #include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include <azure/core/_az_cfg.h>
 
+// The expiration of a context is read and written atomically, so that another thread can cancel it
+// while a request polls it.
+AZ_INLINE int64_t _az_context_load_expiration(az_context const* context)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+  return __atomic_load_n(&context->_internal.expiration, __ATOMIC_ACQUIRE);
+#else
+  return *(int64_t const volatile*)&context->_internal.expiration;
+#endif
+}
+
+AZ_INLINE void _az_context_store_expiration(az_context* ref_context, int64_t expiration)
+{
+#if defined(_MSC_VER)
+  (void)_InterlockedExchange64((__int64 volatile*)&ref_context->_internal.expiration, expiration);
+#elif (defined(__GNUC__) || defined(__clang__)) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+  __atomic_store_n(&ref_context->_internal.expiration, expiration, __ATOMIC_RELEASE);
+#else
+  // Without lock-free atomics, a context must not be canceled from another thread than those
+  // which use it.
+  *(int64_t volatile*)&ref_context->_internal.expiration = expiration;
+#endif
+}
+
 // This is a global az_context node representing the entire application. By default, this node
 // never expires. Call az_context_cancel passing a pointer to this node to cancel the entire
 // application (which cancels all the child nodes).
@@ -24,9 +53,10 @@ AZ_NODISCARD int64_t az_context_get_expiration(az_context const* context)
   int64_t expiration = _az_CONTEXT_MAX_EXPIRATION;
   for (; context != NULL; context = context->_internal.parent)
   {
-    if (context->_internal.expiration < expiration)
+    int64_t const context_expiration = _az_context_load_expiration(context);
+    if (context_expiration < expiration)
     {
-      expiration = context->_internal.expiration;
+      expiration = context_expiration;
     }
   }
   return expiration;
@@ -79,7 +109,7 @@ void az_context_cancel(az_context* ref_context)
 {
   _az_PRECONDITION_NOT_NULL(ref_context);
 
-  ref_context->_internal.expiration = 0; // The beginning of time
+  _az_context_store_expiration(ref_context, 0); // The beginning of time
 }
 
 AZ_NODISCARD bool az_context_has_expired(az_context const* context, int64_t current_time)
@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: MIT
 
 #include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
 #include <azure/core/internal/az_http_internal.h>
 #include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
 
 #include <azure/core/_az_cfg.h>
 
@@ -22,3 +24,60 @@ AZ_NODISCARD az_result az_http_pipeline_process(
       ref_request,
       ref_response);
 }
+
+AZ_NODISCARD az_result az_http_pipeline_next_policy(
+    az_http_policy* ref_policies,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_policies);
+  _az_PRECONDITION_NOT_NULL(ref_request);
+  _az_PRECONDITION_NOT_NULL(ref_response);
+
+  return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+}
+
+AZ_NODISCARD az_result _az_http_pipeline_add_policy(
+    _az_http_pipeline* ref_pipeline,
+    _az_http_policy_process_fn process,
+    void* options)
+{
+  _az_PRECONDITION_NOT_NULL(ref_pipeline);
+  _az_PRECONDITION_NOT_NULL(process);
+
+  // The policies are added one after the other, so the first one left empty comes after them.
+  for (int32_t i = 0; i < _az_MAXIMUM_NUMBER_OF_POLICIES; i++)
+  {
+    _az_http_policy* const policy = &ref_pipeline->_internal.policies[i];
+    if (policy->_internal.process == NULL)
+    {
+      policy->_internal.process = process;
+      policy->_internal.options = options;
+      return AZ_OK;
+    }
+  }
+
+  return AZ_ERROR_NOT_ENOUGH_SPACE;
+}
+
+AZ_NODISCARD az_result _az_http_pipeline_add_custom_policies(
+    _az_http_pipeline* ref_pipeline,
+    az_http_custom_policy const* policies,
+    int32_t policies_length,
+    az_http_policy_position position)
+{
+  _az_PRECONDITION_NOT_NULL(ref_pipeline);
+  _az_PRECONDITION(policies_length >= 0);
+  _az_PRECONDITION(policies_length == 0 || policies != NULL);
+
+  for (int32_t i = 0; i < policies_length; i++)
+  {
+    if (policies[i].position == position)
+    {
+      _az_RETURN_IF_FAILED(
+          _az_http_pipeline_add_policy(ref_pipeline, policies[i].process, policies[i].options));
+    }
+  }
+
+  return AZ_OK;
+}
@@ -5,12 +5,53 @@
 #include <azure/core/az_credentials.h>
 #include <azure/core/az_http.h>
 #include <azure/core/az_span.h>
+#include <azure/core/internal/az_config_internal.h>
 #include <azure/core/internal/az_http_internal.h>
 #include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include <azure/core/_az_cfg.h>
 
-static const az_span AZ_HTTP_HEADER_USER_AGENT = AZ_SPAN_LITERAL_FROM_STR("User-Agent");
+AZ_INLINE bool _az_http_policy_try_lock(int32_t volatile* ref_lock)
+{
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchange((long volatile*)ref_lock, 1, 0) == 0;
+#elif defined(__GNUC__) || defined(__clang__)
+  int32_t expected = 0;
+  return __atomic_compare_exchange_n(
+      ref_lock, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+#else
+  // Without atomics, the state of a policy must not be shared by requests sent from different
+  // threads.
+  *ref_lock = 1;
+  return true;
+#endif
+}
+
+void _az_http_policy_lock(int32_t volatile* ref_lock)
+{
+  while (!_az_http_policy_try_lock(ref_lock))
+  {
+  }
+}
+
+void _az_http_policy_unlock(int32_t volatile* ref_lock)
+{
+#if defined(_MSC_VER)
+  (void)_InterlockedExchange((long volatile*)ref_lock, 0);
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_store_n(ref_lock, 0, __ATOMIC_RELEASE);
+#else
+  *ref_lock = 0;
+#endif
+}
 
 AZ_NODISCARD az_result az_http_pipeline_policy_apiversion(
     _az_http_policy* ref_policies,
@@ -52,11 +93,157 @@ AZ_NODISCARD az_result az_http_pipeline_policy_telemetry(
   _az_http_policy_telemetry_options* options = (_az_http_policy_telemetry_options*)(ref_options);
 
   _az_RETURN_IF_FAILED(
-      az_http_request_append_header(ref_request, AZ_HTTP_HEADER_USER_AGENT, options->os));
+      az_http_request_set_header(ref_request, AZ_HTTP_HEADER_ID_USER_AGENT, options->os));
 
   return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
 }
 
+// Compresses the body into the buffer of the options, with gzip.
+static AZ_NODISCARD az_result _az_http_policy_compression_compress_body(
+    az_http_policy_compression_options const* options,
+    az_span body,
+    az_span* out_compressed)
+{
+  az_http_content_codec const* const codec = options->codec;
+  _az_RETURN_IF_FAILED(codec->begin(codec->user_context, AZ_HTTP_CONTENT_CODING_GZIP, true));
+
+  az_span destination = options->request_compression_buffer;
+  az_result result = AZ_OK;
+  bool is_end = false;
+  while (!is_end)
+  {
+    int32_t body_used = 0;
+    int32_t destination_used = 0;
+    result = codec->process(
+        codec->user_context, body, destination, true, &body_used, &destination_used, &is_end);
+    if (az_result_failed(result))
+    {
+      break;
+    }
+
+    body = az_span_slice_to_end(body, body_used);
+    destination = az_span_slice_to_end(destination, destination_used);
+    if (!is_end && az_span_size(destination) == 0)
+    {
+      result = AZ_ERROR_NOT_ENOUGH_SPACE;
+      break;
+    }
+  }
+
+  codec->end(codec->user_context);
+  *out_compressed = az_span_slice(
+      options->request_compression_buffer,
+      0,
+      az_span_size(options->request_compression_buffer) - az_span_size(destination));
+
+  return result;
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_compression(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_compression_options const* const options
+      = (az_http_policy_compression_options const*)ref_options;
+
+  az_span const body = ref_request->_internal.body;
+  if (options->codec == NULL || options->request_compression_threshold < 0
+      || ref_request->_internal.body_provider != NULL || az_span_size(body) == 0
+      || az_span_size(body) < options->request_compression_threshold)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  // Bodies which don't get smaller are sent as they are.
+  az_span compressed = { 0 };
+  az_result const result = _az_http_policy_compression_compress_body(options, body, &compressed);
+  if (result == AZ_ERROR_NOT_ENOUGH_SPACE || az_span_size(compressed) >= az_span_size(body))
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  _az_RETURN_IF_FAILED(result);
+
+  // The length of the body the client may have set is replaced by the compressed length, which
+  // is kept on the stack until the request has been sent.
+  uint8_t content_length_buffer[_az_INT64_AS_STR_BUFFER_SIZE] = { 0 };
+  int32_t const headers_length = az_http_request_headers_count(ref_request);
+  az_span content_length = { 0 };
+  bool const has_content_length = az_result_succeeded(az_http_request_get_header_by_id(
+      ref_request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, &content_length));
+  if (has_content_length)
+  {
+    az_span remainder = { 0 };
+    az_span const compressed_length = AZ_SPAN_FROM_BUFFER(content_length_buffer);
+    _az_RETURN_IF_FAILED(az_span_i32toa(compressed_length, az_span_size(compressed), &remainder));
+    _az_RETURN_IF_FAILED(az_http_request_set_header(
+        ref_request,
+        AZ_HTTP_HEADER_ID_CONTENT_LENGTH,
+        az_span_slice(compressed_length, 0, _az_span_diff(remainder, compressed_length))));
+  }
+
+  az_result next_result = az_http_request_append_header(
+      ref_request, AZ_SPAN_FROM_STR("Content-Encoding"), AZ_SPAN_FROM_STR("gzip"));
+  if (az_result_succeeded(next_result))
+  {
+    ref_request->_internal.body = compressed;
+    next_result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  // The request is given back as the client made it: the compressed body is in the buffer of the
+  // options, which the next request reuses, and the compressed length is about to go out of scope.
+  ref_request->_internal.body = body;
+  _az_http_request_remove_headers_from(ref_request, headers_length);
+  if (has_content_length)
+  {
+    _az_RETURN_IF_FAILED(
+        az_http_request_set_header(ref_request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, content_length));
+  }
+
+  return next_result;
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_decompression(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_compression_options const* const options
+      = (az_http_policy_compression_options const*)ref_options;
+
+  az_http_content_codec const* const codec = options->codec;
+  if (codec == NULL || !options->decompress_responses)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  _az_RETURN_IF_FAILED(az_http_request_append_header(
+      ref_request, AZ_SPAN_FROM_STR("Accept-Encoding"), AZ_SPAN_FROM_STR("gzip, deflate")));
+
+  // The body is decompressed by az_http_response_append_body(), as the transport receives it.
+  ref_response->_internal.body_decoding.codec = codec;
+  ref_response->_internal.body_decoding.state = _az_HTTP_RESPONSE_BODY_DECODING_NOT_STARTED;
+
+  az_result result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+
+  // The compressed body ended before the response did.
+  if (ref_response->_internal.body_decoding.state == _az_HTTP_RESPONSE_BODY_DECODING_STARTED)
+  {
+    codec->end(codec->user_context);
+    ref_response->_internal.body_decoding.state = _az_HTTP_RESPONSE_BODY_DECODING_ENDED;
+    if (az_result_succeeded(result))
+    {
+      result = AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+    }
+  }
+
+  ref_response->_internal.body_decoding.codec = NULL;
+  return result;
+}
+
 AZ_NODISCARD az_result az_http_pipeline_policy_credential(
     _az_http_policy* ref_policies,
     void* ref_options,
@@ -0,0 +1,299 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_config.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_config_internal.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+static az_http_status_code const _az_http_circuit_breaker_default_status_codes[] = {
+  AZ_HTTP_STATUS_CODE_REQUEST_TIMEOUT,       AZ_HTTP_STATUS_CODE_TOO_MANY_REQUESTS,
+  AZ_HTTP_STATUS_CODE_INTERNAL_SERVER_ERROR, AZ_HTTP_STATUS_CODE_BAD_GATEWAY,
+  AZ_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE,   AZ_HTTP_STATUS_CODE_GATEWAY_TIMEOUT,
+  AZ_HTTP_STATUS_CODE_END_OF_LIST,
+};
+
+AZ_NODISCARD az_http_policy_circuit_breaker_options
+az_http_policy_circuit_breaker_options_default()
+{
+  return (az_http_policy_circuit_breaker_options){
+    .status_codes = _az_http_circuit_breaker_default_status_codes,
+    .failure_threshold = 0, // Off until the application sets it.
+    .failure_window_msec = 30 * _az_TIME_MILLISECONDS_PER_SECOND, // 30 seconds
+    .open_duration_msec = 10 * _az_TIME_MILLISECONDS_PER_SECOND, // 10 seconds
+  };
+}
+
+AZ_NODISCARD az_result az_http_policy_circuit_breaker_init(
+    az_http_policy_circuit_breaker* out_circuit_breaker,
+    az_http_policy_circuit_breaker_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_circuit_breaker);
+
+  *out_circuit_breaker = (az_http_policy_circuit_breaker){
+    ._internal = {
+      .options = options == NULL ? az_http_policy_circuit_breaker_options_default() : *options,
+      .endpoints = { { 0 } },
+      .lock = 0,
+    },
+  };
+
+  _az_PRECONDITION_NOT_NULL(out_circuit_breaker->_internal.options.status_codes);
+  _az_PRECONDITION(out_circuit_breaker->_internal.options.failure_threshold >= 0);
+
+  return AZ_OK;
+}
+
+// The endpoint of a URL is its scheme and authority, hashed with FNV-1a ignoring case.
+AZ_NODISCARD static uint32_t _az_http_circuit_breaker_get_key(az_span url)
+{
+  int32_t const scheme_end = az_span_find(url, AZ_SPAN_FROM_STR("://"));
+  int32_t const authority_start = scheme_end < 0 ? 0 : scheme_end + 3;
+
+  uint8_t const* const url_ptr = az_span_ptr(url);
+  uint32_t key = 2166136261U;
+  for (int32_t i = 0; i < az_span_size(url); i++)
+  {
+    uint8_t c = url_ptr[i];
+    if (i >= authority_start && (c == '/' || c == '?' || c == '#'))
+    {
+      break;
+    }
+
+    if (c >= 'A' && c <= 'Z')
+    {
+      c = (uint8_t)(c + ('a' - 'A'));
+    }
+
+    key = (key ^ c) * 16777619U;
+  }
+
+  // 0 marks the entries which aren't used.
+  return key == 0 ? 1 : key;
+}
+
+// Finds the circuit of an endpoint, or replaces the circuit used least recently with it.
+AZ_NODISCARD static _az_http_circuit_breaker_endpoint* _az_http_circuit_breaker_get_endpoint(
+    az_http_policy_circuit_breaker* ref_circuit_breaker,
+    uint32_t key,
+    int64_t now)
+{
+  _az_http_circuit_breaker_endpoint* const endpoints = ref_circuit_breaker->_internal.endpoints;
+  _az_http_circuit_breaker_endpoint* replaced = &endpoints[0];
+  for (int32_t i = 0; i < AZ_HTTP_CIRCUIT_BREAKER_ENDPOINT_COUNT; i++)
+  {
+    if (endpoints[i].key == key)
+    {
+      endpoints[i].last_used = now;
+      return &endpoints[i];
+    }
+
+    if (replaced->key != 0
+        && (endpoints[i].key == 0 || endpoints[i].last_used < replaced->last_used))
+    {
+      replaced = &endpoints[i];
+    }
+  }
+
+  *replaced = (_az_http_circuit_breaker_endpoint){
+    .key = key,
+    .state = _az_HTTP_CIRCUIT_BREAKER_STATE_CLOSED,
+    .failure_count = 0,
+    .window_start = now,
+    .opened_at = 0,
+    .last_used = now,
+    .is_probe_pending = false,
+  };
+
+  return replaced;
+}
+
+// The errors of a request which failed to reach its endpoint, or got a broken response from it.
+// Other errors, such as a response which doesn't fit its buffer, come from the client.
+AZ_NODISCARD static bool _az_http_circuit_breaker_is_endpoint_error(az_result result)
+{
+  switch (result)
+  {
+    case AZ_ERROR_HTTP_ADAPTER:
+    case AZ_ERROR_HTTP_CONNECTION_INTERRUPTED:
+    case AZ_ERROR_HTTP_RESPONSE_COULDNT_RESOLVE_HOST:
+    case AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER:
+    case AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+AZ_NODISCARD static bool _az_http_circuit_breaker_is_failure(
+    az_http_policy_circuit_breaker_options const* options,
+    az_result result,
+    az_http_response* ref_response)
+{
+  if (az_result_failed(result))
+  {
+    return _az_http_circuit_breaker_is_endpoint_error(result);
+  }
+
+  // Leave the parser where it was, for the policies which read the response next.
+  _az_http_response_parser const parser = ref_response->_internal.parser;
+  az_http_response_status_line status_line = { 0 };
+  az_result const status_line_result
+      = az_http_response_get_status_line(ref_response, &status_line);
+  ref_response->_internal.parser = parser;
+  if (az_result_failed(status_line_result))
+  {
+    return true;
+  }
+
+  for (az_http_status_code const* status_code = options->status_codes;
+       *status_code != AZ_HTTP_STATUS_CODE_END_OF_LIST;
+       ++status_code)
+  {
+    if (*status_code == status_line.status_code)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void _az_http_circuit_breaker_record(
+    az_http_policy_circuit_breaker_options const* options,
+    _az_http_circuit_breaker_endpoint* ref_endpoint,
+    bool is_failure,
+    int64_t now)
+{
+  if (!is_failure)
+  {
+    if (ref_endpoint->state != _az_HTTP_CIRCUIT_BREAKER_STATE_CLOSED)
+    {
+      ref_endpoint->state = _az_HTTP_CIRCUIT_BREAKER_STATE_CLOSED;
+      ref_endpoint->failure_count = 0;
+      ref_endpoint->window_start = now;
+      ref_endpoint->is_probe_pending = false;
+    }
+
+    return;
+  }
+
+  if (ref_endpoint->state == _az_HTTP_CIRCUIT_BREAKER_STATE_CLOSED)
+  {
+    if (now - ref_endpoint->window_start > options->failure_window_msec)
+    {
+      ref_endpoint->window_start = now;
+      ref_endpoint->failure_count = 0;
+    }
+
+    if (++ref_endpoint->failure_count < options->failure_threshold)
+    {
+      return;
+    }
+  }
+
+  // The failures reached the threshold, or the probe of a half-open circuit failed.
+  ref_endpoint->state = _az_HTTP_CIRCUIT_BREAKER_STATE_OPEN;
+  ref_endpoint->failure_count = 0;
+  ref_endpoint->opened_at = now;
+  ref_endpoint->is_probe_pending = false;
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_circuit_breaker(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_circuit_breaker* const circuit_breaker
+      = (az_http_policy_circuit_breaker*)ref_options;
+
+  if (circuit_breaker == NULL || circuit_breaker->_internal.options.failure_threshold <= 0)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  az_span url = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_url(ref_request, &url));
+  az_http_policy_circuit_breaker_options const* const options
+      = &circuit_breaker->_internal.options;
+  uint32_t const key = _az_http_circuit_breaker_get_key(url);
+  int64_t const now = az_platform_clock_msec();
+  bool is_open = false;
+  bool is_probe = false;
+
+  _az_http_policy_lock(&circuit_breaker->_internal.lock);
+  _az_http_circuit_breaker_endpoint* endpoint
+      = _az_http_circuit_breaker_get_endpoint(circuit_breaker, key, now);
+  switch (endpoint->state)
+  {
+    case _az_HTTP_CIRCUIT_BREAKER_STATE_OPEN:
+      if (now - endpoint->opened_at < options->open_duration_msec)
+      {
+        is_open = true;
+        break;
+      }
+
+      endpoint->state = _az_HTTP_CIRCUIT_BREAKER_STATE_HALF_OPEN;
+      endpoint->is_probe_pending = true;
+      is_probe = true;
+      break;
+
+    case _az_HTTP_CIRCUIT_BREAKER_STATE_HALF_OPEN:
+      // Other requests wait for the probe to tell whether the endpoint recovered.
+      if (endpoint->is_probe_pending)
+      {
+        is_open = true;
+        break;
+      }
+
+      endpoint->is_probe_pending = true;
+      is_probe = true;
+      break;
+
+    default:
+      break;
+  }
+  _az_http_policy_unlock(&circuit_breaker->_internal.lock);
+
+  if (is_open)
+  {
+    return AZ_ERROR_HTTP_CIRCUIT_OPEN;
+  }
+
+  az_result const result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+
+  // A request which was canceled, or failed in the client, says nothing about its endpoint.
+  bool const is_endpoint_result
+      = az_result_succeeded(result) || _az_http_circuit_breaker_is_endpoint_error(result);
+  bool const is_failure
+      = is_endpoint_result && _az_http_circuit_breaker_is_failure(options, result, ref_response);
+  int64_t const completed_at = az_platform_clock_msec();
+
+  // Other threads may have made room for other endpoints while the request was sent, so the
+  // endpoint is looked up again.
+  _az_http_policy_lock(&circuit_breaker->_internal.lock);
+  endpoint = _az_http_circuit_breaker_get_endpoint(circuit_breaker, key, completed_at);
+  if (is_endpoint_result)
+  {
+    _az_http_circuit_breaker_record(options, endpoint, is_failure, completed_at);
+  }
+  else if (is_probe)
+  {
+    endpoint->is_probe_pending = false;
+  }
+  _az_http_policy_unlock(&circuit_breaker->_internal.lock);
+
+  return result;
+}
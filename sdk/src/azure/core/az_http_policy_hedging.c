@@ -0,0 +1,256 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_config.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// The longest az_http_client_async_poll() waits at once, once both copies are in flight.
+#define _az_HTTP_HEDGING_POLL_INTERVAL_MSEC 100
+
+// A copy of the request in flight, with a context of its own to cancel it.
+typedef struct
+{
+  az_http_request request;
+  az_context context;
+  az_http_response* response;
+  az_result result;
+  bool is_in_flight;
+} _az_http_hedging_attempt;
+
+static void _az_http_hedging_on_complete(
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_result result,
+    void* user_context)
+{
+  (void)request;
+  (void)ref_response;
+  _az_http_hedging_attempt* const attempt = (_az_http_hedging_attempt*)user_context;
+  attempt->result = result;
+  attempt->is_in_flight = false;
+}
+
+AZ_NODISCARD static bool _az_http_hedging_has_succeeded(_az_http_hedging_attempt const* attempt)
+{
+  // A copy which was never sent has no response.
+  if (attempt->response == NULL || attempt->is_in_flight || az_result_failed(attempt->result))
+  {
+    return false;
+  }
+
+  // Leave the parser where it was, for the policies which read the response next.
+  _az_http_response_parser const parser = attempt->response->_internal.parser;
+  az_http_response_status_line status_line = { 0 };
+  az_result const result = az_http_response_get_status_line(attempt->response, &status_line);
+  attempt->response->_internal.parser = parser;
+
+  return az_result_succeeded(result)
+      && status_line.status_code < AZ_HTTP_STATUS_CODE_INTERNAL_SERVER_ERROR;
+}
+
+static az_result _az_http_hedging_submit(
+    az_http_client_async* ref_client,
+    _az_http_hedging_attempt* ref_attempt,
+    az_http_request const* request,
+    az_http_response* ref_response)
+{
+  az_context const* const parent
+      = request->_internal.context != NULL ? request->_internal.context : &az_context_application;
+  ref_attempt->context = az_context_create_with_expiration(parent, _az_CONTEXT_MAX_EXPIRATION);
+  ref_attempt->request = *request;
+  ref_attempt->request._internal.context = &ref_attempt->context;
+  ref_attempt->response = ref_response;
+  ref_attempt->result = AZ_OK;
+
+  az_result const result = az_http_client_async_submit(
+      ref_client, &ref_attempt->request, ref_response, _az_http_hedging_on_complete, ref_attempt);
+  if (az_result_failed(result))
+  {
+    // The copy wasn't sent, and has no response.
+    ref_attempt->response = NULL;
+    return result;
+  }
+
+  ref_attempt->is_in_flight = true;
+  return AZ_OK;
+}
+
+// The delay before a copy of the request is sent, from the latencies of the recent requests.
+AZ_NODISCARD static int32_t
+_az_http_hedging_get_delay(az_http_policy_hedging_options const* options)
+{
+  int32_t const count = options->_internal.latency_count;
+  if (options->latency_percentile <= 0 || count < AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT)
+  {
+    return options->hedge_delay_msec;
+  }
+
+  // Insertion sort of a copy: there are only a few dozens of latencies.
+  int32_t sorted[AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT];
+  for (int32_t i = 0; i < count; i++)
+  {
+    int32_t const latency = options->_internal.latencies[i];
+    int32_t j = i;
+    for (; j > 0 && sorted[j - 1] > latency; j--)
+    {
+      sorted[j] = sorted[j - 1];
+    }
+
+    sorted[j] = latency;
+  }
+
+  int32_t const index = (count - 1) * options->latency_percentile / 100;
+  int32_t const delay = sorted[index < count ? index : count - 1];
+  return delay > options->hedge_delay_msec ? delay : options->hedge_delay_msec;
+}
+
+static void
+_az_http_hedging_add_latency(az_http_policy_hedging_options* ref_options, int64_t latency_msec)
+{
+  ref_options->_internal.latencies[ref_options->_internal.next_latency]
+      = latency_msec < INT32_MAX ? (int32_t)latency_msec : INT32_MAX;
+  ref_options->_internal.next_latency
+      = (ref_options->_internal.next_latency + 1) % AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT;
+  if (ref_options->_internal.latency_count < AZ_HTTP_HEDGING_LATENCY_SAMPLE_COUNT)
+  {
+    ++ref_options->_internal.latency_count;
+  }
+}
+
+// Both copies are sent by the client of the policy rather than by the policies which follow it, so
+// the policy only hedges a request when it is the last policy, ahead of the transport it replaces.
+// Without options, the policy is off.
+AZ_NODISCARD static bool _az_http_hedging_can_hedge(
+    az_http_policy_hedging_options const* options,
+    _az_http_policy const* policies,
+    az_http_request const* request,
+    az_http_response const* response)
+{
+  return options != NULL && options->client != NULL
+      && policies[0]._internal.process == az_http_pipeline_policy_transport
+      && (az_span_is_content_equal(request->_internal.method, az_http_method_get())
+          || az_span_is_content_equal(request->_internal.method, az_http_method_head()))
+      && response->_internal.body_sink == NULL && response->_internal.body_decoding.codec == NULL;
+}
+
+// Cancels the copy of the request which lost the race, and waits for the client to let go of it.
+static void
+_az_http_hedging_cancel(az_http_client_async* ref_client, _az_http_hedging_attempt* ref_attempt)
+{
+  az_context_cancel(&ref_attempt->context);
+  while (ref_attempt->is_in_flight
+         && az_result_succeeded(
+             az_http_client_async_poll(ref_client, _az_HTTP_HEDGING_POLL_INTERVAL_MSEC, NULL)))
+  {
+  }
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_hedging(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_hedging_options* const options = (az_http_policy_hedging_options*)ref_options;
+  if (!_az_http_hedging_can_hedge(options, ref_policies, ref_request, ref_response))
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  az_http_client_async* const client = options->client;
+  int64_t const start = az_platform_clock_msec();
+  int64_t const hedge_time = start + _az_http_hedging_get_delay(options);
+
+  _az_http_hedging_attempt primary = { 0 };
+  _az_RETURN_IF_FAILED(_az_http_hedging_submit(client, &primary, ref_request, ref_response));
+
+  az_http_response hedge_response = { 0 };
+  _az_http_hedging_attempt hedge = { 0 };
+  bool is_hedging_possible = true;
+  az_result result = AZ_OK;
+  while (true)
+  {
+    // The first response which succeeds wins. A failure is only returned once both completed.
+    if (_az_http_hedging_has_succeeded(&primary) || _az_http_hedging_has_succeeded(&hedge)
+        || (!primary.is_in_flight && !hedge.is_in_flight))
+    {
+      break;
+    }
+
+    int64_t const now = az_platform_clock_msec();
+    int32_t timeout_msec = _az_HTTP_HEDGING_POLL_INTERVAL_MSEC;
+    if (is_hedging_possible && primary.is_in_flight)
+    {
+      if (now < hedge_time)
+      {
+        timeout_msec = hedge_time - now < timeout_msec ? (int32_t)(hedge_time - now)
+                                                       : timeout_msec;
+      }
+      else
+      {
+        is_hedging_possible = false;
+        if (az_span_size(options->hedge_response_buffer) > 0
+            && (options->budget == NULL
+                || _az_http_policy_retry_budget_add(options->budget, -_az_RETRY_BUDGET_TOKEN)))
+        {
+          az_result hedge_result
+              = az_http_response_init(&hedge_response, options->hedge_response_buffer);
+          if (az_result_succeeded(hedge_result))
+          {
+            hedge_result = _az_http_hedging_submit(client, &hedge, ref_request, &hedge_response);
+          }
+
+          // A copy which wasn't sent gives its retry back to the budget.
+          if (az_result_failed(hedge_result) && options->budget != NULL)
+          {
+            (void)_az_http_policy_retry_budget_add(options->budget, _az_RETRY_BUDGET_TOKEN);
+          }
+        }
+
+        continue;
+      }
+    }
+
+    result = az_http_client_async_poll(client, timeout_msec, NULL);
+    if (az_result_failed(result))
+    {
+      break;
+    }
+  }
+
+  // Both copies of the request must be let go of before returning, even when polling failed.
+  if (_az_http_hedging_has_succeeded(&hedge))
+  {
+    _az_http_hedging_add_latency(options, az_platform_clock_msec() - start);
+    _az_http_hedging_cancel(client, &primary);
+    _az_http_response_reset(ref_response);
+    return az_http_response_append(
+        ref_response,
+        az_span_slice(
+            hedge_response._internal.http_response, 0, hedge_response._internal.written));
+  }
+
+  _az_http_hedging_cancel(client, &hedge);
+  _az_http_hedging_cancel(client, &primary);
+  _az_RETURN_IF_FAILED(result);
+
+  if (_az_http_hedging_has_succeeded(&primary))
+  {
+    _az_http_hedging_add_latency(options, az_platform_clock_msec() - start);
+  }
+
+  return primary.result;
+}
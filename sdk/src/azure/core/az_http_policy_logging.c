@@ -3,6 +3,7 @@
 
 #include "az_http_policy_logging_private.h"
 #include "az_span_private.h"
+#include <azure/core/az_arena.h>
 #include <azure/core/az_http_transport.h>
 #include <azure/core/az_platform.h>
 #include <azure/core/internal/az_http_internal.h>
@@ -207,30 +208,91 @@ static az_result _az_http_policy_logging_append_http_response_msg(
   return AZ_OK;
 }
 
-void _az_http_policy_logging_log_http_request(az_http_request const* request)
+static void
+_az_http_policy_logging_write_http_request(az_http_request const* request, az_span log_msg)
 {
-  uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
-  az_span log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
-
   (void)_az_http_policy_logging_append_http_request_msg(request, &log_msg);
 
   _az_LOG_WRITE(AZ_LOG_HTTP_REQUEST, log_msg);
 }
 
-void _az_http_policy_logging_log_http_response(
-    az_http_response const* response,
+static void _az_http_policy_logging_write_http_response(
+    az_http_response* ref_response,
+    int64_t duration_msec,
+    az_http_request const* request,
+    az_span log_msg)
+{
+  // Leave the parser where it was, while the header index stays with the response.
+  _az_http_response_parser const parser = ref_response->_internal.parser;
+
+  (void)_az_http_policy_logging_append_http_response_msg(
+      ref_response, duration_msec, request, &log_msg);
+
+  ref_response->_internal.parser = parser;
+
+  _az_LOG_WRITE(AZ_LOG_HTTP_RESPONSE, log_msg);
+}
+
+// Log messages are written into the arena of the request when it has room for them.
+static az_arena* _az_http_policy_logging_get_arena(az_http_request const* request)
+{
+  return request == NULL ? NULL : az_arena_from_context(request->_internal.context);
+}
+
+// Otherwise, they are written on the stack, which is only taken when there is no room in the arena.
+_az_NOINLINE void _az_http_policy_logging_log_http_request_on_stack(az_http_request const* request)
+{
+  uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
+  _az_http_policy_logging_write_http_request(request, AZ_SPAN_FROM_BUFFER(log_msg_buf));
+}
+
+_az_NOINLINE void _az_http_policy_logging_log_http_response_on_stack(
+    az_http_response* ref_response,
     int64_t duration_msec,
     az_http_request const* request)
 {
   uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
-  az_span log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
+  _az_http_policy_logging_write_http_response(
+      ref_response, duration_msec, request, AZ_SPAN_FROM_BUFFER(log_msg_buf));
+}
 
-  az_http_response response_copy = *response;
+void _az_http_policy_logging_log_http_request(az_http_request const* request)
+{
+  az_arena* const arena = _az_http_policy_logging_get_arena(request);
+  if (arena != NULL)
+  {
+    az_arena_mark const mark = az_arena_get_mark(arena);
+    az_span log_msg = AZ_SPAN_EMPTY;
+    if (az_result_succeeded(az_arena_allocate(arena, AZ_LOG_MESSAGE_BUFFER_SIZE, &log_msg)))
+    {
+      _az_http_policy_logging_write_http_request(request, log_msg);
+      az_arena_rollback(arena, mark);
+      return;
+    }
+  }
 
-  (void)_az_http_policy_logging_append_http_response_msg(
-      &response_copy, duration_msec, request, &log_msg);
+  _az_http_policy_logging_log_http_request_on_stack(request);
+}
 
-  _az_LOG_WRITE(AZ_LOG_HTTP_RESPONSE, log_msg);
+void _az_http_policy_logging_log_http_response(
+    az_http_response* ref_response,
+    int64_t duration_msec,
+    az_http_request const* request)
+{
+  az_arena* const arena = _az_http_policy_logging_get_arena(request);
+  if (arena != NULL)
+  {
+    az_arena_mark const mark = az_arena_get_mark(arena);
+    az_span log_msg = AZ_SPAN_EMPTY;
+    if (az_result_succeeded(az_arena_allocate(arena, AZ_LOG_MESSAGE_BUFFER_SIZE, &log_msg)))
+    {
+      _az_http_policy_logging_write_http_response(ref_response, duration_msec, request, log_msg);
+      az_arena_rollback(arena, mark);
+      return;
+    }
+  }
+
+  _az_http_policy_logging_log_http_response_on_stack(ref_response, duration_msec, request);
 }
 
 #ifndef AZ_NO_LOGGING
@@ -14,7 +14,7 @@
 void _az_http_policy_logging_log_http_request(az_http_request const* request);
 
 void _az_http_policy_logging_log_http_response(
-    az_http_response const* response,
+    az_http_response* ref_response,
     int64_t duration_msec,
     az_http_request const* request);
 
@@ -0,0 +1,242 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_config.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <azure/core/_az_cfg.h>
+
+AZ_INLINE void _az_http_metrics_add(int64_t volatile* ref_counter, int64_t value)
+{
+#if defined(_MSC_VER)
+  (void)_InterlockedExchangeAdd64((__int64 volatile*)ref_counter, value);
+#elif (defined(__GNUC__) || defined(__clang__)) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+  (void)__atomic_fetch_add(ref_counter, value, __ATOMIC_RELAXED);
+#else
+  // Without lock-free atomics, metrics must not be shared by requests sent from different threads.
+  *ref_counter += value;
+#endif
+}
+
+AZ_INLINE int64_t _az_http_metrics_load(int64_t const volatile* counter)
+{
+#if (defined(__GNUC__) || defined(__clang__)) && __GCC_ATOMIC_LLONG_LOCK_FREE == 2
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#else
+  return *counter;
+#endif
+}
+
+AZ_NODISCARD az_result az_http_policy_metrics_init(az_http_policy_metrics* out_metrics)
+{
+  _az_PRECONDITION_NOT_NULL(out_metrics);
+
+  *out_metrics = (az_http_policy_metrics){ ._internal = { .operations = { { 0 } } } };
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_policy_metrics_get_snapshot(
+    az_http_policy_metrics const* metrics,
+    az_http_metrics_operation operation,
+    az_http_metrics_snapshot* out_snapshot)
+{
+  _az_PRECONDITION_NOT_NULL(metrics);
+  _az_PRECONDITION_RANGE(0, operation, _az_HTTP_METRICS_OPERATION_COUNT - 1);
+  _az_PRECONDITION_NOT_NULL(out_snapshot);
+
+  _az_http_metrics_counters const* const counters = &metrics->_internal.operations[operation];
+  out_snapshot->request_count = _az_http_metrics_load(&counters->request_count);
+  out_snapshot->failure_count = _az_http_metrics_load(&counters->failure_count);
+  for (int32_t i = 0; i < 5; i++)
+  {
+    out_snapshot->status_class_counts[i] = _az_http_metrics_load(&counters->status_class_counts[i]);
+  }
+
+  out_snapshot->retry_count = _az_http_metrics_load(&counters->retry_count);
+  out_snapshot->bytes_sent = _az_http_metrics_load(&counters->bytes_sent);
+  out_snapshot->bytes_received = _az_http_metrics_load(&counters->bytes_received);
+  for (int32_t i = 0; i < AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT; i++)
+  {
+    out_snapshot->latency_histogram[i] = _az_http_metrics_load(&counters->latency_histogram[i]);
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD int64_t az_http_metrics_snapshot_get_latency_percentile(
+    az_http_metrics_snapshot const* snapshot,
+    int32_t percentile)
+{
+  _az_PRECONDITION_NOT_NULL(snapshot);
+  _az_PRECONDITION_RANGE(0, percentile, 100);
+
+  int64_t count = 0;
+  for (int32_t i = 0; i < AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT; i++)
+  {
+    count += snapshot->latency_histogram[i];
+  }
+
+  if (count == 0)
+  {
+    return 0;
+  }
+
+  // The rank of the latency, among the latencies sorted in increasing order, counted from 1.
+  int64_t rank = (count * percentile + 99) / 100;
+  if (rank < 1)
+  {
+    rank = 1;
+  }
+
+  for (int32_t i = 0; i < AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT; i++)
+  {
+    rank -= snapshot->latency_histogram[i];
+    if (rank <= 0)
+    {
+      return _az_http_metrics_get_bucket_max_latency(i);
+    }
+  }
+
+  return _az_http_metrics_get_bucket_max_latency(AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT - 1);
+}
+
+AZ_NODISCARD static az_http_metrics_operation
+_az_http_metrics_get_operation(az_http_request const* request)
+{
+  az_http_method const method = request->_internal.method;
+  az_http_method const methods[] = {
+    az_http_method_get(),    az_http_method_head(),   az_http_method_put(),
+    az_http_method_post(),   az_http_method_delete(), az_http_method_patch(),
+  };
+
+  for (int32_t i = 0; i < (int32_t)(sizeof(methods) / sizeof(methods[0])); i++)
+  {
+    if (az_span_is_content_equal(method, methods[i]))
+    {
+      return (az_http_metrics_operation)i;
+    }
+  }
+
+  return AZ_HTTP_METRICS_OPERATION_OTHER;
+}
+
+// Counts the bytes of the body written to the body sink of the response, on their way to it.
+typedef struct
+{
+  az_http_response_body_sink sink;
+  az_http_response_body_sink const* next_sink;
+  int64_t written;
+} _az_http_metrics_body_sink;
+
+static AZ_NODISCARD az_result _az_http_metrics_body_sink_write(void* user_context, az_span part)
+{
+  _az_http_metrics_body_sink* const sink = (_az_http_metrics_body_sink*)user_context;
+  az_result const result = sink->next_sink->write(sink->next_sink->user_context, part);
+  if (az_result_succeeded(result))
+  {
+    sink->written += az_span_size(part);
+  }
+
+  return result;
+}
+
+static AZ_NODISCARD az_result _az_http_metrics_body_sink_reset(void* user_context)
+{
+  _az_http_metrics_body_sink* const sink = (_az_http_metrics_body_sink*)user_context;
+  return sink->next_sink->reset(sink->next_sink->user_context);
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_metrics(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_metrics* const metrics = (az_http_policy_metrics*)ref_options;
+  if (metrics == NULL)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  // The sink of the response is replaced by one which counts the bytes it receives, and put back
+  // once the request completes.
+  az_http_response_body_sink const* const body_sink = ref_response->_internal.body_sink;
+  _az_http_metrics_body_sink counting_sink = { 0 };
+  if (body_sink != NULL)
+  {
+    counting_sink = (_az_http_metrics_body_sink){
+      .sink = {
+        .write = _az_http_metrics_body_sink_write,
+        .reset = body_sink->reset == NULL ? NULL : _az_http_metrics_body_sink_reset,
+        .user_context = &counting_sink,
+      },
+      .next_sink = body_sink,
+      .written = 0,
+    };
+    ref_response->_internal.body_sink = &counting_sink.sink;
+  }
+
+  int32_t const retry_count = ref_request->_internal.retry_count;
+  int64_t const start = az_platform_clock_usec();
+
+  az_result const result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+
+  int64_t const latency_usec = az_platform_clock_usec() - start;
+  ref_response->_internal.body_sink = body_sink;
+
+  int32_t const retries = ref_request->_internal.retry_count - retry_count;
+  int64_t body_size = az_span_size(ref_request->_internal.body);
+  if (ref_request->_internal.body_provider != NULL)
+  {
+    body_size = ref_request->_internal.body_provider->length < 0
+        ? 0
+        : ref_request->_internal.body_provider->length;
+  }
+
+  az_http_response_status_line status_line = { 0 };
+  bool has_status_line = false;
+  if (az_result_succeeded(result))
+  {
+    // Leave the parser where it was, for the policies which read the response next.
+    _az_http_response_parser const parser = ref_response->_internal.parser;
+    has_status_line
+        = az_result_succeeded(az_http_response_get_status_line(ref_response, &status_line));
+    ref_response->_internal.parser = parser;
+  }
+
+  // Every counter is updated on its own, so that requests completing on other threads never wait.
+  _az_http_metrics_counters* const counters
+      = &metrics->_internal.operations[_az_http_metrics_get_operation(ref_request)];
+  int32_t const status_class = (int32_t)status_line.status_code / 100 - 1;
+  if (has_status_line && status_class >= 0 && status_class < 5)
+  {
+    _az_http_metrics_add(&counters->status_class_counts[status_class], 1);
+  }
+  else
+  {
+    _az_http_metrics_add(&counters->failure_count, 1);
+  }
+
+  _az_http_metrics_add(&counters->retry_count, retries);
+  _az_http_metrics_add(&counters->bytes_sent, body_size * (retries + 1));
+  _az_http_metrics_add(
+      &counters->bytes_received, ref_response->_internal.written + counting_sink.written);
+  _az_http_metrics_add(&counters->request_count, 1);
+  _az_http_metrics_add(
+      &counters->latency_histogram[_az_http_metrics_get_latency_bucket(latency_usec)], 1);
+
+  return result;
+}
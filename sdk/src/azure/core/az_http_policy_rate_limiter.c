@@ -0,0 +1,193 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_config_internal.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define _az_RATE_LIMITER_MAX_RATE 1000000
+
+// A request takes a token, counted in thousandths so that a token is refilled for every millisecond
+// times the rate in requests per second.
+#define _az_RATE_LIMITER_TOKEN _az_TIME_MILLISECONDS_PER_SECOND
+
+static az_http_status_code const _az_rate_limiter_throttling_status_codes[] = {
+  AZ_HTTP_STATUS_CODE_TOO_MANY_REQUESTS,
+  AZ_HTTP_STATUS_CODE_SERVICE_UNAVAILABLE,
+  AZ_HTTP_STATUS_CODE_END_OF_LIST,
+};
+
+AZ_NODISCARD az_result az_http_policy_rate_limiter_init(
+    az_http_policy_rate_limiter* out_rate_limiter,
+    int32_t initial_rate,
+    int32_t min_rate,
+    int32_t max_rate)
+{
+  _az_PRECONDITION_NOT_NULL(out_rate_limiter);
+  _az_PRECONDITION_RANGE(1, min_rate, _az_RATE_LIMITER_MAX_RATE);
+  _az_PRECONDITION_RANGE(min_rate, max_rate, _az_RATE_LIMITER_MAX_RATE);
+  _az_PRECONDITION_RANGE(min_rate, initial_rate, max_rate);
+
+  *out_rate_limiter = (az_http_policy_rate_limiter){
+    ._internal = {
+      .tokens = 0,
+      .refilled_at = 0,
+      .blocked_until = 0,
+      .decreased_at = 0,
+      .rate = initial_rate,
+      .min_rate = min_rate,
+      .max_rate = max_rate,
+      .success_count = 0,
+      .lock = 0,
+    },
+  };
+
+  return AZ_OK;
+}
+
+// Takes a token out of the bucket, and returns how long to wait for it, in milliseconds. Must be
+// called under the lock, like the other functions which update the rate limiter.
+AZ_NODISCARD static int64_t
+_az_http_rate_limiter_take_token(az_http_policy_rate_limiter* ref_rate_limiter, int64_t now)
+{
+  int64_t const max_tokens = (int64_t)ref_rate_limiter->_internal.rate * _az_RATE_LIMITER_TOKEN;
+  if (ref_rate_limiter->_internal.refilled_at == 0)
+  {
+    // The bucket starts full.
+    ref_rate_limiter->_internal.tokens = max_tokens;
+  }
+  else if (now > ref_rate_limiter->_internal.refilled_at)
+  {
+    int64_t const tokens = ref_rate_limiter->_internal.tokens
+        + (now - ref_rate_limiter->_internal.refilled_at) * ref_rate_limiter->_internal.rate;
+    ref_rate_limiter->_internal.tokens = tokens < max_tokens ? tokens : max_tokens;
+  }
+
+  ref_rate_limiter->_internal.refilled_at = now;
+  ref_rate_limiter->_internal.tokens -= _az_RATE_LIMITER_TOKEN;
+
+  // While the bucket is in debt, the token is only there once the debt is paid back.
+  int64_t wait_msec = 0;
+  if (ref_rate_limiter->_internal.tokens < 0)
+  {
+    wait_msec = (-ref_rate_limiter->_internal.tokens + ref_rate_limiter->_internal.rate - 1)
+        / ref_rate_limiter->_internal.rate;
+  }
+
+  int64_t const blocked_msec = ref_rate_limiter->_internal.blocked_until - now;
+  return blocked_msec > wait_msec ? blocked_msec : wait_msec;
+}
+
+static void _az_http_rate_limiter_on_throttled(
+    az_http_policy_rate_limiter* ref_rate_limiter,
+    int32_t retry_after_msec,
+    int64_t now)
+{
+  ref_rate_limiter->_internal.success_count = 0;
+
+  if (retry_after_msec > 0 && now + retry_after_msec > ref_rate_limiter->_internal.blocked_until)
+  {
+    ref_rate_limiter->_internal.blocked_until = now + retry_after_msec;
+  }
+
+  // The responses to the requests which were in flight together only lower the rate once.
+  if (ref_rate_limiter->_internal.decreased_at != 0
+      && now - ref_rate_limiter->_internal.decreased_at < _az_TIME_MILLISECONDS_PER_SECOND)
+  {
+    return;
+  }
+
+  int32_t const rate = ref_rate_limiter->_internal.rate / 2;
+  ref_rate_limiter->_internal.rate
+      = rate > ref_rate_limiter->_internal.min_rate ? rate : ref_rate_limiter->_internal.min_rate;
+  ref_rate_limiter->_internal.decreased_at = now;
+
+  // The bucket doesn't hold more than a second of requests at the lower rate.
+  int64_t const max_tokens = (int64_t)ref_rate_limiter->_internal.rate * _az_RATE_LIMITER_TOKEN;
+  if (ref_rate_limiter->_internal.tokens > max_tokens)
+  {
+    ref_rate_limiter->_internal.tokens = max_tokens;
+  }
+}
+
+static void _az_http_rate_limiter_on_success(az_http_policy_rate_limiter* ref_rate_limiter)
+{
+  // Probing upward by one request per second, about once a second, approaches the rate the service
+  // throttles at without overshooting it by much.
+  if (++ref_rate_limiter->_internal.success_count >= ref_rate_limiter->_internal.rate
+      && ref_rate_limiter->_internal.rate < ref_rate_limiter->_internal.max_rate)
+  {
+    ++ref_rate_limiter->_internal.rate;
+    ref_rate_limiter->_internal.success_count = 0;
+  }
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_rate_limiter(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_rate_limiter* const rate_limiter = (az_http_policy_rate_limiter*)ref_options;
+  if (rate_limiter == NULL)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  int64_t const now = az_platform_clock_msec();
+  _az_http_policy_lock(&rate_limiter->_internal.lock);
+  int64_t const wait_msec = _az_http_rate_limiter_take_token(rate_limiter, now);
+  _az_http_policy_unlock(&rate_limiter->_internal.lock);
+
+  if (wait_msec > 0)
+  {
+    az_result const wait_result = _az_http_policy_retry_wait(
+        ref_request->_internal.context, wait_msec < INT32_MAX ? (int32_t)wait_msec : INT32_MAX);
+    if (az_result_failed(wait_result))
+    {
+      // The request isn't sent, and gives its token back.
+      _az_http_policy_lock(&rate_limiter->_internal.lock);
+      rate_limiter->_internal.tokens += _az_RATE_LIMITER_TOKEN;
+      _az_http_policy_unlock(&rate_limiter->_internal.lock);
+      return wait_result;
+    }
+  }
+
+  _az_RETURN_IF_FAILED(_az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response));
+
+  // Leave the parser where it was, for the policies which read the response next.
+  bool is_throttled = false;
+  int32_t retry_after_msec = -1;
+  _az_http_response_parser const parser = ref_response->_internal.parser;
+  az_result const result = _az_http_policy_retry_get_retry_after(
+      ref_response, _az_rate_limiter_throttling_status_codes, &is_throttled, &retry_after_msec);
+  ref_response->_internal.parser = parser;
+  _az_RETURN_IF_FAILED(result);
+
+  if (is_throttled)
+  {
+    int64_t const throttled_at = az_platform_clock_msec();
+    _az_http_policy_lock(&rate_limiter->_internal.lock);
+    _az_http_rate_limiter_on_throttled(rate_limiter, retry_after_msec, throttled_at);
+    _az_http_policy_unlock(&rate_limiter->_internal.lock);
+  }
+  else
+  {
+    _az_http_policy_lock(&rate_limiter->_internal.lock);
+    _az_http_rate_limiter_on_success(rate_limiter);
+    _az_http_policy_unlock(&rate_limiter->_internal.lock);
+  }
+
+  return AZ_OK;
+}
@@ -2,11 +2,13 @@
 // SPDX-License-Identifier: MIT
 
 #include "az_http_private.h"
+#include <azure/core/az_arena.h>
 #include <azure/core/az_config.h>
 #include <azure/core/az_platform.h>
 #include <azure/core/internal/az_config_internal.h>
 #include <azure/core/internal/az_http_internal.h>
 #include <azure/core/internal/az_log_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/core/internal/az_retry_internal.h>
 #include <azure/core/internal/az_span_internal.h>
@@ -15,8 +17,14 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #include <azure/core/_az_cfg.h>
 
+#define _az_RETRY_BUDGET_MAX_RETRIES 1000000
+
 static az_http_status_code const _default_status_codes[] = {
   AZ_HTTP_STATUS_CODE_REQUEST_TIMEOUT,       AZ_HTTP_STATUS_CODE_TOO_MANY_REQUESTS,
   AZ_HTTP_STATUS_CODE_INTERNAL_SERVER_ERROR, AZ_HTTP_STATUS_CODE_BAD_GATEWAY,
@@ -32,7 +40,75 @@ AZ_NODISCARD az_http_policy_retry_options _az_http_policy_retry_options_default(
     .max_retry_delay_msec
     = 2 * _az_TIME_SECONDS_PER_MINUTE * _az_TIME_MILLISECONDS_PER_SECOND, // 2 minutes
     .status_codes = _default_status_codes,
+    .budget = NULL,
+  };
+}
+
+AZ_NODISCARD az_result az_http_policy_retry_budget_init(
+    az_http_policy_retry_budget* out_budget,
+    int32_t max_retries,
+    int32_t retry_percent)
+{
+  _az_PRECONDITION_NOT_NULL(out_budget);
+  _az_PRECONDITION_RANGE(1, max_retries, _az_RETRY_BUDGET_MAX_RETRIES);
+  _az_PRECONDITION_RANGE(0, retry_percent, 100);
+
+  *out_budget = (az_http_policy_retry_budget){
+    ._internal = {
+      .tokens = max_retries * _az_RETRY_BUDGET_TOKEN,
+      .max_tokens = max_retries * _az_RETRY_BUDGET_TOKEN,
+      .deposit = retry_percent * _az_RETRY_BUDGET_TOKEN / 100,
+    },
   };
+
+  return AZ_OK;
+}
+
+AZ_INLINE bool _az_http_policy_retry_budget_compare_exchange(
+    int32_t volatile* ref_tokens,
+    int32_t expected,
+    int32_t desired)
+{
+#if defined(_MSC_VER)
+  return _InterlockedCompareExchange((long volatile*)ref_tokens, desired, expected) == expected;
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_compare_exchange_n(
+      ref_tokens, &expected, desired, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+  // Without atomics, a budget must not be shared by requests sent from different threads.
+  if (*ref_tokens != expected)
+  {
+    return false;
+  }
+
+  *ref_tokens = desired;
+  return true;
+#endif
+}
+
+bool _az_http_policy_retry_budget_add(az_http_policy_retry_budget* ref_budget, int32_t tokens)
+{
+  while (true)
+  {
+    int32_t const current = ref_budget->_internal.tokens;
+    int32_t desired = current + tokens;
+    if (desired < 0)
+    {
+      return false;
+    }
+
+    if (desired > ref_budget->_internal.max_tokens)
+    {
+      desired = ref_budget->_internal.max_tokens;
+    }
+
+    if (desired == current
+        || _az_http_policy_retry_budget_compare_exchange(
+            &ref_budget->_internal.tokens, current, desired))
+    {
+      return true;
+    }
+  }
 }
 
 // TODO: Add unit tests
@@ -62,16 +138,50 @@ AZ_INLINE az_result _az_http_policy_retry_append_http_retry_msg(
   return AZ_OK;
 }
 
-AZ_INLINE void _az_http_policy_retry_log(int32_t attempt, int32_t delay_msec)
+AZ_INLINE void _az_http_policy_retry_write_log(int32_t attempt, int32_t delay_msec, az_span log_msg)
 {
-  uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
-  az_span log_msg = AZ_SPAN_FROM_BUFFER(log_msg_buf);
-
   (void)_az_http_policy_retry_append_http_retry_msg(attempt, delay_msec, &log_msg);
 
   _az_LOG_WRITE(AZ_LOG_HTTP_RETRY, log_msg);
 }
 
+// Without room in the arena of the request, the log message is written on the stack, which is only
+// taken then.
+_az_NOINLINE void _az_http_policy_retry_log_on_stack(int32_t attempt, int32_t delay_msec)
+{
+  uint8_t log_msg_buf[AZ_LOG_MESSAGE_BUFFER_SIZE] = { 0 };
+  _az_http_policy_retry_write_log(attempt, delay_msec, AZ_SPAN_FROM_BUFFER(log_msg_buf));
+}
+
+// The log message is written into the arena of the request when it has room for it.
+static void _az_http_policy_retry_log(az_arena* arena, int32_t attempt, int32_t delay_msec)
+{
+  if (arena != NULL)
+  {
+    az_arena_mark const mark = az_arena_get_mark(arena);
+    az_span log_msg = AZ_SPAN_EMPTY;
+    if (az_result_succeeded(az_arena_allocate(arena, AZ_LOG_MESSAGE_BUFFER_SIZE, &log_msg)))
+    {
+      _az_http_policy_retry_write_log(attempt, delay_msec, log_msg);
+      az_arena_rollback(arena, mark);
+      return;
+    }
+  }
+
+  _az_http_policy_retry_log_on_stack(attempt, delay_msec);
+}
+
+// A connection can be lost after the service received the request, so only the requests which can
+// be applied more than once without changing the outcome are sent again.
+AZ_NODISCARD static bool _az_http_policy_retry_is_idempotent(az_http_request const* request)
+{
+  az_http_method const method = request->_internal.method;
+  return az_span_is_content_equal(method, az_http_method_get())
+      || az_span_is_content_equal(method, az_http_method_head())
+      || az_span_is_content_equal(method, az_http_method_put())
+      || az_span_is_content_equal(method, az_http_method_delete());
+}
+
 AZ_INLINE AZ_NODISCARD int32_t _az_uint32_span_to_int32(az_span span)
 {
   uint32_t value = 0;
@@ -83,7 +193,7 @@ AZ_INLINE AZ_NODISCARD int32_t _az_uint32_span_to_int32(az_span span)
   return value < INT32_MAX ? (int32_t)value : INT32_MAX;
 }
 
-AZ_INLINE AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
+AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
     az_http_response* ref_response,
     az_http_status_code const* status_codes,
     bool* should_retry,
@@ -103,16 +213,18 @@ AZ_INLINE AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
     // Try to get the value of retry-after header, if there's one.
     *should_retry = true;
 
-    az_span header_name = { 0 };
+    // The values are in milliseconds.
+    az_span const msec_header_names[] = {
+      AZ_SPAN_FROM_STR("retry-after-ms"),
+      AZ_SPAN_FROM_STR("x-ms-retry-after-ms"),
+    };
+
     az_span header_value = { 0 };
-    while (az_result_succeeded(
-        az_http_response_get_next_header(ref_response, &header_name, &header_value)))
+    for (size_t i = 0; i < sizeof(msec_header_names) / sizeof(msec_header_names[0]); ++i)
     {
-      if (az_span_is_content_equal_ignoring_case(header_name, AZ_SPAN_FROM_STR("retry-after-ms"))
-          || az_span_is_content_equal_ignoring_case(
-              header_name, AZ_SPAN_FROM_STR("x-ms-retry-after-ms")))
+      if (az_result_succeeded(
+              az_http_response_get_header(ref_response, msec_header_names[i], &header_value)))
       {
-        // The value is in milliseconds.
         int32_t const msec = _az_uint32_span_to_int32(header_value);
         if (msec >= 0) // int32_t max == ~24 days
         {
@@ -120,23 +232,25 @@ AZ_INLINE AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
           return AZ_OK;
         }
       }
-      else if (az_span_is_content_equal_ignoring_case(header_name, AZ_SPAN_FROM_STR("Retry-After")))
-      {
-        // The value is either seconds or date.
-        int32_t const seconds = _az_uint32_span_to_int32(header_value);
-        if (seconds >= 0) // int32_t max == ~68 years
-        {
-          *retry_after_msec = (seconds <= (INT32_MAX / _az_TIME_MILLISECONDS_PER_SECOND))
-              ? seconds * _az_TIME_MILLISECONDS_PER_SECOND
-              : INT32_MAX;
+    }
 
-          return AZ_OK;
-        }
+    if (az_result_succeeded(az_http_response_get_header(
+            ref_response, AZ_SPAN_FROM_STR("Retry-After"), &header_value)))
+    {
+      // The value is either seconds or date.
+      int32_t const seconds = _az_uint32_span_to_int32(header_value);
+      if (seconds >= 0) // int32_t max == ~68 years
+      {
+        *retry_after_msec = (seconds <= (INT32_MAX / _az_TIME_MILLISECONDS_PER_SECOND))
+            ? seconds * _az_TIME_MILLISECONDS_PER_SECOND
+            : INT32_MAX;
 
-        // TODO: Other possible value is HTTP Date. For that, we'll need to parse date, get
-        // current date, subtract one from another, get seconds. And the device should have a
-        // sense of calendar clock.
+        return AZ_OK;
       }
+
+      // TODO: Other possible value is HTTP Date. For that, we'll need to parse date, get
+      // current date, subtract one from another, get seconds. And the device should have a
+      // sense of calendar clock.
     }
 
     *retry_after_msec = -1;
@@ -148,6 +262,41 @@ AZ_INLINE AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result
+_az_http_policy_retry_wait(az_context const* context, int32_t retry_after_msec)
+{
+  int64_t expiration = _az_CONTEXT_MAX_EXPIRATION;
+  if (context != NULL)
+  {
+    expiration = az_context_get_expiration(context);
+    int64_t const now = az_platform_clock_msec();
+
+    // An attempt which would be made after the deadline of the context can only be canceled, so it
+    // isn't waited for.
+    if (az_context_has_expired(context, now) || expiration - now < retry_after_msec)
+    {
+      return AZ_ERROR_CANCELED;
+    }
+  }
+
+  for (int32_t remaining_msec = retry_after_msec; remaining_msec > 0;
+       remaining_msec -= AZ_HTTP_POLICY_RETRY_CANCELLATION_CHECK_INTERVAL_MSEC)
+  {
+    az_platform_sleep_msec(
+        remaining_msec < AZ_HTTP_POLICY_RETRY_CANCELLATION_CHECK_INTERVAL_MSEC
+            ? remaining_msec
+            : AZ_HTTP_POLICY_RETRY_CANCELLATION_CHECK_INTERVAL_MSEC);
+
+    // Only az_context_cancel() moves the expiration of a context, and it moves it to the past.
+    if (context != NULL && az_context_get_expiration(context) < expiration)
+    {
+      return AZ_ERROR_CANCELED;
+    }
+  }
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD az_result az_http_pipeline_policy_retry(
     _az_http_policy* ref_policies,
     void* ref_options,
@@ -166,52 +315,90 @@ AZ_NODISCARD az_result az_http_pipeline_policy_retry(
 
   az_context* const context = ref_request->_internal.context;
 
+  az_http_policy_retry_budget* const budget = retry_options->budget;
+  if (budget != NULL)
+  {
+    (void)_az_http_policy_retry_budget_add(budget, budget->_internal.deposit);
+  }
+
+  // Seeded differently by each request, so that the requests which failed together don't retry at
+  // the same time.
+  uint32_t random_state = (uint32_t)az_platform_clock_nsec() ^ (uint32_t)(uintptr_t)ref_request;
+  int32_t previous_delay_msec = retry_delay_msec;
+
   bool const should_log = _az_LOG_SHOULD_WRITE(AZ_LOG_HTTP_RETRY);
   az_result result = AZ_OK;
   int32_t attempt = 1;
   while (true)
   {
-    _az_RETURN_IF_FAILED(
-        az_http_response_init(ref_response, ref_response->_internal.http_response));
+    _az_http_response_reset(ref_response);
     _az_RETURN_IF_FAILED(_az_http_request_remove_retry_headers(ref_request));
 
     result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
 
-    // Even HTTP 429, or 502 are expected to be AZ_OK, so the failed result is not retriable.
-    if (attempt > max_retries || az_result_failed(result))
+    // Even HTTP 429, or 502 are expected to be AZ_OK, so a failed result is not retriable, unless
+    // the connection of an idempotent request was lost before the response could be received.
+    if (attempt > max_retries
+        || (az_result_failed(result)
+            && (result != AZ_ERROR_HTTP_CONNECTION_INTERRUPTED
+                || !_az_http_policy_retry_is_idempotent(ref_request))))
     {
       return result;
     }
 
     int32_t retry_after_msec = -1;
-    bool should_retry = false;
-    az_http_response response_copy = *ref_response;
-    _az_RETURN_IF_FAILED(_az_http_policy_retry_get_retry_after(
-        &response_copy, status_codes, &should_retry, &retry_after_msec));
+    if (az_result_succeeded(result))
+    {
+      // Leave the parser where it was, while the header index stays with the response.
+      bool should_retry = false;
+      _az_http_response_parser const parser = ref_response->_internal.parser;
+      az_result const retry_after_result = _az_http_policy_retry_get_retry_after(
+          ref_response, status_codes, &should_retry, &retry_after_msec);
+      ref_response->_internal.parser = parser;
+      _az_RETURN_IF_FAILED(retry_after_result);
+
+      if (!should_retry)
+      {
+        return result;
+      }
+    }
+
+    // A streamed body which was already read can only be sent again once rewound, and a body which
+    // was already received can only be received again once the sink discarded it.
+    if (!_az_http_request_can_resend_body(ref_request)
+        || !_az_http_response_can_receive_body_again(ref_response))
+    {
+      return result;
+    }
 
-    if (!should_retry)
+    // Once the budget shared with other requests is spent, the failure is returned as is.
+    if (budget != NULL && !_az_http_policy_retry_budget_add(budget, -_az_RETRY_BUDGET_TOKEN))
     {
       return result;
     }
 
     ++attempt;
+    ++ref_request->_internal.retry_count;
 
     if (retry_after_msec < 0)
     { // there wasn't any kind of "retry-after" response header
-      retry_after_msec = _az_retry_calc_delay(attempt, retry_delay_msec, max_retry_delay_msec);
+      retry_after_msec = _az_retry_calc_decorrelated_delay(
+          previous_delay_msec,
+          retry_delay_msec,
+          max_retry_delay_msec,
+          _az_retry_random(&random_state));
+      previous_delay_msec = retry_after_msec;
     }
 
     if (should_log)
     {
-      _az_http_policy_retry_log(attempt, retry_after_msec);
+      _az_http_policy_retry_log(az_arena_from_context(context), attempt, retry_after_msec);
     }
 
-    az_platform_sleep_msec(retry_after_msec);
+    _az_RETURN_IF_FAILED(_az_http_policy_retry_wait(context, retry_after_msec));
 
-    if (context != NULL && az_context_has_expired(context, az_platform_clock_msec()))
-    {
-      return AZ_ERROR_CANCELED;
-    }
+    _az_RETURN_IF_FAILED(_az_http_request_rewind_body(ref_request));
+    _az_RETURN_IF_FAILED(_az_http_response_reset_body_sink(ref_response));
   }
 
   return result;
@@ -0,0 +1,444 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include <azure/core/az_config.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <azure/core/_az_cfg.h>
+
+// "00-" + 32 hex digits of trace ID + "-" + 16 hex digits of span ID + "-" + 2 hex digits of flags.
+#define _az_TRACEPARENT_SIZE 55
+
+#define _az_TRACING_FLAG_SAMPLED 0x01
+
+uint8_t const az_http_tracing_context_key = 0;
+
+AZ_INLINE uint32_t _az_http_tracing_load(uint32_t volatile* ref_value)
+{
+#if defined(_MSC_VER)
+  return (uint32_t)_InterlockedOr((long volatile*)ref_value, 0);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_load_n(ref_value, __ATOMIC_ACQUIRE);
+#else
+  return *ref_value;
+#endif
+}
+
+AZ_INLINE void _az_http_tracing_store(uint32_t volatile* ref_value, uint32_t value)
+{
+#if defined(_MSC_VER)
+  (void)_InterlockedExchange((long volatile*)ref_value, (long)value);
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_store_n(ref_value, value, __ATOMIC_RELEASE);
+#else
+  *ref_value = value;
+#endif
+}
+
+AZ_INLINE bool
+_az_http_tracing_compare_exchange(uint32_t volatile* ref_value, uint32_t expected, uint32_t desired)
+{
+#if defined(_MSC_VER)
+  return (uint32_t)_InterlockedCompareExchange(
+             (long volatile*)ref_value, (long)desired, (long)expected)
+      == expected;
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_compare_exchange_n(
+      ref_value, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#else
+  // Without atomics, tracing must not be shared by requests sent from different threads.
+  if (*ref_value != expected)
+  {
+    return false;
+  }
+
+  *ref_value = desired;
+  return true;
+#endif
+}
+
+AZ_INLINE uint32_t _az_http_tracing_increment(uint32_t volatile* ref_value)
+{
+#if defined(_MSC_VER)
+  return (uint32_t)_InterlockedIncrement((long volatile*)ref_value);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_add_fetch(ref_value, 1, __ATOMIC_RELAXED);
+#else
+  return ++*ref_value;
+#endif
+}
+
+AZ_NODISCARD az_result az_http_policy_tracing_init(
+    az_http_policy_tracing* out_tracing,
+    az_http_tracing_export_fn export_span,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(out_tracing);
+  _az_PRECONDITION_NOT_NULL(export_span);
+
+  *out_tracing = (az_http_policy_tracing){
+    ._internal = {
+      .export_span = export_span,
+      .user_context = user_context,
+      .id_sequence = 0,
+      .dropped_count = 0,
+      .enqueue_position = 0,
+      .dequeue_position = 0,
+      .slots = { { 0 } },
+    },
+  };
+
+  // The sequence of a free slot is the position it is enqueued at next.
+  for (uint32_t i = 0; i < AZ_HTTP_TRACING_SPAN_BUFFER_SIZE; i++)
+  {
+    out_tracing->_internal.slots[i].sequence = i;
+  }
+
+  return AZ_OK;
+}
+
+// Queues a finished span, or drops it when the buffer is full. This is a bounded multi-producer
+// multi-consumer queue, where each slot tells by its sequence whether it was written or read.
+static void
+_az_http_tracing_enqueue(az_http_policy_tracing* ref_tracing, az_http_tracing_span const* span)
+{
+  uint32_t position = _az_http_tracing_load(&ref_tracing->_internal.enqueue_position);
+  _az_http_tracing_slot* slot = NULL;
+  while (true)
+  {
+    slot = &ref_tracing->_internal.slots[position & (AZ_HTTP_TRACING_SPAN_BUFFER_SIZE - 1)];
+    int32_t const difference
+        = (int32_t)(_az_http_tracing_load(&slot->sequence) - position);
+    if (difference == 0)
+    {
+      if (_az_http_tracing_compare_exchange(
+              &ref_tracing->_internal.enqueue_position, position, position + 1))
+      {
+        break;
+      }
+    }
+    else if (difference < 0)
+    {
+      // The slot still holds the span enqueued a whole buffer ago.
+      (void)_az_http_tracing_increment(&ref_tracing->_internal.dropped_count);
+      return;
+    }
+
+    position = _az_http_tracing_load(&ref_tracing->_internal.enqueue_position);
+  }
+
+  slot->span = *span;
+  _az_http_tracing_store(&slot->sequence, position + 1);
+}
+
+AZ_NODISCARD static bool
+_az_http_tracing_dequeue(az_http_policy_tracing* ref_tracing, az_http_tracing_span* out_span)
+{
+  uint32_t position = _az_http_tracing_load(&ref_tracing->_internal.dequeue_position);
+  _az_http_tracing_slot* slot = NULL;
+  while (true)
+  {
+    slot = &ref_tracing->_internal.slots[position & (AZ_HTTP_TRACING_SPAN_BUFFER_SIZE - 1)];
+    int32_t const difference
+        = (int32_t)(_az_http_tracing_load(&slot->sequence) - (position + 1));
+    if (difference == 0)
+    {
+      if (_az_http_tracing_compare_exchange(
+              &ref_tracing->_internal.dequeue_position, position, position + 1))
+      {
+        break;
+      }
+    }
+    else if (difference < 0)
+    {
+      return false;
+    }
+
+    position = _az_http_tracing_load(&ref_tracing->_internal.dequeue_position);
+  }
+
+  *out_span = slot->span;
+  _az_http_tracing_store(&slot->sequence, position + AZ_HTTP_TRACING_SPAN_BUFFER_SIZE);
+  return true;
+}
+
+int32_t az_http_policy_tracing_flush(az_http_policy_tracing* ref_tracing)
+{
+  _az_PRECONDITION_NOT_NULL(ref_tracing);
+
+  int32_t exported_count = 0;
+  az_http_tracing_span span = { 0 };
+  while (_az_http_tracing_dequeue(ref_tracing, &span))
+  {
+    ref_tracing->_internal.export_span(&span, ref_tracing->_internal.user_context);
+    ++exported_count;
+  }
+
+  return exported_count;
+}
+
+AZ_NODISCARD static bool _az_http_tracing_is_zero(uint8_t const* id, int32_t size)
+{
+  for (int32_t i = 0; i < size; i++)
+  {
+    if (id[i] != 0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+AZ_NODISCARD static int32_t _az_http_tracing_hex_value(uint8_t c)
+{
+  // Lowercase only, as the specification requires.
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+AZ_NODISCARD static bool _az_http_tracing_parse_hex(uint8_t const* hex, uint8_t* out, int32_t size)
+{
+  for (int32_t i = 0; i < size; i++)
+  {
+    int32_t const high = _az_http_tracing_hex_value(hex[2 * i]);
+    int32_t const low = _az_http_tracing_hex_value(hex[2 * i + 1]);
+    if (high < 0 || low < 0)
+    {
+      return false;
+    }
+
+    out[i] = (uint8_t)(high << 4 | low);
+  }
+
+  return true;
+}
+
+static void _az_http_tracing_write_hex(uint8_t const* id, int32_t size, uint8_t* out)
+{
+  static uint8_t const digits[] = "0123456789abcdef";
+  for (int32_t i = 0; i < size; i++)
+  {
+    out[2 * i] = digits[id[i] >> 4];
+    out[2 * i + 1] = digits[id[i] & 0x0F];
+  }
+}
+
+AZ_NODISCARD az_result
+az_http_tracing_context_parse(az_span traceparent, az_http_tracing_context* out_context)
+{
+  _az_PRECONDITION_NOT_NULL(out_context);
+
+  uint8_t const* const value = az_span_ptr(traceparent);
+  if (az_span_size(traceparent) != _az_TRACEPARENT_SIZE || value[0] != '0' || value[1] != '0'
+      || value[2] != '-' || value[35] != '-' || value[52] != '-')
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  az_http_tracing_context context = { 0 };
+  if (!_az_http_tracing_parse_hex(value + 3, context.trace_id, sizeof(context.trace_id))
+      || !_az_http_tracing_parse_hex(value + 36, context.span_id, sizeof(context.span_id))
+      || !_az_http_tracing_parse_hex(value + 53, &context.trace_flags, 1)
+      || _az_http_tracing_is_zero(context.trace_id, sizeof(context.trace_id))
+      || _az_http_tracing_is_zero(context.span_id, sizeof(context.span_id)))
+  {
+    return AZ_ERROR_UNEXPECTED_CHAR;
+  }
+
+  *out_context = context;
+  return AZ_OK;
+}
+
+// Fills an ID with random bytes, which are never all zeros (SplitMix64).
+static void _az_http_tracing_generate_id(
+    az_http_policy_tracing* ref_tracing,
+    void const* salt,
+    uint8_t* out_id,
+    int32_t size)
+{
+  uint64_t state = (uint64_t)az_platform_clock_nsec() ^ (uint64_t)(uintptr_t)salt
+      ^ ((uint64_t)_az_http_tracing_increment(&ref_tracing->_internal.id_sequence) << 32);
+  do
+  {
+    for (int32_t i = 0; i < size; i += 8)
+    {
+      state += 0x9E3779B97F4A7C15ULL;
+      uint64_t bits = state;
+      bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+      bits ^= bits >> 31;
+      for (int32_t j = 0; j < 8 && i + j < size; j++)
+      {
+        out_id[i + j] = (uint8_t)(bits >> (8 * j));
+      }
+    }
+  } while (_az_http_tracing_is_zero(out_id, size));
+}
+
+// Starts a span which is a child of the trace context of the request, or of a new trace.
+static void _az_http_tracing_start_span(
+    az_http_policy_tracing* ref_tracing,
+    az_http_request const* request,
+    int32_t attempt,
+    az_http_tracing_span* out_span)
+{
+  *out_span = (az_http_tracing_span){ .attempt = attempt };
+
+  void const* value = NULL;
+  if (request->_internal.context != NULL
+      && az_result_succeeded(
+          az_context_get_value(request->_internal.context, &az_http_tracing_context_key, &value)))
+  {
+    az_http_tracing_context const* const parent = (az_http_tracing_context const*)value;
+    for (int32_t i = 0; i < (int32_t)sizeof(out_span->trace_id); i++)
+    {
+      out_span->trace_id[i] = parent->trace_id[i];
+    }
+
+    for (int32_t i = 0; i < (int32_t)sizeof(out_span->parent_span_id); i++)
+    {
+      out_span->parent_span_id[i] = parent->span_id[i];
+    }
+
+    out_span->trace_flags = parent->trace_flags;
+  }
+  else
+  {
+    _az_http_tracing_generate_id(
+        ref_tracing, request, out_span->trace_id, sizeof(out_span->trace_id));
+    out_span->trace_flags = _az_TRACING_FLAG_SAMPLED;
+  }
+
+  _az_http_tracing_generate_id(ref_tracing, out_span, out_span->span_id, sizeof(out_span->span_id));
+  out_span->start_nsec = az_platform_clock_nsec();
+}
+
+static void _az_http_tracing_end_span(
+    az_http_policy_tracing* ref_tracing,
+    az_http_tracing_span* ref_span,
+    az_result result,
+    az_http_response* ref_response)
+{
+  ref_span->end_nsec = az_platform_clock_nsec();
+  ref_span->result = result;
+
+  if ((ref_span->trace_flags & _az_TRACING_FLAG_SAMPLED) == 0)
+  {
+    return;
+  }
+
+  if (az_result_succeeded(result))
+  {
+    // Leave the parser where it was, for the policies which read the response next.
+    _az_http_response_parser const parser = ref_response->_internal.parser;
+    az_http_response_status_line status_line = { 0 };
+    if (az_result_succeeded(az_http_response_get_status_line(ref_response, &status_line)))
+    {
+      ref_span->status_code = status_line.status_code;
+    }
+
+    ref_response->_internal.parser = parser;
+  }
+
+  _az_http_tracing_enqueue(ref_tracing, ref_span);
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_tracing(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_tracing* const tracing = (az_http_policy_tracing*)ref_options;
+  if (tracing == NULL)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  az_http_tracing_span span = { 0 };
+  _az_http_tracing_start_span(tracing, ref_request, 0, &span);
+
+  // The spans of the attempts are children of the span of the request, through the context.
+  az_http_tracing_context span_context = { .trace_flags = span.trace_flags };
+  for (int32_t i = 0; i < (int32_t)sizeof(span_context.trace_id); i++)
+  {
+    span_context.trace_id[i] = span.trace_id[i];
+  }
+
+  for (int32_t i = 0; i < (int32_t)sizeof(span_context.span_id); i++)
+  {
+    span_context.span_id[i] = span.span_id[i];
+  }
+
+  az_context* const context = ref_request->_internal.context;
+  az_context span_scope = az_context_create_with_value(
+      context != NULL ? context : &az_context_application,
+      &az_http_tracing_context_key,
+      &span_context);
+
+  ref_request->_internal.context = &span_scope;
+  az_result const result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  ref_request->_internal.context = context;
+
+  _az_http_tracing_end_span(tracing, &span, result, ref_response);
+  return result;
+}
+
+AZ_NODISCARD az_result az_http_pipeline_policy_tracing_attempt(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  az_http_policy_tracing* const tracing = (az_http_policy_tracing*)ref_options;
+  if (tracing == NULL)
+  {
+    return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  }
+
+  az_http_tracing_span span = { 0 };
+  _az_http_tracing_start_span(tracing, ref_request, ref_request->_internal.retry_count + 1, &span);
+
+  uint8_t traceparent[_az_TRACEPARENT_SIZE] = { '0', '0', '-' };
+  _az_http_tracing_write_hex(span.trace_id, sizeof(span.trace_id), traceparent + 3);
+  traceparent[35] = '-';
+  _az_http_tracing_write_hex(span.span_id, sizeof(span.span_id), traceparent + 36);
+  traceparent[52] = '-';
+  _az_http_tracing_write_hex(&span.trace_flags, 1, traceparent + 53);
+
+  // The header refers to the buffer on the stack, so it is removed once the attempt completes.
+  // Tracing never fails a request: without room left for the header, the attempt is sent without
+  // it, and its span is still recorded.
+  int32_t const headers_length = ref_request->_internal.headers_length;
+  az_result const header_result = az_http_request_append_header(
+      ref_request, AZ_SPAN_FROM_STR("traceparent"), AZ_SPAN_FROM_BUFFER(traceparent));
+
+  az_result const result = _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+  if (az_result_succeeded(header_result))
+  {
+    _az_http_request_remove_headers_from(ref_request, headers_length);
+  }
+
+  _az_http_tracing_end_span(tracing, &span, result, ref_response);
+  return result;
+}
@@ -11,6 +11,7 @@
 #include <azure/core/internal/az_precondition_internal.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <azure/core/_az_cfg_prefix.h>
 
@@ -33,20 +34,164 @@ _az_http_request_mark_retry_headers_start(az_http_request* ref_request)
   return AZ_OK;
 }
 
+/**
+ * @brief Removes the headers added after the first \p headers_length headers of the request.
+ *
+ * @param ref_request HTTP request.
+ * @param headers_length The number of headers to keep.
+ */
+AZ_INLINE void
+_az_http_request_remove_headers_from(az_http_request* ref_request, int32_t headers_length)
+{
+  ref_request->_internal.headers_length = headers_length;
+
+  // Forget the well-known headers which were removed.
+  for (int32_t id = AZ_HTTP_HEADER_ID_NONE + 1; id < _az_HTTP_HEADER_ID_COUNT; ++id)
+  {
+    if (ref_request->_internal.well_known_headers[id] > headers_length)
+    {
+      ref_request->_internal.well_known_headers[id] = 0;
+    }
+  }
+}
+
 AZ_NODISCARD AZ_INLINE az_result _az_http_request_remove_retry_headers(az_http_request* ref_request)
 {
   _az_PRECONDITION_NOT_NULL(ref_request);
-  ref_request->_internal.headers_length = ref_request->_internal.retry_headers_start_byte_offset
-      / (int32_t)sizeof(_az_http_request_header);
+  _az_http_request_remove_headers_from(
+      ref_request,
+      ref_request->_internal.retry_headers_start_byte_offset
+          / (int32_t)sizeof(_az_http_request_header));
+
   return AZ_OK;
 }
 
 /**
- * @brief Sets buffer and parser to its initial state.
+ * @brief Tells whether the body of the request can be sent again, which is the case unless it is
+ * streamed from an #az_http_request_body_provider that can't be rewound.
+ *
+ * @param request HTTP request.
+ */
+AZ_NODISCARD AZ_INLINE bool _az_http_request_can_resend_body(az_http_request const* request)
+{
+  az_http_request_body_provider const* const body_provider = request->_internal.body_provider;
+  return body_provider == NULL || body_provider->rewind != NULL;
+}
+
+/**
+ * @brief Moves the #az_http_request_body_provider of the request, if any, back to the start of the
+ * body before the request is sent again.
+ *
+ * @param ref_request HTTP request, whose body can be sent again (see
+ * #_az_http_request_can_resend_body()).
+ *
+ * @return
+ *   - *`AZ_OK`* success.
+ *   - Any failure from the rewind callback of the body provider.
+ */
+AZ_NODISCARD AZ_INLINE az_result _az_http_request_rewind_body(az_http_request* ref_request)
+{
+  _az_PRECONDITION_NOT_NULL(ref_request);
+  az_http_request_body_provider const* const body_provider = ref_request->_internal.body_provider;
+  if (body_provider == NULL)
+  {
+    return AZ_OK;
+  }
+
+  _az_PRECONDITION_NOT_NULL(body_provider->rewind);
+  return body_provider->rewind(body_provider->user_context);
+}
+
+/**
+ * @brief Sets buffer and parser to its initial state. The body sink of the response is kept.
  *
  */
 void _az_http_response_reset(az_http_response* ref_response);
 
+/**
+ * @brief Tells whether the response can be received again, which is the case unless part of its
+ * body went to an #az_http_response_body_sink that can't be reset.
+ *
+ * @param response HTTP response.
+ */
+AZ_NODISCARD AZ_INLINE bool
+_az_http_response_can_receive_body_again(az_http_response const* response)
+{
+  az_http_response_body_sink const* const body_sink = response->_internal.body_sink;
+  return !response->_internal.is_body_streamed || body_sink->reset != NULL;
+}
+
+/**
+ * @brief Discards the body an #az_http_response_body_sink received, if any, before the request is
+ * sent again.
+ *
+ * @param ref_response HTTP response, which can be received again (see
+ * #_az_http_response_can_receive_body_again()).
+ *
+ * @return
+ *   - *`AZ_OK`* success.
+ *   - Any failure from the reset callback of the body sink.
+ */
+AZ_NODISCARD AZ_INLINE az_result _az_http_response_reset_body_sink(az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  az_http_response_body_sink const* const body_sink = ref_response->_internal.body_sink;
+  if (!ref_response->_internal.is_body_streamed)
+  {
+    return AZ_OK;
+  }
+
+  _az_PRECONDITION_NOT_NULL(body_sink->reset);
+  return body_sink->reset(body_sink->user_context);
+}
+
+/**
+ * @brief Adds tokens to an #az_http_policy_retry_budget, up to its capacity, or takes them out of
+ * it when there are enough.
+ *
+ * @return `false` when there weren't enough tokens to take out, and the budget is unchanged.
+ */
+bool _az_http_policy_retry_budget_add(az_http_policy_retry_budget* ref_budget, int32_t tokens);
+
+/// The tokens of an #az_http_policy_retry_budget a retry takes, in hundredths of a token.
+#define _az_RETRY_BUDGET_TOKEN 100
+
+/**
+ * @brief Gets how long the response asks to wait before the next request, when its status code is
+ * one of \p status_codes.
+ *
+ * @param[out] should_retry Whether the status code is one of \p status_codes.
+ * @param[out] retry_after_msec The delay in milliseconds, or -1 when the response doesn't tell.
+ */
+AZ_NODISCARD az_result _az_http_policy_retry_get_retry_after(
+    az_http_response* ref_response,
+    az_http_status_code const* status_codes,
+    bool* should_retry,
+    int32_t* retry_after_msec);
+
+/**
+ * @brief Takes the spin lock guarding the state shared by the requests of a policy, such as a rate
+ * limiter or a circuit breaker.
+ *
+ * @details The lock must only be held for a few instructions, and never while a request is sent or
+ * waits. \p ref_lock is 0 while the lock is free.
+ */
+void _az_http_policy_lock(int32_t volatile* ref_lock);
+
+/**
+ * @brief Releases a spin lock taken with #_az_http_policy_lock().
+ */
+void _az_http_policy_unlock(int32_t volatile* ref_lock);
+
+/**
+ * @brief Waits for \p retry_after_msec, in short sleeps so that a canceled \p context is noticed
+ * early.
+ *
+ * @retval #AZ_ERROR_CANCELED The context was canceled, or expires before the end of the delay.
+ */
+AZ_NODISCARD az_result
+_az_http_policy_retry_wait(az_context const* context, int32_t retry_after_msec);
+
 #include <azure/core/_az_cfg_suffix.h>
 
 #endif // _az_HTTP_PRIVATE_H
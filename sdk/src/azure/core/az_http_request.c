@@ -57,7 +57,10 @@ AZ_NODISCARD az_result az_http_request_init(
                                .max_headers = az_span_size(headers_buffer)
                                    / (int32_t)sizeof(_az_http_request_header),
                                .retry_headers_start_byte_offset = 0,
+                               .well_known_headers = { 0 },
                                .body = body,
+                               .body_provider = NULL,
+                               .retry_count = 0,
                            } };
 
   return AZ_OK;
@@ -118,6 +121,60 @@ AZ_NODISCARD az_result az_http_request_set_query_parameter(
   return AZ_OK;
 }
 
+// The interned names of the well-known headers, in the order of az_http_header_id.
+static az_span const _az_http_header_names[_az_HTTP_HEADER_ID_COUNT] = {
+  AZ_SPAN_LITERAL_FROM_STR(""),
+  AZ_SPAN_LITERAL_FROM_STR("Authorization"),
+  AZ_SPAN_LITERAL_FROM_STR("Content-Length"),
+  AZ_SPAN_LITERAL_FROM_STR("Content-Type"),
+  AZ_SPAN_LITERAL_FROM_STR("User-Agent"),
+  AZ_SPAN_LITERAL_FROM_STR("x-ms-client-request-id"),
+  AZ_SPAN_LITERAL_FROM_STR("x-ms-version"),
+};
+
+static AZ_NODISCARD az_http_header_id _az_http_header_id_from_name(az_span name)
+{
+  int32_t const name_size = az_span_size(name);
+  for (int32_t id = AZ_HTTP_HEADER_ID_NONE + 1; id < _az_HTTP_HEADER_ID_COUNT; ++id)
+  {
+    // Most names are told apart by their size, before their content is compared.
+    if (az_span_size(_az_http_header_names[id]) == name_size
+        && az_span_is_content_equal_ignoring_case(_az_http_header_names[id], name))
+    {
+      return (az_http_header_id)id;
+    }
+  }
+
+  return AZ_HTTP_HEADER_ID_NONE;
+}
+
+static AZ_NODISCARD az_result _az_http_request_add_header(
+    az_http_request* ref_request,
+    az_http_header_id id,
+    az_span name,
+    az_span value)
+{
+  if (ref_request->_internal.headers_length >= ref_request->_internal.max_headers)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  _az_http_request_header* const headers
+      = (_az_http_request_header*)az_span_ptr(ref_request->_internal.headers);
+  headers[ref_request->_internal.headers_length]
+      = (_az_http_request_header){ .name = name, .value = value };
+
+  ref_request->_internal.headers_length++;
+
+  // Only the first header with a given name is replaced by az_http_request_set_header().
+  if (id != AZ_HTTP_HEADER_ID_NONE && ref_request->_internal.well_known_headers[id] == 0)
+  {
+    ref_request->_internal.well_known_headers[id] = ref_request->_internal.headers_length;
+  }
+
+  return AZ_OK;
+}
+
 AZ_NODISCARD az_result
 az_http_request_append_header(az_http_request* ref_request, az_span name, az_span value)
 {
@@ -132,20 +189,27 @@ az_http_request_append_header(az_http_request* ref_request, az_span name, az_spa
   // Make this function to only work with valid input for header name
   _az_PRECONDITION(az_http_is_valid_header_name(name));
 
-  az_span headers = ref_request->_internal.headers;
-  _az_http_request_header header_to_append = { .name = name, .value = value };
+  return _az_http_request_add_header(
+      ref_request, _az_http_header_id_from_name(name), name, value);
+}
 
-  _az_RETURN_IF_NOT_ENOUGH_SIZE(headers, (int32_t)sizeof header_to_append);
+AZ_NODISCARD az_result
+az_http_request_set_header(az_http_request* ref_request, az_http_header_id id, az_span value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_request);
+  _az_PRECONDITION_RANGE(AZ_HTTP_HEADER_ID_NONE + 1, id, _az_HTTP_HEADER_ID_COUNT - 1);
 
-  az_span_copy(
-      az_span_slice_to_end(
-          headers,
-          (int32_t)sizeof(_az_http_request_header) * ref_request->_internal.headers_length),
-      az_span_create((uint8_t*)&header_to_append, sizeof header_to_append));
+  value = _az_span_trim_whitespace(value);
 
-  ref_request->_internal.headers_length++;
+  int32_t const position = ref_request->_internal.well_known_headers[id];
+  if (position > 0)
+  {
+    ((_az_http_request_header*)az_span_ptr(ref_request->_internal.headers))[position - 1].value
+        = value;
+    return AZ_OK;
+  }
 
-  return AZ_OK;
+  return _az_http_request_add_header(ref_request, id, _az_http_header_names[id], value);
 }
 
 AZ_NODISCARD az_result az_http_request_get_header(
@@ -172,6 +236,27 @@ AZ_NODISCARD az_result az_http_request_get_header(
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_http_request_get_header_by_id(
+    az_http_request const* request,
+    az_http_header_id id,
+    az_span* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(request);
+  _az_PRECONDITION_RANGE(AZ_HTTP_HEADER_ID_NONE + 1, id, _az_HTTP_HEADER_ID_COUNT - 1);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  int32_t const position = request->_internal.well_known_headers[id];
+  if (position == 0)
+  {
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  _az_http_request_header const* const headers
+      = (_az_http_request_header const*)az_span_ptr(request->_internal.headers);
+  *out_value = headers[position - 1].value;
+  return AZ_OK;
+}
+
 AZ_NODISCARD az_result
 az_http_request_get_method(az_http_request const* request, az_http_method* out_method)
 {
@@ -202,6 +287,32 @@ AZ_NODISCARD az_result az_http_request_get_body(az_http_request const* request,
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_http_request_set_body_provider(
+    az_http_request* ref_request,
+    az_http_request_body_provider const* body_provider)
+{
+  _az_PRECONDITION_NOT_NULL(ref_request);
+  if (body_provider != NULL)
+  {
+    _az_PRECONDITION_NOT_NULL(body_provider->read);
+    _az_PRECONDITION(body_provider->length >= -1);
+  }
+
+  ref_request->_internal.body_provider = body_provider;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_request_get_body_provider(
+    az_http_request const* request,
+    az_http_request_body_provider const** out_body_provider)
+{
+  _az_PRECONDITION_NOT_NULL(request);
+  _az_PRECONDITION_NOT_NULL(out_body_provider);
+
+  *out_body_provider = request->_internal.body_provider;
+  return AZ_OK;
+}
+
 AZ_NODISCARD int32_t az_http_request_headers_count(az_http_request const* request)
 {
   return request->_internal.headers_length;
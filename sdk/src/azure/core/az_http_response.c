@@ -56,6 +56,7 @@ _az_get_http_status_line(az_span* ref_span, az_http_response_status_line* out_st
 
   // HTTP-version = HTTP-name "/" DIGIT "." DIGIT
   // https://tools.ietf.org/html/rfc7230#section-2.6
+  // HTTP/2 responses are written by the HTTP stacks as "HTTP/2", with no minor version.
   az_span const start = AZ_SPAN_FROM_STR("HTTP/");
   az_span const dot = AZ_SPAN_FROM_STR(".");
   az_span const space = AZ_SPAN_FROM_STR(" ");
@@ -63,8 +64,12 @@ _az_get_http_status_line(az_span* ref_span, az_http_response_status_line* out_st
   // parse and move reader if success
   _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, start));
   _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->major_version));
-  _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, dot));
-  _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->minor_version));
+  out_status_line->minor_version = 0;
+  if (az_span_size(*ref_span) > 0 && az_span_ptr(*ref_span)[0] == '.')
+  {
+    _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, dot));
+    _az_RETURN_IF_FAILED(_az_get_digit(ref_span, &out_status_line->minor_version));
+  }
 
   // SP = " "
   _az_RETURN_IF_FAILED(_az_is_expected_span(ref_span, space));
@@ -120,6 +125,7 @@ AZ_NODISCARD az_result az_http_response_get_status_line(
 
   // Restart parser to the beginning
   ref_response->_internal.parser.remaining = ref_response->_internal.http_response;
+  ref_response->_internal.parser.next_header = 0;
 
   // read an HTTP status line.
   _az_RETURN_IF_FAILED(
@@ -131,39 +137,16 @@ AZ_NODISCARD az_result az_http_response_get_status_line(
   return AZ_OK;
 }
 
-AZ_NODISCARD az_result az_http_response_get_next_header(
-    az_http_response* ref_response,
-    az_span* out_name,
-    az_span* out_value)
+// Parses the header at the start of reader, and moves reader to the next one. Returns
+// AZ_ERROR_HTTP_END_OF_HEADERS, after moving reader to the body, when there are no more headers.
+static AZ_NODISCARD az_result
+_az_http_response_parse_header(az_span* reader, az_span* out_name, az_span* out_value)
 {
-  _az_PRECONDITION_NOT_NULL(ref_response);
-  _az_PRECONDITION_NOT_NULL(out_name);
-  _az_PRECONDITION_NOT_NULL(out_value);
-
-  az_span* reader = &ref_response->_internal.parser.remaining;
-  {
-    _az_http_response_kind const kind = ref_response->_internal.parser.next_kind;
-    // if reader is expecting to read body (all headers were read), return
-    // AZ_ERROR_HTTP_END_OF_HEADERS so we know we reach end of headers
-    if (kind == _az_HTTP_RESPONSE_KIND_BODY)
-    {
-      return AZ_ERROR_HTTP_END_OF_HEADERS;
-    }
-    // Can't read a header if status line was not previously called,
-    // User needs to call az_http_response_status_line() which would reset parser and set kind to
-    // headers
-    if (kind != _az_HTTP_RESPONSE_KIND_HEADER)
-    {
-      return AZ_ERROR_HTTP_INVALID_STATE;
-    }
-  }
-
   // check if we are at the end of all headers to change state to Body.
   // We keep state to Headers if current char is not '\r' (there is another header)
-  if (az_span_ptr(ref_response->_internal.parser.remaining)[0] == '\r')
+  if (az_span_ptr(*reader)[0] == '\r')
   {
     _az_RETURN_IF_FAILED(_az_is_expected_span(reader, AZ_SPAN_FROM_STR("\r\n")));
-    ref_response->_internal.parser.next_kind = _az_HTTP_RESPONSE_KIND_BODY;
     return AZ_ERROR_HTTP_END_OF_HEADERS;
   }
 
@@ -268,6 +251,213 @@ AZ_NODISCARD az_result az_http_response_get_next_header(
   return AZ_OK;
 }
 
+
+// Case-insensitive FNV-1a hash of a header name.
+static AZ_NODISCARD uint32_t _az_http_response_hash_header_name(az_span name)
+{
+  uint32_t hash = 2166136261U;
+  uint8_t const* const ptr = az_span_ptr(name);
+  int32_t const size = az_span_size(name);
+  for (int32_t i = 0; i < size; ++i)
+  {
+    hash = (hash ^ (uint32_t)tolower(ptr[i])) * 16777619U;
+  }
+
+  return hash;
+}
+
+// The offset of part from the start of the http_response it was sliced from.
+static AZ_NODISCARD int32_t _az_http_response_offset_of(az_span part, az_span http_response)
+{
+  return (int32_t)(az_span_ptr(part) - az_span_ptr(http_response));
+}
+
+static void _az_http_response_build_header_index(az_http_response* ref_response)
+{
+  az_span const http_response = ref_response->_internal.http_response;
+  az_span reader = http_response;
+  az_http_response_status_line status_line = { 0 };
+
+  ref_response->_internal.header_index.state = _az_HTTP_RESPONSE_HEADER_INDEX_UNAVAILABLE;
+  if (az_result_failed(_az_get_http_status_line(&reader, &status_line)))
+  {
+    return;
+  }
+
+  _az_http_response_header_index_entry* const entries
+      = ref_response->_internal.header_index.entries;
+  int32_t count = 0;
+  while (true)
+  {
+    int32_t const line_offset = _az_http_response_offset_of(reader, http_response);
+    az_span name = { 0 };
+    az_span value = { 0 };
+    az_result const result = _az_http_response_parse_header(&reader, &name, &value);
+    if (result == AZ_ERROR_HTTP_END_OF_HEADERS)
+    {
+      ref_response->_internal.header_index.headers_end = line_offset;
+      break;
+    }
+
+    if (az_result_failed(result) || count == AZ_HTTP_RESPONSE_HEADER_INDEX_SIZE)
+    {
+      return;
+    }
+
+    entries[count] = (_az_http_response_header_index_entry){
+      .name_hash = _az_http_response_hash_header_name(name),
+      .line_offset = line_offset,
+      .name_offset = _az_http_response_offset_of(name, http_response),
+      .name_size = az_span_size(name),
+      .value_offset = _az_http_response_offset_of(value, http_response),
+      .value_size = az_span_size(value),
+    };
+    ++count;
+  }
+
+  ref_response->_internal.header_index.count = count;
+  ref_response->_internal.header_index.state = _az_HTTP_RESPONSE_HEADER_INDEX_BUILT;
+}
+
+// Whether the headers are indexed, building the index if it wasn't yet.
+static AZ_NODISCARD bool _az_http_response_has_header_index(az_http_response* ref_response)
+{
+  if (ref_response->_internal.header_index.state == _az_HTTP_RESPONSE_HEADER_INDEX_NOT_BUILT)
+  {
+    _az_http_response_build_header_index(ref_response);
+  }
+
+  return ref_response->_internal.header_index.state == _az_HTTP_RESPONSE_HEADER_INDEX_BUILT;
+}
+
+AZ_NODISCARD az_result az_http_response_get_next_header(
+    az_http_response* ref_response,
+    az_span* out_name,
+    az_span* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  _az_PRECONDITION_NOT_NULL(out_name);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  _az_http_response_parser* const parser = &ref_response->_internal.parser;
+  {
+    _az_http_response_kind const kind = parser->next_kind;
+    // if reader is expecting to read body (all headers were read), return
+    // AZ_ERROR_HTTP_END_OF_HEADERS so we know we reach end of headers
+    if (kind == _az_HTTP_RESPONSE_KIND_BODY)
+    {
+      return AZ_ERROR_HTTP_END_OF_HEADERS;
+    }
+    // Can't read a header if status line was not previously called,
+    // User needs to call az_http_response_status_line() which would reset parser and set kind to
+    // headers
+    if (kind != _az_HTTP_RESPONSE_KIND_HEADER)
+    {
+      return AZ_ERROR_HTTP_INVALID_STATE;
+    }
+  }
+
+  if (!_az_http_response_has_header_index(ref_response))
+  {
+    az_result const result
+        = _az_http_response_parse_header(&parser->remaining, out_name, out_value);
+    if (result == AZ_ERROR_HTTP_END_OF_HEADERS)
+    {
+      parser->next_kind = _az_HTTP_RESPONSE_KIND_BODY;
+    }
+    else if (az_result_succeeded(result))
+    {
+      ++parser->next_header;
+    }
+
+    return result;
+  }
+
+  // Return the next header from the index, keeping the parser where parsing it would have left it.
+  az_span const http_response = ref_response->_internal.http_response;
+  int32_t const count = ref_response->_internal.header_index.count;
+  if (parser->next_header >= count)
+  {
+    parser->remaining = az_span_slice_to_end(
+        http_response,
+        ref_response->_internal.header_index.headers_end + (int32_t)sizeof("\r\n") - 1);
+    parser->next_kind = _az_HTTP_RESPONSE_KIND_BODY;
+    return AZ_ERROR_HTTP_END_OF_HEADERS;
+  }
+
+  _az_http_response_header_index_entry const* const entry
+      = &ref_response->_internal.header_index.entries[parser->next_header];
+  *out_name = az_span_slice(
+      http_response, entry->name_offset, entry->name_offset + entry->name_size);
+  *out_value = az_span_slice(
+      http_response, entry->value_offset, entry->value_offset + entry->value_size);
+
+  ++parser->next_header;
+  parser->remaining = az_span_slice_to_end(
+      http_response,
+      parser->next_header < count
+          ? ref_response->_internal.header_index.entries[parser->next_header].line_offset
+          : ref_response->_internal.header_index.headers_end);
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result
+az_http_response_get_header(az_http_response* ref_response, az_span name, az_span* out_value)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  _az_PRECONDITION_VALID_SPAN(name, 1, false);
+  _az_PRECONDITION_NOT_NULL(out_value);
+
+  az_span const http_response = ref_response->_internal.http_response;
+  if (_az_http_response_has_header_index(ref_response))
+  {
+    uint32_t const name_hash = _az_http_response_hash_header_name(name);
+    _az_http_response_header_index_entry const* const entries
+        = ref_response->_internal.header_index.entries;
+    int32_t const count = ref_response->_internal.header_index.count;
+    for (int32_t i = 0; i < count; ++i)
+    {
+      if (entries[i].name_hash == name_hash
+          && az_span_is_content_equal_ignoring_case(
+              az_span_slice(
+                  http_response,
+                  entries[i].name_offset,
+                  entries[i].name_offset + entries[i].name_size),
+              name))
+      {
+        *out_value = az_span_slice(
+            http_response,
+            entries[i].value_offset,
+            entries[i].value_offset + entries[i].value_size);
+        return AZ_OK;
+      }
+    }
+
+    return AZ_ERROR_ITEM_NOT_FOUND;
+  }
+
+  // The headers didn't fit in the index, or are corrupt, so parse them without moving the parser.
+  az_span reader = http_response;
+  az_http_response_status_line status_line = { 0 };
+  _az_RETURN_IF_FAILED(_az_get_http_status_line(&reader, &status_line));
+
+  az_span header_name = { 0 };
+  az_span header_value = { 0 };
+  az_result result = AZ_OK;
+  while (az_result_succeeded(
+      result = _az_http_response_parse_header(&reader, &header_name, &header_value)))
+  {
+    if (az_span_is_content_equal_ignoring_case(header_name, name))
+    {
+      *out_value = header_value;
+      return AZ_OK;
+    }
+  }
+
+  return result == AZ_ERROR_HTTP_END_OF_HEADERS ? AZ_ERROR_ITEM_NOT_FOUND : result;
+}
+
 AZ_NODISCARD az_result az_http_response_get_body(az_http_response* ref_response, az_span* out_body)
 {
   _az_PRECONDITION_NOT_NULL(ref_response);
@@ -299,8 +489,10 @@ AZ_NODISCARD az_result az_http_response_get_body(az_http_response* ref_response,
     }
   }
 
-  // take all the remaining content from reader as body
-  *out_body = az_span_slice_to_end(ref_response->_internal.parser.remaining, 0);
+  // take all the remaining content from reader as body, unless the body went to the sink
+  *out_body = ref_response->_internal.is_body_streamed
+      ? AZ_SPAN_EMPTY
+      : az_span_slice_to_end(ref_response->_internal.parser.remaining, 0);
 
   ref_response->_internal.parser.next_kind = _az_HTTP_RESPONSE_KIND_EOF;
   return AZ_OK;
@@ -310,9 +502,32 @@ void _az_http_response_reset(az_http_response* ref_response)
 {
   // never fails, discard the result
   // init will set written to 0 and will use the same az_span. Internal parser's state is also
-  // reset
+  // reset. The body sink and the codec are kept, for the body of the next response.
+  az_http_response_body_sink const* const body_sink = ref_response->_internal.body_sink;
+  az_http_content_codec const* const codec = ref_response->_internal.body_decoding.codec;
+  if (ref_response->_internal.body_decoding.state == _az_HTTP_RESPONSE_BODY_DECODING_STARTED)
+  {
+    codec->end(codec->user_context);
+  }
+
   az_result result = az_http_response_init(ref_response, ref_response->_internal.http_response);
   (void)result;
+  ref_response->_internal.body_sink = body_sink;
+  ref_response->_internal.body_decoding.codec = codec;
+}
+
+AZ_NODISCARD az_result az_http_response_set_body_sink(
+    az_http_response* ref_response,
+    az_http_response_body_sink const* body_sink)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  if (body_sink != NULL)
+  {
+    _az_PRECONDITION_NOT_NULL(body_sink->write);
+  }
+
+  ref_response->_internal.body_sink = body_sink;
+  return AZ_OK;
 }
 
 // internal function to get az_http_response remainder
@@ -329,8 +544,158 @@ AZ_NODISCARD az_result az_http_response_append(az_http_response* ref_response, a
   int32_t write_size = az_span_size(source);
   _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining, write_size);
 
+  // Once the headers indexed were all written, what is appended is the body, which leaves the
+  // index as is.
+  if (ref_response->_internal.header_index.state != _az_HTTP_RESPONSE_HEADER_INDEX_BUILT
+      || ref_response->_internal.header_index.headers_end + (int32_t)sizeof("\r\n") - 1
+          > ref_response->_internal.written)
+  {
+    ref_response->_internal.header_index.state = _az_HTTP_RESPONSE_HEADER_INDEX_NOT_BUILT;
+  }
+
   az_span_copy(remaining, source);
   ref_response->_internal.written += write_size;
 
   return AZ_OK;
 }
+
+// Whether the status line written so far is a successful (2xx) one, whose body goes to the sink.
+static AZ_NODISCARD bool
+_az_http_response_is_written_status_success(az_http_response const* response)
+{
+  // The status line parser reads up to the reason phrase without checking the size.
+  int32_t const min_status_line_size = (int32_t)sizeof("HTTP/1.1 200 ") - 1;
+  if (response->_internal.written < min_status_line_size)
+  {
+    return false;
+  }
+
+  az_span written
+      = az_span_slice(response->_internal.http_response, 0, response->_internal.written);
+  az_http_response_status_line status_line = { 0 };
+  if (az_result_failed(_az_get_http_status_line(&written, &status_line)))
+  {
+    return false;
+  }
+
+  return status_line.status_code >= AZ_HTTP_STATUS_CODE_OK
+      && status_line.status_code < AZ_HTTP_STATUS_CODE_MULTIPLE_CHOICES;
+}
+
+// Writes the body, as it is once decompressed, into the sink or the http_response buffer.
+static AZ_NODISCARD az_result
+_az_http_response_write_body(az_http_response* ref_response, az_span source)
+{
+  az_http_response_body_sink const* const body_sink = ref_response->_internal.body_sink;
+  if (body_sink != NULL
+      && (ref_response->_internal.is_body_streamed
+          || _az_http_response_is_written_status_success(ref_response)))
+  {
+    ref_response->_internal.is_body_streamed = true;
+    return az_span_size(source) == 0 ? AZ_OK
+                                     : body_sink->write(body_sink->user_context, source);
+  }
+
+  return az_http_response_append(ref_response, source);
+}
+
+// Finds out, from the Content-Encoding header, whether the body which starts being received has to
+// be decompressed.
+static AZ_NODISCARD az_result _az_http_response_begin_body_decoding(az_http_response* ref_response)
+{
+  ref_response->_internal.body_decoding.state = _az_HTTP_RESPONSE_BODY_DECODING_IDENTITY;
+
+  az_span content_encoding = { 0 };
+  if (az_result_failed(az_http_response_get_header(
+          ref_response, AZ_SPAN_FROM_STR("Content-Encoding"), &content_encoding)))
+  {
+    return AZ_OK;
+  }
+
+  az_http_content_coding coding = AZ_HTTP_CONTENT_CODING_IDENTITY;
+  if (az_span_is_content_equal_ignoring_case(content_encoding, AZ_SPAN_FROM_STR("gzip"))
+      || az_span_is_content_equal_ignoring_case(content_encoding, AZ_SPAN_FROM_STR("x-gzip")))
+  {
+    coding = AZ_HTTP_CONTENT_CODING_GZIP;
+  }
+  else if (az_span_is_content_equal_ignoring_case(content_encoding, AZ_SPAN_FROM_STR("deflate")))
+  {
+    coding = AZ_HTTP_CONTENT_CODING_DEFLATE;
+  }
+  else
+  {
+    // Codings which weren't asked for, such as "identity", are left as they are.
+    return AZ_OK;
+  }
+
+  az_http_content_codec const* const codec = ref_response->_internal.body_decoding.codec;
+  _az_RETURN_IF_FAILED(codec->begin(codec->user_context, coding, false));
+  ref_response->_internal.body_decoding.state = _az_HTTP_RESPONSE_BODY_DECODING_STARTED;
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result
+_az_http_response_decode_body(az_http_response* ref_response, az_span source)
+{
+  az_http_content_codec const* const codec = ref_response->_internal.body_decoding.codec;
+  uint8_t decoded[AZ_HTTP_RESPONSE_DECODING_BUFFER_SIZE];
+  while (ref_response->_internal.body_decoding.state == _az_HTTP_RESPONSE_BODY_DECODING_STARTED)
+  {
+    int32_t source_used = 0;
+    int32_t decoded_size = 0;
+    bool is_end = false;
+    _az_RETURN_IF_FAILED(codec->process(
+        codec->user_context,
+        source,
+        AZ_SPAN_FROM_BUFFER(decoded),
+        false,
+        &source_used,
+        &decoded_size,
+        &is_end));
+
+    source = az_span_slice_to_end(source, source_used);
+    if (is_end)
+    {
+      codec->end(codec->user_context);
+      ref_response->_internal.body_decoding.state = _az_HTTP_RESPONSE_BODY_DECODING_ENDED;
+    }
+
+    if (decoded_size > 0)
+    {
+      _az_RETURN_IF_FAILED(
+          _az_http_response_write_body(ref_response, az_span_create(decoded, decoded_size)));
+    }
+    else if (az_span_size(source) == 0)
+    {
+      // The codec holds no more output, until it gets more of the body.
+      break;
+    }
+    else if (source_used == 0)
+    {
+      return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+    }
+  }
+
+  // Nothing is expected after the end of the compressed body.
+  return az_span_size(source) == 0 ? AZ_OK : AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+}
+
+AZ_NODISCARD az_result
+az_http_response_append_body(az_http_response* ref_response, az_span source)
+{
+  _az_PRECONDITION_NOT_NULL(ref_response);
+
+  if (ref_response->_internal.body_decoding.codec == NULL || az_span_size(source) == 0)
+  {
+    return _az_http_response_write_body(ref_response, source);
+  }
+
+  if (ref_response->_internal.body_decoding.state == _az_HTTP_RESPONSE_BODY_DECODING_NOT_STARTED)
+  {
+    _az_RETURN_IF_FAILED(_az_http_response_begin_body_decoding(ref_response));
+  }
+
+  return ref_response->_internal.body_decoding.state == _az_HTTP_RESPONSE_BODY_DECODING_IDENTITY
+      ? _az_http_response_write_body(ref_response, source)
+      : _az_http_response_decode_body(ref_response, source);
+}
@@ -0,0 +1,405 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_http_private.h"
+#include "az_span_private.h"
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// A chunk size with more hex digits could overflow the int64_t it is read into.
+#define _az_HTTP_CHUNK_SIZE_MAX_DIGITS 15
+
+AZ_NODISCARD az_result az_http_response_decoder_init(
+    az_http_response_decoder* out_decoder,
+    az_http_response* ref_response,
+    az_http_method method)
+{
+  _az_PRECONDITION_NOT_NULL(out_decoder);
+  _az_PRECONDITION_NOT_NULL(ref_response);
+
+  *out_decoder = (az_http_response_decoder){
+    ._internal = {
+      .response = ref_response,
+      .state = _az_HTTP_RESPONSE_DECODER_STATE_HEADERS,
+      .remaining = 0,
+      .headers_end_size = 0,
+      .chunk_size_digits = 0,
+      .is_head_request = az_span_is_content_equal(method, az_http_method_head()),
+    },
+  };
+
+  return AZ_OK;
+}
+
+// Whether the last coding of a Transfer-Encoding header value is chunked.
+static AZ_NODISCARD bool _az_http_response_decoder_is_chunked(az_span transfer_encoding)
+{
+  int32_t last_coding_start = 0;
+  uint8_t const* const ptr = az_span_ptr(transfer_encoding);
+  int32_t const size = az_span_size(transfer_encoding);
+  for (int32_t i = 0; i < size; ++i)
+  {
+    if (ptr[i] == ',')
+    {
+      last_coding_start = i + 1;
+    }
+  }
+
+  return az_span_is_content_equal_ignoring_case(
+      _az_span_trim_whitespace(az_span_slice_to_end(transfer_encoding, last_coding_start)),
+      AZ_SPAN_FROM_STR("chunked"));
+}
+
+// Finds how the body of the response whose headers were received is delimited.
+// https://tools.ietf.org/html/rfc7230#section-3.3.3
+static AZ_NODISCARD az_result _az_http_response_decoder_start_body(
+    az_http_response_decoder* ref_decoder,
+    az_http_response_status_line const* status_line)
+{
+  az_http_response* const response = ref_decoder->_internal.response;
+  az_http_status_code const status_code = status_line->status_code;
+
+  if (ref_decoder->_internal.is_head_request || (status_code >= 100 && status_code < 200)
+      || status_code == AZ_HTTP_STATUS_CODE_NO_CONTENT
+      || status_code == AZ_HTTP_STATUS_CODE_NOT_MODIFIED)
+  {
+    ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE;
+    return AZ_OK;
+  }
+
+  az_span value = { 0 };
+  az_result result
+      = az_http_response_get_header(response, AZ_SPAN_FROM_STR("Transfer-Encoding"), &value);
+  if (az_result_succeeded(result))
+  {
+    // A body which isn't chunked last can only end when the connection is closed.
+    if (_az_http_response_decoder_is_chunked(value))
+    {
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE;
+      ref_decoder->_internal.remaining = 0;
+      ref_decoder->_internal.chunk_size_digits = 0;
+    }
+    else
+    {
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_BODY_UNTIL_CLOSE;
+    }
+
+    return AZ_OK;
+  }
+
+  if (result != AZ_ERROR_ITEM_NOT_FOUND)
+  {
+    return result;
+  }
+
+  result = az_http_response_get_header(response, AZ_SPAN_FROM_STR("Content-Length"), &value);
+  if (az_result_succeeded(result))
+  {
+    uint64_t content_length = 0;
+    if (az_result_failed(az_span_atou64(value, &content_length)) || content_length > INT64_MAX)
+    {
+      return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+    }
+
+    ref_decoder->_internal.remaining = (int64_t)content_length;
+    ref_decoder->_internal.state = content_length == 0
+        ? _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE
+        : _az_HTTP_RESPONSE_DECODER_STATE_BODY;
+
+    return AZ_OK;
+  }
+
+  if (result != AZ_ERROR_ITEM_NOT_FOUND)
+  {
+    return result;
+  }
+
+  ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_BODY_UNTIL_CLOSE;
+  return AZ_OK;
+}
+
+// Appends the status line and headers at the start of received to the response, and returns how
+// many bytes they took. Once they were all received, finds how the body is delimited.
+static AZ_NODISCARD az_result _az_http_response_decoder_feed_headers(
+    az_http_response_decoder* ref_decoder,
+    az_span received,
+    int32_t* out_bytes_used)
+{
+  static uint8_t const headers_end[] = { '\r', '\n', '\r', '\n' };
+  int32_t const headers_end_size = (int32_t)sizeof(headers_end);
+
+  uint8_t const* const ptr = az_span_ptr(received);
+  int32_t const size = az_span_size(received);
+  int32_t matched = ref_decoder->_internal.headers_end_size;
+  int32_t used = 0;
+  while (used < size && matched < headers_end_size)
+  {
+    uint8_t const c = ptr[used];
+    ++used;
+    if (c == headers_end[matched])
+    {
+      ++matched;
+    }
+    else
+    {
+      matched = c == '\r' ? 1 : 0;
+    }
+  }
+
+  az_http_response* const response = ref_decoder->_internal.response;
+  _az_RETURN_IF_FAILED(az_http_response_append(response, az_span_slice(received, 0, used)));
+  ref_decoder->_internal.headers_end_size = matched;
+  *out_bytes_used = used;
+
+  if (matched < headers_end_size)
+  {
+    return AZ_OK;
+  }
+
+  // Leave the response parser where it was, for the application to read the response.
+  _az_http_response_parser const parser = response->_internal.parser;
+  az_http_response_status_line status_line = { 0 };
+  az_result result = az_http_response_get_status_line(response, &status_line);
+  response->_internal.parser = parser;
+  if (az_result_failed(result))
+  {
+    return AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER;
+  }
+
+  // An interim response is followed by the final one, which replaces it.
+  if (status_line.status_code >= 100 && status_line.status_code < 200
+      && status_line.status_code != AZ_HTTP_STATUS_CODE_SWITCHING_PROTOCOLS)
+  {
+    _az_http_response_reset(response);
+    ref_decoder->_internal.headers_end_size = 0;
+    return AZ_OK;
+  }
+
+  return _az_http_response_decoder_start_body(ref_decoder, &status_line);
+}
+
+// Decodes the chunked body at the start of received, up to the end of the current chunk data.
+// https://tools.ietf.org/html/rfc7230#section-4.1
+static AZ_NODISCARD az_result _az_http_response_decoder_feed_chunked(
+    az_http_response_decoder* ref_decoder,
+    az_span received,
+    int32_t* out_bytes_used)
+{
+  if (ref_decoder->_internal.state == _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA)
+  {
+    int32_t const size = ref_decoder->_internal.remaining < az_span_size(received)
+        ? (int32_t)ref_decoder->_internal.remaining
+        : az_span_size(received);
+
+    _az_RETURN_IF_FAILED(az_http_response_append_body(
+        ref_decoder->_internal.response, az_span_slice(received, 0, size)));
+
+    ref_decoder->_internal.remaining -= size;
+    if (ref_decoder->_internal.remaining == 0)
+    {
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_CR;
+    }
+
+    *out_bytes_used = size;
+    return AZ_OK;
+  }
+
+  // The chunk framing is parsed one byte at a time, since it can end up split across fragments.
+  uint8_t const c = az_span_ptr(received)[0];
+  *out_bytes_used = 1;
+  switch (ref_decoder->_internal.state)
+  {
+    case _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE:
+    {
+      int32_t digit = -1;
+      if (c >= '0' && c <= '9')
+      {
+        digit = c - '0';
+      }
+      else if (c >= 'a' && c <= 'f')
+      {
+        digit = c - 'a' + 10;
+      }
+      else if (c >= 'A' && c <= 'F')
+      {
+        digit = c - 'A' + 10;
+      }
+
+      if (digit >= 0)
+      {
+        if (ref_decoder->_internal.chunk_size_digits == _az_HTTP_CHUNK_SIZE_MAX_DIGITS)
+        {
+          return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+        }
+
+        ref_decoder->_internal.remaining = ref_decoder->_internal.remaining * 16 + digit;
+        ++ref_decoder->_internal.chunk_size_digits;
+        return AZ_OK;
+      }
+
+      if (ref_decoder->_internal.chunk_size_digits == 0)
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      if (c == '\r')
+      {
+        ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE_LF;
+        return AZ_OK;
+      }
+
+      // chunk-ext = *( BWS ";" BWS chunk-ext-name [ BWS "=" BWS chunk-ext-val ] )
+      if (c != ';' && c != ' ' && c != '\t')
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_EXTENSION;
+      return AZ_OK;
+    }
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_EXTENSION:
+      // Chunk extensions are ignored.
+      if (c == '\r')
+      {
+        ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE_LF;
+      }
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE_LF:
+      if (c != '\n')
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      // The last chunk has a size of 0, and is followed by the trailers.
+      ref_decoder->_internal.state = ref_decoder->_internal.remaining == 0
+          ? _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE_START
+          : _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA;
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_CR:
+      if (c != '\r')
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_LF;
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_DATA_LF:
+      if (c != '\n')
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_CHUNK_SIZE;
+      ref_decoder->_internal.remaining = 0;
+      ref_decoder->_internal.chunk_size_digits = 0;
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE_START:
+      // Trailers are discarded, until the empty line which ends them.
+      ref_decoder->_internal.state = c == '\r' ? _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LF
+                                               : _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE;
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE:
+      if (c == '\n')
+      {
+        ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LINE_START;
+      }
+      return AZ_OK;
+
+    case _az_HTTP_RESPONSE_DECODER_STATE_TRAILER_LF:
+      if (c != '\n')
+      {
+        return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+      }
+
+      ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE;
+      return AZ_OK;
+
+    default:
+      return AZ_ERROR_HTTP_INVALID_STATE;
+  }
+}
+
+AZ_NODISCARD az_result az_http_response_decoder_feed(
+    az_http_response_decoder* ref_decoder,
+    az_span received,
+    int32_t* out_bytes_used)
+{
+  _az_PRECONDITION_NOT_NULL(ref_decoder);
+  _az_PRECONDITION_VALID_SPAN(received, 0, true);
+  _az_PRECONDITION_NOT_NULL(out_bytes_used);
+
+  int32_t used = 0;
+  int32_t const size = az_span_size(received);
+  while (used < size)
+  {
+    az_span const remaining = az_span_slice_to_end(received, used);
+    int32_t remaining_used = 0;
+    switch (ref_decoder->_internal.state)
+    {
+      case _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE:
+        *out_bytes_used = used;
+        return AZ_OK;
+
+      case _az_HTTP_RESPONSE_DECODER_STATE_HEADERS:
+        _az_RETURN_IF_FAILED(
+            _az_http_response_decoder_feed_headers(ref_decoder, remaining, &remaining_used));
+        break;
+
+      case _az_HTTP_RESPONSE_DECODER_STATE_BODY:
+        remaining_used = ref_decoder->_internal.remaining < az_span_size(remaining)
+            ? (int32_t)ref_decoder->_internal.remaining
+            : az_span_size(remaining);
+        _az_RETURN_IF_FAILED(az_http_response_append_body(
+            ref_decoder->_internal.response, az_span_slice(remaining, 0, remaining_used)));
+
+        ref_decoder->_internal.remaining -= remaining_used;
+        if (ref_decoder->_internal.remaining == 0)
+        {
+          ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE;
+        }
+        break;
+
+      case _az_HTTP_RESPONSE_DECODER_STATE_BODY_UNTIL_CLOSE:
+        _az_RETURN_IF_FAILED(
+            az_http_response_append_body(ref_decoder->_internal.response, remaining));
+        remaining_used = az_span_size(remaining);
+        break;
+
+      default:
+        _az_RETURN_IF_FAILED(
+            _az_http_response_decoder_feed_chunked(ref_decoder, remaining, &remaining_used));
+        break;
+    }
+
+    used += remaining_used;
+  }
+
+  *out_bytes_used = used;
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_response_decoder_end(az_http_response_decoder* ref_decoder)
+{
+  _az_PRECONDITION_NOT_NULL(ref_decoder);
+
+  if (ref_decoder->_internal.state == _az_HTTP_RESPONSE_DECODER_STATE_BODY_UNTIL_CLOSE)
+  {
+    ref_decoder->_internal.state = _az_HTTP_RESPONSE_DECODER_STATE_COMPLETE;
+  }
+
+  return az_http_response_decoder_is_complete(ref_decoder) ? AZ_OK
+                                                            : AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+}
@@ -0,0 +1,469 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_json.h>
+#include <azure/core/az_precondition.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <stdint.h>
+
+#include <azure/core/_az_cfg.h>
+
+// A property of a JSON object, indexed within the scratch buffer.
+typedef struct
+{
+  az_span name; // The unescaped property name, copied into the scratch buffer.
+  az_span value; // The JSON text of the value, pointing into the JSON document.
+  bool is_matched; // Whether a property with the same name was found in the other object.
+} _az_json_merge_patch_property;
+
+// Unescapes the name of the property the reader is on into the start of the buffer.
+AZ_NODISCARD static az_result _az_json_merge_patch_get_property_name(
+    az_json_token const* property_name_token,
+    az_span buffer,
+    az_span* out_name)
+{
+  // az_json_token_get_string() always needs room for a null terminator.
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(buffer, 1);
+
+  int32_t name_length = 0;
+  _az_RETURN_IF_FAILED(az_json_token_get_string(
+      property_name_token, (char*)az_span_ptr(buffer), az_span_size(buffer), &name_length));
+
+  *out_name = az_span_slice(buffer, 0, name_length);
+  return AZ_OK;
+}
+
+// Skips over the value the reader is on, and returns the whole JSON text of that value.
+AZ_NODISCARD static az_result _az_json_merge_patch_get_value_text(
+    az_json_reader* ref_json_reader,
+    az_span* out_value)
+{
+  // The slice of a string token excludes the quotes, which are part of the value text.
+  uint8_t* value_start = az_span_ptr(ref_json_reader->token.slice);
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_STRING)
+  {
+    value_start--;
+  }
+
+  _az_RETURN_IF_FAILED(az_json_reader_skip_children(ref_json_reader));
+
+  uint8_t* value_end
+      = az_span_ptr(ref_json_reader->token.slice) + az_span_size(ref_json_reader->token.slice);
+  if (ref_json_reader->token.kind == AZ_JSON_TOKEN_STRING)
+  {
+    value_end++;
+  }
+
+  *out_value = az_span_create(value_start, (int32_t)(value_end - value_start));
+  return AZ_OK;
+}
+
+// Returns the JSON text of the root value of a document, after verifying the whole document.
+AZ_NODISCARD static az_result _az_json_merge_patch_get_root_value_text(
+    az_span json,
+    az_span* out_value,
+    az_json_token_kind* out_kind)
+{
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, json, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+
+  *out_kind = reader.token.kind;
+  _az_RETURN_IF_FAILED(_az_json_merge_patch_get_value_text(&reader, out_value));
+
+  // Nothing but white space is allowed after the root value.
+  az_result const result = az_json_reader_next_token(&reader);
+  return result == AZ_ERROR_JSON_READER_DONE
+      ? AZ_OK
+      : (az_result_failed(result) ? result : AZ_ERROR_UNEXPECTED_CHAR);
+}
+
+// Compares two JSON values token by token, so that white space differences are ignored. Strings
+// and numbers are compared as written, so different escaping or number formatting of the same value
+// is considered a change, which is harmless within a merge patch.
+AZ_NODISCARD static bool _az_json_merge_patch_is_value_equal(az_span left, az_span right)
+{
+  if (az_span_is_content_equal(left, right))
+  {
+    return true;
+  }
+
+  az_json_reader left_reader = { 0 };
+  az_json_reader right_reader = { 0 };
+  if (az_result_failed(az_json_reader_init(&left_reader, left, NULL))
+      || az_result_failed(az_json_reader_init(&right_reader, right, NULL)))
+  {
+    return false;
+  }
+
+  while (true)
+  {
+    az_result const left_result = az_json_reader_next_token(&left_reader);
+    az_result const right_result = az_json_reader_next_token(&right_reader);
+
+    if (left_result != right_result)
+    {
+      return false;
+    }
+
+    if (left_result == AZ_ERROR_JSON_READER_DONE)
+    {
+      return true;
+    }
+
+    if (az_result_failed(left_result) || left_reader.token.kind != right_reader.token.kind
+        || !az_span_is_content_equal(left_reader.token.slice, right_reader.token.slice))
+    {
+      return false;
+    }
+  }
+}
+
+// Writes a JSON value, which has already been validated, without any insignificant white space.
+AZ_NODISCARD static az_result _az_json_merge_patch_append_value(
+    az_json_writer* ref_json_writer,
+    az_span value)
+{
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, value, NULL));
+  return az_json_transcode(&reader, ref_json_writer, AZ_JSON_TRANSCODE_MINIFY);
+}
+
+// Indexes the properties of a JSON object at the start of the scratch buffer, and returns the rest
+// of the scratch buffer. An empty object span is indexed as an object without any properties.
+AZ_NODISCARD static az_result _az_json_merge_patch_index_object(
+    az_span object,
+    az_span scratch_buffer,
+    _az_json_merge_patch_property** out_properties,
+    int32_t* out_property_count,
+    az_span* out_remaining)
+{
+  az_json_reader reader = { 0 };
+
+  // Count the properties first, to know how much of the scratch buffer to set aside for the index.
+  int32_t property_count = 0;
+  if (az_span_size(object) > 0)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_init(&reader, object, NULL));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+    {
+      property_count++;
+      _az_RETURN_IF_FAILED(az_json_reader_skip_children(&reader));
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    }
+  }
+
+  // The index must be suitably aligned within the scratch buffer.
+  uintptr_t const misalignment = (uintptr_t)az_span_ptr(scratch_buffer) % sizeof(void*);
+  int32_t const index_offset = misalignment == 0 ? 0 : (int32_t)(sizeof(void*) - misalignment);
+  int32_t const index_size
+      = index_offset + property_count * (int32_t)sizeof(_az_json_merge_patch_property);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(scratch_buffer, index_size);
+
+  _az_json_merge_patch_property* properties
+      = (_az_json_merge_patch_property*)(void*)(az_span_ptr(scratch_buffer) + index_offset);
+  az_span remaining = az_span_slice_to_end(scratch_buffer, index_size);
+
+  if (property_count > 0)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_init(&reader, object, NULL));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  }
+
+  for (int32_t i = 0; i < property_count; i++)
+  {
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    _az_RETURN_IF_FAILED(
+        _az_json_merge_patch_get_property_name(&reader.token, remaining, &properties[i].name));
+    remaining = az_span_slice_to_end(remaining, az_span_size(properties[i].name));
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    _az_RETURN_IF_FAILED(_az_json_merge_patch_get_value_text(&reader, &properties[i].value));
+    properties[i].is_matched = false;
+  }
+
+  *out_properties = properties;
+  *out_property_count = property_count;
+  *out_remaining = remaining;
+  return AZ_OK;
+}
+
+// Returns the first property of the index with the given name which wasn't matched yet, and marks
+// it as matched, or NULL if there is none.
+AZ_NODISCARD static _az_json_merge_patch_property* _az_json_merge_patch_match_property(
+    _az_json_merge_patch_property* properties,
+    int32_t property_count,
+    az_span name)
+{
+  for (int32_t i = 0; i < property_count; i++)
+  {
+    if (!properties[i].is_matched && az_span_is_content_equal(properties[i].name, name))
+    {
+      properties[i].is_matched = true;
+      return &properties[i];
+    }
+  }
+
+  return NULL;
+}
+
+AZ_NODISCARD static az_result _az_json_merge_patch_create_object(
+    az_span original_object,
+    az_span modified_object,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer,
+    bool* out_has_changes)
+{
+  _az_json_merge_patch_property* properties = NULL;
+  int32_t property_count = 0;
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_merge_patch_index_object(
+      original_object, scratch_buffer, &properties, &property_count, &remaining));
+
+  *out_has_changes = false;
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  // Added and changed properties.
+  az_json_reader reader = { 0 };
+  _az_RETURN_IF_FAILED(az_json_reader_init(&reader, modified_object, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    // The name is only needed until it is written, so it doesn't take up scratch space for long.
+    az_span name = AZ_SPAN_EMPTY;
+    _az_RETURN_IF_FAILED(_az_json_merge_patch_get_property_name(&reader.token, remaining, &name));
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    az_json_token_kind const value_kind = reader.token.kind;
+    az_span value = AZ_SPAN_EMPTY;
+    _az_RETURN_IF_FAILED(_az_json_merge_patch_get_value_text(&reader, &value));
+
+    _az_json_merge_patch_property* original
+        = _az_json_merge_patch_match_property(properties, property_count, name);
+
+    if (original != NULL && value_kind == AZ_JSON_TOKEN_BEGIN_OBJECT
+        && az_span_ptr(original->value)[0] == '{')
+    {
+      az_json_writer_mark const mark = az_json_writer_get_mark(ref_json_writer);
+      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, name));
+
+      bool nested_has_changes = false;
+      _az_RETURN_IF_FAILED(_az_json_merge_patch_create_object(
+          original->value,
+          value,
+          az_span_slice_to_end(remaining, az_span_size(name)),
+          ref_json_writer,
+          &nested_has_changes));
+
+      // Drop the nested object if nothing changed within it. A chunked writer may not be able to
+      // roll back past a chunk boundary, in which case the empty object, a no-op in a merge patch,
+      // is left in place.
+      if (nested_has_changes || az_result_failed(az_json_writer_rollback(ref_json_writer, &mark)))
+      {
+        *out_has_changes = true;
+      }
+    }
+    else if (original == NULL || !_az_json_merge_patch_is_value_equal(original->value, value))
+    {
+      _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, name));
+      _az_RETURN_IF_FAILED(_az_json_merge_patch_append_value(ref_json_writer, value));
+      *out_has_changes = true;
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+  }
+
+  // Removed properties.
+  for (int32_t i = 0; i < property_count; i++)
+  {
+    if (!properties[i].is_matched)
+    {
+      _az_RETURN_IF_FAILED(
+          az_json_writer_append_property_name(ref_json_writer, properties[i].name));
+      _az_RETURN_IF_FAILED(az_json_writer_append_null(ref_json_writer));
+      *out_has_changes = true;
+    }
+  }
+
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+AZ_NODISCARD az_result az_json_merge_patch_create(
+    az_span original_json,
+    az_span modified_json,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer)
+{
+  _az_PRECONDITION_VALID_SPAN(original_json, 1, false);
+  _az_PRECONDITION_VALID_SPAN(modified_json, 1, false);
+  _az_PRECONDITION_VALID_SPAN(scratch_buffer, 0, true);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+
+  az_span original_value = AZ_SPAN_EMPTY;
+  az_span modified_value = AZ_SPAN_EMPTY;
+  az_json_token_kind original_kind = AZ_JSON_TOKEN_NONE;
+  az_json_token_kind modified_kind = AZ_JSON_TOKEN_NONE;
+  _az_RETURN_IF_FAILED(
+      _az_json_merge_patch_get_root_value_text(original_json, &original_value, &original_kind));
+  _az_RETURN_IF_FAILED(
+      _az_json_merge_patch_get_root_value_text(modified_json, &modified_value, &modified_kind));
+
+  // Unless both documents are objects, the patch replaces the whole document.
+  if (original_kind != AZ_JSON_TOKEN_BEGIN_OBJECT || modified_kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return _az_json_merge_patch_append_value(ref_json_writer, modified_value);
+  }
+
+  bool has_changes = false;
+  return _az_json_merge_patch_create_object(
+      original_value, modified_value, scratch_buffer, ref_json_writer, &has_changes);
+}
+
+AZ_NODISCARD static az_result _az_json_merge_patch_apply_object(
+    az_span target_object,
+    az_span patch_object,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer);
+
+// Writes a property of the merged object, whose name is in the patch. An empty target value stands
+// for a property that isn't in the target object.
+AZ_NODISCARD static az_result _az_json_merge_patch_apply_property(
+    az_span name,
+    az_span target_value,
+    az_span patch_value,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer)
+{
+  uint8_t const patch_value_start = az_span_ptr(patch_value)[0];
+
+  // A null value in the patch removes the property.
+  if (patch_value_start == 'n')
+  {
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, name));
+
+  // An object in the patch is merged into the target value, or into an empty object when the target
+  // value is missing or isn't an object, so that the nulls within it are removed as well.
+  if (patch_value_start == '{')
+  {
+    bool const is_target_object
+        = az_span_size(target_value) > 0 && az_span_ptr(target_value)[0] == '{';
+    return _az_json_merge_patch_apply_object(
+        is_target_object ? target_value : AZ_SPAN_EMPTY,
+        patch_value,
+        scratch_buffer,
+        ref_json_writer);
+  }
+
+  return _az_json_merge_patch_append_value(ref_json_writer, patch_value);
+}
+
+// Writes the result of applying a patch object to a target object. An empty target object span is
+// merged as an object without any properties.
+AZ_NODISCARD static az_result _az_json_merge_patch_apply_object(
+    az_span target_object,
+    az_span patch_object,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer)
+{
+  _az_json_merge_patch_property* patch_properties = NULL;
+  int32_t patch_property_count = 0;
+  az_span remaining = AZ_SPAN_EMPTY;
+  _az_RETURN_IF_FAILED(_az_json_merge_patch_index_object(
+      patch_object, scratch_buffer, &patch_properties, &patch_property_count, &remaining));
+
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  // The properties of the target object keep their order, whether they are patched or not.
+  if (az_span_size(target_object) > 0)
+  {
+    az_json_reader reader = { 0 };
+    _az_RETURN_IF_FAILED(az_json_reader_init(&reader, target_object, NULL));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    while (reader.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+    {
+      az_span name = AZ_SPAN_EMPTY;
+      _az_RETURN_IF_FAILED(_az_json_merge_patch_get_property_name(&reader.token, remaining, &name));
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+      az_span value = AZ_SPAN_EMPTY;
+      _az_RETURN_IF_FAILED(_az_json_merge_patch_get_value_text(&reader, &value));
+
+      _az_json_merge_patch_property* patch_property
+          = _az_json_merge_patch_match_property(patch_properties, patch_property_count, name);
+      if (patch_property == NULL)
+      {
+        _az_RETURN_IF_FAILED(az_json_writer_append_property_name(ref_json_writer, name));
+        _az_RETURN_IF_FAILED(_az_json_merge_patch_append_value(ref_json_writer, value));
+      }
+      else
+      {
+        _az_RETURN_IF_FAILED(_az_json_merge_patch_apply_property(
+            name,
+            value,
+            patch_property->value,
+            az_span_slice_to_end(remaining, az_span_size(name)),
+            ref_json_writer));
+      }
+
+      _az_RETURN_IF_FAILED(az_json_reader_next_token(&reader));
+    }
+  }
+
+  // Properties which are only in the patch are added at the end.
+  for (int32_t i = 0; i < patch_property_count; i++)
+  {
+    if (!patch_properties[i].is_matched)
+    {
+      _az_RETURN_IF_FAILED(_az_json_merge_patch_apply_property(
+          patch_properties[i].name,
+          AZ_SPAN_EMPTY,
+          patch_properties[i].value,
+          remaining,
+          ref_json_writer));
+    }
+  }
+
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+AZ_NODISCARD az_result az_json_merge_patch_apply(
+    az_span target_json,
+    az_span patch_json,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer)
+{
+  _az_PRECONDITION_VALID_SPAN(target_json, 1, false);
+  _az_PRECONDITION_VALID_SPAN(patch_json, 1, false);
+  _az_PRECONDITION_VALID_SPAN(scratch_buffer, 0, true);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+
+  az_span target_value = AZ_SPAN_EMPTY;
+  az_span patch_value = AZ_SPAN_EMPTY;
+  az_json_token_kind target_kind = AZ_JSON_TOKEN_NONE;
+  az_json_token_kind patch_kind = AZ_JSON_TOKEN_NONE;
+  _az_RETURN_IF_FAILED(
+      _az_json_merge_patch_get_root_value_text(target_json, &target_value, &target_kind));
+  _az_RETURN_IF_FAILED(
+      _az_json_merge_patch_get_root_value_text(patch_json, &patch_value, &patch_kind));
+
+  // A patch which isn't an object replaces the whole document.
+  if (patch_kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return _az_json_merge_patch_append_value(ref_json_writer, patch_value);
+  }
+
+  return _az_json_merge_patch_apply_object(
+      target_kind == AZ_JSON_TOKEN_BEGIN_OBJECT ? target_value : AZ_SPAN_EMPTY,
+      patch_value,
+      scratch_buffer,
+      ref_json_writer);
+}
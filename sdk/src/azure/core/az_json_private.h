@@ -58,6 +58,9 @@ enum
 
   // The number of unique values in base 16 (hexadecimal).
   _az_NUMBER_OF_HEX_VALUES = 16,
+
+  // The number of spaces per nesting level used by az_json_transcode when pretty printing.
+  _az_JSON_PRETTY_PRINT_INDENT_SIZE = 2,
 };
 
 typedef enum
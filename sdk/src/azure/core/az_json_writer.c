@@ -27,8 +27,12 @@ AZ_NODISCARD az_result az_json_writer_init(
       .bytes_written = 0,
       .total_bytes_written = 0,
       .need_comma = false,
+#ifndef AZ_NO_PRECONDITION_CHECKING
       .token_kind = AZ_JSON_TOKEN_NONE,
       .bit_stack = { 0 },
+#else
+      .current_depth = 0,
+#endif // AZ_NO_PRECONDITION_CHECKING
       .options = options == NULL ? az_json_writer_options_default() : *options,
     },
   };
@@ -53,14 +57,80 @@ AZ_NODISCARD az_result az_json_writer_chunked_init(
       .bytes_written = 0,
       .total_bytes_written = 0,
       .need_comma = false,
+#ifndef AZ_NO_PRECONDITION_CHECKING
       .token_kind = AZ_JSON_TOKEN_NONE,
       .bit_stack = { 0 },
+#else
+      .current_depth = 0,
+#endif // AZ_NO_PRECONDITION_CHECKING
       .options = options == NULL ? az_json_writer_options_default() : *options,
     },
   };
   return AZ_OK;
 }
 
+void az_json_writer_reset(az_json_writer* ref_json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+
+  ref_json_writer->_internal.bytes_written = 0;
+  ref_json_writer->_internal.total_bytes_written = 0;
+  ref_json_writer->_internal.need_comma = false;
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  ref_json_writer->_internal.token_kind = AZ_JSON_TOKEN_NONE;
+  ref_json_writer->_internal.bit_stack = (_az_json_bit_stack){ 0 };
+#else
+  ref_json_writer->_internal.current_depth = 0;
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+AZ_NODISCARD az_json_writer_mark az_json_writer_get_mark(az_json_writer const* json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(json_writer);
+
+  return (az_json_writer_mark){
+    ._internal = {
+      .destination_ptr = az_span_ptr(json_writer->_internal.destination_buffer),
+      .bytes_written = json_writer->_internal.bytes_written,
+      .total_bytes_written = json_writer->_internal.total_bytes_written,
+      .need_comma = json_writer->_internal.need_comma,
+#ifndef AZ_NO_PRECONDITION_CHECKING
+      .token_kind = json_writer->_internal.token_kind,
+      .bit_stack = json_writer->_internal.bit_stack,
+#else
+      .current_depth = json_writer->_internal.current_depth,
+#endif // AZ_NO_PRECONDITION_CHECKING
+    },
+  };
+}
+
+AZ_NODISCARD az_result
+az_json_writer_rollback(az_json_writer* ref_json_writer, az_json_writer_mark const* mark)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(mark);
+
+  // The text written into previous buffers, provided by the allocator callback, can't be discarded.
+  if (mark->_internal.destination_ptr != az_span_ptr(ref_json_writer->_internal.destination_buffer))
+  {
+    return AZ_ERROR_JSON_INVALID_STATE;
+  }
+
+  _az_PRECONDITION(mark->_internal.bytes_written <= ref_json_writer->_internal.bytes_written);
+
+  ref_json_writer->_internal.bytes_written = mark->_internal.bytes_written;
+  ref_json_writer->_internal.total_bytes_written = mark->_internal.total_bytes_written;
+  ref_json_writer->_internal.need_comma = mark->_internal.need_comma;
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  ref_json_writer->_internal.token_kind = mark->_internal.token_kind;
+  ref_json_writer->_internal.bit_stack = mark->_internal.bit_stack;
+#else
+  ref_json_writer->_internal.current_depth = mark->_internal.current_depth;
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  return AZ_OK;
+}
+
 static AZ_NODISCARD az_span
 _get_remaining_span(az_json_writer* ref_json_writer, int32_t required_size)
 {
@@ -91,6 +161,7 @@ _get_remaining_span(az_json_writer* ref_json_writer, int32_t required_size)
   return remaining;
 }
 
+#ifndef AZ_NO_PRECONDITION_CHECKING
 // This validation method is used outside of just preconditions, within
 // az_json_writer_append_json_text.
 static AZ_NODISCARD bool _az_is_appending_value_valid(az_json_writer const* json_writer)
@@ -135,7 +206,6 @@ static AZ_NODISCARD bool _az_is_appending_value_valid(az_json_writer const* json
   return true;
 }
 
-#ifndef AZ_NO_PRECONDITION_CHECKING
 static AZ_NODISCARD bool _az_is_appending_property_name_valid(az_json_writer const* json_writer)
 {
   _az_PRECONDITION_NOT_NULL(json_writer);
@@ -197,6 +267,16 @@ static AZ_NODISCARD bool _az_is_appending_container_end_valid(
   // JSON writer state is valid and an end of a container can be appended.
   return true;
 }
+
+static AZ_NODISCARD bool _az_is_json_writer_complete(az_json_writer const* json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(json_writer);
+
+  // A single, complete, JSON value has been written when all objects and arrays are closed and at
+  // least one token was written.
+  return json_writer->_internal.bit_stack._internal.current_depth == 0
+      && json_writer->_internal.token_kind != AZ_JSON_TOKEN_NONE;
+}
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 // Returns the length of the JSON string within the az_span after it has been escaped.
@@ -393,7 +473,41 @@ AZ_INLINE void _az_update_json_writer_state(
   ref_json_writer->_internal.bytes_written += bytes_written_in_last;
   ref_json_writer->_internal.total_bytes_written += total_bytes_written;
   ref_json_writer->_internal.need_comma = need_comma;
+#ifndef AZ_NO_PRECONDITION_CHECKING
   ref_json_writer->_internal.token_kind = token_kind;
+#else
+  (void)token_kind;
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+AZ_NODISCARD AZ_INLINE int32_t _az_json_writer_get_current_depth(az_json_writer const* json_writer)
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  return json_writer->_internal.bit_stack._internal.current_depth;
+#else
+  return json_writer->_internal.current_depth;
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+AZ_INLINE void _az_json_writer_push_container(
+    az_json_writer* ref_json_writer,
+    _az_json_stack_item item)
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  _az_json_stack_push(&ref_json_writer->_internal.bit_stack, item);
+#else
+  (void)item;
+  ref_json_writer->_internal.current_depth++;
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+AZ_INLINE void _az_json_writer_pop_container(az_json_writer* ref_json_writer)
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  _az_json_stack_pop(&ref_json_writer->_internal.bit_stack);
+#else
+  ref_json_writer->_internal.current_depth--;
+#endif // AZ_NO_PRECONDITION_CHECKING
 }
 
 static AZ_NODISCARD az_result az_json_writer_span_copy_chunked(
@@ -770,6 +884,7 @@ az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_te
   // AZ_JSON_TOKEN_NONE, AZ_JSON_TOKEN_START_ARRAY, AZ_JSON_TOKEN_START_OBJECT,
   // AZ_JSON_TOKEN_PROPERTY_NAME
 
+#ifndef AZ_NO_PRECONDITION_CHECKING
   // The JSON text is valid, but appending it to the the JSON writer at the current state still may
   // not be valid.
   if (!_az_is_appending_value_valid(ref_json_writer))
@@ -778,6 +893,7 @@ az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_te
     // Also first_token_kind cannot be AZ_JSON_TOKEN_NONE at this point.
     return AZ_ERROR_JSON_INVALID_STATE;
   }
+#endif // AZ_NO_PRECONDITION_CHECKING
 
   az_span remaining_json = _get_remaining_span(ref_json_writer, _az_MINIMUM_STRING_CHUNK_SIZE);
   _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, _az_MINIMUM_STRING_CHUNK_SIZE);
@@ -797,6 +913,69 @@ az_json_writer_append_json_text(az_json_writer* ref_json_writer, az_span json_te
   return AZ_OK;
 }
 
+AZ_NODISCARD az_result az_json_writer_append_nested_writer(
+    az_json_writer* ref_json_writer,
+    az_json_writer const* nested_json_writer)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(nested_json_writer);
+  _az_PRECONDITION(nested_json_writer->_internal.allocator_callback == NULL);
+  _az_PRECONDITION(_az_is_json_writer_complete(nested_json_writer));
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+
+  // The nested JSON text was written by a JSON writer, so unlike az_json_writer_append_json_text,
+  // it doesn't need to be validated again.
+  az_span const nested_json = az_json_writer_get_bytes_used_in_destination(nested_json_writer);
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  az_json_token_kind const last_token_kind = nested_json_writer->_internal.token_kind;
+#else
+  az_json_token_kind const last_token_kind = AZ_JSON_TOKEN_NONE; // Not tracked.
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  int32_t required_size = az_span_size(nested_json);
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    required_size++; // For the leading comma separator.
+  }
+
+  if (ref_json_writer->_internal.allocator_callback == NULL)
+  {
+    az_span remaining_json = _get_remaining_span(ref_json_writer, required_size);
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, required_size);
+
+    if (ref_json_writer->_internal.need_comma)
+    {
+      remaining_json = az_span_copy_u8(remaining_json, ',');
+    }
+
+    az_span_copy(remaining_json, nested_json);
+
+    _az_update_json_writer_state(
+        ref_json_writer, required_size, required_size, true, last_token_kind);
+    return AZ_OK;
+  }
+
+  // Don't ask the allocator callback for a buffer large enough to hold all of the nested JSON text,
+  // and copy it in chunks instead.
+  az_span remaining_json = _get_remaining_span(ref_json_writer, _az_MINIMUM_STRING_CHUNK_SIZE);
+  _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, _az_MINIMUM_STRING_CHUNK_SIZE);
+
+  if (ref_json_writer->_internal.need_comma)
+  {
+    remaining_json = az_span_copy_u8(remaining_json, ',');
+    ref_json_writer->_internal.bytes_written++;
+  }
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_span_copy_chunked(ref_json_writer, &remaining_json, nested_json));
+
+  // We already tracked and updated bytes_written while writing, so no need to update it here.
+  _az_update_json_writer_state(ref_json_writer, 0, required_size, true, last_token_kind);
+  return AZ_OK;
+}
+
 static AZ_NODISCARD az_result _az_json_writer_append_literal(
     az_json_writer* ref_json_writer,
     az_span literal,
@@ -933,7 +1112,7 @@ static AZ_NODISCARD az_result _az_json_writer_append_container_start(
 
   // The current depth is equal to or larger than the maximum allowed depth of 64. Cannot write the
   // next JSON object or array.
-  if (ref_json_writer->_internal.bit_stack._internal.current_depth >= _az_MAX_JSON_STACK_SIZE)
+  if (_az_json_writer_get_current_depth(ref_json_writer) >= _az_MAX_JSON_STACK_SIZE)
   {
     return AZ_ERROR_JSON_NESTING_OVERFLOW;
   }
@@ -957,14 +1136,9 @@ static AZ_NODISCARD az_result _az_json_writer_append_container_start(
 
   _az_update_json_writer_state(
       ref_json_writer, required_size, required_size, false, container_kind);
-  if (container_kind == AZ_JSON_TOKEN_BEGIN_OBJECT)
-  {
-    _az_json_stack_push(&ref_json_writer->_internal.bit_stack, _az_JSON_STACK_OBJECT);
-  }
-  else
-  {
-    _az_json_stack_push(&ref_json_writer->_internal.bit_stack, _az_JSON_STACK_ARRAY);
-  }
+  _az_json_writer_push_container(
+      ref_json_writer,
+      container_kind == AZ_JSON_TOKEN_BEGIN_OBJECT ? _az_JSON_STACK_OBJECT : _az_JSON_STACK_ARRAY);
 
   return AZ_OK;
 }
@@ -997,7 +1171,7 @@ static AZ_NODISCARD az_result az_json_writer_append_container_end(
   az_span_copy_u8(remaining_json, byte);
 
   _az_update_json_writer_state(ref_json_writer, required_size, required_size, true, container_kind);
-  _az_json_stack_pop(&ref_json_writer->_internal.bit_stack);
+  _az_json_writer_pop_container(ref_json_writer);
 
   return AZ_OK;
 }
@@ -1011,3 +1185,186 @@ AZ_NODISCARD az_result az_json_writer_append_end_array(az_json_writer* ref_json_
 {
   return az_json_writer_append_container_end(ref_json_writer, ']', AZ_JSON_TOKEN_END_ARRAY);
 }
+
+// Copies the text as is, requesting chunks from the allocator callback, if there is one, as needed.
+static AZ_NODISCARD az_result
+_az_json_writer_append_raw(az_json_writer* ref_json_writer, az_span text)
+{
+  while (az_span_size(text) > 0)
+  {
+    int32_t const text_size = az_span_size(text);
+    int32_t const required_size
+        = text_size < _az_MINIMUM_STRING_CHUNK_SIZE ? text_size : _az_MINIMUM_STRING_CHUNK_SIZE;
+
+    az_span remaining_json = _get_remaining_span(ref_json_writer, required_size);
+    _az_RETURN_IF_NOT_ENOUGH_SIZE(remaining_json, required_size);
+
+    int32_t const remaining_size = az_span_size(remaining_json);
+    int32_t const copy_size = text_size < remaining_size ? text_size : remaining_size;
+    az_span_copy(remaining_json, az_span_slice(text, 0, copy_size));
+
+    ref_json_writer->_internal.bytes_written += copy_size;
+    ref_json_writer->_internal.total_bytes_written += copy_size;
+    text = az_span_slice_to_end(text, copy_size);
+  }
+
+  return AZ_OK;
+}
+
+// Copies the token text as it appears in the JSON being read, without any unescaping, including
+// when the token straddles multiple buffers of a chunked JSON reader.
+static AZ_NODISCARD az_result
+_az_json_writer_append_token_text(az_json_writer* ref_json_writer, az_json_token const* json_token)
+{
+  if (!json_token->_internal.is_multisegment)
+  {
+    return _az_json_writer_append_raw(ref_json_writer, json_token->slice);
+  }
+
+  for (int32_t i = json_token->_internal.start_buffer_index;
+       i <= json_token->_internal.end_buffer_index;
+       i++)
+  {
+    az_span source = json_token->_internal.pointer_to_first_buffer[i];
+    if (i == json_token->_internal.start_buffer_index)
+    {
+      source = az_span_slice_to_end(source, json_token->_internal.start_buffer_offset);
+    }
+    else if (i == json_token->_internal.end_buffer_index)
+    {
+      source = az_span_slice(source, 0, json_token->_internal.end_buffer_offset);
+    }
+    _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, source));
+  }
+
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result
+_az_json_writer_append_new_line(az_json_writer* ref_json_writer, int32_t depth)
+{
+  static az_span const indentation = AZ_SPAN_LITERAL_FROM_STR("                ");
+
+  _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, AZ_SPAN_FROM_STR("\n")));
+
+  int32_t spaces = depth * _az_JSON_PRETTY_PRINT_INDENT_SIZE;
+  while (spaces > 0)
+  {
+    int32_t const chunk = spaces < az_span_size(indentation) ? spaces : az_span_size(indentation);
+    _az_RETURN_IF_FAILED(
+        _az_json_writer_append_raw(ref_json_writer, az_span_slice(indentation, 0, chunk)));
+    spaces -= chunk;
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_json_transcode(
+    az_json_reader* ref_json_reader,
+    az_json_writer* ref_json_writer,
+    az_json_transcode_format format)
+{
+  _az_PRECONDITION_NOT_NULL(ref_json_reader);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION(ref_json_reader->token.kind == AZ_JSON_TOKEN_NONE);
+  _az_PRECONDITION(_az_is_appending_value_valid(ref_json_writer));
+  _az_PRECONDITION(
+      format == AZ_JSON_TRANSCODE_MINIFY || format == AZ_JSON_TRANSCODE_PRETTY_PRINT);
+
+  bool const pretty_print = format == AZ_JSON_TRANSCODE_PRETTY_PRINT;
+
+  // The writer only tracks the kind of the last token when preconditions are enabled, so keep track
+  // of it here, to know whether a container being closed is empty.
+  az_json_token_kind previous_kind = AZ_JSON_TOKEN_NONE;
+
+  az_result result = AZ_OK;
+  while (az_result_succeeded(result = az_json_reader_next_token(ref_json_reader)))
+  {
+    az_json_token const* const token = &ref_json_reader->token;
+    az_json_token_kind const kind = token->kind;
+    int32_t const depth = _az_json_writer_get_current_depth(ref_json_writer);
+
+    if (kind == AZ_JSON_TOKEN_END_OBJECT || kind == AZ_JSON_TOKEN_END_ARRAY)
+    {
+      bool const is_empty_container = previous_kind == AZ_JSON_TOKEN_BEGIN_OBJECT
+          || previous_kind == AZ_JSON_TOKEN_BEGIN_ARRAY;
+      if (pretty_print && !is_empty_container)
+      {
+        _az_RETURN_IF_FAILED(_az_json_writer_append_new_line(ref_json_writer, depth - 1));
+      }
+
+      _az_RETURN_IF_FAILED(_az_json_writer_append_raw(
+          ref_json_writer,
+          kind == AZ_JSON_TOKEN_END_OBJECT ? AZ_SPAN_FROM_STR("}") : AZ_SPAN_FROM_STR("]")));
+
+      _az_json_writer_pop_container(ref_json_writer);
+      _az_update_json_writer_state(ref_json_writer, 0, 0, true, kind);
+      previous_kind = kind;
+      continue;
+    }
+
+    if (ref_json_writer->_internal.need_comma)
+    {
+      _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, AZ_SPAN_FROM_STR(",")));
+    }
+
+    // Values within an array and property names go on their own line, while property values follow
+    // the property name on the same line.
+    if (pretty_print && depth > 0 && previous_kind != AZ_JSON_TOKEN_PROPERTY_NAME)
+    {
+      _az_RETURN_IF_FAILED(_az_json_writer_append_new_line(ref_json_writer, depth));
+    }
+
+    switch (kind)
+    {
+      case AZ_JSON_TOKEN_BEGIN_OBJECT:
+      case AZ_JSON_TOKEN_BEGIN_ARRAY:
+      {
+        if (depth >= _az_MAX_JSON_STACK_SIZE)
+        {
+          return AZ_ERROR_JSON_NESTING_OVERFLOW;
+        }
+
+        bool const is_object = kind == AZ_JSON_TOKEN_BEGIN_OBJECT;
+        _az_RETURN_IF_FAILED(_az_json_writer_append_raw(
+            ref_json_writer, is_object ? AZ_SPAN_FROM_STR("{") : AZ_SPAN_FROM_STR("[")));
+
+        _az_json_writer_push_container(
+            ref_json_writer, is_object ? _az_JSON_STACK_OBJECT : _az_JSON_STACK_ARRAY);
+        _az_update_json_writer_state(ref_json_writer, 0, 0, false, kind);
+        break;
+      }
+      case AZ_JSON_TOKEN_PROPERTY_NAME:
+      {
+        _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, AZ_SPAN_FROM_STR("\"")));
+        _az_RETURN_IF_FAILED(_az_json_writer_append_token_text(ref_json_writer, token));
+        _az_RETURN_IF_FAILED(_az_json_writer_append_raw(
+            ref_json_writer, pretty_print ? AZ_SPAN_FROM_STR("\": ") : AZ_SPAN_FROM_STR("\":")));
+
+        _az_update_json_writer_state(ref_json_writer, 0, 0, false, kind);
+        break;
+      }
+      case AZ_JSON_TOKEN_STRING:
+      {
+        _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, AZ_SPAN_FROM_STR("\"")));
+        _az_RETURN_IF_FAILED(_az_json_writer_append_token_text(ref_json_writer, token));
+        _az_RETURN_IF_FAILED(_az_json_writer_append_raw(ref_json_writer, AZ_SPAN_FROM_STR("\"")));
+
+        _az_update_json_writer_state(ref_json_writer, 0, 0, true, kind);
+        break;
+      }
+      default:
+      {
+        // Numbers and literals are copied as is.
+        _az_RETURN_IF_FAILED(_az_json_writer_append_token_text(ref_json_writer, token));
+
+        _az_update_json_writer_state(ref_json_writer, 0, 0, true, kind);
+        break;
+      }
+    }
+
+    previous_kind = kind;
+  }
+
+  return result == AZ_ERROR_JSON_READER_DONE ? AZ_OK : result;
+}
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 
+#include <azure/core/az_json.h>
 #include <azure/core/az_precondition.h>
 #include <azure/core/az_result.h>
 #include <azure/core/az_span.h>
@@ -210,3 +211,83 @@ AZ_NODISCARD az_result az_iot_hub_client_twin_parse_received_topic(
 
   return result;
 }
+
+// Finds the top level `$version` of a twin properties JSON object, if there is one.
+AZ_NODISCARD static az_result _az_iot_hub_client_twin_get_properties_version(
+    az_span properties,
+    bool* out_has_version,
+    int64_t* out_version)
+{
+  *out_has_version = false;
+
+  az_json_reader jr;
+  _az_RETURN_IF_FAILED(az_json_reader_init(&jr, properties, NULL));
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  if (jr.token.kind != AZ_JSON_TOKEN_BEGIN_OBJECT)
+  {
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  while (jr.token.kind == AZ_JSON_TOKEN_PROPERTY_NAME)
+  {
+    bool const is_version = az_json_token_is_text_equal(&jr.token, az_iot_hub_twin_version_prop);
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+
+    if (is_version)
+    {
+      if (jr.token.kind != AZ_JSON_TOKEN_NUMBER)
+      {
+        return AZ_ERROR_UNEXPECTED_CHAR;
+      }
+
+      *out_has_version = true;
+      return az_json_token_get_int64(&jr.token, out_version);
+    }
+
+    _az_RETURN_IF_FAILED(az_json_reader_skip_children(&jr));
+    _az_RETURN_IF_FAILED(az_json_reader_next_token(&jr));
+  }
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_iot_hub_client_twin_desired_properties_apply_patch(
+    az_iot_hub_client const* client,
+    az_span desired_properties,
+    az_span patch,
+    az_span scratch_buffer,
+    az_json_writer* ref_json_writer,
+    bool* out_is_applied)
+{
+  _az_PRECONDITION_NOT_NULL(client);
+  _az_PRECONDITION_VALID_SPAN(desired_properties, 1, false);
+  _az_PRECONDITION_VALID_SPAN(patch, 1, false);
+  _az_PRECONDITION_NOT_NULL(ref_json_writer);
+  _az_PRECONDITION_NOT_NULL(out_is_applied);
+  (void)client;
+
+  *out_is_applied = false;
+
+  bool desired_properties_has_version = false;
+  bool patch_has_version = false;
+  int64_t desired_properties_version = 0;
+  int64_t patch_version = 0;
+  _az_RETURN_IF_FAILED(_az_iot_hub_client_twin_get_properties_version(
+      desired_properties, &desired_properties_has_version, &desired_properties_version));
+  _az_RETURN_IF_FAILED(
+      _az_iot_hub_client_twin_get_properties_version(patch, &patch_has_version, &patch_version));
+
+  // Outdated and duplicate patches must not revert newer values.
+  if (desired_properties_has_version && patch_has_version
+      && patch_version <= desired_properties_version)
+  {
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_FAILED(
+      az_json_merge_patch_apply(desired_properties, patch, scratch_buffer, ref_json_writer));
+
+  *out_is_applied = true;
+  return AZ_OK;
+}
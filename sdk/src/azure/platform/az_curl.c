@@ -1,22 +1,55 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include <azure/core/az_arena.h>
 #include <azure/core/az_http.h>
 #include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
 #include <azure/core/az_span.h>
 #include <azure/core/internal/az_result_internal.h>
 #include <azure/core/internal/az_span_internal.h>
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <curl/curl.h>
 
+#ifndef AZ_CURL_CONNECTION_POOL_SIZE
+// The number of CURL easy handles kept alive between requests, along with their connections.
+#define AZ_CURL_CONNECTION_POOL_SIZE 8
+#endif
+
+#if AZ_CURL_CONNECTION_POOL_SIZE > 0
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
 #include <azure/core/_az_cfg.h>
 
-static AZ_NODISCARD az_result _az_span_malloc(int32_t size, az_span* out)
+// Whether memory was taken from an arena, rather than from the heap.
+static AZ_NODISCARD bool _az_span_is_from_arena(az_arena const* arena, az_span span)
+{
+  uintptr_t const start = (uintptr_t)arena->_internal.buffer;
+  uintptr_t const address = (uintptr_t)az_span_ptr(span);
+  return address >= start && address < start + (uintptr_t)arena->_internal.size;
+}
+
+// Memory is taken from the arena of the request when it has room for it, and from the heap
+// otherwise.
+static AZ_NODISCARD az_result _az_span_malloc(az_arena* arena, int32_t size, az_span* out)
 {
   _az_PRECONDITION_NOT_NULL(out);
 
+  if (arena != NULL && az_result_succeeded(az_arena_allocate(arena, size, out)))
+  {
+    return AZ_OK;
+  }
+
   uint8_t* const p = (uint8_t*)malloc((size_t)size);
   if (p == NULL)
   {
@@ -26,13 +59,19 @@ static AZ_NODISCARD az_result _az_span_malloc(int32_t size, az_span* out)
   return AZ_OK;
 }
 
-static void _az_span_free(az_span* p)
+// Memory taken from an arena is released when the arena is rolled back or reset.
+static void _az_span_free(az_arena const* arena, az_span* p)
 {
   if (p == NULL)
   {
     return;
   }
-  free(az_span_ptr(*p));
+
+  if (arena == NULL || !_az_span_is_from_arena(arena, *p))
+  {
+    free(az_span_ptr(*p));
+  }
+
   *p = AZ_SPAN_EMPTY;
 }
 
@@ -52,6 +91,13 @@ static AZ_NODISCARD az_result _az_http_client_curl_code_to_result(CURLcode code)
     case CURLE_COULDNT_RESOLVE_HOST:
       return AZ_ERROR_HTTP_RESPONSE_COULDNT_RESOLVE_HOST;
 
+    case CURLE_HTTP2:
+    case CURLE_HTTP2_STREAM:
+    case CURLE_SEND_ERROR:
+    case CURLE_RECV_ERROR:
+    case CURLE_GOT_NOTHING:
+      return AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+
     default:
       // let any other error code be an HTTP PAL ERROR
       return AZ_ERROR_HTTP_ADAPTER;
@@ -78,6 +124,319 @@ AZ_NODISCARD AZ_INLINE az_result _az_http_client_curl_done(CURL** pp)
   return AZ_OK;
 }
 
+/**
+ * @brief the state of a request being sent with a curl handle, which must stay alive until the
+ * handle is done with the request.
+ */
+typedef struct
+{
+  CURL* curl;
+  struct curl_slist* headers; // Custom headers set with CURLOPT_HTTPHEADER.
+  az_span post_fields; // A 0-terminated copy of the POST body, set with CURLOPT_POSTFIELDS.
+  az_span upload_body; // The part of the PUT body not yet read by the CURLOPT_READFUNCTION.
+  az_http_request_body_provider const* body_provider; // Streams the body when not NULL.
+  az_http_response* response; // Receives the status line and headers, and the body.
+  az_result body_callback_result; // The failure which made a body callback abort the transfer.
+  az_arena* arena; // The arena of the request, or NULL.
+  az_arena_mark arena_mark; // Where the arena was before the transfer took memory from it.
+} _az_http_client_curl_transfer;
+
+#if AZ_CURL_CONNECTION_POOL_SIZE > 0
+
+#ifdef _WIN32
+typedef SRWLOCK _az_http_client_curl_lock;
+#define _az_HTTP_CLIENT_CURL_LOCK_INIT SRWLOCK_INIT
+
+static void _az_http_client_curl_lock_init(_az_http_client_curl_lock* lock)
+{
+  InitializeSRWLock(lock);
+}
+
+static void _az_http_client_curl_lock_acquire(_az_http_client_curl_lock* lock)
+{
+  AcquireSRWLockExclusive(lock);
+}
+
+static void _az_http_client_curl_lock_release(_az_http_client_curl_lock* lock)
+{
+  ReleaseSRWLockExclusive(lock);
+}
+#else
+typedef pthread_mutex_t _az_http_client_curl_lock;
+#define _az_HTTP_CLIENT_CURL_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+
+static void _az_http_client_curl_lock_init(_az_http_client_curl_lock* lock)
+{
+  (void)pthread_mutex_init(lock, NULL);
+}
+
+static void _az_http_client_curl_lock_acquire(_az_http_client_curl_lock* lock)
+{
+  (void)pthread_mutex_lock(lock);
+}
+
+static void _az_http_client_curl_lock_release(_az_http_client_curl_lock* lock)
+{
+  (void)pthread_mutex_unlock(lock);
+}
+#endif
+
+// The longest `scheme://host:port` which pooled handles are keyed by. Requests to longer ones use
+// a handle of their own, like when the pool is disabled.
+#define _az_HTTP_CLIENT_CURL_POOL_KEY_MAX_SIZE 256
+
+typedef struct
+{
+  CURL* curl;
+  bool is_in_use;
+  uint64_t last_released; // Used to pick the least recently used handle for another host.
+  int32_t key_size;
+  uint8_t key[_az_HTTP_CLIENT_CURL_POOL_KEY_MAX_SIZE];
+} _az_http_client_curl_pooled_handle;
+
+static _az_http_client_curl_lock _az_http_client_curl_pool_lock = _az_HTTP_CLIENT_CURL_LOCK_INIT;
+
+static struct
+{
+  _az_http_client_curl_pooled_handle handles[AZ_CURL_CONNECTION_POOL_SIZE];
+  uint64_t release_count;
+  bool is_initialized;
+  // Lets every pooled handle resume the TLS sessions and reuse the DNS lookups of the others.
+  CURLSH* share;
+  _az_http_client_curl_lock share_locks[CURL_LOCK_DATA_LAST];
+} _az_http_client_curl_pool;
+
+static void _az_http_client_curl_share_lock(
+    CURL* handle,
+    curl_lock_data data,
+    curl_lock_access access,
+    void* userptr)
+{
+  (void)handle;
+  (void)access;
+  (void)userptr;
+  _az_http_client_curl_lock_acquire(&_az_http_client_curl_pool.share_locks[data]);
+}
+
+static void _az_http_client_curl_share_unlock(CURL* handle, curl_lock_data data, void* userptr)
+{
+  (void)handle;
+  (void)userptr;
+  _az_http_client_curl_lock_release(&_az_http_client_curl_pool.share_locks[data]);
+}
+
+/**
+ * @brief closes the connections of every pooled handle which isn't in use when the process exits.
+ */
+static void _az_http_client_curl_pool_cleanup(void)
+{
+  _az_http_client_curl_lock_acquire(&_az_http_client_curl_pool_lock);
+
+  bool is_any_in_use = false;
+  for (int32_t i = 0; i < AZ_CURL_CONNECTION_POOL_SIZE; i++)
+  {
+    _az_http_client_curl_pooled_handle* pooled = &_az_http_client_curl_pool.handles[i];
+    if (pooled->curl != NULL && !pooled->is_in_use)
+    {
+      curl_easy_cleanup(pooled->curl);
+      pooled->curl = NULL;
+    }
+
+    is_any_in_use = is_any_in_use || pooled->is_in_use;
+  }
+
+  if (!is_any_in_use && _az_http_client_curl_pool.share != NULL)
+  {
+    (void)curl_share_cleanup(_az_http_client_curl_pool.share);
+    _az_http_client_curl_pool.share = NULL;
+  }
+
+  _az_http_client_curl_lock_release(&_az_http_client_curl_pool_lock);
+}
+
+/**
+ * @brief sets up the pool on first use. Must be called with the pool lock held.
+ */
+static void _az_http_client_curl_pool_initialize(void)
+{
+  if (_az_http_client_curl_pool.is_initialized)
+  {
+    return;
+  }
+
+  _az_http_client_curl_pool.is_initialized = true;
+  (void)atexit(_az_http_client_curl_pool_cleanup);
+
+  for (int32_t i = 0; i < CURL_LOCK_DATA_LAST; i++)
+  {
+    _az_http_client_curl_lock_init(&_az_http_client_curl_pool.share_locks[i]);
+  }
+
+  // Without the share, pooled handles still reuse their own connections and TLS sessions.
+  CURLSH* share = curl_share_init();
+  if (share != NULL
+      && (curl_share_setopt(share, CURLSHOPT_LOCKFUNC, _az_http_client_curl_share_lock)
+              != CURLSHE_OK
+          || curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, _az_http_client_curl_share_unlock)
+              != CURLSHE_OK
+          || curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK
+          || curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) != CURLSHE_OK))
+  {
+    (void)curl_share_cleanup(share);
+    share = NULL;
+  }
+
+  _az_http_client_curl_pool.share = share;
+}
+
+/**
+ * @brief gets the `scheme://host:port` part of the request url, which pooled handles are keyed by.
+ */
+static AZ_NODISCARD az_span _az_http_client_curl_get_pool_key(az_span url)
+{
+  int32_t authority_start = az_span_find(url, AZ_SPAN_FROM_STR("://"));
+  authority_start = authority_start < 0 ? 0 : authority_start + 3;
+
+  az_span const authority = az_span_slice_to_end(url, authority_start);
+  int32_t authority_size = 0;
+  while (authority_size < az_span_size(authority)
+         && az_span_ptr(authority)[authority_size] != '/'
+         && az_span_ptr(authority)[authority_size] != '?')
+  {
+    authority_size++;
+  }
+
+  return az_span_slice(url, 0, authority_start + authority_size);
+}
+
+/**
+ * @brief returns a handle to the pool, keeping its connections open, or cleans up a handle which
+ * wasn't pooled.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_pool_release(CURL** pp, int32_t pool_index)
+{
+  if (pool_index < 0)
+  {
+    return _az_http_client_curl_done(pp);
+  }
+
+  // Forget the options of this request (which point to its buffers), but not the connections.
+  curl_easy_reset(*pp);
+  *pp = NULL;
+
+  _az_http_client_curl_lock_acquire(&_az_http_client_curl_pool_lock);
+  _az_http_client_curl_pooled_handle* pooled = &_az_http_client_curl_pool.handles[pool_index];
+  pooled->is_in_use = false;
+  pooled->last_released = ++_az_http_client_curl_pool.release_count;
+  _az_http_client_curl_lock_release(&_az_http_client_curl_pool_lock);
+
+  return AZ_OK;
+}
+
+/**
+ * @brief takes a handle out of the pool for a request to the \p request url. An idle handle which
+ * was last used for the same host is preferred, as it can reuse its connection. When every pooled
+ * handle is in use, a handle of its own is created for the request, and \p out_pool_index is -1.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_pool_acquire(
+    az_http_request const* request,
+    CURL** out_curl,
+    int32_t* out_pool_index)
+{
+  az_span url = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_url(request, &url));
+  az_span const key = _az_http_client_curl_get_pool_key(url);
+
+  *out_curl = NULL;
+  *out_pool_index = -1;
+
+  _az_http_client_curl_lock_acquire(&_az_http_client_curl_pool_lock);
+  _az_http_client_curl_pool_initialize();
+
+  int32_t same_host_index = -1;
+  int32_t empty_index = -1;
+  int32_t least_recently_used_index = -1;
+  if (az_span_size(key) <= _az_HTTP_CLIENT_CURL_POOL_KEY_MAX_SIZE)
+  {
+    for (int32_t i = 0; i < AZ_CURL_CONNECTION_POOL_SIZE; i++)
+    {
+      _az_http_client_curl_pooled_handle* pooled = &_az_http_client_curl_pool.handles[i];
+      if (pooled->curl == NULL)
+      {
+        empty_index = empty_index < 0 ? i : empty_index;
+      }
+      else if (!pooled->is_in_use)
+      {
+        if (az_span_is_content_equal(az_span_create(pooled->key, pooled->key_size), key))
+        {
+          same_host_index = i;
+          break;
+        }
+
+        if (least_recently_used_index < 0
+            || pooled->last_released
+                < _az_http_client_curl_pool.handles[least_recently_used_index].last_released)
+        {
+          least_recently_used_index = i;
+        }
+      }
+    }
+  }
+
+  int32_t const index = same_host_index >= 0
+      ? same_host_index
+      : (empty_index >= 0 ? empty_index : least_recently_used_index);
+
+  if (index >= 0)
+  {
+    _az_http_client_curl_pooled_handle* pooled = &_az_http_client_curl_pool.handles[index];
+    if (pooled->curl == NULL)
+    {
+      pooled->curl = curl_easy_init();
+    }
+
+    if (pooled->curl != NULL)
+    {
+      pooled->is_in_use = true;
+      pooled->key_size = az_span_size(key);
+      az_span_copy(AZ_SPAN_FROM_BUFFER(pooled->key), key);
+
+      *out_curl = pooled->curl;
+      *out_pool_index = index;
+    }
+  }
+
+  CURLSH* const share = _az_http_client_curl_pool.share;
+  _az_http_client_curl_lock_release(&_az_http_client_curl_pool_lock);
+
+  if (*out_curl == NULL)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_curl_init(out_curl));
+    if (*out_curl == NULL)
+    {
+      return AZ_ERROR_OUT_OF_MEMORY;
+    }
+  }
+
+  if (share != NULL)
+  {
+    // Options are cleared every time a handle goes back to the pool, so this is set again.
+    CURLcode const code = curl_easy_setopt(*out_curl, CURLOPT_SHARE, share);
+    if (code != CURLE_OK)
+    {
+      // Give the handle back, so that its slot of the pool isn't lost.
+      int32_t const pool_index = *out_pool_index;
+      *out_pool_index = -1;
+      _az_RETURN_IF_FAILED(_az_http_client_curl_pool_release(out_curl, pool_index));
+      return _az_http_client_curl_code_to_result(code);
+    }
+  }
+
+  return AZ_OK;
+}
+
+#endif // AZ_CURL_CONNECTION_POOL_SIZE > 0
+
 /**
  * @brief writes a header key and value to a buffer as a 0-terminated string and using a separator
  * span in between. Returns error as soon as any of the write operations fails
@@ -113,11 +472,10 @@ _az_http_client_curl_slist_append(struct curl_slist** ref_list, char const* str)
   _az_PRECONDITION_NOT_NULL(ref_list);
   _az_PRECONDITION_NOT_NULL(str);
 
+  // The list is left as it was on failure: the transfer frees it once it is cleaned up.
   struct curl_slist* const new_list = curl_slist_append(*ref_list, str);
   if (new_list == NULL)
   {
-    // free any previous allocates custom headers
-    curl_slist_free_all(*ref_list);
     return AZ_ERROR_HTTP_ADAPTER;
   }
 
@@ -134,13 +492,15 @@ _az_http_client_curl_slist_append(struct curl_slist** ref_list, char const* str)
  * @param header_value http header value
  * @param ref_list list of headers as curl list
  * @param separator a symbol to be used between key and value for a header
+ * @param arena the arena of the request to take the buffer from, or NULL
  * @return az_result
  */
 static AZ_NODISCARD az_result _az_http_client_curl_add_header_to_curl_list(
     az_span header_name,
     az_span header_value,
     struct curl_slist** ref_list,
-    az_span separator)
+    az_span separator,
+    az_arena* arena)
 {
   _az_PRECONDITION_NOT_NULL(ref_list);
 
@@ -150,7 +510,7 @@ static AZ_NODISCARD az_result _az_http_client_curl_add_header_to_curl_list(
     int32_t const buffer_size = az_span_size(header_name) + az_span_size(separator)
         + az_span_size(header_value) + 1 /*one for 0 terminated*/;
 
-    _az_RETURN_IF_FAILED(_az_span_malloc(buffer_size, &writable_buffer));
+    _az_RETURN_IF_FAILED(_az_span_malloc(arena, buffer_size, &writable_buffer));
   }
 
   // write buffer
@@ -165,7 +525,7 @@ static AZ_NODISCARD az_result _az_http_client_curl_add_header_to_curl_list(
   }
 
   // at any case, error or OK, free the allocated memory
-  _az_span_free(&writable_buffer);
+  _az_span_free(arena, &writable_buffer);
   return result;
 }
 
@@ -213,10 +573,13 @@ _az_http_client_curl_add_expect_header(CURL* ref_curl, struct curl_slist** ref_l
  *
  * @param request an http builder request reference
  * @param ref_headers list of headers in curl specific list
+ * @param arena the arena of the request to take buffers from, or NULL
  * @return az_result
  */
-static AZ_NODISCARD az_result
-_az_http_client_curl_build_headers(az_http_request const* request, struct curl_slist** ref_headers)
+static AZ_NODISCARD az_result _az_http_client_curl_build_headers(
+    az_http_request const* request,
+    struct curl_slist** ref_headers,
+    az_arena* arena)
 {
   _az_PRECONDITION_NOT_NULL(request);
 
@@ -226,7 +589,7 @@ _az_http_client_curl_build_headers(az_http_request const* request, struct curl_s
   {
     _az_RETURN_IF_FAILED(az_http_request_get_header(request, offset, &header_name, &header_value));
     _az_RETURN_IF_FAILED(_az_http_client_curl_add_header_to_curl_list(
-        header_name, header_value, ref_headers, AZ_SPAN_FROM_STR(":")));
+        header_name, header_value, ref_headers, AZ_SPAN_FROM_STR(":"), arena));
   }
 
   return AZ_OK;
@@ -285,62 +648,166 @@ static size_t _az_http_client_curl_write_to_span(
 }
 
 /**
- * handles GET request
+ * @brief the CURLOPT_WRITEFUNCTION, which writes the response body with
+ * #az_http_response_append_body(), so that it can go to the body sink of the response.
+ *
+ * @return the number of bytes received, or anything else to abort the transfer.
  */
-static AZ_NODISCARD az_result _az_http_client_curl_send_get_request(CURL* ref_curl)
+static size_t _az_http_client_curl_write_body(
+    char* contents,
+    size_t size,
+    size_t nmemb,
+    void* userp)
 {
-  _az_PRECONDITION_NOT_NULL(ref_curl);
+  size_t const expected_size = size * nmemb;
+  _az_http_client_curl_transfer* const transfer = (_az_http_client_curl_transfer*)userp;
 
-  // send
-  _az_RETURN_IF_CURL_FAILED(curl_easy_perform(ref_curl));
+  az_result const result = az_http_response_append_body(
+      transfer->response, az_span_create((uint8_t*)contents, (int32_t)expected_size));
+  if (az_result_failed(result))
+  {
+    // Running out of buffer space is reported as CURLE_WRITE_ERROR, like for the headers.
+    if (result != AZ_ERROR_NOT_ENOUGH_SPACE)
+    {
+      transfer->body_callback_result = result;
+    }
 
-  return AZ_OK;
+    return expected_size + 1;
+  }
+
+  return expected_size;
 }
 
 /**
  * handles DELETE request
  */
-static AZ_NODISCARD az_result _az_http_client_curl_send_delete_request(CURL* ref_curl)
+static AZ_NODISCARD az_result _az_http_client_curl_setup_delete_request(CURL* ref_curl)
 {
   _az_PRECONDITION_NOT_NULL(ref_curl);
 
   _az_RETURN_IF_FAILED(_az_http_client_curl_code_to_result(
       curl_easy_setopt(ref_curl, CURLOPT_CUSTOMREQUEST, "DELETE")));
 
-  _az_RETURN_IF_FAILED(_az_http_client_curl_code_to_result(curl_easy_perform(ref_curl)));
-
   return AZ_OK;
 }
 
 /**
- * handles POST request. It handles seting up a body for request
+ * @brief the CURLOPT_READFUNCTION of a transfer whose body is streamed from an
+ * #az_http_request_body_provider. The body is read straight into the curl upload buffer.
+ *
+ * @return the number of bytes read, 0 once the body was read, or CURL_READFUNC_ABORT if the body
+ * provider failed.
+ */
+static size_t _az_http_client_curl_body_provider_read_callback(
+    char* dst,
+    size_t size,
+    size_t nmemb,
+    void* userdata)
+{
+  _az_http_client_curl_transfer* const transfer = (_az_http_client_curl_transfer*)userdata;
+  az_http_request_body_provider const* const body_provider = transfer->body_provider;
+
+  size_t const dst_size = size * nmemb;
+  int32_t const dst_buffer_size = dst_size > INT32_MAX ? INT32_MAX : (int32_t)dst_size;
+  if (dst_buffer_size < 1)
+  {
+    return CURL_READFUNC_ABORT;
+  }
+
+  int32_t bytes_read = 0;
+  az_result const result = body_provider->read(
+      body_provider->user_context, az_span_create((uint8_t*)dst, dst_buffer_size), &bytes_read);
+  if (az_result_failed(result) || bytes_read < 0 || bytes_read > dst_buffer_size)
+  {
+    transfer->body_callback_result = az_result_failed(result) ? result : AZ_ERROR_ARG;
+    return CURL_READFUNC_ABORT;
+  }
+
+  return (size_t)bytes_read;
+}
+
+/**
+ * @brief the CURLOPT_SEEKFUNCTION of a transfer whose body is streamed from an
+ * #az_http_request_body_provider, which curl calls when it has to send the body again on its own,
+ * such as over a new connection. Only rewinding to the start of the body is supported.
+ */
+static int _az_http_client_curl_body_provider_seek_callback(
+    void* userdata,
+    curl_off_t offset,
+    int origin)
+{
+  _az_http_client_curl_transfer* const transfer = (_az_http_client_curl_transfer*)userdata;
+  az_http_request_body_provider const* const body_provider = transfer->body_provider;
+
+  if (offset != 0 || origin != SEEK_SET || body_provider->rewind == NULL)
+  {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+
+  az_result const result = body_provider->rewind(body_provider->user_context);
+  if (az_result_failed(result))
+  {
+    transfer->body_callback_result = result;
+    return CURL_SEEKFUNC_FAIL;
+  }
+
+  return CURL_SEEKFUNC_OK;
+}
+
+/**
+ * @brief makes curl pull the body of the transfer from its #az_http_request_body_provider.
  */
 static AZ_NODISCARD az_result
-_az_http_client_curl_send_post_request(CURL* ref_curl, az_http_request const* request)
+_az_http_client_curl_setup_body_provider(_az_http_client_curl_transfer* ref_transfer)
 {
-  _az_PRECONDITION_NOT_NULL(ref_curl);
+  CURL* const ref_curl = ref_transfer->curl;
+
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(
+      ref_curl, CURLOPT_READFUNCTION, _az_http_client_curl_body_provider_read_callback));
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_READDATA, (void*)ref_transfer));
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(
+      ref_curl, CURLOPT_SEEKFUNCTION, _az_http_client_curl_body_provider_seek_callback));
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_SEEKDATA, (void*)ref_transfer));
+
+  return AZ_OK;
+}
+
+/**
+ * handles POST request. It handles seting up a body for request, which is kept by the transfer
+ * until the request is sent.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_setup_post_request(
+    _az_http_client_curl_transfer* ref_transfer,
+    az_http_request const* request)
+{
+  _az_PRECONDITION_NOT_NULL(ref_transfer);
   _az_PRECONDITION_NOT_NULL(request);
 
+  if (ref_transfer->body_provider != NULL)
+  {
+    _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_transfer->curl, CURLOPT_POST, 1L));
+    _az_RETURN_IF_FAILED(_az_http_client_curl_setup_body_provider(ref_transfer));
+
+    // A length of -1 sends the body with chunked transfer encoding.
+    _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(
+        ref_transfer->curl,
+        CURLOPT_POSTFIELDSIZE_LARGE,
+        (curl_off_t)ref_transfer->body_provider->length));
+    return AZ_OK;
+  }
+
   // Method
   az_span request_body = { 0 };
   _az_RETURN_IF_FAILED(az_http_request_get_body(request, &request_body));
-  az_span body = { 0 };
   int32_t const required_length = az_span_size(request_body) + az_span_size(AZ_SPAN_FROM_STR("\0"));
 
-  _az_RETURN_IF_FAILED(_az_span_malloc(required_length, &body));
+  _az_RETURN_IF_FAILED(
+      _az_span_malloc(ref_transfer->arena, required_length, &ref_transfer->post_fields));
 
-  char* b = (char*)az_span_ptr(body);
+  char* b = (char*)az_span_ptr(ref_transfer->post_fields);
   az_span_to_str(b, required_length, request_body);
 
-  az_result res_code
-      = _az_http_client_curl_code_to_result(curl_easy_setopt(ref_curl, CURLOPT_POSTFIELDS, b));
-  if (az_result_succeeded(res_code))
-  {
-    res_code = _az_http_client_curl_code_to_result(curl_easy_perform(ref_curl));
-  }
-
-  _az_span_free(&body);
-  _az_RETURN_IF_FAILED(res_code);
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_transfer->curl, CURLOPT_POSTFIELDS, b));
 
   return AZ_OK;
 }
@@ -402,33 +869,42 @@ static int32_t _az_http_client_curl_upload_read_callback(
 }
 
 /**
- * Perform an UPLOAD or PUT request.
+ * Set up an UPLOAD or PUT request.
  * As of CURL 7.12.1 CURLOPT_PUT is deprecated.  PUT requests should be made using CURLOPT_UPLOAD
  */
-static AZ_NODISCARD az_result
-_az_http_client_curl_send_upload_request(CURL* ref_curl, az_http_request const* request)
+static AZ_NODISCARD az_result _az_http_client_curl_setup_upload_request(
+    _az_http_client_curl_transfer* ref_transfer,
+    az_http_request const* request)
 {
-  _az_PRECONDITION_NOT_NULL(ref_curl);
+  _az_PRECONDITION_NOT_NULL(ref_transfer);
   _az_PRECONDITION_NOT_NULL(request);
 
-  az_span body = { 0 };
-  _az_RETURN_IF_FAILED(az_http_request_get_body(request, &body));
-
+  CURL* ref_curl = ref_transfer->curl;
   _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_UPLOAD, 1L));
+
+  if (ref_transfer->body_provider != NULL)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_curl_setup_body_provider(ref_transfer));
+
+    // A length of -1 sends the body with chunked transfer encoding.
+    _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(
+        ref_curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)ref_transfer->body_provider->length));
+    return AZ_OK;
+  }
+
+  az_span* body = &ref_transfer->upload_body;
+  _az_RETURN_IF_FAILED(az_http_request_get_body(request, body));
+
   _az_RETURN_IF_CURL_FAILED(
       curl_easy_setopt(ref_curl, CURLOPT_READFUNCTION, _az_http_client_curl_upload_read_callback));
 
   // Setup the request to pass body into the read callback
-  // The read callback receives the address of body
-  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_READDATA, &body));
+  // The read callback receives the address of body, which lives as long as the transfer
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_READDATA, body));
 
   // Set the size of the upload
   _az_RETURN_IF_CURL_FAILED(
-      curl_easy_setopt(ref_curl, CURLOPT_INFILESIZE, (curl_off_t)az_span_size(body)));
-
-  // Do the curl work
-  // curl_easy_perform does not return until the CURLOPT_READFUNCTION callbacks complete.
-  _az_RETURN_IF_CURL_FAILED(curl_easy_perform(ref_curl));
+      curl_easy_setopt(ref_curl, CURLOPT_INFILESIZE, (curl_off_t)az_span_size(*body)));
 
   return AZ_OK;
 }
@@ -439,12 +915,14 @@ _az_http_client_curl_send_upload_request(CURL* ref_curl, az_http_request const*
  * @param ref_curl curl specific structure to send a request
  * @param ref_list curl headers list
  * @param request an http request
+ * @param arena the arena of the request to take buffers from, or NULL
  * @return az_result
  */
 static AZ_NODISCARD az_result _az_http_client_curl_setup_headers(
     CURL* ref_curl,
     struct curl_slist** ref_list,
-    az_http_request const* request)
+    az_http_request const* request,
+    az_arena* arena)
 {
   _az_PRECONDITION_NOT_NULL(ref_curl);
   _az_PRECONDITION_NOT_NULL(request);
@@ -456,7 +934,7 @@ static AZ_NODISCARD az_result _az_http_client_curl_setup_headers(
   }
 
   // build headers into a slist as curl is expecting
-  _az_RETURN_IF_FAILED(_az_http_client_curl_build_headers(request, ref_list));
+  _az_RETURN_IF_FAILED(_az_http_client_curl_build_headers(request, ref_list, arena));
   // set all headers from slist
   _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_HTTPHEADER, *ref_list));
 
@@ -468,10 +946,11 @@ static AZ_NODISCARD az_result _az_http_client_curl_setup_headers(
  *
  * @param ref_curl specific curl struct to send a request
  * @param request an az http request builder holding all data to send request
+ * @param arena the arena of the request to take the buffer from, or NULL
  * @return az_result
  */
 static AZ_NODISCARD az_result
-_az_http_client_curl_setup_url(CURL* ref_curl, az_http_request const* request)
+_az_http_client_curl_setup_url(CURL* ref_curl, az_http_request const* request, az_arena* arena)
 {
   _az_PRECONDITION_NOT_NULL(ref_curl);
   _az_PRECONDITION_NOT_NULL(request);
@@ -488,7 +967,7 @@ _az_http_client_curl_setup_url(CURL* ref_curl, az_http_request const* request)
     int32_t const url_final_size = request_url_size + 1;
 
     // allocate buffer to add \0
-    _az_RETURN_IF_FAILED(_az_span_malloc(url_final_size, &writable_buffer));
+    _az_RETURN_IF_FAILED(_az_span_malloc(arena, url_final_size, &writable_buffer));
   }
 
   // write url in buffer (will add \0 at the end)
@@ -504,23 +983,27 @@ _az_http_client_curl_setup_url(CURL* ref_curl, az_http_request const* request)
   // free used buffer before anything else
   // NOLINTNEXTLINE(clang-analyzer-security.insecureAPI.DeprecatedOrUnsafeBufferHandling)
   memset(az_span_ptr(writable_buffer), 0, (size_t)az_span_size(writable_buffer));
-  _az_span_free(&writable_buffer);
+  _az_span_free(arena, &writable_buffer);
 
   return result;
 }
 
-// TODO: Fix up the documentation here.
 /**
- * @brief set url the response redirection to user buffer
+ * @brief makes curl write the status line and headers of the response into its buffer, and hand
+ * the body to #_az_http_client_curl_write_body().
  *
- * @param ref_curl specific curl structure used to send http request
+ * @param ref_transfer the transfer whose curl handle receives the response
  * @param response an http response object which will hold all the HTTP response
  * @return az_result
  */
-static AZ_NODISCARD az_result
-_az_http_client_curl_setup_response_redirect(CURL* ref_curl, az_http_response* response)
+static AZ_NODISCARD az_result _az_http_client_curl_setup_response_redirect(
+    _az_http_client_curl_transfer* ref_transfer,
+    az_http_response* response)
 {
-  _az_PRECONDITION_NOT_NULL(ref_curl);
+  _az_PRECONDITION_NOT_NULL(ref_transfer);
+
+  CURL* const ref_curl = ref_transfer->curl;
+  ref_transfer->response = response;
 
   _az_RETURN_IF_CURL_FAILED(
       curl_easy_setopt(ref_curl, CURLOPT_HEADERFUNCTION, _az_http_client_curl_write_to_span));
@@ -528,71 +1011,159 @@ _az_http_client_curl_setup_response_redirect(CURL* ref_curl, az_http_response* r
   _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_HEADERDATA, (void*)response));
 
   _az_RETURN_IF_CURL_FAILED(
-      curl_easy_setopt(ref_curl, CURLOPT_WRITEFUNCTION, _az_http_client_curl_write_to_span));
+      curl_easy_setopt(ref_curl, CURLOPT_WRITEFUNCTION, _az_http_client_curl_write_body));
 
-  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_WRITEDATA, (void*)response));
+  _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_WRITEDATA, (void*)ref_transfer));
 
   return AZ_OK;
 }
 
 /**
- * @brief use this function to group all the actions that we do with CURL so we can clean it after
- * it no matter is there is an error at any step.
+ * @brief sets every option of \p ref_transfer's curl handle needed to send \p request, without
+ * sending it. Whatever the result, the transfer must be cleaned up with
+ * #_az_http_client_curl_transfer_cleanup().
  *
- * @param ref_curl curl specific structure used to send an http request
+ * @param ref_transfer the transfer holding the curl handle and the data it refers to while sending
  * @param request http builder with specific data to build an http request
  * @param ref_response pre-allocated buffer where to write http response
 
- * @return AZ_OK if request was sent and a response was received
+ * @return AZ_OK if the request is ready to be sent
  */
-static AZ_NODISCARD az_result _az_http_client_curl_send_request_impl_process(
-    CURL* ref_curl,
+static AZ_NODISCARD az_result _az_http_client_curl_setup_transfer(
+    _az_http_client_curl_transfer* ref_transfer,
     az_http_request const* request,
     az_http_response* ref_response)
 {
-  _az_PRECONDITION_NOT_NULL(ref_curl);
+  _az_PRECONDITION_NOT_NULL(ref_transfer);
   _az_PRECONDITION_NOT_NULL(request);
 
-  az_result result = AZ_ERROR_ARG;
+  CURL* ref_curl = ref_transfer->curl;
 
-  struct curl_slist* list = NULL;
-  _az_RETURN_IF_FAILED(_az_http_client_curl_setup_headers(ref_curl, &list, request));
+  _az_RETURN_IF_FAILED(az_http_request_get_body_provider(request, &ref_transfer->body_provider));
+  ref_transfer->body_callback_result = AZ_OK;
 
-  _az_RETURN_IF_FAILED(_az_http_client_curl_setup_url(ref_curl, request));
+  ref_transfer->arena = az_arena_from_context(request->_internal.context);
+  if (ref_transfer->arena != NULL)
+  {
+    ref_transfer->arena_mark = az_arena_get_mark(ref_transfer->arena);
+  }
 
-  _az_RETURN_IF_FAILED(_az_http_client_curl_setup_response_redirect(ref_curl, ref_response));
+  az_result result = _az_http_client_curl_setup_headers(
+      ref_curl, &ref_transfer->headers, request, ref_transfer->arena);
+  if (az_result_succeeded(result))
+  {
+    result = _az_http_client_curl_setup_url(ref_curl, request, ref_transfer->arena);
+  }
+
+  // curl copies the headers and the URL, so the arena gets their buffers back once they are set,
+  // or failed to be. The POST fields are then all the transfer holds in the arena.
+  if (ref_transfer->arena != NULL)
+  {
+    az_arena_rollback(ref_transfer->arena, ref_transfer->arena_mark);
+  }
+
+  _az_RETURN_IF_FAILED(result);
+
+  _az_RETURN_IF_FAILED(_az_http_client_curl_setup_response_redirect(ref_transfer, ref_response));
 
   az_http_method method;
   _az_RETURN_IF_FAILED(az_http_request_get_method(request, &method));
 
   if (az_span_is_content_equal(method, az_http_method_get()))
   {
-    result = _az_http_client_curl_send_get_request(ref_curl);
+    return AZ_OK;
   }
   else if (az_span_is_content_equal(method, az_http_method_delete()))
   {
-    result = _az_http_client_curl_send_delete_request(ref_curl);
+    return _az_http_client_curl_setup_delete_request(ref_curl);
   }
   else if (az_span_is_content_equal(method, az_http_method_post()))
   {
-    _az_RETURN_IF_FAILED(_az_http_client_curl_add_expect_header(ref_curl, &list));
-    result = _az_http_client_curl_send_post_request(ref_curl, request);
+    _az_RETURN_IF_FAILED(_az_http_client_curl_add_expect_header(ref_curl, &ref_transfer->headers));
+    return _az_http_client_curl_setup_post_request(ref_transfer, request);
   }
   else if (az_span_is_content_equal(method, az_http_method_put()))
   {
     // As of CURL 7.12.1 CURLOPT_PUT is deprecated.  PUT requests should be made using
     // CURLOPT_UPLOAD
-    _az_RETURN_IF_FAILED(_az_http_client_curl_add_expect_header(ref_curl, &list));
-    result = _az_http_client_curl_send_upload_request(ref_curl, request);
+    _az_RETURN_IF_FAILED(_az_http_client_curl_add_expect_header(ref_curl, &ref_transfer->headers));
+    return _az_http_client_curl_setup_upload_request(ref_transfer, request);
   }
-  else
+
+  return AZ_ERROR_HTTP_INVALID_METHOD_VERB;
+}
+
+/**
+ * @brief gets the result of a transfer which curl is done with. A failure of the request body
+ * provider, or of the response body sink, is reported as is, rather than as the transfer being
+ * aborted.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_transfer_get_result(
+    _az_http_client_curl_transfer const* transfer,
+    CURLcode code)
+{
+  if (az_result_failed(transfer->body_callback_result))
   {
-    return AZ_ERROR_HTTP_INVALID_METHOD_VERB;
+    return transfer->body_callback_result;
   }
 
+  return _az_http_client_curl_code_to_result(code);
+}
+
+/**
+ * @brief frees the data a transfer kept for its curl handle, once the request is done.
+ */
+static void _az_http_client_curl_transfer_cleanup(_az_http_client_curl_transfer* ref_transfer)
+{
   // Clean custom headers previously appended
-  curl_slist_free_all(list);
+  curl_slist_free_all(ref_transfer->headers);
+  ref_transfer->headers = NULL;
+
+  // Give the arena back the POST fields, so that each retry reuses the same bytes. Transfers in
+  // flight together on the same arena don't complete in the order they were set up, so this is
+  // only done when nothing was allocated after them: the bytes of a transfer which completes ahead
+  // of those allocated after it stay taken until the arena is reset, since curl may still be
+  // sending the POST fields of the others.
+  az_arena* const arena = ref_transfer->arena;
+  if (arena != NULL && _az_span_is_from_arena(arena, ref_transfer->post_fields)
+      && az_span_ptr(ref_transfer->post_fields) + az_span_size(ref_transfer->post_fields)
+          == arena->_internal.buffer + arena->_internal.used)
+  {
+    az_arena_rollback(arena, ref_transfer->arena_mark);
+  }
+
+  _az_span_free(arena, &ref_transfer->post_fields);
+  ref_transfer->arena = NULL;
+}
 
+/**
+ * @brief use this function to group all the actions that we do with CURL so we can clean it after
+ * it no matter is there is an error at any step.
+ *
+ * @param ref_curl curl specific structure used to send an http request
+ * @param request http builder with specific data to build an http request
+ * @param ref_response pre-allocated buffer where to write http response
+
+ * @return AZ_OK if request was sent and a response was received
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_send_request_impl_process(
+    CURL* ref_curl,
+    az_http_request const* request,
+    az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_curl);
+  _az_PRECONDITION_NOT_NULL(request);
+
+  _az_http_client_curl_transfer transfer = { .curl = ref_curl };
+
+  az_result result = _az_http_client_curl_setup_transfer(&transfer, request, ref_response);
+  if (az_result_succeeded(result))
+  {
+    // curl_easy_perform does not return until the CURLOPT_READFUNCTION callbacks complete.
+    result = _az_http_client_curl_transfer_get_result(&transfer, curl_easy_perform(ref_curl));
+  }
+
+  _az_http_client_curl_transfer_cleanup(&transfer);
   return result;
 }
 
@@ -611,6 +1182,18 @@ az_http_client_send_request(az_http_request const* request, az_http_response* re
 
   CURL* curl = NULL;
 
+#if AZ_CURL_CONNECTION_POOL_SIZE > 0
+  // take a handle from the pool, which may already be connected to the host
+  int32_t pool_index = -1;
+  _az_RETURN_IF_FAILED(_az_http_client_curl_pool_acquire(request, &curl, &pool_index));
+
+  // process request
+  az_result process_result
+      = _az_http_client_curl_send_request_impl_process(curl, request, ref_response);
+
+  // no matter if error or not, give the handle back, so its connection can be reused
+  _az_RETURN_IF_FAILED(_az_http_client_curl_pool_release(&curl, pool_index));
+#else
   // init curl
   _az_RETURN_IF_FAILED(_az_http_client_curl_init(&curl));
 
@@ -620,6 +1203,319 @@ az_http_client_send_request(az_http_request const* request, az_http_response* re
 
   // no matter if error or not, call curl done before returning to let curl clean everything
   _az_RETURN_IF_FAILED(_az_http_client_curl_done(&curl));
+#endif // AZ_CURL_CONNECTION_POOL_SIZE > 0
 
   return process_result;
 }
+
+/**
+ * @brief selects the HTTP version of a transfer sent by an #az_http_client_async.
+ *
+ * @details HTTP/2 is only negotiated over TLS. There, a transfer waits for a connection to the same
+ * host which is still being set up, so that it can be multiplexed over it instead of opening one
+ * more connection.
+ */
+static AZ_NODISCARD az_result _az_http_client_curl_async_setup_http_version(
+    CURL* ref_curl,
+    az_http_request const* request,
+    bool enable_http2)
+{
+  if (!enable_http2)
+  {
+    _az_RETURN_IF_CURL_FAILED(
+        curl_easy_setopt(ref_curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1));
+    return AZ_OK;
+  }
+
+  _az_RETURN_IF_CURL_FAILED(
+      curl_easy_setopt(ref_curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS));
+
+  az_span url = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_url(request, &url));
+  az_span const https_scheme = AZ_SPAN_FROM_STR("https://");
+  if (az_span_size(url) >= az_span_size(https_scheme)
+      && az_span_is_content_equal_ignoring_case(
+          az_span_slice(url, 0, az_span_size(https_scheme)), https_scheme))
+  {
+    _az_RETURN_IF_CURL_FAILED(curl_easy_setopt(ref_curl, CURLOPT_PIPEWAIT, 1L));
+  }
+
+  return AZ_OK;
+}
+
+/**
+ * @brief a request submitted to an #az_http_client_async, linked into its list of transfers.
+ */
+typedef struct _az_http_client_curl_async_transfer
+{
+  _az_http_client_curl_transfer transfer;
+  az_http_request const* request;
+  az_http_response* response;
+  az_http_client_async_callback callback;
+  void* user_context;
+  struct _az_http_client_curl_async_transfer* next;
+} _az_http_client_curl_async_transfer;
+
+AZ_NODISCARD az_result az_http_client_async_init(
+    az_http_client_async* out_client,
+    az_http_client_async_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_client);
+
+  az_http_client_async_options const client_options
+      = options == NULL ? az_http_client_async_options_default() : *options;
+  _az_PRECONDITION(client_options.max_concurrent_streams >= 0);
+  _az_PRECONDITION(client_options.max_host_connections >= 0);
+
+  CURLM* const multi = curl_multi_init();
+  if (multi == NULL)
+  {
+    return AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  // Without HTTP/2, each request in flight gets its own connection.
+  bool failed = curl_multi_setopt(
+                    multi,
+                    CURLMOPT_PIPELINING,
+                    client_options.enable_http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING)
+      != CURLM_OK;
+  failed = failed
+      || curl_multi_setopt(
+             multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)client_options.max_host_connections)
+          != CURLM_OK;
+#if LIBCURL_VERSION_NUM >= 0x074300 // CURLMOPT_MAX_CONCURRENT_STREAMS was added in 7.67.0
+  if (client_options.enable_http2 && client_options.max_concurrent_streams > 0)
+  {
+    failed = failed
+        || curl_multi_setopt(
+               multi, CURLMOPT_MAX_CONCURRENT_STREAMS, (long)client_options.max_concurrent_streams)
+            != CURLM_OK;
+  }
+#endif // LIBCURL_VERSION_NUM >= 0x074300
+
+  if (failed)
+  {
+    (void)curl_multi_cleanup(multi);
+    return AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  *out_client = (az_http_client_async){
+    ._internal = {
+      .multi_handle = multi,
+      .transfers = NULL,
+      .transfer_count = 0,
+      .options = client_options,
+    },
+  };
+
+  return AZ_OK;
+}
+
+AZ_NODISCARD az_result az_http_client_async_submit(
+    az_http_client_async* ref_client,
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_http_client_async_callback callback,
+    void* user_context)
+{
+  _az_PRECONDITION_NOT_NULL(ref_client);
+  _az_PRECONDITION_NOT_NULL(ref_client->_internal.multi_handle);
+  _az_PRECONDITION_NOT_NULL(request);
+  _az_PRECONDITION_NOT_NULL(ref_response);
+  _az_PRECONDITION_NOT_NULL(callback);
+
+  _az_http_client_curl_async_transfer* const async_transfer = (_az_http_client_curl_async_transfer*)
+      calloc(1, sizeof(_az_http_client_curl_async_transfer));
+  if (async_transfer == NULL)
+  {
+    return AZ_ERROR_OUT_OF_MEMORY;
+  }
+
+  _az_http_client_curl_transfer* const transfer = &async_transfer->transfer;
+  transfer->post_fields = AZ_SPAN_EMPTY;
+  transfer->upload_body = AZ_SPAN_EMPTY;
+  transfer->curl = curl_easy_init();
+  if (transfer->curl == NULL)
+  {
+    free(async_transfer);
+    return AZ_ERROR_OUT_OF_MEMORY;
+  }
+
+  az_result result = _az_http_client_curl_setup_transfer(transfer, request, ref_response);
+  if (az_result_succeeded(result))
+  {
+    result = _az_http_client_curl_code_to_result(
+        curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, (void*)async_transfer));
+  }
+
+  if (az_result_succeeded(result))
+  {
+    result = _az_http_client_curl_async_setup_http_version(
+        transfer->curl, request, ref_client->_internal.options.enable_http2);
+  }
+
+  if (az_result_succeeded(result)
+      && curl_multi_add_handle((CURLM*)ref_client->_internal.multi_handle, transfer->curl)
+          != CURLM_OK)
+  {
+    result = AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  if (az_result_failed(result))
+  {
+    _az_http_client_curl_transfer_cleanup(transfer);
+    curl_easy_cleanup(transfer->curl);
+    free(async_transfer);
+    return result;
+  }
+
+  async_transfer->request = request;
+  async_transfer->response = ref_response;
+  async_transfer->callback = callback;
+  async_transfer->user_context = user_context;
+  async_transfer->next = (_az_http_client_curl_async_transfer*)ref_client->_internal.transfers;
+  ref_client->_internal.transfers = async_transfer;
+  ref_client->_internal.transfer_count++;
+
+  return AZ_OK;
+}
+
+/**
+ * @brief takes a transfer out of the client, releases it, and then reports its result.
+ */
+static void _az_http_client_curl_async_complete(
+    az_http_client_async* ref_client,
+    _az_http_client_curl_async_transfer* async_transfer,
+    az_result result)
+{
+  _az_http_client_curl_async_transfer** link
+      = (_az_http_client_curl_async_transfer**)&ref_client->_internal.transfers;
+  while (*link != async_transfer)
+  {
+    link = &(*link)->next;
+  }
+  *link = async_transfer->next;
+  ref_client->_internal.transfer_count--;
+
+  CURL* const curl = async_transfer->transfer.curl;
+  (void)curl_multi_remove_handle((CURLM*)ref_client->_internal.multi_handle, curl);
+  _az_http_client_curl_transfer_cleanup(&async_transfer->transfer);
+  curl_easy_cleanup(curl);
+
+  // The transfer is freed before the callback, which may submit another request.
+  _az_http_client_curl_async_transfer const completed = *async_transfer;
+  free(async_transfer);
+
+  completed.callback(completed.request, completed.response, result, completed.user_context);
+}
+
+/**
+ * @brief reports every transfer which curl is done with, and returns how many there were.
+ */
+static int32_t _az_http_client_curl_async_complete_done(az_http_client_async* ref_client)
+{
+  CURLM* const multi = (CURLM*)ref_client->_internal.multi_handle;
+  int32_t completed_count = 0;
+
+  CURLMsg* message = NULL;
+  int messages_left = 0;
+  while ((message = curl_multi_info_read(multi, &messages_left)) != NULL)
+  {
+    if (message->msg != CURLMSG_DONE)
+    {
+      continue;
+    }
+
+    _az_http_client_curl_async_transfer* async_transfer = NULL;
+    if (curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char**)&async_transfer)
+            != CURLE_OK
+        || async_transfer == NULL)
+    {
+      continue;
+    }
+
+    _az_http_client_curl_async_complete(
+        ref_client,
+        async_transfer,
+        _az_http_client_curl_transfer_get_result(&async_transfer->transfer, message->data.result));
+    completed_count++;
+  }
+
+  return completed_count;
+}
+
+AZ_NODISCARD az_result az_http_client_async_poll(
+    az_http_client_async* ref_client,
+    int32_t timeout_msec,
+    int32_t* out_in_flight_count)
+{
+  _az_PRECONDITION_NOT_NULL(ref_client);
+  _az_PRECONDITION_NOT_NULL(ref_client->_internal.multi_handle);
+  _az_PRECONDITION(timeout_msec >= 0);
+
+  CURLM* const multi = (CURLM*)ref_client->_internal.multi_handle;
+  int running_count = 0;
+
+  if (ref_client->_internal.transfer_count > 0)
+  {
+    if (curl_multi_perform(multi, &running_count) != CURLM_OK)
+    {
+      return AZ_ERROR_HTTP_ADAPTER;
+    }
+
+    // Only wait for the network when there was nothing to report yet.
+    if (_az_http_client_curl_async_complete_done(ref_client) == 0
+        && ref_client->_internal.transfer_count > 0)
+    {
+      if (curl_multi_wait(multi, NULL, 0, (int)timeout_msec, NULL) != CURLM_OK
+          || curl_multi_perform(multi, &running_count) != CURLM_OK)
+      {
+        return AZ_ERROR_HTTP_ADAPTER;
+      }
+
+      (void)_az_http_client_curl_async_complete_done(ref_client);
+    }
+  }
+
+  // Cancel the requests whose context expired while they were in flight.
+  int64_t const now = az_platform_clock_msec();
+  _az_http_client_curl_async_transfer* async_transfer
+      = (_az_http_client_curl_async_transfer*)ref_client->_internal.transfers;
+  while (async_transfer != NULL)
+  {
+    _az_http_client_curl_async_transfer* const next = async_transfer->next;
+    az_context const* const context = async_transfer->request->_internal.context;
+    if (context != NULL && az_context_has_expired(context, now))
+    {
+      _az_http_client_curl_async_complete(ref_client, async_transfer, AZ_ERROR_CANCELED);
+    }
+
+    async_transfer = next;
+  }
+
+  if (out_in_flight_count != NULL)
+  {
+    *out_in_flight_count = ref_client->_internal.transfer_count;
+  }
+
+  return AZ_OK;
+}
+
+void az_http_client_async_deinit(az_http_client_async* ref_client)
+{
+  _az_PRECONDITION_NOT_NULL(ref_client);
+
+  while (ref_client->_internal.transfers != NULL)
+  {
+    _az_http_client_curl_async_complete(
+        ref_client,
+        (_az_http_client_curl_async_transfer*)ref_client->_internal.transfers,
+        AZ_ERROR_CANCELED);
+  }
+
+  if (ref_client->_internal.multi_handle != NULL)
+  {
+    (void)curl_multi_cleanup((CURLM*)ref_client->_internal.multi_handle);
+    ref_client->_internal.multi_handle = NULL;
+  }
+}
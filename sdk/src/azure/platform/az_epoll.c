@@ -0,0 +1,828 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_span_internal.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <azure/core/_az_cfg.h>
+
+#ifndef AZ_EPOLL_CONNECTION_POOL_SIZE
+// The number of idle connections kept alive between requests.
+#define AZ_EPOLL_CONNECTION_POOL_SIZE 8
+#endif
+
+// The request line, headers and small bodies are gathered in a buffer of this size on the stack
+// before being sent, so that most requests are sent with a single system call.
+#define _az_HTTP_CLIENT_EPOLL_SEND_BUFFER_SIZE 2048
+
+// The size of the buffer on the stack which the response is received into, before it is decoded.
+#define _az_HTTP_CLIENT_EPOLL_RECEIVE_BUFFER_SIZE 4096
+
+// The longest host name, which getaddrinfo() needs to be NUL-terminated.
+#define _az_HTTP_CLIENT_EPOLL_HOST_MAX_SIZE 256
+
+typedef struct
+{
+  int socket;
+  int epoll;
+  uint32_t events; // The events the socket is currently registered for in epoll.
+  int32_t port;
+  int32_t host_size;
+  char host[_az_HTTP_CLIENT_EPOLL_HOST_MAX_SIZE];
+} _az_http_client_epoll_connection;
+
+typedef struct
+{
+  az_span host;
+  az_span authority; // host[:port], as sent in the Host header.
+  az_span path_and_query;
+  int32_t port;
+} _az_http_client_epoll_url;
+
+typedef struct
+{
+  _az_http_client_epoll_connection* connection;
+  az_context* context;
+  int32_t size;
+  uint8_t buffer[_az_HTTP_CLIENT_EPOLL_SEND_BUFFER_SIZE];
+} _az_http_client_epoll_writer;
+
+/**
+ * @brief splits an `http://host[:port]/path?query` URL in the parts needed to connect and to write
+ * the request line.
+ */
+static AZ_NODISCARD az_result
+_az_http_client_epoll_parse_url(az_span url, _az_http_client_epoll_url* out_url)
+{
+  az_span const scheme = AZ_SPAN_FROM_STR("http://");
+  if (az_span_size(url) < az_span_size(scheme)
+      || !az_span_is_content_equal_ignoring_case(
+          az_span_slice(url, 0, az_span_size(scheme)), scheme))
+  {
+    // TLS is left to HTTP stacks such as libcurl.
+    return AZ_ERROR_NOT_IMPLEMENTED;
+  }
+
+  url = az_span_slice_to_end(url, az_span_size(scheme));
+  int32_t authority_size = 0;
+  uint8_t const* const ptr = az_span_ptr(url);
+  while (authority_size < az_span_size(url) && ptr[authority_size] != '/'
+         && ptr[authority_size] != '?' && ptr[authority_size] != '#')
+  {
+    ++authority_size;
+  }
+
+  out_url->authority = az_span_slice(url, 0, authority_size);
+  out_url->path_and_query = az_span_slice_to_end(url, authority_size);
+  out_url->host = out_url->authority;
+  out_url->port = 80;
+
+  // The port follows the last ':', unless it is part of an IPv6 address between brackets.
+  for (int32_t i = authority_size - 1; i >= 0 && ptr[i] != ']'; --i)
+  {
+    if (ptr[i] == ':')
+    {
+      uint32_t port = 0;
+      if (az_result_failed(az_span_atou32(az_span_slice(url, i + 1, authority_size), &port))
+          || port == 0 || port > UINT16_MAX)
+      {
+        return AZ_ERROR_ARG;
+      }
+
+      out_url->host = az_span_slice(url, 0, i);
+      out_url->port = (int32_t)port;
+      break;
+    }
+  }
+
+  if (az_span_size(out_url->host) > 2 && ptr[0] == '['
+      && ptr[az_span_size(out_url->host) - 1] == ']')
+  {
+    out_url->host = az_span_slice(out_url->host, 1, az_span_size(out_url->host) - 1);
+  }
+
+  if (az_span_size(out_url->host) == 0
+      || az_span_size(out_url->host) >= _az_HTTP_CLIENT_EPOLL_HOST_MAX_SIZE)
+  {
+    return AZ_ERROR_ARG;
+  }
+
+  return AZ_OK;
+}
+
+/**
+ * @brief whether the last socket operation failed only because the socket wasn't ready for it.
+ */
+static AZ_NODISCARD bool _az_http_client_epoll_would_block(void)
+{
+#if EAGAIN == EWOULDBLOCK
+  return errno == EAGAIN;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/**
+ * @brief returns how long to wait for the socket, in milliseconds, before the context of the
+ * request expires. -1 waits until the socket is ready.
+ */
+static AZ_NODISCARD int _az_http_client_epoll_get_timeout_msec(az_context* context)
+{
+  if (context == NULL)
+  {
+    return -1;
+  }
+
+  int64_t const expiration = az_context_get_expiration(context);
+  if (expiration == _az_CONTEXT_MAX_EXPIRATION)
+  {
+    return -1;
+  }
+
+  int64_t const remaining = expiration - az_platform_clock_msec();
+  return remaining <= 0 ? 0 : (remaining < INT_MAX ? (int)remaining : INT_MAX);
+}
+
+/**
+ * @brief waits until the socket of the connection is ready for \p events.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_wait(
+    _az_http_client_epoll_connection* connection,
+    uint32_t events,
+    az_context* context)
+{
+  struct epoll_event event = { .events = events, .data = { .fd = connection->socket } };
+  if (connection->events != events)
+  {
+    if (epoll_ctl(connection->epoll, EPOLL_CTL_MOD, connection->socket, &event) != 0)
+    {
+      return AZ_ERROR_HTTP_ADAPTER;
+    }
+
+    connection->events = events;
+  }
+
+  while (true)
+  {
+    int const timeout_msec = _az_http_client_epoll_get_timeout_msec(context);
+    if (timeout_msec == 0)
+    {
+      return AZ_ERROR_CANCELED;
+    }
+
+    int const ready = epoll_wait(connection->epoll, &event, 1, timeout_msec);
+    if (ready > 0)
+    {
+      // Errors and hang-ups are reported by the send() or recv() which follows.
+      return AZ_OK;
+    }
+
+    if (ready < 0 && errno != EINTR)
+    {
+      return AZ_ERROR_HTTP_ADAPTER;
+    }
+  }
+}
+
+static void _az_http_client_epoll_close(_az_http_client_epoll_connection* connection)
+{
+  if (connection->socket >= 0)
+  {
+    (void)close(connection->socket);
+    connection->socket = -1;
+  }
+
+  if (connection->epoll >= 0)
+  {
+    (void)close(connection->epoll);
+    connection->epoll = -1;
+  }
+}
+
+/**
+ * @brief connects a non-blocking socket to one of the addresses of the host.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_connect(
+    _az_http_client_epoll_connection* connection,
+    az_context* context)
+{
+  char port[sizeof("65535")] = { 0 };
+  az_span port_remainder = { 0 };
+  _az_RETURN_IF_FAILED(
+      az_span_i32toa(AZ_SPAN_FROM_BUFFER(port), connection->port, &port_remainder));
+
+  struct addrinfo hints = { 0 };
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* addresses = NULL;
+  if (getaddrinfo(connection->host, port, &hints, &addresses) != 0)
+  {
+    return AZ_ERROR_HTTP_RESPONSE_COULDNT_RESOLVE_HOST;
+  }
+
+  connection->epoll = epoll_create1(EPOLL_CLOEXEC);
+  if (connection->epoll < 0)
+  {
+    freeaddrinfo(addresses);
+    return AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  az_result result = AZ_ERROR_HTTP_ADAPTER;
+  for (struct addrinfo* address = addresses; address != NULL; address = address->ai_next)
+  {
+    connection->socket = socket(
+        address->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, address->ai_protocol);
+    if (connection->socket < 0)
+    {
+      continue;
+    }
+
+    struct epoll_event event = { .events = EPOLLOUT, .data = { .fd = connection->socket } };
+    connection->events = EPOLLOUT;
+    int error = 0;
+    socklen_t error_size = sizeof(error);
+    if (epoll_ctl(connection->epoll, EPOLL_CTL_ADD, connection->socket, &event) == 0
+        && (connect(connection->socket, address->ai_addr, address->ai_addrlen) == 0
+            || (errno == EINPROGRESS
+                && az_result_succeeded(
+                    result = _az_http_client_epoll_wait(connection, EPOLLOUT, context))
+                && getsockopt(connection->socket, SOL_SOCKET, SO_ERROR, &error, &error_size) == 0
+                && error == 0)))
+    {
+      // Requests are written at once, so there is nothing to gain from delaying small packets.
+      int const no_delay = 1;
+      (void)setsockopt(connection->socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+      freeaddrinfo(addresses);
+      return AZ_OK;
+    }
+
+    (void)epoll_ctl(connection->epoll, EPOLL_CTL_DEL, connection->socket, &event);
+    (void)close(connection->socket);
+    connection->socket = -1;
+    if (result == AZ_ERROR_CANCELED)
+    {
+      break;
+    }
+
+    result = AZ_ERROR_HTTP_ADAPTER;
+  }
+
+  freeaddrinfo(addresses);
+  _az_http_client_epoll_close(connection);
+  return result;
+}
+
+static pthread_mutex_t _az_http_client_epoll_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct
+{
+  _az_http_client_epoll_connection connections[AZ_EPOLL_CONNECTION_POOL_SIZE > 0
+                                                   ? AZ_EPOLL_CONNECTION_POOL_SIZE
+                                                   : 1];
+  int32_t count; // The idle connections, from the least to the most recently used.
+  bool is_initialized;
+} _az_http_client_epoll_pool;
+
+/**
+ * @brief closes the idle connections when the process exits.
+ */
+static void _az_http_client_epoll_pool_cleanup(void)
+{
+  (void)pthread_mutex_lock(&_az_http_client_epoll_pool_lock);
+  for (int32_t i = 0; i < _az_http_client_epoll_pool.count; i++)
+  {
+    _az_http_client_epoll_close(&_az_http_client_epoll_pool.connections[i]);
+  }
+
+  _az_http_client_epoll_pool.count = 0;
+  (void)pthread_mutex_unlock(&_az_http_client_epoll_pool_lock);
+}
+
+/**
+ * @brief whether an idle connection was closed, or received unexpected bytes, since it was used.
+ */
+static AZ_NODISCARD bool
+_az_http_client_epoll_is_connection_stale(_az_http_client_epoll_connection const* connection)
+{
+  uint8_t byte = 0;
+  ssize_t const received = recv(connection->socket, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  return !(received < 0 && _az_http_client_epoll_would_block());
+}
+
+/**
+ * @brief takes an idle connection to the host of the request out of the pool. Returns false when
+ * there is none, and a connection has to be opened.
+ */
+static AZ_NODISCARD bool
+_az_http_client_epoll_pool_acquire(_az_http_client_epoll_connection* ref_connection)
+{
+  bool is_found = false;
+  (void)pthread_mutex_lock(&_az_http_client_epoll_pool_lock);
+
+  // The most recently used connections are the least likely to have been closed by the server.
+  for (int32_t i = _az_http_client_epoll_pool.count - 1; i >= 0 && !is_found; i--)
+  {
+    _az_http_client_epoll_connection* const pooled = &_az_http_client_epoll_pool.connections[i];
+    if (pooled->port != ref_connection->port || pooled->host_size != ref_connection->host_size
+        || memcmp(pooled->host, ref_connection->host, (size_t)pooled->host_size) != 0)
+    {
+      continue;
+    }
+
+    _az_http_client_epoll_connection connection = *pooled;
+    --_az_http_client_epoll_pool.count;
+    memmove(
+        pooled,
+        pooled + 1,
+        (size_t)(_az_http_client_epoll_pool.count - i) * sizeof(*pooled));
+
+    if (_az_http_client_epoll_is_connection_stale(&connection))
+    {
+      _az_http_client_epoll_close(&connection);
+    }
+    else
+    {
+      *ref_connection = connection;
+      is_found = true;
+    }
+  }
+
+  (void)pthread_mutex_unlock(&_az_http_client_epoll_pool_lock);
+  return is_found;
+}
+
+/**
+ * @brief keeps a connection alive for the next request to the same host, closing the least
+ * recently used idle connection when the pool is full.
+ */
+static void _az_http_client_epoll_pool_release(_az_http_client_epoll_connection* connection)
+{
+  if (AZ_EPOLL_CONNECTION_POOL_SIZE <= 0)
+  {
+    _az_http_client_epoll_close(connection);
+    return;
+  }
+
+  (void)pthread_mutex_lock(&_az_http_client_epoll_pool_lock);
+  if (!_az_http_client_epoll_pool.is_initialized)
+  {
+    _az_http_client_epoll_pool.is_initialized = true;
+    (void)atexit(_az_http_client_epoll_pool_cleanup);
+  }
+
+  if (_az_http_client_epoll_pool.count == AZ_EPOLL_CONNECTION_POOL_SIZE)
+  {
+    _az_http_client_epoll_close(&_az_http_client_epoll_pool.connections[0]);
+    --_az_http_client_epoll_pool.count;
+    memmove(
+        &_az_http_client_epoll_pool.connections[0],
+        &_az_http_client_epoll_pool.connections[1],
+        (size_t)_az_http_client_epoll_pool.count * sizeof(*connection));
+  }
+
+  _az_http_client_epoll_pool.connections[_az_http_client_epoll_pool.count] = *connection;
+  ++_az_http_client_epoll_pool.count;
+  (void)pthread_mutex_unlock(&_az_http_client_epoll_pool_lock);
+
+  connection->socket = -1;
+  connection->epoll = -1;
+}
+
+static AZ_NODISCARD az_result _az_http_client_epoll_send(
+    _az_http_client_epoll_connection* connection,
+    az_span data,
+    az_context* context)
+{
+  uint8_t const* ptr = az_span_ptr(data);
+  size_t size = (size_t)az_span_size(data);
+  while (size > 0)
+  {
+    ssize_t const sent = send(connection->socket, ptr, size, MSG_NOSIGNAL);
+    if (sent >= 0)
+    {
+      ptr += sent;
+      size -= (size_t)sent;
+    }
+    else if (_az_http_client_epoll_would_block())
+    {
+      _az_RETURN_IF_FAILED(_az_http_client_epoll_wait(connection, EPOLLOUT, context));
+    }
+    else if (errno != EINTR)
+    {
+      return AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+    }
+  }
+
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_http_client_epoll_flush(_az_http_client_epoll_writer* ref_writer)
+{
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_send(
+      ref_writer->connection,
+      az_span_create(ref_writer->buffer, ref_writer->size),
+      ref_writer->context));
+
+  ref_writer->size = 0;
+  return AZ_OK;
+}
+
+/**
+ * @brief gathers \p data in the send buffer, sending what doesn't fit in it straight away.
+ */
+static AZ_NODISCARD az_result
+_az_http_client_epoll_write(_az_http_client_epoll_writer* ref_writer, az_span data)
+{
+  int32_t const free_size = (int32_t)sizeof(ref_writer->buffer) - ref_writer->size;
+  if (az_span_size(data) > free_size)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_flush(ref_writer));
+    if (az_span_size(data) >= (int32_t)sizeof(ref_writer->buffer))
+    {
+      return _az_http_client_epoll_send(ref_writer->connection, data, ref_writer->context);
+    }
+  }
+
+  az_span_copy(
+      az_span_create(ref_writer->buffer + ref_writer->size, az_span_size(data)), data);
+  ref_writer->size += az_span_size(data);
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_http_client_epoll_write_chunk_size(
+    _az_http_client_epoll_writer* ref_writer,
+    int32_t chunk_size)
+{
+  static uint8_t const hex_digits[] = "0123456789abcdef";
+  uint8_t chunk_size_line[sizeof("7fffffff\r\n")] = { 0 };
+  int32_t start = (int32_t)sizeof(chunk_size_line) - 1;
+  chunk_size_line[--start] = '\n';
+  chunk_size_line[--start] = '\r';
+  do
+  {
+    chunk_size_line[--start] = hex_digits[chunk_size & 0xF];
+    chunk_size /= 16;
+  } while (chunk_size > 0);
+
+  return _az_http_client_epoll_write(
+      ref_writer,
+      az_span_create(chunk_size_line + start, (int32_t)sizeof(chunk_size_line) - 1 - start));
+}
+
+/**
+ * @brief writes the body read from the body provider of the request, with chunked encoding when
+ * its length is unknown.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_write_body_provider(
+    _az_http_client_epoll_writer* ref_writer,
+    az_http_request_body_provider const* body_provider)
+{
+  bool const is_chunked = body_provider->length < 0;
+  uint8_t part[_az_HTTP_CLIENT_EPOLL_SEND_BUFFER_SIZE];
+  while (true)
+  {
+    int32_t bytes_read = 0;
+    _az_RETURN_IF_FAILED(
+        body_provider->read(body_provider->user_context, AZ_SPAN_FROM_BUFFER(part), &bytes_read));
+
+    if (is_chunked)
+    {
+      _az_RETURN_IF_FAILED(_az_http_client_epoll_write_chunk_size(ref_writer, bytes_read));
+    }
+
+    if (bytes_read == 0)
+    {
+      break;
+    }
+
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, az_span_create(part, bytes_read)));
+    if (is_chunked)
+    {
+      _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n")));
+    }
+  }
+
+  return is_chunked ? _az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n"))
+                    : AZ_OK;
+}
+
+/**
+ * @brief writes the request straight into the socket, in HTTP/1.1.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_write_request(
+    _az_http_client_epoll_writer* ref_writer,
+    az_http_request const* request,
+    _az_http_client_epoll_url const* url)
+{
+  az_http_method method = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_method(request, &method));
+
+  // request-line = method SP request-target SP HTTP-version CRLF
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, method));
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR(" ")));
+  if (az_span_size(url->path_and_query) == 0 || az_span_ptr(url->path_and_query)[0] != '/')
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("/")));
+  }
+
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, url->path_and_query));
+  _az_RETURN_IF_FAILED(
+      _az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR(" HTTP/1.1\r\nHost: ")));
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, url->authority));
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n")));
+
+  int32_t const headers_count = az_http_request_headers_count(request);
+  for (int32_t i = 0; i < headers_count; i++)
+  {
+    az_span name = { 0 };
+    az_span value = { 0 };
+    _az_RETURN_IF_FAILED(az_http_request_get_header(request, i, &name, &value));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, name));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR(": ")));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, value));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n")));
+  }
+
+  az_http_request_body_provider const* body_provider = NULL;
+  _az_RETURN_IF_FAILED(az_http_request_get_body_provider(request, &body_provider));
+  az_span body = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_body(request, &body));
+
+  // Requests with no body only need a Content-Length when their method expects one.
+  int64_t const content_length = body_provider != NULL ? body_provider->length : az_span_size(body);
+  if (content_length > 0
+      || (content_length == 0
+          && (az_span_is_content_equal(method, az_http_method_post())
+              || az_span_is_content_equal(method, az_http_method_put())
+              || az_span_is_content_equal(method, az_http_method_patch()))))
+  {
+    uint8_t content_length_buffer[sizeof("-9223372036854775808")] = { 0 };
+    az_span content_length_remainder = { 0 };
+    _az_RETURN_IF_FAILED(az_span_i64toa(
+        AZ_SPAN_FROM_BUFFER(content_length_buffer), content_length, &content_length_remainder));
+
+    _az_RETURN_IF_FAILED(
+        _az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("Content-Length: ")));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(
+        ref_writer,
+        az_span_slice(
+            AZ_SPAN_FROM_BUFFER(content_length_buffer),
+            0,
+            _az_span_diff(content_length_remainder, AZ_SPAN_FROM_BUFFER(content_length_buffer)))));
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n")));
+  }
+  else if (content_length < 0)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_write(
+        ref_writer, AZ_SPAN_FROM_STR("Transfer-Encoding: chunked\r\n")));
+  }
+
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write(ref_writer, AZ_SPAN_FROM_STR("\r\n")));
+  _az_RETURN_IF_FAILED(
+      body_provider != NULL ? _az_http_client_epoll_write_body_provider(ref_writer, body_provider)
+                            : _az_http_client_epoll_write(ref_writer, body));
+
+  return _az_http_client_epoll_flush(ref_writer);
+}
+
+/**
+ * @brief whether the server lets the connection be used for another request after the response.
+ */
+static AZ_NODISCARD bool _az_http_client_epoll_is_keep_alive(az_http_response* ref_response)
+{
+  // Leave the parser where it was, for the application to read the response.
+  _az_http_response_parser const parser = ref_response->_internal.parser;
+  az_http_response_status_line status_line = { 0 };
+  az_result const result = az_http_response_get_status_line(ref_response, &status_line);
+  ref_response->_internal.parser = parser;
+  if (az_result_failed(result))
+  {
+    return false;
+  }
+
+  // HTTP/1.1 connections are persistent, unless closed explicitly, and HTTP/1.0 ones are not.
+  az_span connection = { 0 };
+  bool const has_connection = az_result_succeeded(
+      az_http_response_get_header(ref_response, AZ_SPAN_FROM_STR("Connection"), &connection));
+  if (status_line.major_version == 1 && status_line.minor_version >= 1)
+  {
+    return !has_connection
+        || !az_span_is_content_equal_ignoring_case(connection, AZ_SPAN_FROM_STR("close"));
+  }
+
+  return has_connection
+      && az_span_is_content_equal_ignoring_case(connection, AZ_SPAN_FROM_STR("keep-alive"));
+}
+
+/**
+ * @brief receives and decodes the response, and returns whether any byte of it was received.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_receive_response(
+    _az_http_client_epoll_connection* connection,
+    az_http_request const* request,
+    az_http_response* ref_response,
+    bool* out_is_keep_alive,
+    bool* out_is_any_received)
+{
+  az_http_method method = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_method(request, &method));
+
+  az_http_response_decoder decoder = { 0 };
+  _az_RETURN_IF_FAILED(az_http_response_decoder_init(&decoder, ref_response, method));
+
+  *out_is_keep_alive = false;
+  *out_is_any_received = false;
+  bool is_connection_closed = false;
+  uint8_t buffer[_az_HTTP_CLIENT_EPOLL_RECEIVE_BUFFER_SIZE];
+  while (!az_http_response_decoder_is_complete(&decoder))
+  {
+    ssize_t const received = recv(connection->socket, buffer, sizeof(buffer), 0);
+    if (received > 0)
+    {
+      *out_is_any_received = true;
+      int32_t used = 0;
+      az_result const result = az_http_response_decoder_feed(
+          &decoder, az_span_create(buffer, (int32_t)received), &used);
+      if (az_result_failed(result))
+      {
+        return result == AZ_ERROR_NOT_ENOUGH_SPACE ? AZ_ERROR_HTTP_RESPONSE_OVERFLOW : result;
+      }
+
+      // A server doesn't send anything after the response until it gets the next request.
+      if (used < received)
+      {
+        is_connection_closed = true;
+      }
+    }
+    else if (received == 0)
+    {
+      is_connection_closed = true;
+      _az_RETURN_IF_FAILED(az_http_response_decoder_end(&decoder));
+    }
+    else if (_az_http_client_epoll_would_block())
+    {
+      _az_RETURN_IF_FAILED(
+          _az_http_client_epoll_wait(connection, EPOLLIN, request->_internal.context));
+    }
+    else if (errno != EINTR)
+    {
+      return AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+    }
+  }
+
+  *out_is_keep_alive = !is_connection_closed && _az_http_client_epoll_is_keep_alive(ref_response);
+  return AZ_OK;
+}
+
+/**
+ * @brief sends the request over the connection and receives its response.
+ */
+static AZ_NODISCARD az_result _az_http_client_epoll_send_request(
+    _az_http_client_epoll_connection* connection,
+    az_http_request const* request,
+    _az_http_client_epoll_url const* url,
+    az_http_response* ref_response,
+    bool* out_is_keep_alive,
+    bool* out_is_any_received)
+{
+  *out_is_keep_alive = false;
+  *out_is_any_received = false;
+
+  _az_http_client_epoll_writer writer = {
+    .connection = connection,
+    .context = request->_internal.context,
+    .size = 0,
+  };
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_write_request(&writer, request, url));
+
+  return _az_http_client_epoll_receive_response(
+      connection, request, ref_response, out_is_keep_alive, out_is_any_received);
+}
+
+AZ_NODISCARD az_result
+az_http_client_send_request(az_http_request const* request, az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(request);
+  _az_PRECONDITION_NOT_NULL(ref_response);
+
+  az_span request_url = { 0 };
+  _az_RETURN_IF_FAILED(az_http_request_get_url(request, &request_url));
+  _az_http_client_epoll_url url = { 0 };
+  _az_RETURN_IF_FAILED(_az_http_client_epoll_parse_url(request_url, &url));
+
+  _az_http_client_epoll_connection connection = {
+    .socket = -1,
+    .epoll = -1,
+    .events = 0,
+    .port = url.port,
+    .host_size = az_span_size(url.host),
+  };
+  az_span_to_str(connection.host, (int32_t)sizeof(connection.host), url.host);
+
+  bool is_reused = _az_http_client_epoll_pool_acquire(&connection);
+  if (!is_reused)
+  {
+    _az_RETURN_IF_FAILED(_az_http_client_epoll_connect(&connection, request->_internal.context));
+  }
+
+  bool is_keep_alive = false;
+  bool is_any_received = false;
+  az_result result = _az_http_client_epoll_send_request(
+      &connection, request, &url, ref_response, &is_keep_alive, &is_any_received);
+
+  // The server may have closed an idle connection just as it was reused. The request is sent
+  // again over a new connection, if its body can be sent again.
+  if (is_reused && !is_any_received && result == AZ_ERROR_HTTP_CONNECTION_INTERRUPTED)
+  {
+    az_http_request_body_provider const* body_provider = NULL;
+    _az_RETURN_IF_FAILED(az_http_request_get_body_provider(request, &body_provider));
+    _az_http_client_epoll_close(&connection);
+    if (body_provider == NULL
+        || (body_provider->rewind != NULL
+            && az_result_succeeded(body_provider->rewind(body_provider->user_context))))
+    {
+      result = _az_http_client_epoll_connect(&connection, request->_internal.context);
+      if (az_result_succeeded(result))
+      {
+        result = _az_http_client_epoll_send_request(
+            &connection, request, &url, ref_response, &is_keep_alive, &is_any_received);
+      }
+    }
+  }
+
+  if (az_result_succeeded(result) && is_keep_alive)
+  {
+    _az_http_client_epoll_pool_release(&connection);
+  }
+  else
+  {
+    _az_http_client_epoll_close(&connection);
+  }
+
+  return result;
+}
+
+// Requests are only sent synchronously over raw sockets; the asynchronous client is provided by
+// the libcurl transport.
+
+AZ_NODISCARD az_result az_http_client_async_init(
+    az_http_client_async* out_client,
+    az_http_client_async_options const* options)
+{
+  _az_PRECONDITION_NOT_NULL(out_client);
+  (void)options;
+  *out_client = (az_http_client_async){ 0 };
+  return AZ_ERROR_NOT_IMPLEMENTED;
+}
+
+AZ_NODISCARD az_result az_http_client_async_submit(
+    az_http_client_async* ref_client,
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_http_client_async_callback callback,
+    void* user_context)
+{
+  (void)ref_client;
+  (void)request;
+  (void)ref_response;
+  (void)callback;
+  (void)user_context;
+  return AZ_ERROR_NOT_IMPLEMENTED;
+}
+
+AZ_NODISCARD az_result az_http_client_async_poll(
+    az_http_client_async* ref_client,
+    int32_t timeout_msec,
+    int32_t* out_in_flight_count)
+{
+  (void)ref_client;
+  (void)timeout_msec;
+  if (out_in_flight_count != NULL)
+  {
+    *out_in_flight_count = 0;
+  }
+
+  return AZ_ERROR_NOT_IMPLEMENTED;
+}
+
+void az_http_client_async_deinit(az_http_client_async* ref_client) { (void)ref_client; }
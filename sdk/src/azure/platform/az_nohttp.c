@@ -21,3 +21,50 @@ az_http_client_send_request(az_http_request const* request, az_http_response* re
   (void)ref_response;
   return AZ_ERROR_DEPENDENCY_NOT_PROVIDED;
 }
+
+/**
+ * @brief Provides no asynchronous HTTP support.
+ *
+ * @param out_client The #az_http_client_async to initialize.
+ * @param options Ignored.
+ * @return #AZ_ERROR_DEPENDENCY_NOT_PROVIDED
+ */
+AZ_NODISCARD az_result az_http_client_async_init(
+    az_http_client_async* out_client,
+    az_http_client_async_options const* options)
+{
+  (void)options;
+  *out_client = (az_http_client_async){ 0 };
+  return AZ_ERROR_DEPENDENCY_NOT_PROVIDED;
+}
+
+AZ_NODISCARD az_result az_http_client_async_submit(
+    az_http_client_async* ref_client,
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_http_client_async_callback callback,
+    void* user_context)
+{
+  (void)ref_client;
+  (void)request;
+  (void)ref_response;
+  (void)callback;
+  (void)user_context;
+  return AZ_ERROR_DEPENDENCY_NOT_PROVIDED;
+}
+
+AZ_NODISCARD az_result az_http_client_async_poll(
+    az_http_client_async* ref_client,
+    int32_t timeout_msec,
+    int32_t* out_in_flight_count)
+{
+  (void)ref_client;
+  (void)timeout_msec;
+  if (out_in_flight_count != NULL)
+  {
+    *out_in_flight_count = 0;
+  }
+  return AZ_ERROR_DEPENDENCY_NOT_PROVIDED;
+}
+
+void az_http_client_async_deinit(az_http_client_async* ref_client) { (void)ref_client; }
@@ -7,4 +7,8 @@
 
 AZ_NODISCARD int64_t az_platform_clock_msec() { return 0; }
 
+AZ_NODISCARD int64_t az_platform_clock_usec() { return 0; }
+
+AZ_NODISCARD int64_t az_platform_clock_nsec() { return 0; }
+
 void az_platform_sleep_msec(int32_t milliseconds) { (void)milliseconds; }
@@ -4,19 +4,56 @@
 #include <azure/core/az_platform.h>
 #include <azure/core/internal/az_config_internal.h>
 
+#include <errno.h>
 #include <time.h>
 
 #include <unistd.h>
 
 #include <azure/core/_az_cfg.h>
 
+// CLOCK_MONOTONIC keeps counting while the process is blocked, unlike clock(), which counts the
+// CPU time of the process, and isn't affected by changes to the system time.
+static struct timespec _az_posix_clock_now()
+{
+  struct timespec now = { 0 };
+  (void)clock_gettime(CLOCK_MONOTONIC, &now);
+  return now;
+}
+
 AZ_NODISCARD int64_t az_platform_clock_msec()
 {
-  // NOLINTNEXTLINE(bugprone-misplaced-widening-cast)
-  return (int64_t)((clock() / CLOCKS_PER_SEC) * _az_TIME_MILLISECONDS_PER_SECOND);
+  struct timespec const now = _az_posix_clock_now();
+  return (int64_t)now.tv_sec * _az_TIME_MILLISECONDS_PER_SECOND
+      + now.tv_nsec
+      / (_az_TIME_MICROSECONDS_PER_MILLISECOND * _az_TIME_NANOSECONDS_PER_MICROSECOND);
+}
+
+AZ_NODISCARD int64_t az_platform_clock_usec()
+{
+  struct timespec const now = _az_posix_clock_now();
+  return (int64_t)now.tv_sec * _az_TIME_MILLISECONDS_PER_SECOND
+      * _az_TIME_MICROSECONDS_PER_MILLISECOND
+      + now.tv_nsec / _az_TIME_NANOSECONDS_PER_MICROSECOND;
+}
+
+AZ_NODISCARD int64_t az_platform_clock_nsec()
+{
+  struct timespec const now = _az_posix_clock_now();
+  return (int64_t)now.tv_sec * _az_TIME_MILLISECONDS_PER_SECOND
+      * _az_TIME_MICROSECONDS_PER_MILLISECOND * _az_TIME_NANOSECONDS_PER_MICROSECOND
+      + now.tv_nsec;
 }
 
 void az_platform_sleep_msec(int32_t milliseconds)
 {
-  (void)usleep((useconds_t)milliseconds * _az_TIME_MICROSECONDS_PER_MILLISECOND);
+  // usleep() may reject a second or more, and both return early when a signal is handled.
+  struct timespec remaining = {
+    .tv_sec = milliseconds / _az_TIME_MILLISECONDS_PER_SECOND,
+    .tv_nsec = (long)(milliseconds % _az_TIME_MILLISECONDS_PER_SECOND)
+        * _az_TIME_MICROSECONDS_PER_MILLISECOND * _az_TIME_NANOSECONDS_PER_MICROSECOND,
+  };
+
+  while (nanosleep(&remaining, &remaining) != 0 && errno == EINTR)
+  {
+  }
 }
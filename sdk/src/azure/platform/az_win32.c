@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <azure/core/az_platform.h>
+#include <azure/core/internal/az_config_internal.h>
 
 // Two macros below are not used in the code below, it is windows.h that consumes them.
 #define WIN32_LEAN_AND_MEAN
@@ -10,6 +11,38 @@
 
 #include <azure/core/_az_cfg.h>
 
-AZ_NODISCARD int64_t az_platform_clock_msec() { return GetTickCount64(); }
+// The performance counter is monotonic, with a resolution of a microsecond or finer.
+static int64_t _az_win32_clock(int64_t units_per_second)
+{
+  LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
+  (void)QueryPerformanceFrequency(&frequency);
+  (void)QueryPerformanceCounter(&counter);
+
+  // Splitting the counter into seconds and the rest keeps the multiplication from overflowing.
+  int64_t const seconds = counter.QuadPart / frequency.QuadPart;
+  int64_t const rest = counter.QuadPart % frequency.QuadPart;
+  return seconds * units_per_second + rest * units_per_second / frequency.QuadPart;
+}
+
+// All the clocks come from the performance counter, so that durations measured with one of them
+// match the others.
+AZ_NODISCARD int64_t az_platform_clock_msec()
+{
+  return _az_win32_clock(_az_TIME_MILLISECONDS_PER_SECOND);
+}
+
+AZ_NODISCARD int64_t az_platform_clock_usec()
+{
+  return _az_win32_clock(
+      (int64_t)_az_TIME_MILLISECONDS_PER_SECOND * _az_TIME_MICROSECONDS_PER_MILLISECOND);
+}
+
+AZ_NODISCARD int64_t az_platform_clock_nsec()
+{
+  return _az_win32_clock(
+      (int64_t)_az_TIME_MILLISECONDS_PER_SECOND * _az_TIME_MICROSECONDS_PER_MILLISECOND
+      * _az_TIME_NANOSECONDS_PER_MICROSECOND);
+}
 
 void az_platform_sleep_msec(int32_t milliseconds) { Sleep(milliseconds); }
@@ -0,0 +1,186 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_http.h>
+#include <azure/core/az_result.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_precondition_internal.h>
+#include <azure/platform/az_zlib.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <azure/core/_az_cfg.h>
+
+// Bodies are compressed with a 4 KiB window and a small hash table, which need about 40 KiB.
+#define _az_ZLIB_COMPRESSION_WINDOW_BITS 12
+#define _az_ZLIB_COMPRESSION_MEMORY_LEVEL 5
+
+// Adding this to the window bits of inflateInit2() detects gzip and zlib headers both.
+#define _az_ZLIB_DETECT_HEADER 32
+
+// Adding this to the window bits of deflateInit2() writes a gzip header instead of a zlib one.
+#define _az_ZLIB_GZIP_HEADER 16
+
+// What zlib allocates is aligned on this size.
+#define _az_ZLIB_ALIGNMENT 16
+
+// The state of the codec, at the start of its work buffer. zlib allocates what it needs out of the
+// rest of the buffer, which is released all at once when the next body begins.
+typedef struct
+{
+  z_stream stream;
+  uint8_t* heap;
+  size_t heap_size;
+  size_t heap_used;
+  bool is_compressing;
+  bool is_started;
+} _az_zlib_codec;
+
+static voidpf _az_zlib_alloc(voidpf opaque, uInt items, uInt size)
+{
+  _az_zlib_codec* const codec = (_az_zlib_codec*)opaque;
+  size_t const allocation_size
+      = ((size_t)items * size + _az_ZLIB_ALIGNMENT - 1) & ~(size_t)(_az_ZLIB_ALIGNMENT - 1);
+  if (allocation_size > codec->heap_size - codec->heap_used)
+  {
+    return Z_NULL;
+  }
+
+  voidpf const allocation = codec->heap + codec->heap_used;
+  codec->heap_used += allocation_size;
+  return allocation;
+}
+
+static void _az_zlib_free(voidpf opaque, voidpf address)
+{
+  (void)opaque;
+  (void)address;
+}
+
+static void _az_zlib_codec_end(void* user_context)
+{
+  _az_zlib_codec* const codec = (_az_zlib_codec*)user_context;
+  if (codec->is_started)
+  {
+    (void)(codec->is_compressing ? deflateEnd(&codec->stream) : inflateEnd(&codec->stream));
+    codec->is_started = false;
+  }
+
+  codec->heap_used = 0;
+}
+
+static AZ_NODISCARD az_result
+_az_zlib_codec_begin(void* user_context, az_http_content_coding coding, bool is_compressing)
+{
+  _az_zlib_codec* const codec = (_az_zlib_codec*)user_context;
+  if (coding != AZ_HTTP_CONTENT_CODING_GZIP && coding != AZ_HTTP_CONTENT_CODING_DEFLATE)
+  {
+    return AZ_ERROR_NOT_SUPPORTED;
+  }
+
+  _az_zlib_codec_end(codec);
+  memset(&codec->stream, 0, sizeof(codec->stream));
+  codec->stream.zalloc = _az_zlib_alloc;
+  codec->stream.zfree = _az_zlib_free;
+  codec->stream.opaque = codec;
+  codec->is_compressing = is_compressing;
+
+  int const result = is_compressing
+      ? deflateInit2(
+          &codec->stream,
+          Z_DEFAULT_COMPRESSION,
+          Z_DEFLATED,
+          _az_ZLIB_COMPRESSION_WINDOW_BITS
+              + (coding == AZ_HTTP_CONTENT_CODING_GZIP ? _az_ZLIB_GZIP_HEADER : 0),
+          _az_ZLIB_COMPRESSION_MEMORY_LEVEL,
+          Z_DEFAULT_STRATEGY)
+      : inflateInit2(&codec->stream, MAX_WBITS + _az_ZLIB_DETECT_HEADER);
+
+  if (result != Z_OK)
+  {
+    codec->heap_used = 0;
+    return result == Z_MEM_ERROR ? AZ_ERROR_OUT_OF_MEMORY : AZ_ERROR_ARG;
+  }
+
+  codec->is_started = true;
+  return AZ_OK;
+}
+
+static AZ_NODISCARD az_result _az_zlib_codec_process(
+    void* user_context,
+    az_span source,
+    az_span destination,
+    bool is_last,
+    int32_t* out_source_used,
+    int32_t* out_destination_used,
+    bool* out_is_end)
+{
+  _az_zlib_codec* const codec = (_az_zlib_codec*)user_context;
+  _az_PRECONDITION(codec->is_started);
+
+  codec->stream.next_in = az_span_ptr(source);
+  codec->stream.avail_in = (uInt)az_span_size(source);
+  codec->stream.next_out = az_span_ptr(destination);
+  codec->stream.avail_out = (uInt)az_span_size(destination);
+
+  int const result = codec->is_compressing
+      ? deflate(&codec->stream, is_last ? Z_FINISH : Z_NO_FLUSH)
+      : inflate(&codec->stream, Z_NO_FLUSH);
+
+  *out_source_used = az_span_size(source) - (int32_t)codec->stream.avail_in;
+  *out_destination_used = az_span_size(destination) - (int32_t)codec->stream.avail_out;
+  *out_is_end = result == Z_STREAM_END;
+
+  switch (result)
+  {
+    case Z_OK:
+    case Z_STREAM_END:
+    case Z_BUF_ERROR: // No progress was possible, until there is more source or destination.
+      return AZ_OK;
+    case Z_MEM_ERROR:
+      return AZ_ERROR_OUT_OF_MEMORY;
+    case Z_DATA_ERROR:
+    case Z_NEED_DICT:
+      return AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY;
+    default:
+      return AZ_ERROR_ARG;
+  }
+}
+
+AZ_NODISCARD az_result az_zlib_codec_init(az_http_content_codec* out_codec, az_span work_buffer)
+{
+  _az_PRECONDITION_NOT_NULL(out_codec);
+
+  // The state of the codec is aligned for zlib to use it.
+  uint8_t* const buffer = az_span_ptr(work_buffer);
+  size_t const padding = (size_t)(-(uintptr_t)buffer & (_az_ZLIB_ALIGNMENT - 1));
+  size_t const state_size
+      = (sizeof(_az_zlib_codec) + _az_ZLIB_ALIGNMENT - 1) & ~(size_t)(_az_ZLIB_ALIGNMENT - 1);
+  if (az_span_size(work_buffer) < AZ_ZLIB_CODEC_WORK_BUFFER_SIZE)
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  _az_zlib_codec* const codec = (_az_zlib_codec*)(void*)(buffer + padding);
+  *codec = (_az_zlib_codec){
+    .heap = buffer + padding + state_size,
+    .heap_size = (size_t)az_span_size(work_buffer) - padding - state_size,
+    .heap_used = 0,
+    .is_compressing = false,
+    .is_started = false,
+  };
+
+  *out_codec = (az_http_content_codec){
+    .begin = _az_zlib_codec_begin,
+    .process = _az_zlib_codec_process,
+    .end = _az_zlib_codec_end,
+    .user_context = codec,
+  };
+
+  return AZ_OK;
+}
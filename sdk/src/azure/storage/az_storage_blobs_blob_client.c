@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // SPDX-License-Identifier: MIT
 
+#include <azure/core/az_arena.h>
 #include <azure/core/az_http.h>
 #include <azure/core/az_http_transport.h>
 #include <azure/core/az_json.h>
@@ -27,9 +28,6 @@ static az_span const AZ_STORAGE_BLOBS_BLOB_HEADER_X_MS_BLOB_TYPE
 
 static az_span const AZ_STORAGE_BLOBS_BLOB_TYPE_BLOCKBLOB = AZ_SPAN_LITERAL_FROM_STR("BlockBlob");
 
-static az_span const AZ_HTTP_HEADER_CONTENT_LENGTH = AZ_SPAN_LITERAL_FROM_STR("Content-Length");
-static az_span const AZ_HTTP_HEADER_CONTENT_TYPE = AZ_SPAN_LITERAL_FROM_STR("Content-Type");
-
 AZ_NODISCARD az_storage_blobs_blob_client_options az_storage_blobs_blob_client_options_default()
 {
 
@@ -45,6 +43,14 @@ AZ_NODISCARD az_storage_blobs_blob_client_options az_storage_blobs_blob_client_o
       .telemetry_options = _az_http_policy_telemetry_options_default(),
     },
     .retry_options = _az_http_policy_retry_options_default(),
+    .compression_options = _az_http_policy_compression_options_default(),
+    .circuit_breaker = NULL,
+    .rate_limiter = NULL,
+    .metrics = NULL,
+    .tracing = NULL,
+    .hedging = NULL,
+    .custom_policies = NULL,
+    .custom_policies_length = 0,
   };
 
   // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
@@ -74,52 +80,52 @@ AZ_NODISCARD az_result az_storage_blobs_blob_client_init(
       .endpoint = AZ_SPAN_FROM_BUFFER(out_client->_internal.endpoint_buffer),
       .options = *options,
       .credential = cred,
-      .pipeline = (_az_http_pipeline){
-        ._internal = {
-          .policies = {
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_apiversion,
-                .options= &out_client->_internal.options._internal.api_version,
-              },
-            },
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_telemetry,
-                .options = &out_client->_internal.options._internal.telemetry_options,
-              },
-            },
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_retry,
-                .options = &out_client->_internal.options.retry_options,
-              },
-            },
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_credential,
-                .options = cred,
-              },
-            },
+    },
+  };
+
+  // The options of the policies are those copied into the client.
+  az_storage_blobs_blob_client_options* const client_options = &out_client->_internal.options;
+  _az_http_pipeline* const pipeline = &out_client->_internal.pipeline;
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_apiversion, &client_options->_internal.api_version));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_telemetry, &client_options->_internal.telemetry_options));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_compression, &client_options->compression_options));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_decompression, &client_options->compression_options));
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_metrics, options->metrics));
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_tracing, options->tracing));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_circuit_breaker, options->circuit_breaker));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_custom_policies(
+      pipeline,
+      options->custom_policies,
+      options->custom_policies_length,
+      AZ_HTTP_POLICY_POSITION_PER_CALL));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_retry, &client_options->retry_options));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_rate_limiter, options->rate_limiter));
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_credential, cred));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_policy(
+      pipeline, az_http_pipeline_policy_tracing_attempt, options->tracing));
+  _az_RETURN_IF_FAILED(_az_http_pipeline_add_custom_policies(
+      pipeline,
+      options->custom_policies,
+      options->custom_policies_length,
+      AZ_HTTP_POLICY_POSITION_PER_RETRY));
 #ifndef AZ_NO_LOGGING
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_logging,
-                .options = NULL,
-              },
-            },
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_logging, NULL));
 #endif // AZ_NO_LOGGING
-            {
-              ._internal = {
-                .process = az_http_pipeline_policy_transport,
-                .options = NULL,
-              },
-            },
-          },
-        }
-      }
-    }
-  };
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_hedging, options->hedging));
+  _az_RETURN_IF_FAILED(
+      _az_http_pipeline_add_policy(pipeline, az_http_pipeline_policy_transport, NULL));
 
   // Copy url to client buffer so customer can re-use buffer on his/her side
   int32_t const uri_size = az_span_size(endpoint);
@@ -133,45 +139,36 @@ AZ_NODISCARD az_result az_storage_blobs_blob_client_init(
   return AZ_OK;
 }
 
-AZ_NODISCARD az_result az_storage_blobs_blob_upload(
+/**
+ * @brief Sends the Put Blob request, with a body which is either \p content, or streamed from
+ * \p body_provider when it is not `NULL`, building the request in \p request_url_span and
+ * \p request_headers_span.
+ */
+static AZ_NODISCARD az_result _az_storage_blobs_blob_upload_with_buffers(
     az_storage_blobs_blob_client* ref_client,
     az_span content, /* Buffer of content*/
-    az_storage_blobs_blob_upload_options const* options,
+    az_http_request_body_provider const* body_provider,
+    az_storage_blobs_blob_upload_options const* opt,
+    az_span request_url_span,
+    az_span request_headers_span,
     az_http_response* ref_response)
 {
-
-  az_storage_blobs_blob_upload_options opt;
-  if (options == NULL)
-  {
-    opt = az_storage_blobs_blob_upload_options_default();
-  }
-  else
-  {
-    opt = *options;
-  }
-
-  // Request buffer
-  // create request buffer TODO: define size for a blob upload
-  uint8_t url_buffer[AZ_HTTP_REQUEST_URL_BUFFER_SIZE];
-  az_span request_url_span = AZ_SPAN_FROM_BUFFER(url_buffer);
   // copy url from client
   int32_t uri_size = az_span_size(ref_client->_internal.endpoint);
   _az_RETURN_IF_NOT_ENOUGH_SIZE(request_url_span, uri_size);
   az_span_copy(request_url_span, ref_client->_internal.endpoint);
 
-  uint8_t headers_buffer[_az_STORAGE_HTTP_REQUEST_HEADER_BUFFER_SIZE];
-  az_span request_headers_span = AZ_SPAN_FROM_BUFFER(headers_buffer);
-
   // create request
   az_http_request request;
   _az_RETURN_IF_FAILED(az_http_request_init(
       &request,
-      opt.context,
+      opt->context,
       az_http_method_put(),
       request_url_span,
       uri_size,
       request_headers_span,
       content));
+  _az_RETURN_IF_FAILED(az_http_request_set_body_provider(&request, body_provider));
 
   // add blob type to request
   _az_RETURN_IF_FAILED(az_http_request_append_header(
@@ -180,18 +177,117 @@ AZ_NODISCARD az_result az_storage_blobs_blob_upload(
   uint8_t content_length[_az_INT64_AS_STR_BUFFER_SIZE] = { 0 };
   az_span content_length_span = AZ_SPAN_FROM_BUFFER(content_length);
   az_span remainder;
-  _az_RETURN_IF_FAILED(az_span_i64toa(content_length_span, az_span_size(content), &remainder));
+  int64_t const content_size
+      = body_provider == NULL ? az_span_size(content) : body_provider->length;
+  _az_RETURN_IF_FAILED(az_span_i64toa(content_length_span, content_size, &remainder));
   content_length_span
       = az_span_slice(content_length_span, 0, _az_span_diff(remainder, content_length_span));
 
   // add Content-Length to request
   _az_RETURN_IF_FAILED(
-      az_http_request_append_header(&request, AZ_HTTP_HEADER_CONTENT_LENGTH, content_length_span));
+      az_http_request_set_header(&request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, content_length_span));
 
   // add blob type to request
-  _az_RETURN_IF_FAILED(az_http_request_append_header(
-      &request, AZ_HTTP_HEADER_CONTENT_TYPE, AZ_SPAN_FROM_STR("text/plain")));
+  _az_RETURN_IF_FAILED(az_http_request_set_header(
+      &request, AZ_HTTP_HEADER_ID_CONTENT_TYPE, AZ_SPAN_FROM_STR("text/plain")));
 
   // start pipeline
   return az_http_pipeline_process(&ref_client->_internal.pipeline, &request, ref_response);
 }
+
+// Builds the request on the stack, when the context has no arena with room for it. The buffers are
+// only reserved when it is called.
+_az_NOINLINE AZ_NODISCARD az_result _az_storage_blobs_blob_upload_with_stack_buffers(
+    az_storage_blobs_blob_client* ref_client,
+    az_span content,
+    az_http_request_body_provider const* body_provider,
+    az_storage_blobs_blob_upload_options const* options,
+    az_http_response* ref_response)
+{
+  uint8_t url_buffer[AZ_HTTP_REQUEST_URL_BUFFER_SIZE];
+  uint8_t headers_buffer[_az_STORAGE_HTTP_REQUEST_HEADER_BUFFER_SIZE];
+  return _az_storage_blobs_blob_upload_with_buffers(
+      ref_client,
+      content,
+      body_provider,
+      options,
+      AZ_SPAN_FROM_BUFFER(url_buffer),
+      AZ_SPAN_FROM_BUFFER(headers_buffer),
+      ref_response);
+}
+
+static AZ_NODISCARD az_result _az_storage_blobs_blob_upload(
+    az_storage_blobs_blob_client* ref_client,
+    az_span content, /* Buffer of content*/
+    az_http_request_body_provider const* body_provider,
+    az_storage_blobs_blob_upload_options const* options,
+    az_http_response* ref_response)
+{
+
+  az_storage_blobs_blob_upload_options opt;
+  if (options == NULL)
+  {
+    opt = az_storage_blobs_blob_upload_options_default();
+  }
+  else
+  {
+    opt = *options;
+  }
+
+  // The request is built in the arena of the context when it has room for it. What the policies
+  // and the transport take from the arena while the request is sent is released along with it.
+  az_arena* const arena = az_arena_from_context(opt.context);
+  if (arena != NULL)
+  {
+    az_arena_mark const mark = az_arena_get_mark(arena);
+    az_span request_url_span = AZ_SPAN_EMPTY;
+    az_span request_headers_span = AZ_SPAN_EMPTY;
+    if (az_result_succeeded(
+            az_arena_allocate(arena, AZ_HTTP_REQUEST_URL_BUFFER_SIZE, &request_url_span))
+        && az_result_succeeded(az_arena_allocate(
+            arena, _az_STORAGE_HTTP_REQUEST_HEADER_BUFFER_SIZE, &request_headers_span)))
+    {
+      az_result const result = _az_storage_blobs_blob_upload_with_buffers(
+          ref_client,
+          content,
+          body_provider,
+          &opt,
+          request_url_span,
+          request_headers_span,
+          ref_response);
+      az_arena_rollback(arena, mark);
+      return result;
+    }
+
+    az_arena_rollback(arena, mark);
+  }
+
+  return _az_storage_blobs_blob_upload_with_stack_buffers(
+      ref_client, content, body_provider, &opt, ref_response);
+}
+
+AZ_NODISCARD az_result az_storage_blobs_blob_upload(
+    az_storage_blobs_blob_client* ref_client,
+    az_span content, /* Buffer of content*/
+    az_storage_blobs_blob_upload_options const* options,
+    az_http_response* ref_response)
+{
+  return _az_storage_blobs_blob_upload(ref_client, content, NULL, options, ref_response);
+}
+
+AZ_NODISCARD az_result az_storage_blobs_blob_upload_stream(
+    az_storage_blobs_blob_client* ref_client,
+    az_http_request_body_provider const* body_provider,
+    az_storage_blobs_blob_upload_options const* options,
+    az_http_response* ref_response)
+{
+  _az_PRECONDITION_NOT_NULL(ref_client);
+  _az_PRECONDITION_NOT_NULL(body_provider);
+  _az_PRECONDITION_NOT_NULL(body_provider->read);
+  // Put Blob needs to know the size of the blob upfront.
+  _az_PRECONDITION(body_provider->length >= 0);
+  _az_PRECONDITION_NOT_NULL(ref_response);
+
+  return _az_storage_blobs_blob_upload(
+      ref_client, AZ_SPAN_EMPTY, body_provider, options, ref_response);
+}
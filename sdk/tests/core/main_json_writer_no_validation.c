@@ -0,0 +1,19 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+#include <stdlib.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include "az_test_definitions.h"
+
+#include <azure/core/_az_cfg.h>
+
+// The JSON writer and these tests are compiled with AZ_NO_PRECONDITION_CHECKING, which removes the
+// writer state tracking. The tests compare the output against the same expected JSON text as
+// az_core_test.
+int main() { return test_az_json_writer_output(); }
@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <az_http_policy_logging_private.h>
+#include <azure/core/az_arena.h>
+#include <azure/core/az_config.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_result.h>
+#include <azure/core/internal/az_http_internal.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+static void test_az_arena_allocate(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[64];
+  az_arena arena;
+  assert_int_equal(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  az_span first = AZ_SPAN_EMPTY;
+  az_span second = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 3, &first), AZ_OK);
+  assert_int_equal(az_span_size(first), 3);
+  assert_int_equal(az_arena_allocate(&arena, 8, &second), AZ_OK);
+  assert_int_equal(az_span_size(second), 8);
+
+  // Allocations don't overlap, and are aligned on 8 bytes.
+  assert_true(az_span_ptr(second) >= az_span_ptr(first) + 3);
+  assert_int_equal((uintptr_t)az_span_ptr(first) % 8, 0);
+  assert_int_equal((uintptr_t)az_span_ptr(second) % 8, 0);
+
+  az_span empty = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 0, &empty), AZ_OK);
+  assert_int_equal(az_span_size(empty), 0);
+}
+
+static void test_az_arena_not_enough_space(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[64];
+  az_arena arena;
+  assert_int_equal(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  az_span span = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 100, &span), AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(az_arena_allocate(&arena, 100, &span), AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The peak counts what didn't fit, to size the buffer.
+  assert_true(az_arena_get_peak_size(&arena) >= 100);
+
+  // Nothing was taken by the allocations which failed.
+  assert_int_equal(az_arena_allocate(&arena, 48, &span), AZ_OK);
+
+  uint8_t empty_buffer[1];
+  assert_int_equal(az_arena_init(&arena, az_span_create(empty_buffer, 0)), AZ_OK);
+  assert_int_equal(az_arena_allocate(&arena, 1, &span), AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_az_arena_rollback_and_reset(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[64];
+  az_arena arena;
+  assert_int_equal(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  az_span first = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 16, &first), AZ_OK);
+
+  az_arena_mark const mark = az_arena_get_mark(&arena);
+  az_span second = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 16, &second), AZ_OK);
+  az_arena_rollback(&arena, mark);
+
+  az_span third = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 16, &third), AZ_OK);
+  assert_ptr_equal(az_span_ptr(third), az_span_ptr(second));
+
+  az_arena_reset(&arena);
+  az_span fourth = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, 16, &fourth), AZ_OK);
+  assert_ptr_equal(az_span_ptr(fourth), az_span_ptr(first));
+
+  // The peak stays once the memory is released.
+  assert_true(az_arena_get_peak_size(&arena) >= 32);
+}
+
+static void test_az_arena_from_context(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[64];
+  az_arena arena;
+  assert_int_equal(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+
+  assert_null(az_arena_from_context(NULL));
+  assert_null(az_arena_from_context(&az_context_application));
+
+  az_context const with_arena
+      = az_context_create_with_value(&az_context_application, &az_arena_context_key, &arena);
+  az_context const child = az_context_create_with_expiration(&with_arena, 100);
+  assert_ptr_equal(az_arena_from_context(&with_arena), &arena);
+  assert_ptr_equal(az_arena_from_context(&child), &arena);
+}
+
+static void test_az_arena_log_message(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[2 * AZ_LOG_MESSAGE_BUFFER_SIZE];
+  az_arena arena;
+  assert_int_equal(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(buffer)), AZ_OK);
+  az_context context
+      = az_context_create_with_value(&az_context_application, &az_arena_context_key, &arena);
+
+  uint8_t url_buffer[64];
+  az_span url = AZ_SPAN_FROM_BUFFER(url_buffer);
+  az_span_copy(url, AZ_SPAN_FROM_STR("https://www.example.com"));
+  uint8_t headers_buffer[4 * sizeof(_az_http_request_header)];
+  az_http_request request;
+  assert_int_equal(
+      az_http_request_init(
+          &request,
+          &context,
+          az_http_method_get(),
+          url,
+          sizeof("https://www.example.com") - 1,
+          AZ_SPAN_FROM_BUFFER(headers_buffer),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  // The log message is written into the arena, which gets the memory back right away.
+  _az_http_policy_logging_log_http_request(&request);
+  assert_true(az_arena_get_peak_size(&arena) >= AZ_LOG_MESSAGE_BUFFER_SIZE);
+
+  az_span span = AZ_SPAN_EMPTY;
+  assert_int_equal(az_arena_allocate(&arena, (int32_t)sizeof(buffer) - 8, &span), AZ_OK);
+}
+
+int test_az_arena()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_arena_allocate),
+    cmocka_unit_test(test_az_arena_not_enough_space),
+    cmocka_unit_test(test_az_arena_rollback_and_reset),
+    cmocka_unit_test(test_az_arena_from_context),
+    cmocka_unit_test(test_az_arena_log_message),
+  };
+  return cmocka_run_group_tests_name("az_core_arena", tests, NULL, NULL);
+}
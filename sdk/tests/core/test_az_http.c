@@ -560,6 +560,35 @@ static void test_http_response(void** state)
     }
   }
 
+  // HTTP/2 status line, with no minor version.
+  {
+    az_span response_span = AZ_SPAN_FROM_STR( //
+        "HTTP/2 201 \r\n"
+        "content-length: 2\r\n"
+        "\r\n"
+        "{}");
+
+    az_http_response response = { 0 };
+    assert_return_code(az_http_response_init(&response, response_span), AZ_OK);
+
+    az_http_response_status_line status_line = { 0 };
+    assert_return_code(az_http_response_get_status_line(&response, &status_line), AZ_OK);
+    assert_int_equal(status_line.major_version, 2);
+    assert_int_equal(status_line.minor_version, 0);
+    assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_CREATED);
+    assert_true(az_span_is_content_equal(status_line.reason_phrase, AZ_SPAN_FROM_STR("")));
+
+    az_span header_name = { 0 };
+    az_span header_value = { 0 };
+    assert_return_code(
+        az_http_response_get_next_header(&response, &header_name, &header_value), AZ_OK);
+    assert_true(az_span_is_content_equal(header_name, AZ_SPAN_FROM_STR("content-length")));
+
+    az_span body = { 0 };
+    assert_return_code(az_http_response_get_body(&response, &body), AZ_OK);
+    assert_true(az_span_is_content_equal(body, AZ_SPAN_FROM_STR("{}")));
+  }
+
   az_span response_span = AZ_SPAN_FROM_STR( //
       "HTTP/1.1 200 Ok\r\n"
       "Content-Type: text/html; charset=UTF-8\r\n"
@@ -892,6 +921,556 @@ static void test_http_response_append_overflow_on_second_call(void** state)
   }
 }
 
+typedef struct
+{
+  az_span content;
+  int32_t offset;
+  int32_t rewind_count;
+} _test_body_provider_state;
+
+static az_result _test_body_provider_read(
+    void* user_context,
+    az_span destination,
+    int32_t* out_bytes_read)
+{
+  _test_body_provider_state* const state = (_test_body_provider_state*)user_context;
+  az_span const remaining = az_span_slice_to_end(state->content, state->offset);
+  int32_t const size = az_span_size(remaining) < az_span_size(destination)
+      ? az_span_size(remaining)
+      : az_span_size(destination);
+  az_span_copy(destination, az_span_slice(remaining, 0, size));
+  state->offset += size;
+  *out_bytes_read = size;
+  return AZ_OK;
+}
+
+static az_result _test_body_provider_rewind(void* user_context)
+{
+  _test_body_provider_state* const state = (_test_body_provider_state*)user_context;
+  state->offset = 0;
+  state->rewind_count++;
+  return AZ_OK;
+}
+
+static void test_http_request_set_header(void** state)
+{
+  (void)state;
+
+  uint8_t header_buf[4 * sizeof(_az_http_request_header)] = { 0 };
+  az_http_request request = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("https://www.example.com");
+  TEST_EXPECT_SUCCESS(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_put(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(header_buf),
+      AZ_SPAN_EMPTY));
+
+  // Well-known headers appended by name are found by id, whatever the case of their name.
+  az_span value = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_request_append_header(
+      &request, AZ_SPAN_FROM_STR("content-type"), AZ_SPAN_FROM_STR("text/plain")));
+  TEST_EXPECT_SUCCESS(
+      az_http_request_append_header(&request, AZ_SPAN_FROM_STR("x-ms-blob-type"), AZ_SPAN_EMPTY));
+  TEST_EXPECT_SUCCESS(
+      az_http_request_get_header_by_id(&request, AZ_HTTP_HEADER_ID_CONTENT_TYPE, &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("text/plain")));
+  assert_int_equal(
+      az_http_request_get_header_by_id(&request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, &value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+
+  // Setting a header which was added replaces its value.
+  TEST_EXPECT_SUCCESS(az_http_request_set_header(
+      &request, AZ_HTTP_HEADER_ID_CONTENT_TYPE, AZ_SPAN_FROM_STR("application/json")));
+  assert_int_equal(az_http_request_headers_count(&request), 2);
+
+  az_span name = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_request_get_header(&request, 0, &name, &value));
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("content-type")));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("application/json")));
+
+  // Retry headers are set on each attempt, without the request growing.
+  TEST_EXPECT_SUCCESS(_az_http_request_mark_retry_headers_start(&request));
+  for (int i = 0; i < 3; i++)
+  {
+    TEST_EXPECT_SUCCESS(_az_http_request_remove_retry_headers(&request));
+    assert_int_equal(
+        az_http_request_get_header_by_id(&request, AZ_HTTP_HEADER_ID_AUTHORIZATION, &value),
+        AZ_ERROR_ITEM_NOT_FOUND);
+
+    TEST_EXPECT_SUCCESS(az_http_request_set_header(
+        &request, AZ_HTTP_HEADER_ID_AUTHORIZATION, AZ_SPAN_FROM_STR("Bearer token")));
+    TEST_EXPECT_SUCCESS(az_http_request_set_header(
+        &request, AZ_HTTP_HEADER_ID_AUTHORIZATION, AZ_SPAN_FROM_STR("Bearer other")));
+    TEST_EXPECT_SUCCESS(az_http_request_set_header(
+        &request, AZ_HTTP_HEADER_ID_CONTENT_TYPE, AZ_SPAN_FROM_STR("text/plain")));
+    assert_int_equal(az_http_request_headers_count(&request), 3);
+  }
+
+  TEST_EXPECT_SUCCESS(az_http_request_get_header(&request, 2, &name, &value));
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Authorization")));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("Bearer other")));
+
+  // The table of headers is full.
+  TEST_EXPECT_SUCCESS(az_http_request_set_header(
+      &request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, AZ_SPAN_FROM_STR("0")));
+  assert_int_equal(
+      az_http_request_set_header(
+          &request, AZ_HTTP_HEADER_ID_USER_AGENT, AZ_SPAN_FROM_STR("azsdk-c")),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+  assert_int_equal(
+      az_http_request_append_header(&request, AZ_SPAN_FROM_STR("x"), AZ_SPAN_EMPTY),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_http_request_body_provider(void** state)
+{
+  (void)state;
+
+  uint8_t url_buf[100] = { 0 };
+  uint8_t header_buf[sizeof(_az_http_request_header)] = { 0 };
+  az_span const url_span = AZ_SPAN_FROM_BUFFER(url_buf);
+  az_span_copy(url_span, request_url);
+
+  az_http_request request;
+  TEST_EXPECT_SUCCESS(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_put(),
+      url_span,
+      az_span_size(request_url),
+      AZ_SPAN_FROM_BUFFER(header_buf),
+      AZ_SPAN_EMPTY));
+
+  // No body provider by default, and the body span can be sent again.
+  az_http_request_body_provider const* body_provider = NULL;
+  TEST_EXPECT_SUCCESS(az_http_request_get_body_provider(&request, &body_provider));
+  assert_null(body_provider);
+  assert_true(_az_http_request_can_resend_body(&request));
+  TEST_EXPECT_SUCCESS(_az_http_request_rewind_body(&request));
+
+  _test_body_provider_state provider_state = {
+    .content = AZ_SPAN_FROM_STR("streamed body"),
+    .offset = 0,
+    .rewind_count = 0,
+  };
+  az_http_request_body_provider const provider = {
+    .read = _test_body_provider_read,
+    .rewind = _test_body_provider_rewind,
+    .length = az_span_size(provider_state.content),
+    .user_context = &provider_state,
+  };
+  TEST_EXPECT_SUCCESS(az_http_request_set_body_provider(&request, &provider));
+  TEST_EXPECT_SUCCESS(az_http_request_get_body_provider(&request, &body_provider));
+  assert_ptr_equal(body_provider, &provider);
+
+  // Read part of the body, then rewind it to send it again.
+  uint8_t read_buf[8] = { 0 };
+  int32_t bytes_read = 0;
+  TEST_EXPECT_SUCCESS(
+      body_provider->read(body_provider->user_context, AZ_SPAN_FROM_BUFFER(read_buf), &bytes_read));
+  assert_int_equal(bytes_read, 8);
+  assert_true(_az_http_request_can_resend_body(&request));
+  TEST_EXPECT_SUCCESS(_az_http_request_rewind_body(&request));
+  assert_int_equal(provider_state.offset, 0);
+  assert_int_equal(provider_state.rewind_count, 1);
+
+  // A body provider which can't be rewound can only be sent once.
+  az_http_request_body_provider const read_once_provider = {
+    .read = _test_body_provider_read,
+    .rewind = NULL,
+    .length = -1,
+    .user_context = &provider_state,
+  };
+  TEST_EXPECT_SUCCESS(az_http_request_set_body_provider(&request, &read_once_provider));
+  assert_false(_az_http_request_can_resend_body(&request));
+
+  // Back to the body span.
+  TEST_EXPECT_SUCCESS(az_http_request_set_body_provider(&request, NULL));
+  TEST_EXPECT_SUCCESS(az_http_request_get_body_provider(&request, &body_provider));
+  assert_null(body_provider);
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  az_http_request_body_provider const no_read_provider = {
+    .read = NULL,
+    .rewind = NULL,
+    .length = 0,
+    .user_context = NULL,
+  };
+  ASSERT_PRECONDITION_CHECKED(az_http_request_set_body_provider(&request, &no_read_provider));
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+typedef struct
+{
+  uint8_t buffer[32];
+  int32_t size;
+  int32_t reset_count;
+  az_result write_result;
+} _test_body_sink_state;
+
+static az_result _test_body_sink_write(void* user_context, az_span body_part)
+{
+  _test_body_sink_state* const state = (_test_body_sink_state*)user_context;
+  if (az_result_failed(state->write_result))
+  {
+    return state->write_result;
+  }
+
+  az_span const destination = az_span_slice_to_end(AZ_SPAN_FROM_BUFFER(state->buffer), state->size);
+  assert_true(az_span_size(body_part) <= az_span_size(destination));
+  az_span_copy(destination, body_part);
+  state->size += az_span_size(body_part);
+  return AZ_OK;
+}
+
+static az_result _test_body_sink_reset(void* user_context)
+{
+  _test_body_sink_state* const state = (_test_body_sink_state*)user_context;
+  state->size = 0;
+  state->reset_count++;
+  return AZ_OK;
+}
+
+static void test_http_response_body_sink(void** state)
+{
+  (void)state;
+
+  _test_body_sink_state sink_state = { .size = 0, .reset_count = 0, .write_result = AZ_OK };
+  az_http_response_body_sink const sink = {
+    .write = _test_body_sink_write,
+    .reset = _test_body_sink_reset,
+    .user_context = &sink_state,
+  };
+
+  uint8_t buffer[64] = { 0 };
+  az_http_response response = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_set_body_sink(&response, &sink));
+
+  // The body of a successful response goes to the sink, even when it doesn't fit in the buffer.
+  az_span const headers = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Length: 30\r\n\r\n");
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, headers));
+  TEST_EXPECT_SUCCESS(
+      az_http_response_append_body(&response, AZ_SPAN_FROM_STR("a body which is larger ")));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("than 64")));
+  assert_int_equal(response._internal.written, az_span_size(headers));
+  assert_true(az_span_is_content_equal(
+      az_span_create(sink_state.buffer, sink_state.size),
+      AZ_SPAN_FROM_STR("a body which is larger than 64")));
+  assert_true(_az_http_response_can_receive_body_again(&response));
+
+  az_http_response_status_line status_line = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+  az_span body = AZ_SPAN_FROM_STR("not empty");
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_int_equal(az_span_size(body), 0);
+
+  // Before the response is received again, the sink discards the body it got.
+  TEST_EXPECT_SUCCESS(_az_http_response_reset_body_sink(&response));
+  assert_int_equal(sink_state.size, 0);
+  assert_int_equal(sink_state.reset_count, 1);
+
+  // Resetting the response keeps the sink, and the body of an error goes to the buffer.
+  _az_http_response_reset(&response);
+  assert_ptr_equal(response._internal.body_sink, &sink);
+  TEST_EXPECT_SUCCESS(
+      az_http_response_append(&response, AZ_SPAN_FROM_STR("HTTP/1.1 404 Not Found\r\n\r\n")));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("{}")));
+  assert_int_equal(sink_state.size, 0);
+  TEST_EXPECT_SUCCESS(_az_http_response_reset_body_sink(&response));
+  assert_int_equal(sink_state.reset_count, 1);
+  TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_NOT_FOUND);
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, 2), AZ_SPAN_FROM_STR("{}")));
+
+  // A failure from the sink is returned as is.
+  _az_http_response_reset(&response);
+  sink_state.write_result = AZ_ERROR_CANCELED;
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, headers));
+  assert_int_equal(
+      az_http_response_append_body(&response, AZ_SPAN_FROM_STR("x")), AZ_ERROR_CANCELED);
+
+  // A body which went to a sink that can't be reset can't be received again.
+  az_http_response_body_sink const receive_once_sink = {
+    .write = _test_body_sink_write,
+    .reset = NULL,
+    .user_context = &sink_state,
+  };
+  sink_state.write_result = AZ_OK;
+  _az_http_response_reset(&response);
+  TEST_EXPECT_SUCCESS(az_http_response_set_body_sink(&response, &receive_once_sink));
+  assert_true(_az_http_response_can_receive_body_again(&response));
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, headers));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("x")));
+  assert_false(_az_http_response_can_receive_body_again(&response));
+
+  // Without a sink, the body is written into the buffer.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, headers));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("body")));
+  assert_int_equal(response._internal.written, az_span_size(headers) + 4);
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  az_http_response_body_sink const no_write_sink = {
+    .write = NULL,
+    .reset = NULL,
+    .user_context = NULL,
+  };
+  ASSERT_PRECONDITION_CHECKED(az_http_response_set_body_sink(&response, &no_write_sink));
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+typedef struct
+{
+  az_http_content_coding coding;
+  int32_t begin_count;
+  int32_t end_count;
+} _test_codec_state;
+
+static az_result
+_test_codec_begin(void* user_context, az_http_content_coding coding, bool is_compressing)
+{
+  _test_codec_state* const state = (_test_codec_state*)user_context;
+  assert_false(is_compressing);
+  state->coding = coding;
+  state->begin_count++;
+  return AZ_OK;
+}
+
+// Writes each byte of the source twice, until a '.' ends the body.
+static az_result _test_codec_process(
+    void* user_context,
+    az_span source,
+    az_span destination,
+    bool is_last,
+    int32_t* out_source_used,
+    int32_t* out_destination_used,
+    bool* out_is_end)
+{
+  (void)user_context;
+  (void)is_last;
+
+  int32_t used = 0;
+  *out_is_end = false;
+  while (used < az_span_size(source) && 2 * (used + 1) <= az_span_size(destination)
+         && !*out_is_end)
+  {
+    uint8_t const c = az_span_ptr(source)[used];
+    az_span_ptr(destination)[2 * used] = c;
+    az_span_ptr(destination)[2 * used + 1] = c;
+    *out_is_end = c == '.';
+    used++;
+  }
+
+  *out_source_used = used;
+  *out_destination_used = 2 * used;
+  return AZ_OK;
+}
+
+static void _test_codec_end(void* user_context)
+{
+  ((_test_codec_state*)user_context)->end_count++;
+}
+
+static void test_http_response_body_decoding(void** state)
+{
+  (void)state;
+
+  _test_codec_state codec_state = { 0 };
+  az_http_content_codec const codec = {
+    .begin = _test_codec_begin,
+    .process = _test_codec_process,
+    .end = _test_codec_end,
+    .user_context = &codec_state,
+  };
+
+  uint8_t buffer[64] = { 0 };
+  az_http_response response = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  response._internal.body_decoding.codec = &codec;
+
+  // The body is decoded as it is received.
+  az_span const headers = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Encoding: GZIP\r\n\r\n");
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, headers));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("ab")));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("c.")));
+  assert_int_equal(codec_state.coding, AZ_HTTP_CONTENT_CODING_GZIP);
+  assert_int_equal(codec_state.begin_count, 1);
+  assert_int_equal(codec_state.end_count, 1);
+  assert_int_equal(response._internal.written, az_span_size(headers) + 8);
+  az_span body = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_true(
+      az_span_is_content_equal(az_span_slice(body, 0, 8), AZ_SPAN_FROM_STR("aabbcc..")));
+
+  // Nothing may follow the end of the body.
+  assert_int_equal(
+      az_http_response_append_body(&response, AZ_SPAN_FROM_STR("d")),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+
+  // Bodies with other codings are left as they are.
+  _az_http_response_reset(&response);
+  assert_ptr_equal(response._internal.body_decoding.codec, &codec);
+  TEST_EXPECT_SUCCESS(az_http_response_append(
+      &response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Encoding: br\r\n\r\n")));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("ab.")));
+  assert_int_equal(codec_state.begin_count, 1);
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, 3), AZ_SPAN_FROM_STR("ab.")));
+
+  // A body which is reset before its end ends the codec.
+  _az_http_response_reset(&response);
+  TEST_EXPECT_SUCCESS(az_http_response_append(
+      &response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Encoding: deflate\r\n\r\n")));
+  TEST_EXPECT_SUCCESS(az_http_response_append_body(&response, AZ_SPAN_FROM_STR("ab")));
+  assert_int_equal(codec_state.coding, AZ_HTTP_CONTENT_CODING_DEFLATE);
+  _az_http_response_reset(&response);
+  assert_int_equal(codec_state.begin_count, 2);
+  assert_int_equal(codec_state.end_count, 2);
+}
+
+static void test_http_response_get_header(void** state)
+{
+  (void)state;
+
+  az_http_response response = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(
+      &response,
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                       "Content-Type: text/plain\r\n"
+                       "  x-ms-request-id :  1234  \r\n"
+                       "Empty:\r\n"
+                       "content-type: ignored\r\n"
+                       "\r\n"
+                       "body")));
+
+  // Headers are looked up ignoring case, and the first one with the name is returned.
+  az_span value = { 0 };
+  TEST_EXPECT_SUCCESS(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("CONTENT-TYPE"), &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("text/plain")));
+  TEST_EXPECT_SUCCESS(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("x-ms-request-id"), &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("1234")));
+  TEST_EXPECT_SUCCESS(az_http_response_get_header(&response, AZ_SPAN_FROM_STR("empty"), &value));
+  assert_int_equal(az_span_size(value), 0);
+  assert_int_equal(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("Content"), &value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(response._internal.header_index.state, _az_HTTP_RESPONSE_HEADER_INDEX_BUILT);
+  assert_int_equal(response._internal.header_index.count, 4);
+
+  // Looking headers up doesn't move the parser, which iterates over the index.
+  az_span name = { 0 };
+  assert_int_equal(
+      az_http_response_get_next_header(&response, &name, &value), AZ_ERROR_HTTP_INVALID_STATE);
+  az_http_response_status_line status_line = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+  TEST_EXPECT_SUCCESS(az_http_response_get_next_header(&response, &name, &value));
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Content-Type")));
+  TEST_EXPECT_SUCCESS(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("Empty"), &value));
+  TEST_EXPECT_SUCCESS(az_http_response_get_next_header(&response, &name, &value));
+  assert_true(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("x-ms-request-id")));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("1234")));
+  assert_true(az_span_is_content_equal(
+      az_span_slice(response._internal.parser.remaining, 0, 6), AZ_SPAN_FROM_STR("Empty:")));
+  TEST_EXPECT_SUCCESS(az_http_response_get_next_header(&response, &name, &value));
+  TEST_EXPECT_SUCCESS(az_http_response_get_next_header(&response, &name, &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("ignored")));
+  assert_int_equal(
+      az_http_response_get_next_header(&response, &name, &value), AZ_ERROR_HTTP_END_OF_HEADERS);
+  az_span body = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_true(az_span_is_content_equal(body, AZ_SPAN_FROM_STR("body")));
+
+  // Appending to the response builds the index again.
+  uint8_t buffer[64] = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_append(&response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n")));
+  assert_int_equal(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("Retry-After"), &value),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+  TEST_EXPECT_SUCCESS(
+      az_http_response_append(&response, AZ_SPAN_FROM_STR("Retry-After: 5\r\n\r\n")));
+  TEST_EXPECT_SUCCESS(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("retry-after"), &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("5")));
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  ASSERT_PRECONDITION_CHECKED(az_http_response_get_header(&response, AZ_SPAN_EMPTY, &value));
+  ASSERT_PRECONDITION_CHECKED(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("Retry-After"), NULL));
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+static void test_http_response_get_header_not_indexed(void** state)
+{
+  (void)state;
+
+  // More headers than the index holds are parsed on each use.
+  uint8_t buffer[1024] = { 0 };
+  az_span remainder
+      = az_span_copy(AZ_SPAN_FROM_BUFFER(buffer), AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"));
+  int32_t const header_count = AZ_HTTP_RESPONSE_HEADER_INDEX_SIZE + 4;
+  for (int32_t i = 0; i < header_count; ++i)
+  {
+    remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("h"));
+    TEST_EXPECT_SUCCESS(az_span_u64toa(remainder, (uint64_t)i, &remainder));
+    remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR(": v"));
+    TEST_EXPECT_SUCCESS(az_span_u64toa(remainder, (uint64_t)i, &remainder));
+    remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("\r\n"));
+  }
+  remainder = az_span_copy(remainder, AZ_SPAN_FROM_STR("\r\nbody"));
+
+  az_http_response response = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  az_span value = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_header(&response, AZ_SPAN_FROM_STR("H19"), &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("v19")));
+  assert_int_equal(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("h20"), &value),
+      AZ_ERROR_ITEM_NOT_FOUND);
+  assert_int_equal(
+      response._internal.header_index.state, _az_HTTP_RESPONSE_HEADER_INDEX_UNAVAILABLE);
+
+  az_http_response_status_line status_line = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+  az_span name = { 0 };
+  int32_t count = 0;
+  while (az_result_succeeded(az_http_response_get_next_header(&response, &name, &value)))
+  {
+    ++count;
+  }
+  assert_int_equal(count, header_count);
+  az_span body = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &body));
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, 4), AZ_SPAN_FROM_STR("body")));
+
+  // Headers before a corrupt one can still be found.
+  TEST_EXPECT_SUCCESS(az_http_response_init(
+      &response,
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                       "Good: 1\r\n"
+                       "(Bad): 2\r\n"
+                       "\r\n")));
+  TEST_EXPECT_SUCCESS(az_http_response_get_header(&response, AZ_SPAN_FROM_STR("good"), &value));
+  assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("1")));
+  assert_int_equal(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("other"), &value),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+
+  // A response without a status line has no headers to look up.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_STR("Good: 1\r\n\r\n")));
+  assert_true(az_result_failed(
+      az_http_response_get_header(&response, AZ_SPAN_FROM_STR("good"), &value)));
+}
+
 int test_az_http()
 {
 #ifndef AZ_NO_PRECONDITION_CHECKING
@@ -914,6 +1493,12 @@ int test_az_http()
     cmocka_unit_test(test_http_response_append_overflow),
     cmocka_unit_test(test_http_response_append),
     cmocka_unit_test(test_http_response_append_overflow_on_second_call),
+    cmocka_unit_test(test_http_request_set_header),
+    cmocka_unit_test(test_http_request_body_provider),
+    cmocka_unit_test(test_http_response_body_sink),
+    cmocka_unit_test(test_http_response_body_decoding),
+    cmocka_unit_test(test_http_response_get_header),
+    cmocka_unit_test(test_http_response_get_header_not_indexed),
   };
   return cmocka_run_group_tests_name("az_core_http", tests, NULL, NULL);
 }
@@ -0,0 +1,359 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+
+#include <azure/core/az_precondition.h>
+#include <azure/core/internal/az_precondition_internal.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <az_test_precondition.h>
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+ENABLE_PRECONDITION_CHECK_TESTS()
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+// Feeds received to the decoder, fragment_size bytes at a time, and returns the bytes used.
+static int32_t _feed_in_fragments(
+    az_http_response_decoder* ref_decoder,
+    az_span received,
+    int32_t fragment_size)
+{
+  int32_t used = 0;
+  while (used < az_span_size(received) && !az_http_response_decoder_is_complete(ref_decoder))
+  {
+    int32_t const end = used + fragment_size < az_span_size(received) ? used + fragment_size
+                                                                       : az_span_size(received);
+    int32_t fragment_used = 0;
+    TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(
+        ref_decoder, az_span_slice(received, used, end), &fragment_used));
+    used += fragment_used;
+  }
+
+  return used;
+}
+
+static void _assert_body(az_http_response* ref_response, az_span expected)
+{
+  az_span body = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(ref_response, &body));
+
+  // The body was written right after the headers, and up to the end of the response.
+  int32_t const body_offset
+      = (int32_t)(az_span_ptr(body) - az_span_ptr(ref_response->_internal.http_response));
+  assert_int_equal(ref_response->_internal.written, body_offset + az_span_size(expected));
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, az_span_size(expected)), expected));
+}
+
+static void test_http_response_decoder_content_length(void** state)
+{
+  (void)state;
+
+  az_span const received = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                                            "Content-Length: 11\r\n"
+                                            "\r\n"
+                                            "hello world"
+                                            "HTTP/1.1 200 OK\r\n");
+  int32_t const response_size
+      = az_span_size(received) - (int32_t)sizeof("HTTP/1.1 200 OK\r\n") + 1;
+
+  // Whatever the fragments, the bytes after the response are left for the next one.
+  for (int32_t fragment_size = 1; fragment_size <= az_span_size(received); ++fragment_size)
+  {
+    uint8_t buffer[128] = { 0 };
+    az_http_response response = { 0 };
+    az_http_response_decoder decoder = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+    TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+
+    assert_int_equal(_feed_in_fragments(&decoder, received, fragment_size), response_size);
+    assert_true(az_http_response_decoder_is_complete(&decoder));
+
+    az_http_response_status_line status_line = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+    assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+    _assert_body(&response, AZ_SPAN_FROM_STR("hello world"));
+
+    int32_t used = -1;
+    TEST_EXPECT_SUCCESS(
+        az_http_response_decoder_feed(&decoder, AZ_SPAN_FROM_STR("more"), &used));
+    assert_int_equal(used, 0);
+    TEST_EXPECT_SUCCESS(az_http_response_decoder_end(&decoder));
+  }
+}
+
+static void test_http_response_decoder_chunked(void** state)
+{
+  (void)state;
+
+  az_span const received = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                                            "Transfer-Encoding: gzip, Chunked\r\n"
+                                            "\r\n"
+                                            "4\r\n"
+                                            "Wiki\r\n"
+                                            "5;name=value\r\n"
+                                            "pedia\r\n"
+                                            "E \r\n"
+                                            " in\r\n\r\nchunks.\r\n"
+                                            "0\r\n"
+                                            "Trailer: ignored\r\n"
+                                            "\r\n");
+
+  for (int32_t fragment_size = 1; fragment_size <= az_span_size(received); ++fragment_size)
+  {
+    uint8_t buffer[128] = { 0 };
+    az_http_response response = { 0 };
+    az_http_response_decoder decoder = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+    TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+
+    assert_int_equal(
+        _feed_in_fragments(&decoder, received, fragment_size), az_span_size(received));
+    assert_true(az_http_response_decoder_is_complete(&decoder));
+
+    // The headers indexed to find how the body is delimited stay indexed.
+    assert_int_equal(response._internal.header_index.state, _az_HTTP_RESPONSE_HEADER_INDEX_BUILT);
+
+    // The chunk data is written after the headers, without the chunk framing.
+    az_http_response_status_line status_line = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+    _assert_body(&response, AZ_SPAN_FROM_STR("Wikipedia in\r\n\r\nchunks."));
+
+    az_span value = { 0 };
+    assert_int_equal(
+        az_http_response_get_header(&response, AZ_SPAN_FROM_STR("Trailer"), &value),
+        AZ_ERROR_ITEM_NOT_FOUND);
+  }
+}
+
+typedef struct
+{
+  uint8_t buffer[64];
+  int32_t size;
+} _test_decoder_sink_state;
+
+static az_result _test_decoder_sink_write(void* user_context, az_span body_part)
+{
+  _test_decoder_sink_state* const sink_state = (_test_decoder_sink_state*)user_context;
+  az_span const remainder
+      = az_span_slice_to_end(AZ_SPAN_FROM_BUFFER(sink_state->buffer), sink_state->size);
+  if (az_span_size(remainder) < az_span_size(body_part))
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  az_span_copy(remainder, body_part);
+  sink_state->size += az_span_size(body_part);
+  return AZ_OK;
+}
+
+static void test_http_response_decoder_chunked_to_sink(void** state)
+{
+  (void)state;
+
+  _test_decoder_sink_state sink_state = { .size = 0 };
+  az_http_response_body_sink const sink = {
+    .write = _test_decoder_sink_write,
+    .reset = NULL,
+    .user_context = &sink_state,
+  };
+
+  // The body doesn't have to fit in the response buffer.
+  uint8_t buffer[64] = { 0 };
+  az_http_response response = { 0 };
+  az_http_response_decoder decoder = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_set_body_sink(&response, &sink));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+
+  az_span const received = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                                            "Transfer-Encoding: chunked\r\n"
+                                            "\r\n"
+                                            "1e\r\n"
+                                            "a body larger than the buffer,\r\n"
+                                            "0f\r\n"
+                                            " sent in chunks\r\n"
+                                            "0\r\n"
+                                            "\r\n");
+  assert_int_equal(_feed_in_fragments(&decoder, received, 7), az_span_size(received));
+  assert_true(az_http_response_decoder_is_complete(&decoder));
+  assert_true(az_span_is_content_equal(
+      az_span_create(sink_state.buffer, sink_state.size),
+      AZ_SPAN_FROM_STR("a body larger than the buffer, sent in chunks")));
+
+  // Without a sink, it is the buffer which is too small.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  int32_t used = 0;
+  assert_int_equal(
+      az_http_response_decoder_feed(&decoder, received, &used), AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_http_response_decoder_without_body(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[128] = { 0 };
+  az_http_response response = { 0 };
+  az_http_response_decoder decoder = { 0 };
+  az_http_response_status_line status_line = { 0 };
+  int32_t used = 0;
+
+  // Interim responses are replaced by the final one.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_put()));
+  az_span const continued = AZ_SPAN_FROM_STR("HTTP/1.1 100 Continue\r\n"
+                                             "\r\n"
+                                             "HTTP/1.1 204 No Content\r\n"
+                                             "Content-Length: 10\r\n"
+                                             "\r\n");
+  assert_int_equal(_feed_in_fragments(&decoder, continued, 5), az_span_size(continued));
+  assert_true(az_http_response_decoder_is_complete(&decoder));
+  TEST_EXPECT_SUCCESS(az_http_response_get_status_line(&response, &status_line));
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_NO_CONTENT);
+  _assert_body(&response, AZ_SPAN_EMPTY);
+
+  // The response to a HEAD request has no body, whatever its headers say.
+  az_span const head = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                                        "Content-Length: 10\r\n"
+                                        "\r\n"
+                                        "next");
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_head()));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(&decoder, head, &used));
+  assert_int_equal(used, az_span_size(head) - 4);
+  assert_true(az_http_response_decoder_is_complete(&decoder));
+
+  // An empty body.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(
+      &decoder, AZ_SPAN_FROM_STR("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n"), &used));
+  assert_true(az_http_response_decoder_is_complete(&decoder));
+}
+
+static void test_http_response_decoder_until_close(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[128] = { 0 };
+  az_http_response response = { 0 };
+  az_http_response_decoder decoder = { 0 };
+  int32_t used = 0;
+
+  // Without a length, the body ends with the connection.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(
+      &decoder, AZ_SPAN_FROM_STR("HTTP/1.0 200 OK\r\nTransfer-Encoding: gzip\r\n\r\nab"), &used));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(&decoder, AZ_SPAN_FROM_STR("cd"), &used));
+  assert_false(az_http_response_decoder_is_complete(&decoder));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_end(&decoder));
+  assert_true(az_http_response_decoder_is_complete(&decoder));
+  _assert_body(&response, AZ_SPAN_FROM_STR("abcd"));
+
+  // Other bodies are cut short when the connection is closed.
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_feed(
+      &decoder, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nab"), &used));
+  assert_int_equal(
+      az_http_response_decoder_end(&decoder), AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  TEST_EXPECT_SUCCESS(
+      az_http_response_decoder_feed(&decoder, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"), &used));
+  assert_int_equal(
+      az_http_response_decoder_end(&decoder), AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+}
+
+static void _assert_decoder_fails(az_span received, az_result expected)
+{
+  uint8_t buffer[128] = { 0 };
+  az_http_response response = { 0 };
+  az_http_response_decoder decoder = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+
+  int32_t used = 0;
+  assert_int_equal(az_http_response_decoder_feed(&decoder, received, &used), expected);
+}
+
+static void test_http_response_decoder_errors(void** state)
+{
+  (void)state;
+
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 OK\r\n\r\n"), AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n(Bad): 1\r\n\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_HEADER);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\rx"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n"
+                       "Transfer-Encoding: chunked\r\n"
+                       "\r\n"
+                       "1000000000000000\r\n"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+  _assert_decoder_fails(
+      AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\rx"),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  uint8_t buffer[16] = { 0 };
+  az_http_response response = { 0 };
+  az_http_response_decoder decoder = { 0 };
+  int32_t used = 0;
+  TEST_EXPECT_SUCCESS(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(buffer)));
+  ASSERT_PRECONDITION_CHECKED(az_http_response_decoder_init(&decoder, NULL, az_http_method_get()));
+  TEST_EXPECT_SUCCESS(az_http_response_decoder_init(&decoder, &response, az_http_method_get()));
+  ASSERT_PRECONDITION_CHECKED(
+      az_http_response_decoder_feed(&decoder, AZ_SPAN_FROM_STR("HTTP"), NULL));
+  ASSERT_PRECONDITION_CHECKED(
+      az_http_response_decoder_feed(NULL, AZ_SPAN_FROM_STR("HTTP"), &used));
+#endif // AZ_NO_PRECONDITION_CHECKING
+}
+
+int test_az_http_response_decoder()
+{
+#ifndef AZ_NO_PRECONDITION_CHECKING
+  SETUP_PRECONDITION_CHECK_TESTS();
+#endif // AZ_NO_PRECONDITION_CHECKING
+
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_http_response_decoder_content_length),
+    cmocka_unit_test(test_http_response_decoder_chunked),
+    cmocka_unit_test(test_http_response_decoder_chunked_to_sink),
+    cmocka_unit_test(test_http_response_decoder_without_body),
+    cmocka_unit_test(test_http_response_decoder_until_close),
+    cmocka_unit_test(test_http_response_decoder_errors),
+  };
+  return cmocka_run_group_tests_name("az_core_http_response_decoder", tests, NULL, NULL);
+}
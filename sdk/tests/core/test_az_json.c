@@ -334,6 +334,8 @@ static void test_json_writer_append_nested_invalid(void** state)
           az_json_writer_append_json_text(&writer, AZ_SPAN_FROM_STR("{\"name\":  ")),
           AZ_ERROR_UNEXPECTED_END);
     }
+#ifndef AZ_NO_PRECONDITION_CHECKING
+    // The writer state is only tracked, and validated, when preconditions are enabled.
     {
       TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
       TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
@@ -371,6 +373,7 @@ static void test_json_writer_append_nested_invalid(void** state)
           az_json_writer_append_json_text(&writer, AZ_SPAN_FROM_STR("true")),
           AZ_ERROR_JSON_INVALID_STATE);
     }
+#endif // AZ_NO_PRECONDITION_CHECKING
   }
 }
 
@@ -414,6 +417,177 @@ az_result test_allocator_always_null(
   return AZ_OK;
 }
 
+static void test_json_writer_reset(void** state)
+{
+  (void)state;
+
+  uint8_t array[50] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("name")));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 1));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+  assert_true(az_span_is_content_equal(
+      az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("{\"name\":1}")));
+
+  az_json_writer_reset(&writer);
+  assert_int_equal(az_span_size(az_json_writer_get_bytes_used_in_destination(&writer)), 0);
+  assert_int_equal(writer._internal.total_bytes_written, 0);
+
+  // The writer state is reset as well, so a new top-level value can be written, without a comma.
+  TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 2));
+  TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+  assert_true(az_span_is_content_equal(
+      az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("[2]")));
+  assert_int_equal(writer._internal.total_bytes_written, 3);
+}
+
+static void test_json_writer_mark_rollback(void** state)
+{
+  (void)state;
+  {
+    uint8_t array[50] = { 0 };
+    az_json_writer writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 1));
+
+    az_json_writer_mark mark = az_json_writer_get_mark(&writer);
+
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("discard")));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_bool(&writer, true));
+
+    TEST_EXPECT_SUCCESS(az_json_writer_rollback(&writer, &mark));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("[1")));
+
+    // The comma and the nesting state are restored along with the position.
+    TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&writer, 2));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("[1,2]")));
+    assert_int_equal(writer._internal.total_bytes_written, 5);
+  }
+  {
+    uint8_t array[10] = { 0 };
+    az_json_writer writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+
+    az_json_writer_mark mark = az_json_writer_get_mark(&writer);
+
+    // The property fits, but its value doesn't, so discard both and close the object.
+    TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(&writer, AZ_SPAN_FROM_STR("abc")));
+    assert_int_equal(
+        az_json_writer_append_string(&writer, AZ_SPAN_FROM_STR("too long")),
+        AZ_ERROR_NOT_ENOUGH_SPACE);
+
+    TEST_EXPECT_SUCCESS(az_json_writer_rollback(&writer, &mark));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&writer));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("{}")));
+  }
+  {
+    int32_t current_index = 0;
+    _az_user_context user_context = { .current_index = &current_index };
+    az_json_writer writer = { 0 };
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_chunked_init(&writer, AZ_SPAN_EMPTY, test_allocator, &user_context, NULL));
+
+    az_json_writer_mark mark = az_json_writer_get_mark(&writer);
+
+    // The allocator callback provides a new buffer, so the writer can't go back to the mark.
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&writer));
+    assert_int_equal(az_json_writer_rollback(&writer, &mark), AZ_ERROR_JSON_INVALID_STATE);
+    assert_int_equal(writer._internal.total_bytes_written, 1);
+  }
+}
+
+static void test_json_writer_append_nested_writer(void** state)
+{
+  (void)state;
+  {
+    uint8_t nested_array[50] = { 0 };
+    az_json_writer nested_writer = { 0 };
+
+    uint8_t array[100] = { 0 };
+    az_json_writer writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+
+    // Build each element with the same nested writer, and splice it into the parent.
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_init(&nested_writer, AZ_SPAN_FROM_BUFFER(nested_array), NULL));
+    for (int32_t i = 0; i < 3; i++)
+    {
+      az_json_writer_reset(&nested_writer);
+      TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&nested_writer));
+      TEST_EXPECT_SUCCESS(
+          az_json_writer_append_property_name(&nested_writer, AZ_SPAN_FROM_STR("id")));
+      TEST_EXPECT_SUCCESS(az_json_writer_append_int32(&nested_writer, i));
+      TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&nested_writer));
+
+      TEST_EXPECT_SUCCESS(az_json_writer_append_nested_writer(&writer, &nested_writer));
+    }
+
+    az_json_writer_reset(&nested_writer);
+    TEST_EXPECT_SUCCESS(az_json_writer_append_string(&nested_writer, AZ_SPAN_FROM_STR("a\"b")));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_nested_writer(&writer, &nested_writer));
+
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+
+    az_span expected = AZ_SPAN_FROM_STR("[{\"id\":0},{\"id\":1},{\"id\":2},\"a\\\"b\"]");
+    assert_true(
+        az_span_is_content_equal(az_json_writer_get_bytes_used_in_destination(&writer), expected));
+    assert_int_equal(writer._internal.total_bytes_written, az_span_size(expected));
+
+    // There is no space left in the parent for the nested JSON.
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_init(&writer, az_span_slice(AZ_SPAN_FROM_BUFFER(array), 0, 5), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+    assert_int_equal(
+        az_json_writer_append_nested_writer(&writer, &nested_writer), AZ_ERROR_NOT_ENOUGH_SPACE);
+    assert_int_equal(writer._internal.bytes_written, 1);
+  }
+  {
+    uint8_t nested_array[200] = { 0 };
+    az_json_writer nested_writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_init(&nested_writer, AZ_SPAN_FROM_BUFFER(nested_array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_object(&nested_writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_property_name(
+        &nested_writer, AZ_SPAN_FROM_STR("a property name longer than a single chunk")));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_null(&nested_writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_object(&nested_writer));
+
+    int32_t current_index = 0;
+    _az_user_context user_context = { .current_index = &current_index };
+    az_json_writer writer = { 0 };
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_chunked_init(&writer, AZ_SPAN_EMPTY, test_allocator, &user_context, NULL));
+
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_bool(&writer, false));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_nested_writer(&writer, &nested_writer));
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+
+    az_span expected
+        = AZ_SPAN_FROM_STR("[false,{\"a property name longer than a single chunk\":null}]");
+    assert_int_equal(writer._internal.total_bytes_written, az_span_size(expected));
+    assert_true(az_span_is_content_equal(
+        az_span_slice(AZ_SPAN_FROM_BUFFER(json_array), 0, writer._internal.total_bytes_written),
+        expected));
+  }
+}
+
 static void test_json_writer_chunked(void** state)
 {
   (void)state;
@@ -2754,6 +2928,128 @@ static void test_az_json_reader_chunked(void** state)
   assert_true(az_span_is_content_equal(expected, az_span_create_from_str(m.name_string)));
 }
 
+static az_span const _transcode_input = AZ_SPAN_LITERAL_FROM_STR(
+    " { \"name\" : \"f\\u0065o\\n\" ,\r\n \"values\":[ 1 , -2.5e3, true ,null, { } , [ ] ],\t"
+    "\"nested\": { \"a\": [ false ] } } ");
+
+static az_span const _transcode_minified = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"name\":\"f\\u0065o\\n\",\"values\":[1,-2.5e3,true,null,{},[]],\"nested\":{\"a\":[false]}}");
+
+static az_span const _transcode_pretty_printed = AZ_SPAN_LITERAL_FROM_STR(
+    "{\n"
+    "  \"name\": \"f\\u0065o\\n\",\n"
+    "  \"values\": [\n"
+    "    1,\n"
+    "    -2.5e3,\n"
+    "    true,\n"
+    "    null,\n"
+    "    {},\n"
+    "    []\n"
+    "  ],\n"
+    "  \"nested\": {\n"
+    "    \"a\": [\n"
+    "      false\n"
+    "    ]\n"
+    "  }\n"
+    "}");
+
+static void test_az_json_transcode(void** state)
+{
+  (void)state;
+  {
+    uint8_t array[200] = { 0 };
+    az_json_reader reader = { 0 };
+    az_json_writer writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, _transcode_input, NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_MINIFY));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), _transcode_minified));
+    assert_int_equal(writer._internal.total_bytes_written, az_span_size(_transcode_minified));
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, _transcode_input, NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_PRETTY_PRINT));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), _transcode_pretty_printed));
+
+    // Pretty printed JSON minifies back to the same text.
+    uint8_t minified[200] = { 0 };
+    TEST_EXPECT_SUCCESS(az_json_reader_init(
+        &reader, az_json_writer_get_bytes_used_in_destination(&writer), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(minified), NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_MINIFY));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), _transcode_minified));
+  }
+  {
+    uint8_t array[10] = { 0 };
+    az_json_reader reader = { 0 };
+    az_json_writer writer = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR(" \"a string\" "), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_PRETTY_PRINT));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), AZ_SPAN_FROM_STR("\"a string\"")));
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR("[1, 2, 3, 4, 5]"), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    assert_int_equal(
+        az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_PRETTY_PRINT),
+        AZ_ERROR_NOT_ENOUGH_SPACE);
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR("[1, 2"), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    assert_int_equal(
+        az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_MINIFY), AZ_ERROR_UNEXPECTED_END);
+
+    TEST_EXPECT_SUCCESS(az_json_reader_init(&reader, AZ_SPAN_FROM_STR("[1, 2}"), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    assert_int_equal(
+        az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_MINIFY), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+}
+
+static void test_az_json_transcode_chunked(void** state)
+{
+  (void)state;
+
+  // Read the input one byte at a time, so every token straddles multiple buffers.
+  az_span input_buffers[128] = { 0 };
+  assert_true(az_span_size(_transcode_input) <= 128);
+  _az_split_buffers_single_byte(_transcode_input, input_buffers);
+
+  az_json_reader reader = { 0 };
+  az_json_writer writer = { 0 };
+  {
+    int32_t current_index = 0;
+    _az_user_context user_context = { .current_index = &current_index };
+
+    TEST_EXPECT_SUCCESS(az_json_reader_chunked_init(
+        &reader, input_buffers, az_span_size(_transcode_input), NULL));
+    TEST_EXPECT_SUCCESS(
+        az_json_writer_chunked_init(&writer, AZ_SPAN_EMPTY, test_allocator, &user_context, NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_MINIFY));
+
+    assert_int_equal(writer._internal.total_bytes_written, az_span_size(_transcode_minified));
+    assert_true(az_span_is_content_equal(
+        az_span_slice(AZ_SPAN_FROM_BUFFER(json_array), 0, writer._internal.total_bytes_written),
+        _transcode_minified));
+  }
+  {
+    uint8_t array[200] = { 0 };
+
+    TEST_EXPECT_SUCCESS(az_json_reader_chunked_init(
+        &reader, input_buffers, az_span_size(_transcode_input), NULL));
+    TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(array), NULL));
+    TEST_EXPECT_SUCCESS(az_json_transcode(&reader, &writer, AZ_JSON_TRANSCODE_PRETTY_PRINT));
+    assert_true(az_span_is_content_equal(
+        az_json_writer_get_bytes_used_in_destination(&writer), _transcode_pretty_printed));
+  }
+}
+
 int test_az_json()
 {
   const struct CMUnitTest tests[]
@@ -2764,6 +3060,9 @@ int test_az_json()
           cmocka_unit_test(test_json_writer_chunked),
           cmocka_unit_test(test_json_writer_chunked_no_callback),
           cmocka_unit_test(test_json_writer_large_string_chunked),
+          cmocka_unit_test(test_json_writer_reset),
+          cmocka_unit_test(test_json_writer_mark_rollback),
+          cmocka_unit_test(test_json_writer_append_nested_writer),
           cmocka_unit_test(test_json_reader),
           cmocka_unit_test(test_json_reader_invalid),
           cmocka_unit_test(test_json_reader_incomplete),
@@ -2775,6 +3074,8 @@ int test_az_json()
           cmocka_unit_test(test_az_json_token_number_too_large),
           cmocka_unit_test(test_az_json_token_literal),
           cmocka_unit_test(test_az_json_token_copy),
-          cmocka_unit_test(test_az_json_reader_chunked) };
+          cmocka_unit_test(test_az_json_reader_chunked),
+          cmocka_unit_test(test_az_json_transcode),
+          cmocka_unit_test(test_az_json_transcode_chunked) };
   return cmocka_run_group_tests_name("az_core_json", tests, NULL, NULL);
 }
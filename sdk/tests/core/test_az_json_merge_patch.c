@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include "az_test_definitions.h"
+#include <azure/core/az_json.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
+
+static void _assert_merge_patch(char* original, char* modified, char* expected)
+{
+  uint8_t scratch[512] = { 0 };
+  uint8_t destination[512] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(destination), NULL));
+  TEST_EXPECT_SUCCESS(az_json_merge_patch_create(
+      az_span_create_from_str(original),
+      az_span_create_from_str(modified),
+      AZ_SPAN_FROM_BUFFER(scratch),
+      &writer));
+
+  az_span const written = az_json_writer_get_bytes_used_in_destination(&writer);
+  az_span const expected_span = az_span_create_from_str(expected);
+  assert_int_equal(az_span_size(written), az_span_size(expected_span));
+  assert_memory_equal(
+      az_span_ptr(written), az_span_ptr(expected_span), (size_t)az_span_size(expected_span));
+}
+
+static void _assert_merge_patch_applied(char* target, char* patch, char* expected)
+{
+  uint8_t scratch[512] = { 0 };
+  uint8_t destination[512] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(destination), NULL));
+  TEST_EXPECT_SUCCESS(az_json_merge_patch_apply(
+      az_span_create_from_str(target),
+      az_span_create_from_str(patch),
+      AZ_SPAN_FROM_BUFFER(scratch),
+      &writer));
+
+  az_span const written = az_json_writer_get_bytes_used_in_destination(&writer);
+  az_span const expected_span = az_span_create_from_str(expected);
+  assert_int_equal(az_span_size(written), az_span_size(expected_span));
+  assert_memory_equal(
+      az_span_ptr(written), az_span_ptr(expected_span), (size_t)az_span_size(expected_span));
+}
+
+static void test_json_merge_patch_create(void** state)
+{
+  (void)state;
+
+  // No changes, regardless of white space and property order.
+  _assert_merge_patch("{\"a\":1,\"b\":[1,2]}", " { \"b\" : [ 1, 2 ], \"a\" : 1 } ", "{}");
+
+  // Added, changed and removed properties.
+  _assert_merge_patch(
+      "{\"a\":1,\"b\":\"x\",\"c\":true}",
+      "{\"a\":2,\"b\":\"x\",\"d\":{\"e\": null}}",
+      "{\"a\":2,\"d\":{\"e\":null},\"c\":null}");
+
+  // Nested objects are compared property by property, and dropped when nothing changed in them.
+  _assert_merge_patch(
+      "{\"same\":{\"x\":1},\"changed\":{\"x\":1,\"y\":{\"z\":[1]}}}",
+      "{\"same\":{\"x\":1},\"changed\":{\"x\":1,\"y\":{\"z\":[1,2]}}}",
+      "{\"changed\":{\"y\":{\"z\":[1,2]}}}");
+
+  // Arrays and values changing kind are replaced whole.
+  _assert_merge_patch(
+      "{\"a\":[1,{\"b\":2}],\"c\":{\"d\":1},\"e\":5}",
+      "{\"a\":[1,{\"b\":3}],\"c\":[],\"e\":{\"f\":\"g\"}}",
+      "{\"a\":[1,{\"b\":3}],\"c\":[],\"e\":{\"f\":\"g\"}}");
+
+  // Property names are compared unescaped, and written escaped.
+  _assert_merge_patch("{\"a\\/b\":1,\"gone\\n\":2}", "{\"a/b\":1}", "{\"gone\\n\":null}");
+
+  // Unless both documents are objects, the whole modified document is the patch.
+  _assert_merge_patch("{\"a\":1}", " [ 1, \"two\" ] ", "[1,\"two\"]");
+  _assert_merge_patch("[1]", "{ \"a\" : 1 }", "{\"a\":1}");
+  _assert_merge_patch("{\"a\":1}", "\"text\"", "\"text\"");
+}
+
+static void test_json_merge_patch_create_errors(void** state)
+{
+  (void)state;
+
+  uint8_t scratch[64] = { 0 };
+  uint8_t destination[64] = { 0 };
+  az_json_writer writer = { 0 };
+
+  // Invalid JSON documents.
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(destination), NULL));
+  assert_int_equal(
+      az_json_merge_patch_create(
+          AZ_SPAN_FROM_STR("{\"a\":1"),
+          AZ_SPAN_FROM_STR("{}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &writer),
+      AZ_ERROR_UNEXPECTED_END);
+  assert_int_equal(
+      az_json_merge_patch_create(
+          AZ_SPAN_FROM_STR("{}"),
+          AZ_SPAN_FROM_STR("{} {}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &writer),
+      AZ_ERROR_UNEXPECTED_CHAR);
+
+  // The scratch buffer can't index all of the original properties.
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(destination), NULL));
+  assert_int_equal(
+      az_json_merge_patch_create(
+          AZ_SPAN_FROM_STR("{\"a\":1,\"b\":2,\"c\":3,\"d\":4}"),
+          AZ_SPAN_FROM_STR("{}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &writer),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The destination is too small for the patch.
+  TEST_EXPECT_SUCCESS(az_json_writer_init(
+      &writer, az_span_slice(AZ_SPAN_FROM_BUFFER(destination), 0, 8), NULL));
+  assert_int_equal(
+      az_json_merge_patch_create(
+          AZ_SPAN_FROM_STR("{}"),
+          AZ_SPAN_FROM_STR("{\"a\":\"long value\"}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &writer),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static void test_json_merge_patch_apply(void** state)
+{
+  (void)state;
+
+  // The examples from RFC 7386, appendix A.
+  _assert_merge_patch_applied("{\"a\":\"b\"}", "{\"a\":\"c\"}", "{\"a\":\"c\"}");
+  _assert_merge_patch_applied("{\"a\":\"b\"}", "{\"b\":\"c\"}", "{\"a\":\"b\",\"b\":\"c\"}");
+  _assert_merge_patch_applied("{\"a\":\"b\"}", "{\"a\":null}", "{}");
+  _assert_merge_patch_applied(
+      "{\"a\":\"b\",\"b\":\"c\"}", "{\"a\":null}", "{\"b\":\"c\"}");
+  _assert_merge_patch_applied("{\"a\":[\"b\"]}", "{\"a\":\"c\"}", "{\"a\":\"c\"}");
+  _assert_merge_patch_applied("{\"a\":\"c\"}", "{\"a\":[\"b\"]}", "{\"a\":[\"b\"]}");
+  _assert_merge_patch_applied(
+      "{\"a\":{\"b\":\"c\"}}",
+      "{\"a\":{\"b\":\"d\",\"c\":null}}",
+      "{\"a\":{\"b\":\"d\"}}");
+  _assert_merge_patch_applied(
+      "{\"a\":[{\"b\":\"c\"}]}", "{\"a\":[1]}", "{\"a\":[1]}");
+  _assert_merge_patch_applied("[\"a\",\"b\"]", "[\"c\",\"d\"]", "[\"c\",\"d\"]");
+  _assert_merge_patch_applied("{\"a\":\"b\"}", "[\"c\"]", "[\"c\"]");
+  _assert_merge_patch_applied("{\"a\":\"foo\"}", "null", "null");
+  _assert_merge_patch_applied("{\"a\":\"foo\"}", "\"bar\"", "\"bar\"");
+  _assert_merge_patch_applied("{\"e\":null}", "{\"a\":1}", "{\"e\":null,\"a\":1}");
+  _assert_merge_patch_applied("[1,2]", "{\"a\":\"b\",\"c\":null}", "{\"a\":\"b\"}");
+  _assert_merge_patch_applied(
+      "{}", "{\"a\":{\"bb\":{\"ccc\":null}}}", "{\"a\":{\"bb\":{}}}");
+
+  // White space is dropped, and the order of the target properties is kept.
+  _assert_merge_patch_applied(
+      " { \"x\" : 1 , \"y\" : { \"z\" : true } } ",
+      " { \"y\" : { \"w\" : [ 1, 2 ] }, \"x\" : 2 } ",
+      "{\"x\":2,\"y\":{\"z\":true,\"w\":[1,2]}}");
+}
+
+static void test_json_merge_patch_round_trip(void** state)
+{
+  (void)state;
+
+  az_span const original = AZ_SPAN_FROM_STR(
+      "{\"name\":\"dev\",\"config\":{\"rate\":5,\"mode\":\"a\",\"tags\":[1]},\"old\":true}");
+  az_span const modified
+      = AZ_SPAN_FROM_STR("{\"name\":\"dev\",\"config\":{\"rate\":10,\"tags\":[1]},\"new\":{}}");
+
+  uint8_t scratch[512] = { 0 };
+  uint8_t patch[256] = { 0 };
+  uint8_t patched[256] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(patch), NULL));
+  TEST_EXPECT_SUCCESS(
+      az_json_merge_patch_create(original, modified, AZ_SPAN_FROM_BUFFER(scratch), &writer));
+  az_span const patch_json = az_json_writer_get_bytes_used_in_destination(&writer);
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(patched), NULL));
+  TEST_EXPECT_SUCCESS(
+      az_json_merge_patch_apply(original, patch_json, AZ_SPAN_FROM_BUFFER(scratch), &writer));
+  assert_true(
+      az_span_is_content_equal(az_json_writer_get_bytes_used_in_destination(&writer), modified));
+}
+
+int test_az_json_merge_patch()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_json_merge_patch_create),
+    cmocka_unit_test(test_json_merge_patch_create_errors),
+    cmocka_unit_test(test_json_merge_patch_apply),
+    cmocka_unit_test(test_json_merge_patch_round_trip),
+  };
+  return cmocka_run_group_tests_name("az_core_json_merge_patch", tests, NULL, NULL);
+}
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+// These tests verify the exact bytes produced by the JSON writer. They are part of az_core_test,
+// and they are also built into az_core_json_writer_no_validation_test, where the JSON writer is
+// compiled with AZ_NO_PRECONDITION_CHECKING. Passing in both builds verifies that removing the
+// writer state tracking doesn't change the JSON text that is written.
+
+#include "az_test_definitions.h"
+#include <azure/core/az_json.h>
+#include <azure/core/internal/az_result_internal.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
+
+#define TEST_OUTPUT_CHUNK_SIZE 64
+
+static uint8_t _output_chunks[4096];
+
+static az_result _output_chunk_allocator(
+    az_span_allocator_context* allocator_context,
+    az_span* out_next_destination)
+{
+  int32_t* next_chunk_offset = (int32_t*)allocator_context->user_context;
+
+  if (*next_chunk_offset + allocator_context->minimum_required_size
+      > (int32_t)sizeof(_output_chunks))
+  {
+    return AZ_ERROR_NOT_ENOUGH_SPACE;
+  }
+
+  // Hand out chunks back to back, so the concatenation of all of them is the whole JSON text.
+  *next_chunk_offset += allocator_context->bytes_used;
+  *out_next_destination = az_span_slice(
+      AZ_SPAN_FROM_BUFFER(_output_chunks),
+      *next_chunk_offset,
+      *next_chunk_offset + allocator_context->minimum_required_size);
+
+  return AZ_OK;
+}
+
+static az_result _write_sample_document(az_json_writer* ref_json_writer)
+{
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("name")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_bool(ref_json_writer, true));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("values")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(ref_json_writer, AZ_SPAN_FROM_STR("bar")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_null(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_bool(ref_json_writer, false));
+  _az_RETURN_IF_FAILED(az_json_writer_append_int32(ref_json_writer, -12));
+  _az_RETURN_IF_FAILED(az_json_writer_append_double(ref_json_writer, 1.5, 2));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_object(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_begin_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+  _az_RETURN_IF_FAILED(az_json_writer_append_end_array(ref_json_writer));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("esc\t")));
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_string(ref_json_writer, AZ_SPAN_FROM_STR("_\"_\\_\n_\x01_")));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("long property name")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_string(
+      ref_json_writer, AZ_SPAN_FROM_STR("a string which is written in more than one chunk\n")));
+
+  _az_RETURN_IF_FAILED(
+      az_json_writer_append_property_name(ref_json_writer, AZ_SPAN_FROM_STR("nested")));
+  _az_RETURN_IF_FAILED(az_json_writer_append_json_text(
+      ref_json_writer, AZ_SPAN_FROM_STR("{\"a\": [1, 2], \"b\": {}}")));
+
+  return az_json_writer_append_end_object(ref_json_writer);
+}
+
+static az_span const _expected_sample_document = AZ_SPAN_LITERAL_FROM_STR(
+    "{"
+    "\"name\":true,"
+    "\"values\":[\"bar\",null,false,-12,1.5,{},[]],"
+    "\"esc\\t\":\"_\\\"_\\\\_\\n_\\u0001_\","
+    "\"long property name\":\"a string which is written in more than one chunk\\n\","
+    "\"nested\":{\"a\": [1, 2], \"b\": {}}"
+    "}");
+
+static void test_json_writer_output_contiguous(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[256] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL));
+  TEST_EXPECT_SUCCESS(_write_sample_document(&writer));
+
+  az_span written = az_json_writer_get_bytes_used_in_destination(&writer);
+  assert_int_equal(az_span_size(written), az_span_size(_expected_sample_document));
+  assert_memory_equal(
+      az_span_ptr(written),
+      az_span_ptr(_expected_sample_document),
+      (size_t)az_span_size(_expected_sample_document));
+  assert_int_equal(writer._internal.total_bytes_written, az_span_size(_expected_sample_document));
+}
+
+static void test_json_writer_output_chunked(void** state)
+{
+  (void)state;
+
+  int32_t next_chunk_offset = 0;
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_chunked_init(
+      &writer,
+      az_span_slice(AZ_SPAN_FROM_BUFFER(_output_chunks), 0, TEST_OUTPUT_CHUNK_SIZE),
+      _output_chunk_allocator,
+      &next_chunk_offset,
+      NULL));
+  TEST_EXPECT_SUCCESS(_write_sample_document(&writer));
+
+  int32_t const total_size = writer._internal.total_bytes_written;
+  assert_int_equal(total_size, next_chunk_offset + writer._internal.bytes_written);
+  assert_int_equal(total_size, az_span_size(_expected_sample_document));
+  assert_memory_equal(_output_chunks, az_span_ptr(_expected_sample_document), (size_t)total_size);
+}
+
+static void test_json_writer_output_nesting_overflow(void** state)
+{
+  (void)state;
+
+  uint8_t buffer[256] = { 0 };
+  az_json_writer writer = { 0 };
+
+  TEST_EXPECT_SUCCESS(az_json_writer_init(&writer, AZ_SPAN_FROM_BUFFER(buffer), NULL));
+
+  for (int32_t i = 0; i < 64; i++)
+  {
+    TEST_EXPECT_SUCCESS(az_json_writer_append_begin_array(&writer));
+  }
+
+  assert_int_equal(az_json_writer_append_begin_array(&writer), AZ_ERROR_JSON_NESTING_OVERFLOW);
+  assert_int_equal(az_json_writer_append_begin_object(&writer), AZ_ERROR_JSON_NESTING_OVERFLOW);
+
+  for (int32_t i = 0; i < 64; i++)
+  {
+    TEST_EXPECT_SUCCESS(az_json_writer_append_end_array(&writer));
+  }
+
+  assert_int_equal(writer._internal.bytes_written, 128);
+  assert_int_equal(buffer[63], '[');
+  assert_int_equal(buffer[64], ']');
+}
+
+int test_az_json_writer_output()
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_json_writer_output_contiguous),
+    cmocka_unit_test(test_json_writer_output_chunked),
+    cmocka_unit_test(test_json_writer_output_nesting_overflow),
+  };
+  return cmocka_run_group_tests_name("az_core_json_writer_output", tests, NULL, NULL);
+}
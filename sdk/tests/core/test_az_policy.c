@@ -2,11 +2,16 @@
 // SPDX-License-Identifier: MIT
 
 #include "az_test_definitions.h"
+#include <az_http_private.h>
 #include <azure/core/az_credentials.h>
 #include <azure/core/az_http.h>
 #include <azure/core/az_http_transport.h>
 #include <azure/core/az_span.h>
 #include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/core/internal/az_retry_internal.h>
+
+#include <string.h>
 
 #include <setjmp.h>
 #include <stdarg.h>
@@ -33,10 +38,44 @@ az_result test_policy_transport_retry_response_with_header_2(
     void* ref_options,
     az_http_request* ref_request,
     az_http_response* ref_response);
+
+az_result test_policy_transport_interrupted_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+az_result test_policy_transport_adapter_error(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+az_result test_policy_transport_read_body_retry_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
+
+az_result test_policy_transport_stream_body_interrupted_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response);
 void test_az_http_pipeline_policy_credential(void** state);
 void test_az_http_pipeline_policy_retry(void** state);
 void test_az_http_pipeline_policy_retry_with_header(void** state);
 void test_az_http_pipeline_policy_retry_with_header_2(void** state);
+void test_az_http_pipeline_policy_retry_connection_interrupted(void** state);
+void test_az_http_pipeline_policy_retry_adapter_error(void** state);
+void test_az_http_pipeline_policy_retry_rewinds_body_provider(void** state);
+void test_az_http_pipeline_policy_retry_body_provider_without_rewind(void** state);
+void test_az_http_pipeline_policy_retry_resets_body_sink(void** state);
+void test_az_http_pipeline_policy_retry_body_sink_without_reset(void** state);
+void test_az_http_pipeline_policy_retry_past_deadline(void** state);
+void test_az_http_pipeline_policy_retry_budget(void** state);
+void test_az_http_pipeline_policy_circuit_breaker(void** state);
+void test_az_http_pipeline_policy_rate_limiter(void** state);
 #endif // _az_MOCK_ENABLED
 
 static az_result test_policy_transport(
@@ -47,6 +86,13 @@ static az_result test_policy_transport(
 
 void test_az_http_pipeline_policy_apiversion(void** state);
 void test_az_http_pipeline_policy_telemetry(void** state);
+void test_az_http_pipeline_policy_retry_decorrelated_delay(void** state);
+void test_az_http_pipeline_policy_hedging_passes_through(void** state);
+void test_az_http_pipeline_policy_metrics(void** state);
+void test_az_http_metrics_latency_percentile(void** state);
+void test_az_http_pipeline_policy_tracing(void** state);
+void test_az_http_pipeline_policy_tracing_span_buffer(void** state);
+void test_az_http_tracing_context_parse(void** state);
 
 az_result test_policy_transport(
     _az_http_policy* ref_policies,
@@ -358,10 +404,1397 @@ void test_az_http_pipeline_policy_retry_with_header_2(void** state)
       az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
 }
 
-int64_t __wrap_az_platform_clock_msec();
-int64_t __wrap_az_platform_clock_msec() { return (int64_t)mock(); }
+const az_span ok_response = AZ_SPAN_LITERAL_FROM_STR("HTTP/1.1 200 OK\r\n"
+                                                     "Content-Type: text/html; charset=UTF-8\r\n"
+                                                     "\r\n"
+                                                     "{}");
 
-#endif // _az_MOCK_ENABLED
+az_result test_policy_transport_interrupted_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+
+  // The first attempt loses its connection, the second one gets the response.
+  int32_t* const attempt_count = (int32_t*)ref_options;
+  (*attempt_count)++;
+  if (*attempt_count == 1)
+  {
+    return AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+  }
+
+  assert_return_code(az_http_response_init(ref_response, ok_response), AZ_OK);
+  return AZ_OK;
+}
+
+az_result test_policy_transport_adapter_error(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+  (void)ref_response;
+
+  int32_t* const attempt_count = (int32_t*)ref_options;
+  (*attempt_count)++;
+  return AZ_ERROR_HTTP_ADAPTER;
+}
+
+static void _test_policy_request_init(
+    az_http_request* out_request,
+    uint8_t* url_buffer,
+    int32_t url_buffer_size,
+    uint8_t* header_buffer,
+    int32_t header_buffer_size)
+{
+  az_span const url_span = az_span_create(url_buffer, url_buffer_size);
+  az_span const remainder = az_span_copy(url_span, AZ_SPAN_FROM_STR("url"));
+  assert_int_equal(az_span_size(remainder), url_buffer_size - 3);
+
+  assert_return_code(
+      az_http_request_init(
+          out_request,
+          &az_context_application,
+          az_http_method_get(),
+          url_span,
+          3,
+          az_span_create(header_buffer, header_buffer_size),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+}
+
+void test_az_http_pipeline_policy_retry_connection_interrupted(void** state)
+{
+  (void)state;
+
+  uint8_t buf[100] = { 0 };
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  _test_policy_request_init(
+      &request, buf, (int32_t)sizeof(buf), header_buf, (int32_t)sizeof(header_buf));
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.retry_delay_msec = 1;
+  retry_options.max_retry_delay_msec = 1;
+  int32_t attempt_count = 0;
+
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = test_policy_transport_interrupted_once,
+        .options = &attempt_count,
+      },
+    },
+  };
+
+  will_return(__wrap_az_platform_clock_msec, 0);
+
+  uint8_t response_buf[100] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  assert_return_code(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+  assert_int_equal(attempt_count, 2);
+
+  az_http_response_status_line status_line = { 0 };
+  assert_return_code(az_http_response_get_status_line(&response, &status_line), AZ_OK);
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+
+  // A POST request may have reached the service, and isn't sent again.
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_post(),
+          AZ_SPAN_FROM_BUFFER(buf),
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_FROM_STR("{}")),
+      AZ_OK);
+  attempt_count = 0;
+  assert_int_equal(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response),
+      AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+  assert_int_equal(attempt_count, 1);
+}
+
+void test_az_http_pipeline_policy_retry_adapter_error(void** state)
+{
+  (void)state;
+
+  uint8_t buf[100] = { 0 };
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  _test_policy_request_init(
+      &request, buf, (int32_t)sizeof(buf), header_buf, (int32_t)sizeof(header_buf));
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  int32_t attempt_count = 0;
+
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = test_policy_transport_adapter_error,
+        .options = &attempt_count,
+      },
+    },
+  };
+
+  // Any other transport failure is returned without retrying.
+  uint8_t response_buf[100] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  assert_int_equal(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response),
+      AZ_ERROR_HTTP_ADAPTER);
+  assert_int_equal(attempt_count, 1);
+}
+
+typedef struct
+{
+  int32_t attempt_count;
+  int32_t rewind_count;
+  int32_t bytes_left;
+} _test_policy_body_state;
+
+static az_result _test_policy_body_read(void* user_context, az_span destination, int32_t* out_read)
+{
+  _test_policy_body_state* const body_state = (_test_policy_body_state*)user_context;
+  int32_t const size = body_state->bytes_left < az_span_size(destination)
+      ? body_state->bytes_left
+      : az_span_size(destination);
+  az_span_fill(az_span_slice(destination, 0, size), 'x');
+  body_state->bytes_left -= size;
+  *out_read = size;
+  return AZ_OK;
+}
+
+static az_result _test_policy_body_rewind(void* user_context)
+{
+  _test_policy_body_state* const body_state = (_test_policy_body_state*)user_context;
+  body_state->bytes_left = 10;
+  body_state->rewind_count++;
+  return AZ_OK;
+}
+
+az_result test_policy_transport_read_body_retry_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_options;
+
+  az_http_request_body_provider const* body_provider = NULL;
+  assert_return_code(az_http_request_get_body_provider(ref_request, &body_provider), AZ_OK);
+  assert_non_null(body_provider);
+  _test_policy_body_state* const body_state = (_test_policy_body_state*)body_provider->user_context;
+
+  // Every attempt must send the whole body.
+  uint8_t body_buf[4] = { 0 };
+  int32_t total_read = 0;
+  int32_t bytes_read = 0;
+  do
+  {
+    assert_return_code(
+        body_provider->read(
+            body_provider->user_context, AZ_SPAN_FROM_BUFFER(body_buf), &bytes_read),
+        AZ_OK);
+    total_read += bytes_read;
+  } while (bytes_read > 0);
+  assert_int_equal(total_read, body_provider->length);
+
+  body_state->attempt_count++;
+  assert_return_code(
+      az_http_response_init(
+          ref_response, body_state->attempt_count == 1 ? retry_response : ok_response),
+      AZ_OK);
+  return AZ_OK;
+}
+
+static void _test_policy_retry_body_provider(
+    az_http_request_body_rewind_fn rewind,
+    _test_policy_body_state* ref_body_state,
+    az_http_response_status_line* out_status_line)
+{
+  uint8_t buf[100] = { 0 };
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  _test_policy_request_init(
+      &request, buf, (int32_t)sizeof(buf), header_buf, (int32_t)sizeof(header_buf));
+
+  *ref_body_state = (_test_policy_body_state){
+    .attempt_count = 0,
+    .rewind_count = 0,
+    .bytes_left = 10,
+  };
+  az_http_request_body_provider const body_provider = {
+    .read = _test_policy_body_read,
+    .rewind = rewind,
+    .length = 10,
+    .user_context = ref_body_state,
+  };
+  assert_return_code(az_http_request_set_body_provider(&request, &body_provider), AZ_OK);
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.retry_delay_msec = 1;
+  retry_options.max_retry_delay_msec = 1;
+
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = test_policy_transport_read_body_retry_once,
+        .options = NULL,
+      },
+    },
+  };
+
+  uint8_t response_buf[200] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  assert_return_code(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+  assert_return_code(az_http_response_get_status_line(&response, out_status_line), AZ_OK);
+}
+
+void test_az_http_pipeline_policy_retry_rewinds_body_provider(void** state)
+{
+  (void)state;
+
+  will_return(__wrap_az_platform_clock_msec, 0);
+
+  _test_policy_body_state body_state = { 0 };
+  az_http_response_status_line status_line = { 0 };
+  _test_policy_retry_body_provider(_test_policy_body_rewind, &body_state, &status_line);
+
+  assert_int_equal(body_state.attempt_count, 2);
+  assert_int_equal(body_state.rewind_count, 1);
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+}
+
+void test_az_http_pipeline_policy_retry_body_provider_without_rewind(void** state)
+{
+  (void)state;
+
+  // The body can't be sent again, so the retriable response is returned as is.
+  _test_policy_body_state body_state = { 0 };
+  az_http_response_status_line status_line = { 0 };
+  _test_policy_retry_body_provider(NULL, &body_state, &status_line);
+
+  assert_int_equal(body_state.attempt_count, 1);
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_REQUEST_TIMEOUT);
+}
+
+typedef struct
+{
+  int32_t attempt_count;
+  int32_t reset_count;
+  int32_t received_size;
+} _test_policy_sink_state;
+
+static az_result _test_policy_sink_write(void* user_context, az_span body_part)
+{
+  _test_policy_sink_state* const sink_state = (_test_policy_sink_state*)user_context;
+  sink_state->received_size += az_span_size(body_part);
+  return AZ_OK;
+}
+
+static az_result _test_policy_sink_reset(void* user_context)
+{
+  _test_policy_sink_state* const sink_state = (_test_policy_sink_state*)user_context;
+  sink_state->received_size = 0;
+  sink_state->reset_count++;
+  return AZ_OK;
+}
+
+az_result test_policy_transport_stream_body_interrupted_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+
+  // The first attempt loses its connection after part of the body went to the sink.
+  _test_policy_sink_state* const sink_state = (_test_policy_sink_state*)ref_options;
+  sink_state->attempt_count++;
+  assert_return_code(
+      az_http_response_append(
+          ref_response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\nContent-Length: 8\r\n\r\n")),
+      AZ_OK);
+  assert_return_code(
+      az_http_response_append_body(ref_response, AZ_SPAN_FROM_STR("1234")), AZ_OK);
+  if (sink_state->attempt_count == 1)
+  {
+    return AZ_ERROR_HTTP_CONNECTION_INTERRUPTED;
+  }
+
+  assert_return_code(
+      az_http_response_append_body(ref_response, AZ_SPAN_FROM_STR("5678")), AZ_OK);
+  return AZ_OK;
+}
+
+static az_result _test_policy_retry_body_sink(
+    az_http_response_body_reset_fn reset,
+    _test_policy_sink_state* ref_sink_state)
+{
+  uint8_t buf[100] = { 0 };
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  _test_policy_request_init(
+      &request, buf, (int32_t)sizeof(buf), header_buf, (int32_t)sizeof(header_buf));
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.retry_delay_msec = 1;
+  retry_options.max_retry_delay_msec = 1;
+
+  *ref_sink_state = (_test_policy_sink_state){
+    .attempt_count = 0,
+    .reset_count = 0,
+    .received_size = 0,
+  };
+  az_http_response_body_sink const body_sink = {
+    .write = _test_policy_sink_write,
+    .reset = reset,
+    .user_context = ref_sink_state,
+  };
+
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = test_policy_transport_stream_body_interrupted_once,
+        .options = ref_sink_state,
+      },
+    },
+  };
+
+  uint8_t response_buf[100] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  assert_return_code(az_http_response_set_body_sink(&response, &body_sink), AZ_OK);
+  return az_http_pipeline_policy_retry(policies, &retry_options, &request, &response);
+}
+
+void test_az_http_pipeline_policy_retry_resets_body_sink(void** state)
+{
+  (void)state;
+
+  will_return(__wrap_az_platform_clock_msec, 0);
+
+  _test_policy_sink_state sink_state = { 0 };
+  assert_return_code(_test_policy_retry_body_sink(_test_policy_sink_reset, &sink_state), AZ_OK);
+  assert_int_equal(sink_state.attempt_count, 2);
+  assert_int_equal(sink_state.reset_count, 1);
+  assert_int_equal(sink_state.received_size, 8);
+}
+
+void test_az_http_pipeline_policy_retry_body_sink_without_reset(void** state)
+{
+  (void)state;
+
+  // Part of the body was received and can't be discarded, so the request is not sent again.
+  _test_policy_sink_state sink_state = { 0 };
+  assert_int_equal(
+      _test_policy_retry_body_sink(NULL, &sink_state), AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+  assert_int_equal(sink_state.attempt_count, 1);
+  assert_int_equal(sink_state.received_size, 4);
+}
+
+static az_result _test_policy_transport_retry_response_canceling(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  int32_t* const attempt_count = (int32_t*)ref_options;
+  ++*attempt_count;
+  az_context_cancel(ref_request->_internal.context);
+  assert_return_code(az_http_response_init(ref_response, retry_response), AZ_OK);
+  return AZ_OK;
+}
+
+void test_az_http_pipeline_policy_retry_past_deadline(void** state)
+{
+  (void)state;
+
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("url");
+  az_context context = az_context_create_with_expiration(&az_context_application, 1000);
+  az_http_request request;
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &context,
+          az_http_method_get(),
+          url,
+          az_span_size(url),
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  int32_t attempt_count = 0;
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = test_policy_transport_retry_response,
+        .options = NULL,
+      },
+    },
+  };
+
+  // The first retry would be made 8 seconds later, after the deadline of the context, so it
+  // fails right away instead of sleeping.
+  will_return(__wrap_az_platform_clock_msec, 0);
+  az_http_response response;
+  assert_int_equal(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response),
+      AZ_ERROR_CANCELED);
+
+  // A canceled context isn't waited for either.
+  policies[0]._internal.process = _test_policy_transport_retry_response_canceling;
+  policies[0]._internal.options = &attempt_count;
+  context = az_context_create_with_expiration(&az_context_application, 1000000);
+  will_return(__wrap_az_platform_clock_msec, 0);
+  assert_int_equal(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response),
+      AZ_ERROR_CANCELED);
+  assert_int_equal(attempt_count, 1);
+}
+
+static az_result _test_policy_transport_retry_response_immediately(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+  int32_t* const attempt_count = (int32_t*)ref_options;
+  ++*attempt_count;
+  return az_http_response_append(
+      ref_response,
+      AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\nretry-after-ms: 0\r\n\r\n"));
+}
+
+void test_az_http_pipeline_policy_retry_budget(void** state)
+{
+  (void)state;
+
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("url");
+  az_http_request request;
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_get(),
+          url,
+          az_span_size(url),
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  // Two retries in a row, then one retry for every four requests.
+  az_http_policy_retry_budget budget = { 0 };
+  assert_return_code(az_http_policy_retry_budget_init(&budget, 2, 25), AZ_OK);
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.max_retries = 5;
+  retry_options.budget = &budget;
+
+  int32_t attempt_count = 0;
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = _test_policy_transport_retry_response_immediately,
+        .options = &attempt_count,
+      },
+    },
+  };
+
+  uint8_t response_buf[100] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+
+  will_return_count(__wrap_az_platform_clock_msec, 0, 2);
+  assert_return_code(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+  assert_int_equal(attempt_count, 3);
+
+  // The budget is spent: the next three requests are not retried, and the fourth one is.
+  for (int32_t i = 0; i < 3; i++)
+  {
+    attempt_count = 0;
+    assert_return_code(
+        az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+    assert_int_equal(attempt_count, 1);
+  }
+
+  attempt_count = 0;
+  will_return(__wrap_az_platform_clock_msec, 0);
+  assert_return_code(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response), AZ_OK);
+  assert_int_equal(attempt_count, 2);
+}
+
+typedef struct
+{
+  az_span status_line;
+  int64_t now;
+  bool is_sent;
+  az_result result;
+} _test_policy_transport_status_options;
+
+static az_result _test_policy_transport_status(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+  _test_policy_transport_status_options* const options
+      = (_test_policy_transport_status_options*)ref_options;
+  options->is_sent = true;
+  if (az_result_failed(options->result))
+  {
+    return options->result;
+  }
+
+  // The response is received at the time the request was sent.
+  will_return(__wrap_az_platform_clock_msec, options->now);
+  return az_http_response_append(ref_response, options->status_line);
+}
+
+static az_result _test_policy_circuit_breaker_send_result(
+    az_http_policy_circuit_breaker* circuit_breaker,
+    az_span url,
+    az_span status_line,
+    az_result transport_result,
+    int64_t now,
+    bool* out_is_sent)
+{
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_get(),
+          url,
+          az_span_size(url),
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  _test_policy_transport_status_options transport_options = {
+    .status_line = status_line,
+    .now = now,
+    .is_sent = false,
+    .result = transport_result,
+  };
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = _test_policy_transport_status,
+        .options = &transport_options,
+      },
+    },
+  };
+
+  uint8_t response_buf[64] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+
+  will_return(__wrap_az_platform_clock_msec, now);
+  az_result const result
+      = az_http_pipeline_policy_circuit_breaker(policies, circuit_breaker, &request, &response);
+  *out_is_sent = transport_options.is_sent;
+  return result;
+}
+
+static az_result _test_policy_circuit_breaker_send(
+    az_http_policy_circuit_breaker* circuit_breaker,
+    az_span url,
+    az_span status_line,
+    int64_t now,
+    bool* out_is_sent)
+{
+  return _test_policy_circuit_breaker_send_result(
+      circuit_breaker, url, status_line, AZ_OK, now, out_is_sent);
+}
+
+void test_az_http_pipeline_policy_circuit_breaker(void** state)
+{
+  (void)state;
+
+  az_http_policy_circuit_breaker_options options = az_http_policy_circuit_breaker_options_default();
+  assert_int_equal(options.failure_threshold, 0);
+  options.failure_threshold = 2;
+  options.failure_window_msec = 1000;
+  options.open_duration_msec = 500;
+
+  az_http_policy_circuit_breaker circuit_breaker;
+  assert_return_code(az_http_policy_circuit_breaker_init(&circuit_breaker, &options), AZ_OK);
+
+  az_span const url = AZ_SPAN_FROM_STR("https://account.blob.core.windows.net/container/a");
+  az_span const same_endpoint = AZ_SPAN_FROM_STR("https://ACCOUNT.blob.core.windows.net/b?c");
+  az_span const other_endpoint = AZ_SPAN_FROM_STR("https://other.blob.core.windows.net/a");
+  az_span const ok = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n\r\n");
+  az_span const unavailable = AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\n\r\n");
+  az_span const not_found = AZ_SPAN_FROM_STR("HTTP/1.1 404 Not Found\r\n\r\n");
+  bool is_sent = false;
+
+  // Errors of the application, or of the client, don't count as failures of the endpoint.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, not_found, 0, &is_sent), AZ_OK);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send_result(
+          &circuit_breaker, url, ok, AZ_ERROR_HTTP_RESPONSE_OVERFLOW, 0, &is_sent),
+      AZ_ERROR_HTTP_RESPONSE_OVERFLOW);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send_result(
+          &circuit_breaker, url, ok, AZ_ERROR_NOT_ENOUGH_SPACE, 0, &is_sent),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // Two failures open the circuit, which fails requests right away.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, unavailable, 0, &is_sent), AZ_OK);
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, same_endpoint, unavailable, 10, &is_sent),
+      AZ_OK);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 100, &is_sent),
+      AZ_ERROR_HTTP_CIRCUIT_OPEN);
+  assert_false(is_sent);
+
+  // Other endpoints have their own circuit.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, other_endpoint, ok, 100, &is_sent),
+      AZ_OK);
+  assert_true(is_sent);
+
+  // Once the circuit was open long enough, a request probes the endpoint, and opens the circuit
+  // again when it fails.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, unavailable, 600, &is_sent), AZ_OK);
+  assert_true(is_sent);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 1000, &is_sent),
+      AZ_ERROR_HTTP_CIRCUIT_OPEN);
+
+  // A probe which succeeds closes the circuit.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 1200, &is_sent), AZ_OK);
+  assert_true(is_sent);
+
+  // Failures to reach the endpoint count, like the status codes. The failure is recorded at the
+  // time the request was sent.
+  will_return(__wrap_az_platform_clock_msec, 1250);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send_result(
+          &circuit_breaker, url, ok, AZ_ERROR_HTTP_CONNECTION_INTERRUPTED, 1250, &is_sent),
+      AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, unavailable, 1260, &is_sent),
+      AZ_OK);
+  assert_int_equal(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 1270, &is_sent),
+      AZ_ERROR_HTTP_CIRCUIT_OPEN);
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 1800, &is_sent), AZ_OK);
+  assert_true(is_sent);
+
+  // Failures further apart than the window don't open the circuit.
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, unavailable, 2900, &is_sent), AZ_OK);
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, unavailable, 4100, &is_sent), AZ_OK);
+  assert_return_code(
+      _test_policy_circuit_breaker_send(&circuit_breaker, url, ok, 4200, &is_sent), AZ_OK);
+  assert_true(is_sent);
+}
+
+static az_result _test_policy_transport_status_only(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+  _test_policy_transport_status_options* const options
+      = (_test_policy_transport_status_options*)ref_options;
+  options->is_sent = true;
+  return az_http_response_append(ref_response, options->status_line);
+}
+
+// Sends a request through the rate limiter, once the clock reads of the policy were queued.
+static az_result _test_policy_rate_limiter_send(
+    az_http_policy_rate_limiter* rate_limiter,
+    az_context* context,
+    az_span status_line,
+    bool* out_is_sent)
+{
+  uint8_t url_buf[] = "url";
+  uint8_t header_buf[(2 * sizeof(_az_http_request_header))] = { 0 };
+  az_http_request request;
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          context,
+          az_http_method_get(),
+          AZ_SPAN_FROM_BUFFER(url_buf),
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  _test_policy_transport_status_options transport_options
+      = { .status_line = status_line, .now = 0, .is_sent = false };
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = _test_policy_transport_status_only,
+        .options = &transport_options,
+      },
+    },
+  };
+
+  uint8_t response_buf[128] = { 0 };
+  az_http_response response;
+  assert_return_code(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+
+  az_result const result
+      = az_http_pipeline_policy_rate_limiter(policies, rate_limiter, &request, &response);
+  *out_is_sent = transport_options.is_sent;
+  return result;
+}
+
+void test_az_http_pipeline_policy_rate_limiter(void** state)
+{
+  (void)state;
+
+  az_http_policy_rate_limiter rate_limiter = { 0 };
+  assert_return_code(az_http_policy_rate_limiter_init(&rate_limiter, 10, 2, 20), AZ_OK);
+
+  az_span const ok = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n\r\n");
+  az_span const throttled
+      = AZ_SPAN_FROM_STR("HTTP/1.1 429 Too Many Requests\r\nretry-after-ms: 20\r\n\r\n");
+  az_span const unavailable = AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\n\r\n");
+  bool is_sent = false;
+
+  // A throttled response halves the rate, and holds the next request back for its retry-after.
+  will_return(__wrap_az_platform_clock_msec, 1000);
+  will_return(__wrap_az_platform_clock_msec, 1000);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, throttled, &is_sent),
+      AZ_OK);
+  assert_int_equal(rate_limiter._internal.rate, 5);
+  assert_int_equal(rate_limiter._internal.blocked_until, 1020);
+
+  // The next request waits 20ms, which reads the clock again.
+  will_return_count(__wrap_az_platform_clock_msec, 1000, 2);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, ok, &is_sent), AZ_OK);
+
+  // As many requests in a row as the rate succeed, and the rate goes up by one.
+  for (int32_t i = 0; i < 4; i++)
+  {
+    will_return(__wrap_az_platform_clock_msec, 1020);
+    assert_return_code(
+        _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, ok, &is_sent),
+        AZ_OK);
+    assert_true(is_sent);
+  }
+
+  assert_int_equal(rate_limiter._internal.rate, 6);
+
+  // The bucket is empty: a request whose context expires before its token is there is canceled,
+  // without being sent, and gives the token back.
+  int64_t const tokens = rate_limiter._internal.tokens;
+  az_context context = az_context_create_with_expiration(&az_context_application, 1100);
+  will_return_count(__wrap_az_platform_clock_msec, 1020, 2);
+  assert_int_equal(
+      _test_policy_rate_limiter_send(&rate_limiter, &context, ok, &is_sent), AZ_ERROR_CANCELED);
+  assert_false(is_sent);
+  assert_int_equal(rate_limiter._internal.tokens, tokens);
+
+  // The responses to the requests in flight together only lower the rate once a second.
+  will_return(__wrap_az_platform_clock_msec, 2000);
+  will_return(__wrap_az_platform_clock_msec, 2000);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, unavailable, &is_sent),
+      AZ_OK);
+  assert_int_equal(rate_limiter._internal.rate, 3);
+
+  will_return(__wrap_az_platform_clock_msec, 2500);
+  will_return(__wrap_az_platform_clock_msec, 2500);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, unavailable, &is_sent),
+      AZ_OK);
+  assert_int_equal(rate_limiter._internal.rate, 3);
+
+  // The rate isn't lowered below the minimum rate.
+  will_return_count(__wrap_az_platform_clock_msec, 4000, 2);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, unavailable, &is_sent),
+      AZ_OK);
+  will_return_count(__wrap_az_platform_clock_msec, 6000, 2);
+  assert_return_code(
+      _test_policy_rate_limiter_send(&rate_limiter, &az_context_application, unavailable, &is_sent),
+      AZ_OK);
+  assert_int_equal(rate_limiter._internal.rate, 2);
+}
+
+int64_t __wrap_az_platform_clock_msec();
+int64_t __wrap_az_platform_clock_msec() { return (int64_t)mock(); }
+
+#endif // _az_MOCK_ENABLED
+
+void test_az_http_pipeline_policy_retry_decorrelated_delay(void** state)
+{
+  (void)state;
+
+  // Each delay is drawn between the minimum delay and three times the previous one.
+  uint32_t random_state = 42;
+  int32_t previous = 1000;
+  bool is_max_reached = false;
+  for (int32_t i = 0; i < 1000; i++)
+  {
+    int32_t const delay = _az_retry_calc_decorrelated_delay(
+        previous, 1000, 30000, _az_retry_random(&random_state));
+    assert_true(delay >= 1000);
+    assert_true(delay <= 3 * previous);
+    assert_true(delay <= 30000);
+    is_max_reached = is_max_reached || delay == 30000;
+    previous = delay;
+  }
+
+  assert_true(is_max_reached);
+
+  // Consecutive draws differ, so that clients which failed together retry at different times.
+  assert_int_not_equal(
+      _az_retry_calc_decorrelated_delay(1000, 1000, 30000, _az_retry_random(&random_state)),
+      _az_retry_calc_decorrelated_delay(1000, 1000, 30000, _az_retry_random(&random_state)));
+}
+
+static az_result _test_policy_transport_counting(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_request;
+  (void)ref_response;
+  ++*(int32_t*)ref_options;
+  return AZ_OK;
+}
+
+void test_az_http_pipeline_policy_hedging_passes_through(void** state)
+{
+  (void)state;
+
+  uint8_t url_buf[] = "url";
+  uint8_t header_buf[sizeof(_az_http_request_header)] = { 0 };
+  uint8_t response_buf[16] = { 0 };
+  az_http_response response = { 0 };
+  assert_return_code(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+
+  int32_t send_count = 0;
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = _test_policy_transport_counting,
+        .options = &send_count,
+      },
+    },
+  };
+
+  // Without a client, a GET request is sent once, by the next policy.
+  az_http_policy_hedging_options options = az_http_policy_hedging_options_default();
+  az_http_request request = { 0 };
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_get(),
+          AZ_SPAN_FROM_BUFFER(url_buf),
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+  assert_return_code(
+      az_http_pipeline_policy_hedging(policies, &options, &request, &response), AZ_OK);
+  assert_int_equal(send_count, 1);
+
+  // A GET request isn't hedged either when a policy other than the transport follows, since its
+  // copies would skip that policy.
+  az_http_client_async client = { 0 };
+  options.client = &client;
+  assert_return_code(
+      az_http_pipeline_policy_hedging(policies, &options, &request, &response), AZ_OK);
+  assert_int_equal(send_count, 2);
+
+  // A PUT request isn't idempotent, and is never hedged even with a client.
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          az_http_method_put(),
+          AZ_SPAN_FROM_BUFFER(url_buf),
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          AZ_SPAN_FROM_STR("body")),
+      AZ_OK);
+  assert_return_code(
+      az_http_pipeline_policy_hedging(policies, &options, &request, &response), AZ_OK);
+  assert_int_equal(send_count, 3);
+}
+
+typedef struct
+{
+  az_span status_line;
+  az_span body;
+  int32_t retry_count;
+  az_result result;
+} _test_policy_metrics_transport_options;
+
+static az_result _test_policy_metrics_transport(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  _test_policy_metrics_transport_options const* const options
+      = (_test_policy_metrics_transport_options const*)ref_options;
+
+  // Stands for the retry policy, which counts its retries on the request.
+  ref_request->_internal.retry_count += options->retry_count;
+  if (az_result_failed(options->result))
+  {
+    return options->result;
+  }
+
+  _az_RETURN_IF_FAILED(az_http_response_append(ref_response, options->status_line));
+  return az_http_response_append_body(ref_response, options->body);
+}
+
+static az_result _test_policy_metrics_sink_write(void* user_context, az_span body_part)
+{
+  *(int32_t*)user_context += az_span_size(body_part);
+  return AZ_OK;
+}
+
+static void _test_policy_metrics_send(
+    az_http_policy_metrics* metrics,
+    az_http_method method,
+    az_span body,
+    az_http_response_body_sink const* body_sink,
+    _test_policy_metrics_transport_options* transport_options)
+{
+  uint8_t url_buf[] = "url";
+  uint8_t header_buf[sizeof(_az_http_request_header)] = { 0 };
+  az_http_request request = { 0 };
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          &az_context_application,
+          method,
+          AZ_SPAN_FROM_BUFFER(url_buf),
+          3,
+          AZ_SPAN_FROM_BUFFER(header_buf),
+          body),
+      AZ_OK);
+
+  uint8_t response_buf[64] = { 0 };
+  az_http_response response = { 0 };
+  assert_return_code(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+  if (body_sink != NULL)
+  {
+    assert_return_code(az_http_response_set_body_sink(&response, body_sink), AZ_OK);
+  }
+
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = _test_policy_metrics_transport,
+        .options = transport_options,
+      },
+    },
+  };
+
+  assert_int_equal(
+      az_http_pipeline_policy_metrics(policies, metrics, &request, &response),
+      transport_options->result);
+  assert_ptr_equal(response._internal.body_sink, body_sink);
+}
+
+void test_az_http_pipeline_policy_metrics(void** state)
+{
+  (void)state;
+
+  az_http_policy_metrics metrics = { 0 };
+  assert_return_code(az_http_policy_metrics_init(&metrics), AZ_OK);
+
+  // The bytes of a body which goes to a body sink are counted on their way to it.
+  int32_t sink_written = 0;
+  az_http_response_body_sink const body_sink = {
+    .write = _test_policy_metrics_sink_write,
+    .reset = NULL,
+    .user_context = &sink_written,
+  };
+  _test_policy_metrics_transport_options get_options = {
+    .status_line = AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n\r\n"),
+    .body = AZ_SPAN_FROM_STR("blob"),
+    .retry_count = 0,
+    .result = AZ_OK,
+  };
+  _test_policy_metrics_send(&metrics, az_http_method_get(), AZ_SPAN_EMPTY, NULL, &get_options);
+  _test_policy_metrics_send(
+      &metrics, az_http_method_get(), AZ_SPAN_EMPTY, &body_sink, &get_options);
+  assert_int_equal(sink_written, 4);
+
+  // The body of a request is sent again with each retry.
+  _test_policy_metrics_transport_options put_options = {
+    .status_line = AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\n\r\n"),
+    .body = AZ_SPAN_EMPTY,
+    .retry_count = 2,
+    .result = AZ_OK,
+  };
+  _test_policy_metrics_send(
+      &metrics, az_http_method_put(), AZ_SPAN_FROM_STR("hello"), NULL, &put_options);
+
+  _test_policy_metrics_transport_options canceled_options = {
+    .status_line = AZ_SPAN_EMPTY,
+    .body = AZ_SPAN_EMPTY,
+    .retry_count = 0,
+    .result = AZ_ERROR_CANCELED,
+  };
+  _test_policy_metrics_send(
+      &metrics, AZ_SPAN_FROM_STR("OPTIONS"), AZ_SPAN_EMPTY, NULL, &canceled_options);
+
+  az_http_metrics_snapshot snapshot = { 0 };
+  assert_return_code(
+      az_http_policy_metrics_get_snapshot(&metrics, AZ_HTTP_METRICS_OPERATION_GET, &snapshot),
+      AZ_OK);
+  assert_int_equal(snapshot.request_count, 2);
+  assert_int_equal(snapshot.status_class_counts[1], 2);
+  assert_int_equal(snapshot.failure_count, 0);
+  assert_int_equal(snapshot.retry_count, 0);
+  assert_int_equal(snapshot.bytes_sent, 0);
+  assert_int_equal(snapshot.bytes_received, 2 * (19 + 4));
+  assert_true(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 100) >= 0);
+
+  assert_return_code(
+      az_http_policy_metrics_get_snapshot(&metrics, AZ_HTTP_METRICS_OPERATION_PUT, &snapshot),
+      AZ_OK);
+  assert_int_equal(snapshot.request_count, 1);
+  assert_int_equal(snapshot.status_class_counts[4], 1);
+  assert_int_equal(snapshot.retry_count, 2);
+  assert_int_equal(snapshot.bytes_sent, 3 * 5);
+
+  assert_return_code(
+      az_http_policy_metrics_get_snapshot(&metrics, AZ_HTTP_METRICS_OPERATION_OTHER, &snapshot),
+      AZ_OK);
+  assert_int_equal(snapshot.request_count, 1);
+  assert_int_equal(snapshot.failure_count, 1);
+  assert_int_equal(snapshot.bytes_received, 0);
+
+  assert_return_code(
+      az_http_policy_metrics_get_snapshot(&metrics, AZ_HTTP_METRICS_OPERATION_HEAD, &snapshot),
+      AZ_OK);
+  assert_int_equal(snapshot.request_count, 0);
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 50), 0);
+}
+
+void test_az_http_metrics_latency_percentile(void** state)
+{
+  (void)state;
+
+  // Each bucket holds latencies within 25% of each other, and buckets don't overlap.
+  int64_t previous_max = -1;
+  for (int32_t bucket = 0; bucket < AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT; bucket++)
+  {
+    int64_t const max = _az_http_metrics_get_bucket_max_latency(bucket);
+    int64_t const min = previous_max + 1;
+    assert_true(max >= min);
+    assert_true(max - min <= min / 4);
+    assert_int_equal(_az_http_metrics_get_latency_bucket(min), bucket);
+    assert_int_equal(_az_http_metrics_get_latency_bucket(max), bucket);
+    previous_max = max;
+  }
+
+  assert_int_equal(
+      _az_http_metrics_get_latency_bucket(INT64_MAX), AZ_HTTP_METRICS_LATENCY_BUCKET_COUNT - 1);
+  assert_int_equal(_az_http_metrics_get_latency_bucket(-1), 0);
+
+  // 98 requests took 1ms, and 2 took 100ms.
+  az_http_metrics_snapshot snapshot = { 0 };
+  snapshot.latency_histogram[_az_http_metrics_get_latency_bucket(1000)] = 98;
+  snapshot.latency_histogram[_az_http_metrics_get_latency_bucket(100000)] = 2;
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 0), 1023);
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 50), 1023);
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 98), 1023);
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 99), 114687);
+  assert_int_equal(az_http_metrics_snapshot_get_latency_percentile(&snapshot, 100), 114687);
+}
+
+typedef struct
+{
+  az_http_tracing_span spans[AZ_HTTP_TRACING_SPAN_BUFFER_SIZE];
+  int32_t count;
+} _test_policy_exported_spans;
+
+static void _test_policy_export_span(az_http_tracing_span const* span, void* user_context)
+{
+  _test_policy_exported_spans* const exported = (_test_policy_exported_spans*)user_context;
+  exported->spans[exported->count++] = *span;
+}
+
+// Sends the request twice, as the retry policy would.
+static az_result _test_policy_retry_once(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_options;
+  _az_RETURN_IF_FAILED(_az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response));
+  ++ref_request->_internal.retry_count;
+  _az_http_response_reset(ref_response);
+  return _az_http_pipeline_nextpolicy(ref_policies, ref_request, ref_response);
+}
+
+typedef struct
+{
+  uint8_t traceparents[2][56];
+  int32_t count;
+} _test_policy_traceparents;
+
+static az_result _test_policy_transport_traceparent(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  _test_policy_traceparents* const traceparents = (_test_policy_traceparents*)ref_options;
+  for (int32_t i = 0; i < ref_request->_internal.headers_length; i++)
+  {
+    az_span name = { 0 };
+    az_span value = { 0 };
+    _az_RETURN_IF_FAILED(az_http_request_get_header(ref_request, i, &name, &value));
+    if (az_span_is_content_equal(name, AZ_SPAN_FROM_STR("traceparent")))
+    {
+      az_span_to_str(
+          (char*)traceparents->traceparents[traceparents->count++],
+          sizeof(traceparents->traceparents[0]),
+          value);
+    }
+  }
+
+  return az_http_response_append(ref_response, AZ_SPAN_FROM_STR("HTTP/1.1 200 OK\r\n\r\n"));
+}
+
+static void _test_policy_tracing_send(
+    az_http_policy_tracing* tracing,
+    az_context* context,
+    int32_t header_count,
+    _test_policy_traceparents* traceparents)
+{
+  uint8_t url_buf[] = "url";
+  uint8_t header_buf[2 * sizeof(_az_http_request_header)] = { 0 };
+  int32_t const header_buf_size = header_count * (int32_t)sizeof(_az_http_request_header);
+  az_http_request request = { 0 };
+  assert_return_code(
+      az_http_request_init(
+          &request,
+          context,
+          az_http_method_get(),
+          AZ_SPAN_FROM_BUFFER(url_buf),
+          3,
+          az_span_create(header_buf, header_buf_size),
+          AZ_SPAN_EMPTY),
+      AZ_OK);
+
+  uint8_t response_buf[64] = { 0 };
+  az_http_response response = { 0 };
+  assert_return_code(az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buf)), AZ_OK);
+
+  _az_http_policy policies[3] = {
+    { ._internal = { .process = _test_policy_retry_once, .options = NULL } },
+    { ._internal = { .process = az_http_pipeline_policy_tracing_attempt, .options = tracing } },
+    { ._internal = { .process = _test_policy_transport_traceparent, .options = traceparents } },
+  };
+
+  assert_return_code(
+      az_http_pipeline_policy_tracing(policies, tracing, &request, &response), AZ_OK);
+
+  // The header was removed, and the context of the request put back.
+  assert_int_equal(request._internal.headers_length, 0);
+  assert_ptr_equal(request._internal.context, context);
+}
+
+void test_az_http_pipeline_policy_tracing(void** state)
+{
+  (void)state;
+
+  _test_policy_exported_spans exported = { 0 };
+  az_http_policy_tracing tracing = { 0 };
+  assert_return_code(
+      az_http_policy_tracing_init(&tracing, _test_policy_export_span, &exported), AZ_OK);
+
+  // The request is part of the trace of the application.
+  az_http_tracing_context parent = { 0 };
+  assert_return_code(
+      az_http_tracing_context_parse(
+          AZ_SPAN_FROM_STR("00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01"), &parent),
+      AZ_OK);
+  az_context context = az_context_create_with_value(
+      &az_context_application, &az_http_tracing_context_key, &parent);
+
+  _test_policy_traceparents traceparents = { 0 };
+  _test_policy_tracing_send(&tracing, &context, 2, &traceparents);
+
+  // Each attempt sent the ID of its own span, in the trace of the application.
+  assert_int_equal(traceparents.count, 2);
+  assert_int_equal(strlen((char*)traceparents.traceparents[0]), 55);
+  assert_memory_equal(traceparents.traceparents[0], "00-0af7651916cd43dd8448eb211c80319c-", 36);
+  assert_memory_equal(traceparents.traceparents[0] + 52, "-01", 4);
+  assert_memory_equal(traceparents.traceparents[1], "00-0af7651916cd43dd8448eb211c80319c-", 36);
+  assert_true(memcmp(traceparents.traceparents[0], traceparents.traceparents[1], 55) != 0);
+
+  // The attempts finished before the request, and their spans are children of its span.
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 3);
+  assert_int_equal(exported.count, 3);
+  az_http_tracing_span const* const request_span = &exported.spans[2];
+  assert_int_equal(request_span->attempt, 0);
+  assert_memory_equal(request_span->trace_id, parent.trace_id, sizeof(parent.trace_id));
+  assert_memory_equal(request_span->parent_span_id, parent.span_id, sizeof(parent.span_id));
+  assert_int_equal(request_span->status_code, AZ_HTTP_STATUS_CODE_OK);
+  assert_true(request_span->end_nsec >= request_span->start_nsec);
+  for (int32_t i = 0; i < 2; i++)
+  {
+    az_http_tracing_span const* const attempt_span = &exported.spans[i];
+    assert_int_equal(attempt_span->attempt, i + 1);
+    assert_memory_equal(attempt_span->trace_id, parent.trace_id, sizeof(parent.trace_id));
+    assert_memory_equal(
+        attempt_span->parent_span_id, request_span->span_id, sizeof(request_span->span_id));
+    assert_true(attempt_span->start_nsec >= request_span->start_nsec);
+    assert_true(attempt_span->end_nsec <= request_span->end_nsec);
+
+    az_http_tracing_context sent = { 0 };
+    assert_return_code(
+        az_http_tracing_context_parse(
+            az_span_create_from_str((char*)traceparents.traceparents[i]), &sent),
+        AZ_OK);
+    assert_memory_equal(sent.span_id, attempt_span->span_id, sizeof(sent.span_id));
+  }
+
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 0);
+
+  // Without a trace in its context, a request starts a sampled trace of its own.
+  traceparents.count = 0;
+  _test_policy_tracing_send(&tracing, &az_context_application, 2, &traceparents);
+  assert_int_equal(traceparents.count, 2);
+  assert_true(
+      memcmp(traceparents.traceparents[0], "00-0af7651916cd43dd8448eb211c80319c-", 36) != 0);
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 3);
+
+  // The trace of the application isn't sampled: the header is sent, but no span is recorded.
+  parent.trace_flags = 0;
+  traceparents.count = 0;
+  _test_policy_tracing_send(&tracing, &context, 2, &traceparents);
+  assert_int_equal(traceparents.count, 2);
+  assert_memory_equal(traceparents.traceparents[0] + 52, "-00", 4);
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 0);
+
+  // Without room for the header, the attempts are still sent, and their spans recorded.
+  parent.trace_flags = 1;
+  traceparents.count = 0;
+  _test_policy_tracing_send(&tracing, &context, 0, &traceparents);
+  assert_int_equal(traceparents.count, 0);
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 3);
+}
+
+void test_az_http_pipeline_policy_tracing_span_buffer(void** state)
+{
+  (void)state;
+
+  _test_policy_exported_spans exported = { 0 };
+  az_http_policy_tracing tracing = { 0 };
+  assert_return_code(
+      az_http_policy_tracing_init(&tracing, _test_policy_export_span, &exported), AZ_OK);
+
+  // Spans which finish while the buffer is full are dropped.
+  _test_policy_traceparents traceparents = { 0 };
+  for (int32_t i = 0; i < AZ_HTTP_TRACING_SPAN_BUFFER_SIZE; i++)
+  {
+    traceparents.count = 0;
+    _test_policy_tracing_send(&tracing, &az_context_application, 2, &traceparents);
+  }
+
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), AZ_HTTP_TRACING_SPAN_BUFFER_SIZE);
+  assert_int_equal(tracing._internal.dropped_count, 2 * AZ_HTTP_TRACING_SPAN_BUFFER_SIZE);
+
+  // The buffer wraps around once spans were exported.
+  exported.count = 0;
+  traceparents.count = 0;
+  _test_policy_tracing_send(&tracing, &az_context_application, 2, &traceparents);
+  assert_int_equal(az_http_policy_tracing_flush(&tracing), 3);
+  assert_int_equal(exported.spans[2].attempt, 0);
+}
+
+void test_az_http_tracing_context_parse(void** state)
+{
+  (void)state;
+
+  az_http_tracing_context context = { 0 };
+  assert_return_code(
+      az_http_tracing_context_parse(
+          AZ_SPAN_FROM_STR("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"), &context),
+      AZ_OK);
+  uint8_t const trace_id[] = { 0x4b, 0xf9, 0x2f, 0x35, 0x77, 0xb3, 0x4d, 0xa6,
+                               0xa3, 0xce, 0x92, 0x9d, 0x0e, 0x0e, 0x47, 0x36 };
+  uint8_t const span_id[] = { 0x00, 0xf0, 0x67, 0xaa, 0x0b, 0xa9, 0x02, 0xb7 };
+  assert_memory_equal(context.trace_id, trace_id, sizeof(trace_id));
+  assert_memory_equal(context.span_id, span_id, sizeof(span_id));
+  assert_int_equal(context.trace_flags, 1);
+
+  az_span const invalid[] = {
+    AZ_SPAN_FROM_STR(""),
+    AZ_SPAN_FROM_STR("01-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01"),
+    AZ_SPAN_FROM_STR("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01"),
+    AZ_SPAN_FROM_STR("00-4bf92f3577b34da6a3ce929d0e0e4736_00f067aa0ba902b7-01"),
+    AZ_SPAN_FROM_STR("00-00000000000000000000000000000000-00f067aa0ba902b7-01"),
+    AZ_SPAN_FROM_STR("00-4bf92f3577b34da6a3ce929d0e0e4736-0000000000000000-01"),
+    AZ_SPAN_FROM_STR("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-"),
+  };
+
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+  {
+    assert_int_equal(
+        az_http_tracing_context_parse(invalid[i], &context), AZ_ERROR_UNEXPECTED_CHAR);
+  }
+}
 
 int test_az_policy()
 {
@@ -370,9 +1803,26 @@ int test_az_policy()
     cmocka_unit_test(test_az_http_pipeline_policy_retry),
     cmocka_unit_test(test_az_http_pipeline_policy_retry_with_header),
     cmocka_unit_test(test_az_http_pipeline_policy_retry_with_header_2),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_connection_interrupted),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_adapter_error),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_rewinds_body_provider),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_body_provider_without_rewind),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_resets_body_sink),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_body_sink_without_reset),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_past_deadline),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_budget),
+    cmocka_unit_test(test_az_http_pipeline_policy_circuit_breaker),
+    cmocka_unit_test(test_az_http_pipeline_policy_rate_limiter),
 #endif // _az_MOCK_ENABLED
     cmocka_unit_test(test_az_http_pipeline_policy_apiversion),
     cmocka_unit_test(test_az_http_pipeline_policy_telemetry),
+    cmocka_unit_test(test_az_http_pipeline_policy_retry_decorrelated_delay),
+    cmocka_unit_test(test_az_http_pipeline_policy_hedging_passes_through),
+    cmocka_unit_test(test_az_http_pipeline_policy_metrics),
+    cmocka_unit_test(test_az_http_metrics_latency_percentile),
+    cmocka_unit_test(test_az_http_pipeline_policy_tracing),
+    cmocka_unit_test(test_az_http_pipeline_policy_tracing_span_buffer),
+    cmocka_unit_test(test_az_http_tracing_context_parse),
   };
   return cmocka_run_group_tests_name("az_core_policy", tests, NULL, NULL);
 }
@@ -19,6 +19,7 @@
 #include <cmocka.h>
 
 #define TEST_SPAN_BUFFER_SIZE 128
+#define TEST_TWIN_SCRATCH_BUFFER_SIZE 512
 
 static const az_span test_device_id = AZ_SPAN_LITERAL_FROM_STR("my_device");
 static const az_span test_device_hostname = AZ_SPAN_LITERAL_FROM_STR("myiothub.azure-devices.net");
@@ -37,6 +38,13 @@ static const az_span test_twin_received_get_response
 static const az_span test_twin_reported_props_success_response
     = AZ_SPAN_LITERAL_FROM_STR("$iothub/twin/res/204/?$rid=id_one&$version=16");
 
+static const az_span test_twin_desired_properties = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"telemetry\":{\"rate\":5,\"enabled\":true},\"led\":\"off\",\"$version\":4}");
+static const az_span test_twin_desired_properties_patch = AZ_SPAN_LITERAL_FROM_STR(
+    "{\"telemetry\":{\"rate\":10},\"led\":null,\"$version\":5}");
+static const az_span test_twin_desired_properties_patched
+    = AZ_SPAN_LITERAL_FROM_STR("{\"telemetry\":{\"rate\":10,\"enabled\":true},\"$version\":5}");
+
 static const char test_correct_twin_get_request_topic[] = "$iothub/twin/GET/?$rid=id_one";
 static const char test_correct_twin_patch_pub_topic[]
     = "$iothub/twin/PATCH/properties/reported/?$rid=id_one";
@@ -181,6 +189,43 @@ static void test_az_iot_hub_client_twin_parse_received_topic_NULL_response_fails
       &client, test_twin_received_topic_desired_success, NULL));
 }
 
+static void test_az_iot_hub_client_twin_desired_properties_apply_patch_NULL_client_fails()
+{
+  uint8_t scratch[TEST_TWIN_SCRATCH_BUFFER_SIZE];
+  uint8_t destination[TEST_SPAN_BUFFER_SIZE];
+  az_json_writer jw;
+  assert_int_equal(az_json_writer_init(&jw, AZ_SPAN_FROM_BUFFER(destination), NULL), AZ_OK);
+  bool is_applied;
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_twin_desired_properties_apply_patch(
+      NULL,
+      test_twin_desired_properties,
+      test_twin_desired_properties_patch,
+      AZ_SPAN_FROM_BUFFER(scratch),
+      &jw,
+      &is_applied));
+}
+
+static void test_az_iot_hub_client_twin_desired_properties_apply_patch_NULL_out_is_applied_fails()
+{
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  uint8_t scratch[TEST_TWIN_SCRATCH_BUFFER_SIZE];
+  uint8_t destination[TEST_SPAN_BUFFER_SIZE];
+  az_json_writer jw;
+  assert_int_equal(az_json_writer_init(&jw, AZ_SPAN_FROM_BUFFER(destination), NULL), AZ_OK);
+
+  ASSERT_PRECONDITION_CHECKED(az_iot_hub_client_twin_desired_properties_apply_patch(
+      &client,
+      test_twin_desired_properties,
+      test_twin_desired_properties_patch,
+      AZ_SPAN_FROM_BUFFER(scratch),
+      &jw,
+      NULL));
+}
+
 #endif // AZ_NO_PRECONDITION_CHECKING
 
 static void test_az_iot_hub_client_twin_document_get_publish_topic_succeed()
@@ -339,6 +384,81 @@ static void test_az_iot_hub_client_twin_parse_received_topic_not_found_prefix_fa
 }
 
 static int _log_invoked_topic = 0;
+static void test_az_iot_hub_client_twin_desired_properties_apply_patch_succeed()
+{
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  uint8_t scratch[TEST_TWIN_SCRATCH_BUFFER_SIZE];
+  uint8_t destination[TEST_SPAN_BUFFER_SIZE];
+  az_json_writer jw;
+  assert_int_equal(az_json_writer_init(&jw, AZ_SPAN_FROM_BUFFER(destination), NULL), AZ_OK);
+  bool is_applied = false;
+
+  assert_int_equal(
+      az_iot_hub_client_twin_desired_properties_apply_patch(
+          &client,
+          test_twin_desired_properties,
+          test_twin_desired_properties_patch,
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &jw,
+          &is_applied),
+      AZ_OK);
+  assert_true(is_applied);
+  assert_true(az_span_is_content_equal(
+      az_json_writer_get_bytes_used_in_destination(&jw), test_twin_desired_properties_patched));
+}
+
+static void test_az_iot_hub_client_twin_desired_properties_apply_patch_outdated_skipped()
+{
+  az_iot_hub_client client;
+  assert_int_equal(
+      az_iot_hub_client_init(&client, test_device_hostname, test_device_id, NULL), AZ_OK);
+
+  uint8_t scratch[TEST_TWIN_SCRATCH_BUFFER_SIZE];
+  uint8_t destination[TEST_SPAN_BUFFER_SIZE];
+  az_json_writer jw;
+  assert_int_equal(az_json_writer_init(&jw, AZ_SPAN_FROM_BUFFER(destination), NULL), AZ_OK);
+  bool is_applied = true;
+
+  // The same patch, received again after it was applied.
+  assert_int_equal(
+      az_iot_hub_client_twin_desired_properties_apply_patch(
+          &client,
+          test_twin_desired_properties_patched,
+          test_twin_desired_properties_patch,
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &jw,
+          &is_applied),
+      AZ_OK);
+  assert_false(is_applied);
+  assert_int_equal(az_span_size(az_json_writer_get_bytes_used_in_destination(&jw)), 0);
+
+  // An older patch, received late.
+  assert_int_equal(
+      az_iot_hub_client_twin_desired_properties_apply_patch(
+          &client,
+          test_twin_desired_properties_patched,
+          AZ_SPAN_FROM_STR("{\"led\":\"on\",\"$version\":3}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &jw,
+          &is_applied),
+      AZ_OK);
+  assert_false(is_applied);
+
+  // A $version which isn't a number.
+  assert_int_equal(
+      az_iot_hub_client_twin_desired_properties_apply_patch(
+          &client,
+          test_twin_desired_properties_patched,
+          AZ_SPAN_FROM_STR("{\"$version\":\"6\"}"),
+          AZ_SPAN_FROM_BUFFER(scratch),
+          &jw,
+          &is_applied),
+      AZ_ERROR_UNEXPECTED_CHAR);
+}
+
 static void _log_listener(az_log_classification classification, az_span message)
 {
   switch (classification)
@@ -427,6 +547,9 @@ int test_az_iot_hub_client_twin()
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_NULL_client_fails),
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_NULL_rec_topic_fails),
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_NULL_response_fails),
+    cmocka_unit_test(test_az_iot_hub_client_twin_desired_properties_apply_patch_NULL_client_fails),
+    cmocka_unit_test(
+        test_az_iot_hub_client_twin_desired_properties_apply_patch_NULL_out_is_applied_fails),
 #endif // AZ_NO_PRECONDITION_CHECKING
     cmocka_unit_test(test_az_iot_hub_client_twin_document_get_publish_topic_succeed),
     cmocka_unit_test(test_az_iot_hub_client_twin_document_get_publish_topic_small_buffer_fails),
@@ -438,6 +561,8 @@ int test_az_iot_hub_client_twin()
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_not_found_fails),
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_not_found_incomplete_fails),
     cmocka_unit_test(test_az_iot_hub_client_twin_parse_received_topic_not_found_prefix_fails),
+    cmocka_unit_test(test_az_iot_hub_client_twin_desired_properties_apply_patch_succeed),
+    cmocka_unit_test(test_az_iot_hub_client_twin_desired_properties_apply_patch_outdated_skipped),
     cmocka_unit_test(test_az_iot_hub_client_twin_logging_succeed),
     cmocka_unit_test(test_az_iot_hub_client_twin_no_logging_succeed),
   };
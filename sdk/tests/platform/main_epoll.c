@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+void test_az_epoll_send_request(void** state);
+void test_az_epoll_send_request_keep_alive(void** state);
+void test_az_epoll_send_request_closed_connection(void** state);
+void test_az_epoll_send_request_errors(void** state);
+void test_az_epoll_send_request_canceled(void** state);
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_epoll_send_request),
+    cmocka_unit_test(test_az_epoll_send_request_keep_alive),
+    cmocka_unit_test(test_az_epoll_send_request_closed_connection),
+    cmocka_unit_test(test_az_epoll_send_request_errors),
+    cmocka_unit_test(test_az_epoll_send_request_canceled),
+  };
+
+  return cmocka_run_group_tests_name("az_epoll", tests, NULL, NULL);
+}
@@ -0,0 +1,24 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+void test_az_hedging_primary_wins(void** state);
+void test_az_hedging_hedge_wins(void** state);
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_hedging_primary_wins),
+    cmocka_unit_test(test_az_hedging_hedge_wins),
+  };
+
+  return cmocka_run_group_tests_name("az_hedging", tests, NULL, NULL);
+}
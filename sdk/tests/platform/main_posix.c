@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+void test_az_posix_clock(void** state);
+void test_az_posix_clock_counts_blocked_time(void** state);
+void test_az_posix_retry_wakes_on_cancel(void** state);
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_posix_clock),
+    cmocka_unit_test(test_az_posix_clock_counts_blocked_time),
+    cmocka_unit_test(test_az_posix_retry_wakes_on_cancel),
+  };
+
+  return cmocka_run_group_tests_name("az_posix", tests, NULL, NULL);
+}
@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+void test_az_zlib_codec_round_trip(void** state);
+void test_az_zlib_policy_decompression(void** state);
+void test_az_zlib_policy_compression(void** state);
+
+int main(void)
+{
+  const struct CMUnitTest tests[] = {
+    cmocka_unit_test(test_az_zlib_codec_round_trip),
+    cmocka_unit_test(test_az_zlib_policy_decompression),
+    cmocka_unit_test(test_az_zlib_policy_compression),
+  };
+
+  return cmocka_run_group_tests_name("az_zlib", tests, NULL, NULL);
+}
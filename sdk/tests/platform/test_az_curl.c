@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_arena.h>
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_RESPONSE_OK "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+
+// Large enough for curl to still be sending the body when the other request completes.
+#define TEST_BODY_SIZE (256 * 1024)
+
+// An HTTP server on the loopback interface, which receives two POST requests at once, answers the
+// one whose body is made of 'a' first, and the other one once the test tells it to.
+typedef struct
+{
+  int listener;
+  int32_t port;
+  pthread_t thread;
+  int resume_pipe[2];
+  bool is_body_intact[2];
+} _test_server;
+
+static int _test_listen(int32_t* out_port)
+{
+  int const listener = socket(AF_INET, SOCK_STREAM, 0);
+  assert_true(listener >= 0);
+
+  struct sockaddr_in address = { 0 };
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_size = sizeof(address);
+  assert_int_equal(bind(listener, (struct sockaddr*)&address, address_size), 0);
+  assert_int_equal(listen(listener, 4), 0);
+  assert_int_equal(getsockname(listener, (struct sockaddr*)&address, &address_size), 0);
+
+  *out_port = ntohs(address.sin_port);
+  return listener;
+}
+
+// Accepts a connection and receives a request into the buffer at index. The body must be
+// TEST_BODY_SIZE times the same byte, which is returned, or 0 when it is not.
+static int _test_server_accept_request(_test_server* server, int32_t index, char* out_body_byte)
+{
+  *out_body_byte = 0;
+  int const connection = accept(server->listener, NULL, NULL);
+  if (connection < 0)
+  {
+    return -1;
+  }
+
+  // Neither side of a test should wait forever for the other one.
+  struct timeval const timeout = { .tv_sec = 5, .tv_usec = 0 };
+  (void)setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  static char request[2][1024 + TEST_BODY_SIZE];
+  char* const buffer = request[index];
+  size_t const capacity = sizeof(request[0]) - 1;
+  size_t size = 0;
+  char const* headers_end = NULL;
+  while (size < capacity)
+  {
+    ssize_t const received = recv(connection, buffer + size, capacity - size, 0);
+    if (received <= 0)
+    {
+      break;
+    }
+
+    size += (size_t)received;
+    buffer[size] = '\0';
+    if (headers_end == NULL)
+    {
+      headers_end = strstr(buffer, "\r\n\r\n");
+    }
+
+    if (headers_end != NULL && size - (size_t)(headers_end + 4 - buffer) >= TEST_BODY_SIZE)
+    {
+      break;
+    }
+  }
+
+  if (headers_end == NULL || size - (size_t)(headers_end + 4 - buffer) != TEST_BODY_SIZE)
+  {
+    return connection;
+  }
+
+  char const* const body = headers_end + 4;
+  for (size_t i = 1; i < TEST_BODY_SIZE; i++)
+  {
+    if (body[i] != body[0])
+    {
+      return connection;
+    }
+  }
+
+  *out_body_byte = body[0];
+  if (body[0] == 'a' || body[0] == 'b')
+  {
+    server->is_body_intact[body[0] - 'a'] = true;
+  }
+
+  return connection;
+}
+
+static void* _test_server_run(void* user_context)
+{
+  _test_server* const server = (_test_server*)user_context;
+
+  char first_byte = 0;
+  char second_byte = 0;
+  int const first = _test_server_accept_request(server, 0, &first_byte);
+  int const second = _test_server_accept_request(server, 1, &second_byte);
+  int const a = first_byte == 'a' ? first : second;
+  int const b = first_byte == 'a' ? second : first;
+
+  if (a >= 0)
+  {
+    (void)send(a, TEST_RESPONSE_OK, strlen(TEST_RESPONSE_OK), MSG_NOSIGNAL);
+    (void)close(a);
+  }
+
+  char resume = 0;
+  (void)read(server->resume_pipe[0], &resume, 1);
+
+  if (b >= 0)
+  {
+    (void)send(b, TEST_RESPONSE_OK, strlen(TEST_RESPONSE_OK), MSG_NOSIGNAL);
+    (void)close(b);
+  }
+
+  return NULL;
+}
+
+typedef struct
+{
+  az_result result;
+  bool is_complete;
+} _test_completion;
+
+static void _test_on_complete(
+    az_http_request const* request,
+    az_http_response* ref_response,
+    az_result result,
+    void* user_context)
+{
+  (void)request;
+  (void)ref_response;
+  _test_completion* const completion = (_test_completion*)user_context;
+  completion->result = result;
+  completion->is_complete = true;
+}
+
+static void _test_poll_until(az_http_client_async* ref_client, _test_completion const* completion)
+{
+  for (int32_t i = 0; i < 100 && !completion->is_complete; i++)
+  {
+    assert_true(az_result_succeeded(az_http_client_async_poll(ref_client, 100, NULL)));
+  }
+
+  assert_true(completion->is_complete);
+}
+
+void test_az_curl_async_posts_share_arena(void** state);
+void test_az_curl_async_posts_share_arena(void** state)
+{
+  (void)state;
+
+  _test_server server = { 0 };
+  assert_int_equal(pipe(server.resume_pipe), 0);
+  server.listener = _test_listen(&server.port);
+  assert_int_equal(pthread_create(&server.thread, NULL, _test_server_run, &server), 0);
+
+  char url[64] = { 0 };
+  (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/blob", (int)server.port);
+  az_span const url_span = az_span_create_from_str(url);
+
+  static uint8_t arena_buffer[4 * TEST_BODY_SIZE];
+  az_arena arena = { 0 };
+  assert_true(az_result_succeeded(az_arena_init(&arena, AZ_SPAN_FROM_BUFFER(arena_buffer))));
+  az_context context
+      = az_context_create_with_value(&az_context_application, &az_arena_context_key, &arena);
+
+  static uint8_t bodies[2][TEST_BODY_SIZE];
+  memset(bodies[0], 'a', TEST_BODY_SIZE);
+  memset(bodies[1], 'b', TEST_BODY_SIZE);
+
+  az_http_client_async client = { 0 };
+  assert_true(az_result_succeeded(az_http_client_async_init(&client, NULL)));
+
+  uint8_t headers[2][256] = { { 0 } };
+  uint8_t response_buffers[2][256] = { { 0 } };
+  az_http_request requests[2] = { { 0 } };
+  az_http_response responses[2] = { { 0 } };
+  _test_completion completions[2] = { { 0 } };
+  for (int32_t i = 0; i < 2; i++)
+  {
+    assert_true(az_result_succeeded(az_http_request_init(
+        &requests[i],
+        &context,
+        az_http_method_post(),
+        url_span,
+        az_span_size(url_span),
+        AZ_SPAN_FROM_BUFFER(headers[i]),
+        AZ_SPAN_FROM_BUFFER(bodies[i]))));
+    assert_true(az_result_succeeded(
+        az_http_response_init(&responses[i], AZ_SPAN_FROM_BUFFER(response_buffers[i]))));
+    assert_true(az_result_succeeded(az_http_client_async_submit(
+        &client, &requests[i], &responses[i], _test_on_complete, &completions[i])));
+  }
+
+  // Both copies of the POST fields were taken from the arena, one after the other.
+  int32_t const used_by_both = az_arena_get_mark(&arena)._internal.used;
+  assert_true(used_by_both > 2 * TEST_BODY_SIZE);
+
+  // The first POST completes while the second one is in flight: the copy of the second one stays
+  // taken, and what the arena hands out next doesn't overwrite it.
+  _test_poll_until(&client, &completions[0]);
+  assert_true(az_result_succeeded(completions[0].result));
+  assert_false(completions[1].is_complete);
+  assert_int_equal(az_arena_get_mark(&arena)._internal.used, used_by_both);
+
+  az_arena_mark const mark = az_arena_get_mark(&arena);
+  az_span scratch = AZ_SPAN_EMPTY;
+  assert_true(az_result_succeeded(az_arena_allocate(&arena, TEST_BODY_SIZE, &scratch)));
+  az_span_fill(scratch, 'x');
+  az_arena_rollback(&arena, mark);
+
+  // Once the second POST completes too, the arena gets its copy back, as nothing was allocated
+  // after it.
+  char const resume = 1;
+  assert_int_equal(write(server.resume_pipe[1], &resume, 1), 1);
+  _test_poll_until(&client, &completions[1]);
+  assert_true(az_result_succeeded(completions[1].result));
+  int32_t const used_after_both = az_arena_get_mark(&arena)._internal.used;
+  assert_true(used_after_both > TEST_BODY_SIZE);
+  assert_true(used_after_both < 2 * TEST_BODY_SIZE);
+
+  for (int32_t i = 0; i < 2; i++)
+  {
+    az_http_response_status_line status_line = { 0 };
+    assert_true(
+        az_result_succeeded(az_http_response_get_status_line(&responses[i], &status_line)));
+    assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+  }
+
+  az_http_client_async_deinit(&client);
+  assert_int_equal(pthread_join(server.thread, NULL), 0);
+  (void)close(server.listener);
+  (void)close(server.resume_pipe[0]);
+  (void)close(server.resume_pipe[1]);
+
+  // The server received both bodies as they were submitted.
+  assert_true(server.is_body_intact[0]);
+  assert_true(server.is_body_intact[1]);
+}
@@ -0,0 +1,393 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_SERVER_MAX_RESPONSES 4
+
+// An HTTP server on the loopback interface, which answers each request it receives with the next
+// of its responses.
+typedef struct
+{
+  int listener;
+  int32_t port;
+  pthread_t thread;
+  char const* responses[TEST_SERVER_MAX_RESPONSES];
+  bool is_closed_after[TEST_SERVER_MAX_RESPONSES]; // Closes the connection after the response.
+  int response_count;
+  int accepted_count;
+  char requests[TEST_SERVER_MAX_RESPONSES][1024];
+} _test_server;
+
+static int _test_listen(int32_t* out_port)
+{
+  int const listener = socket(AF_INET, SOCK_STREAM, 0);
+  assert_true(listener >= 0);
+
+  struct sockaddr_in address = { 0 };
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_size = sizeof(address);
+  assert_int_equal(bind(listener, (struct sockaddr*)&address, address_size), 0);
+  assert_int_equal(listen(listener, 4), 0);
+  assert_int_equal(getsockname(listener, (struct sockaddr*)&address, &address_size), 0);
+
+  *out_port = ntohs(address.sin_port);
+  return listener;
+}
+
+// Receives a request, up to the end of its body when it has a Content-Length.
+static bool _test_server_receive_request(int connection, char* request, size_t request_size)
+{
+  size_t size = 0;
+  while (size < request_size - 1)
+  {
+    ssize_t const received = recv(connection, request + size, request_size - 1 - size, 0);
+    if (received <= 0)
+    {
+      return false;
+    }
+
+    size += (size_t)received;
+    request[size] = '\0';
+
+    char const* const headers_end = strstr(request, "\r\n\r\n");
+    if (headers_end != NULL)
+    {
+      size_t content_length = 0;
+      char const* const content_length_header = strstr(request, "Content-Length: ");
+      if (content_length_header != NULL && content_length_header < headers_end)
+      {
+        (void)sscanf(content_length_header, "Content-Length: %zu", &content_length);
+      }
+
+      if (size >= (size_t)(headers_end + 4 - request) + content_length)
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+static void* _test_server_run(void* user_context)
+{
+  _test_server* const server = (_test_server*)user_context;
+  int response_index = 0;
+  while (response_index < server->response_count)
+  {
+    int const connection = accept(server->listener, NULL, NULL);
+    if (connection < 0)
+    {
+      break;
+    }
+
+    ++server->accepted_count;
+    while (response_index < server->response_count
+           && _test_server_receive_request(
+               connection,
+               server->requests[response_index],
+               sizeof(server->requests[response_index])))
+    {
+      char const* const response = server->responses[response_index];
+      (void)send(connection, response, strlen(response), MSG_NOSIGNAL);
+      if (server->is_closed_after[response_index++])
+      {
+        break;
+      }
+    }
+
+    (void)close(connection);
+  }
+
+  return NULL;
+}
+
+static void _test_server_start(_test_server* server)
+{
+  server->listener = _test_listen(&server->port);
+  assert_int_equal(pthread_create(&server->thread, NULL, _test_server_run, server), 0);
+}
+
+static void _test_server_stop(_test_server* server)
+{
+  assert_int_equal(pthread_join(server->thread, NULL), 0);
+  (void)close(server->listener);
+}
+
+static az_result _test_send(
+    int32_t port,
+    az_context* context,
+    az_http_method method,
+    char const* path,
+    az_span body,
+    az_http_response* out_response,
+    az_span response_buffer)
+{
+  char url[64] = { 0 };
+  (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d%s", (int)port, path);
+  az_span const url_span = az_span_create_from_str(url);
+
+  uint8_t headers[256] = { 0 };
+  az_http_request request = { 0 };
+  assert_true(az_result_succeeded(az_http_request_init(
+      &request,
+      context,
+      method,
+      url_span,
+      az_span_size(url_span),
+      AZ_SPAN_FROM_BUFFER(headers),
+      body)));
+  assert_true(az_result_succeeded(az_http_request_append_header(
+      &request, AZ_SPAN_FROM_STR("x-ms-client-request-id"), AZ_SPAN_FROM_STR("123"))));
+
+  assert_true(az_result_succeeded(az_http_response_init(out_response, response_buffer)));
+  return az_http_client_send_request(&request, out_response);
+}
+
+static void _test_assert_response(
+    az_http_response* response,
+    az_http_status_code expected_status_code,
+    char* expected_body)
+{
+  az_http_response_status_line status_line = { 0 };
+  assert_true(az_result_succeeded(az_http_response_get_status_line(response, &status_line)));
+  assert_int_equal(status_line.status_code, expected_status_code);
+
+  // The body is written right after the headers, and up to the end of the response.
+  az_span body = { 0 };
+  assert_true(az_result_succeeded(az_http_response_get_body(response, &body)));
+  az_span const expected = az_span_create_from_str(expected_body);
+  int32_t const body_offset
+      = (int32_t)(az_span_ptr(body) - az_span_ptr(response->_internal.http_response));
+  assert_int_equal(response->_internal.written, body_offset + az_span_size(expected));
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, az_span_size(expected)), expected));
+}
+
+void test_az_epoll_send_request(void** state);
+void test_az_epoll_send_request(void** state)
+{
+  (void)state;
+
+  _test_server server = {
+    .responses = { "HTTP/1.1 201 Created\r\nContent-Length: 5\r\n\r\nHello" },
+    .is_closed_after = { true },
+    .response_count = 1,
+  };
+  _test_server_start(&server);
+
+  uint8_t buffer[256] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(_test_send(
+      server.port,
+      &az_context_application,
+      az_http_method_put(),
+      "/container/blob?comp=1",
+      AZ_SPAN_FROM_STR("{\"a\":1}"),
+      &response,
+      AZ_SPAN_FROM_BUFFER(buffer))));
+  _test_server_stop(&server);
+
+  _test_assert_response(&response, AZ_HTTP_STATUS_CODE_CREATED, "Hello");
+
+  char expected_request[128] = { 0 };
+  (void)snprintf(
+      expected_request,
+      sizeof(expected_request),
+      "PUT /container/blob?comp=1 HTTP/1.1\r\nHost: 127.0.0.1:%d\r\n"
+      "x-ms-client-request-id: 123\r\nContent-Length: 7\r\n\r\n{\"a\":1}",
+      (int)server.port);
+  assert_string_equal(server.requests[0], expected_request);
+}
+
+void test_az_epoll_send_request_keep_alive(void** state);
+void test_az_epoll_send_request_keep_alive(void** state)
+{
+  (void)state;
+
+  // The connection is kept for the next request, and the chunked body is decoded.
+  _test_server server = {
+    .responses = {
+      "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n",
+      "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+    },
+    .is_closed_after = { false, true },
+    .response_count = 2,
+  };
+  _test_server_start(&server);
+
+  uint8_t buffer[256] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(_test_send(
+      server.port,
+      &az_context_application,
+      az_http_method_get(),
+      "",
+      AZ_SPAN_EMPTY,
+      &response,
+      AZ_SPAN_FROM_BUFFER(buffer))));
+  _test_assert_response(&response, AZ_HTTP_STATUS_CODE_OK, "abcde");
+
+  assert_true(az_result_succeeded(_test_send(
+      server.port,
+      &az_context_application,
+      az_http_method_get(),
+      "/missing",
+      AZ_SPAN_EMPTY,
+      &response,
+      AZ_SPAN_FROM_BUFFER(buffer))));
+  _test_assert_response(&response, AZ_HTTP_STATUS_CODE_NOT_FOUND, "");
+  _test_server_stop(&server);
+
+  assert_int_equal(server.accepted_count, 1);
+  assert_true(strncmp(server.requests[0], "GET / HTTP/1.1\r\n", 16) == 0);
+  assert_true(strncmp(server.requests[1], "GET /missing HTTP/1.1\r\n", 23) == 0);
+  assert_null(strstr(server.requests[1], "Content-Length"));
+}
+
+void test_az_epoll_send_request_closed_connection(void** state);
+void test_az_epoll_send_request_closed_connection(void** state)
+{
+  (void)state;
+
+  // The server closes the connection it didn't say it would close, and the next request is sent
+  // over a new one.
+  _test_server server = {
+    .responses = {
+      "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok",
+      "HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nagain",
+    },
+    .is_closed_after = { true, true },
+    .response_count = 2,
+  };
+  _test_server_start(&server);
+
+  uint8_t buffer[256] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(_test_send(
+      server.port,
+      &az_context_application,
+      az_http_method_get(),
+      "/",
+      AZ_SPAN_EMPTY,
+      &response,
+      AZ_SPAN_FROM_BUFFER(buffer))));
+  _test_assert_response(&response, AZ_HTTP_STATUS_CODE_OK, "ok");
+
+  assert_true(az_result_succeeded(_test_send(
+      server.port,
+      &az_context_application,
+      az_http_method_get(),
+      "/",
+      AZ_SPAN_EMPTY,
+      &response,
+      AZ_SPAN_FROM_BUFFER(buffer))));
+  _test_assert_response(&response, AZ_HTTP_STATUS_CODE_OK, "again");
+  _test_server_stop(&server);
+
+  assert_int_equal(server.accepted_count, 2);
+}
+
+void test_az_epoll_send_request_errors(void** state);
+void test_az_epoll_send_request_errors(void** state)
+{
+  (void)state;
+
+  _test_server server = {
+    .responses = { "HTTP/1.1 200 OK\r\nContent-Length: 64\r\n\r\n0123456789" },
+    .is_closed_after = { true },
+    .response_count = 1,
+  };
+  _test_server_start(&server);
+
+  // The connection is closed before the whole body is received.
+  uint8_t buffer[256] = { 0 };
+  az_http_response response = { 0 };
+  assert_int_equal(
+      _test_send(
+          server.port,
+          &az_context_application,
+          az_http_method_get(),
+          "/",
+          AZ_SPAN_EMPTY,
+          &response,
+          AZ_SPAN_FROM_BUFFER(buffer)),
+      AZ_ERROR_HTTP_CONNECTION_INTERRUPTED);
+  _test_server_stop(&server);
+
+  // Nothing listens on the port anymore.
+  assert_int_equal(
+      _test_send(
+          server.port,
+          &az_context_application,
+          az_http_method_get(),
+          "/",
+          AZ_SPAN_EMPTY,
+          &response,
+          AZ_SPAN_FROM_BUFFER(buffer)),
+      AZ_ERROR_HTTP_ADAPTER);
+
+  // TLS is not supported.
+  uint8_t headers[64] = { 0 };
+  az_http_request request = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("https://127.0.0.1/");
+  assert_true(az_result_succeeded(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_get(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers),
+      AZ_SPAN_EMPTY)));
+  assert_int_equal(az_http_client_send_request(&request, &response), AZ_ERROR_NOT_IMPLEMENTED);
+}
+
+void test_az_epoll_send_request_canceled(void** state);
+void test_az_epoll_send_request_canceled(void** state)
+{
+  (void)state;
+
+  // The connection is accepted by the kernel, but the server never responds, and the context
+  // expired already.
+  int32_t port = 0;
+  int const listener = _test_listen(&port);
+  az_context context = az_context_create_with_expiration(&az_context_application, 0);
+
+  uint8_t buffer[256] = { 0 };
+  az_http_response response = { 0 };
+  assert_int_equal(
+      _test_send(
+          port,
+          &context,
+          az_http_method_get(),
+          "/",
+          AZ_SPAN_EMPTY,
+          &response,
+          AZ_SPAN_FROM_BUFFER(buffer)),
+      AZ_ERROR_CANCELED);
+
+  (void)close(listener);
+}
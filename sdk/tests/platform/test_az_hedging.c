@@ -0,0 +1,257 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_RESPONSE_OK "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nConnection: close\r\n\r\nhello"
+
+// An HTTP server on the loopback interface. When the first request is stalled, the server never
+// answers it, answers the request on the next connection instead, and then waits for the client to
+// close the stalled connection.
+typedef struct
+{
+  int listener;
+  int32_t port;
+  pthread_t thread;
+  bool is_first_request_stalled;
+  int accepted_count;
+  bool is_stalled_connection_closed;
+} _test_server;
+
+static int _test_listen(int32_t* out_port)
+{
+  int const listener = socket(AF_INET, SOCK_STREAM, 0);
+  assert_true(listener >= 0);
+
+  struct sockaddr_in address = { 0 };
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_size = sizeof(address);
+  assert_int_equal(bind(listener, (struct sockaddr*)&address, address_size), 0);
+  assert_int_equal(listen(listener, 4), 0);
+  assert_int_equal(getsockname(listener, (struct sockaddr*)&address, &address_size), 0);
+
+  *out_port = ntohs(address.sin_port);
+  return listener;
+}
+
+// Accepts a connection and receives the headers of a request, which has no body.
+static int _test_server_accept_request(_test_server* server)
+{
+  int const connection = accept(server->listener, NULL, NULL);
+  if (connection < 0)
+  {
+    return -1;
+  }
+
+  ++server->accepted_count;
+
+  // Neither side of a test should wait forever for the other one.
+  struct timeval const timeout = { .tv_sec = 5, .tv_usec = 0 };
+  (void)setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  char request[1024] = { 0 };
+  size_t size = 0;
+  while (size < sizeof(request) - 1 && strstr(request, "\r\n\r\n") == NULL)
+  {
+    ssize_t const received = recv(connection, request + size, sizeof(request) - 1 - size, 0);
+    if (received <= 0)
+    {
+      (void)close(connection);
+      return -1;
+    }
+
+    size += (size_t)received;
+  }
+
+  return connection;
+}
+
+static void* _test_server_run(void* user_context)
+{
+  _test_server* const server = (_test_server*)user_context;
+
+  int const first = _test_server_accept_request(server);
+  if (first < 0)
+  {
+    return NULL;
+  }
+
+  int answered = first;
+  if (server->is_first_request_stalled)
+  {
+    answered = _test_server_accept_request(server);
+  }
+
+  if (answered >= 0)
+  {
+    (void)send(answered, TEST_RESPONSE_OK, strlen(TEST_RESPONSE_OK), MSG_NOSIGNAL);
+    (void)close(answered);
+  }
+
+  if (answered != first)
+  {
+    char buffer[16];
+    server->is_stalled_connection_closed = recv(first, buffer, sizeof(buffer), 0) == 0;
+    (void)close(first);
+  }
+
+  return NULL;
+}
+
+static void _test_server_start(_test_server* server)
+{
+  server->listener = _test_listen(&server->port);
+  assert_int_equal(pthread_create(&server->thread, NULL, _test_server_run, server), 0);
+}
+
+static void _test_server_stop(_test_server* server)
+{
+  assert_int_equal(pthread_join(server->thread, NULL), 0);
+  (void)close(server->listener);
+}
+
+static az_result _test_send_hedged(
+    _test_server const* server,
+    az_http_policy_hedging_options* ref_options,
+    az_http_response* out_response,
+    az_span response_buffer)
+{
+  char url[64] = { 0 };
+  (void)snprintf(url, sizeof(url), "http://127.0.0.1:%d/blob", (int)server->port);
+  az_span const url_span = az_span_create_from_str(url);
+
+  uint8_t headers[256] = { 0 };
+  az_http_request request = { 0 };
+  assert_true(az_result_succeeded(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_get(),
+      url_span,
+      az_span_size(url_span),
+      AZ_SPAN_FROM_BUFFER(headers),
+      AZ_SPAN_EMPTY)));
+
+  // The hedging policy takes the place of the transport, which it only hedges requests ahead of.
+  _az_http_policy policies[1] = {
+    {
+      ._internal = {
+        .process = az_http_pipeline_policy_transport,
+        .options = NULL,
+      },
+    },
+  };
+
+  assert_true(az_result_succeeded(az_http_response_init(out_response, response_buffer)));
+  return az_http_pipeline_policy_hedging(policies, ref_options, &request, out_response);
+}
+
+static void _test_assert_response_ok(az_http_response* response)
+{
+  az_http_response_status_line status_line = { 0 };
+  assert_true(az_result_succeeded(az_http_response_get_status_line(response, &status_line)));
+  assert_int_equal(status_line.status_code, AZ_HTTP_STATUS_CODE_OK);
+
+  // The body is written right after the headers, and up to the end of the response.
+  az_span body = { 0 };
+  assert_true(az_result_succeeded(az_http_response_get_body(response, &body)));
+  int32_t const body_offset
+      = (int32_t)(az_span_ptr(body) - az_span_ptr(response->_internal.http_response));
+  assert_int_equal(response->_internal.written, body_offset + 5);
+  assert_true(az_span_is_content_equal(az_span_slice(body, 0, 5), AZ_SPAN_FROM_STR("hello")));
+}
+
+void test_az_hedging_primary_wins(void** state);
+void test_az_hedging_primary_wins(void** state)
+{
+  (void)state;
+
+  _test_server server = { .is_first_request_stalled = false };
+  _test_server_start(&server);
+
+  az_http_client_async client = { 0 };
+  assert_true(az_result_succeeded(az_http_client_async_init(&client, NULL)));
+
+  uint8_t hedge_buffer[1024] = { 0 };
+  az_http_policy_hedging_options options = az_http_policy_hedging_options_default();
+  options.client = &client;
+  options.hedge_response_buffer = AZ_SPAN_FROM_BUFFER(hedge_buffer);
+  options.hedge_delay_msec = 5000;
+
+  uint8_t response_buffer[1024] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(
+      _test_send_hedged(&server, &options, &response, AZ_SPAN_FROM_BUFFER(response_buffer))));
+  _test_assert_response_ok(&response);
+
+  az_http_client_async_deinit(&client);
+  _test_server_stop(&server);
+
+  // No copy of the request was sent, and its latency counts for the next requests.
+  assert_int_equal(server.accepted_count, 1);
+  assert_int_equal(options._internal.latency_count, 1);
+}
+
+void test_az_hedging_hedge_wins(void** state);
+void test_az_hedging_hedge_wins(void** state)
+{
+  (void)state;
+
+  _test_server server = { .is_first_request_stalled = true };
+  _test_server_start(&server);
+
+  az_http_client_async client = { 0 };
+  assert_true(az_result_succeeded(az_http_client_async_init(&client, NULL)));
+
+  az_http_policy_retry_budget budget = { 0 };
+  assert_true(az_result_succeeded(az_http_policy_retry_budget_init(&budget, 1, 0)));
+
+  uint8_t hedge_buffer[1024] = { 0 };
+  az_http_policy_hedging_options options = az_http_policy_hedging_options_default();
+  options.client = &client;
+  options.hedge_response_buffer = AZ_SPAN_FROM_BUFFER(hedge_buffer);
+  options.hedge_delay_msec = 50;
+  options.budget = &budget;
+
+  uint8_t response_buffer[1024] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(
+      _test_send_hedged(&server, &options, &response, AZ_SPAN_FROM_BUFFER(response_buffer))));
+
+  // The response to the copy was moved into the response of the request.
+  _test_assert_response_ok(&response);
+
+  az_http_client_async_deinit(&client);
+  _test_server_stop(&server);
+
+  // The stalled request was canceled, and the copy took the only retry of the budget. The latency
+  // of the request, until the copy won, counts for the next requests.
+  assert_int_equal(server.accepted_count, 2);
+  assert_true(server.is_stalled_connection_closed);
+  assert_int_equal(budget._internal.tokens, 0);
+  assert_int_equal(options._internal.latency_count, 1);
+  assert_true(options._internal.latencies[0] >= options.hedge_delay_msec);
+}
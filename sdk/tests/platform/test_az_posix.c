@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_platform.h>
+#include <azure/core/internal/az_http_internal.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+void test_az_posix_clock(void** state);
+void test_az_posix_clock(void** state)
+{
+  (void)state;
+
+  // The three clocks are the same clock, in different units.
+  int64_t const msec = az_platform_clock_msec();
+  int64_t const usec = az_platform_clock_usec();
+  int64_t const nsec = az_platform_clock_nsec();
+  int64_t const msec_after = az_platform_clock_msec();
+
+  assert_true(msec <= usec / 1000);
+  assert_true(usec <= nsec / 1000);
+  assert_true(nsec / 1000000 <= msec_after);
+
+  // The clock never goes back.
+  int64_t previous = az_platform_clock_nsec();
+  for (int i = 0; i < 1000; i++)
+  {
+    int64_t const now = az_platform_clock_nsec();
+    assert_true(now >= previous);
+    previous = now;
+  }
+}
+
+void test_az_posix_clock_counts_blocked_time(void** state);
+void test_az_posix_clock_counts_blocked_time(void** state)
+{
+  (void)state;
+
+  // The time spent sleeping is counted, although the process uses no CPU time meanwhile.
+  int64_t const start_msec = az_platform_clock_msec();
+  int64_t const start_usec = az_platform_clock_usec();
+  az_platform_sleep_msec(1100);
+  int64_t const elapsed_msec = az_platform_clock_msec() - start_msec;
+  int64_t const elapsed_usec = az_platform_clock_usec() - start_usec;
+
+  assert_true(elapsed_msec >= 1100);
+  assert_true(elapsed_msec < 5000);
+  assert_true(elapsed_usec >= 1100000);
+
+  // So a context expires while the application is blocked.
+  az_context context = az_context_create_with_expiration(
+      &az_context_application, az_platform_clock_msec() + 50);
+  assert_false(az_context_has_expired(&context, az_platform_clock_msec()));
+  az_platform_sleep_msec(60);
+  assert_true(az_context_has_expired(&context, az_platform_clock_msec()));
+}
+
+static az_result _test_transport_retry_response(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_options;
+  (void)ref_request;
+  return az_http_response_append(
+      ref_response, AZ_SPAN_FROM_STR("HTTP/1.1 503 Service Unavailable\r\n\r\n"));
+}
+
+static void* _test_cancel_later(void* context)
+{
+  az_platform_sleep_msec(200);
+  az_context_cancel((az_context*)context);
+  return NULL;
+}
+
+void test_az_posix_retry_wakes_on_cancel(void** state);
+void test_az_posix_retry_wakes_on_cancel(void** state)
+{
+  (void)state;
+
+  az_context context = az_context_create_with_expiration(
+      &az_context_application, az_platform_clock_msec() + 60 * 1000);
+  uint8_t headers[2 * sizeof(_az_http_request_header)] = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("http://localhost");
+  az_http_request request = { 0 };
+  assert_true(az_result_succeeded(az_http_request_init(
+      &request,
+      &context,
+      az_http_method_get(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers),
+      AZ_SPAN_EMPTY)));
+
+  uint8_t response_buffer[128] = { 0 };
+  az_http_response response = { 0 };
+  assert_true(az_result_succeeded(
+      az_http_response_init(&response, AZ_SPAN_FROM_BUFFER(response_buffer))));
+
+  _az_http_policy policies[] = {
+    { ._internal = { .process = _test_transport_retry_response, .options = NULL } },
+  };
+  az_http_policy_retry_options retry_options = _az_http_policy_retry_options_default();
+  retry_options.retry_delay_msec = 10 * 1000;
+
+  // The retry policy would sleep for 20 seconds, but the context is canceled meanwhile from
+  // another thread.
+  pthread_t thread;
+  assert_int_equal(pthread_create(&thread, NULL, _test_cancel_later, &context), 0);
+  int64_t const start = az_platform_clock_msec();
+  assert_int_equal(
+      az_http_pipeline_policy_retry(policies, &retry_options, &request, &response),
+      AZ_ERROR_CANCELED);
+  int64_t const elapsed = az_platform_clock_msec() - start;
+  assert_int_equal(pthread_join(thread, NULL), 0);
+
+  assert_true(elapsed >= 200);
+  assert_true(elapsed < 200 + 10 * AZ_HTTP_POLICY_RETRY_CANCELLATION_CHECK_INTERVAL_MSEC);
+}
@@ -0,0 +1,357 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// SPDX-License-Identifier: MIT
+
+#include <azure/core/az_context.h>
+#include <azure/core/az_http.h>
+#include <azure/core/az_http_transport.h>
+#include <azure/core/az_span.h>
+#include <azure/core/internal/az_http_internal.h>
+#include <azure/core/internal/az_result_internal.h>
+#include <azure/platform/az_zlib.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmocka.h>
+
+#include <azure/core/_az_cfg.h>
+
+#define TEST_EXPECT_SUCCESS(exp) assert_true(az_result_succeeded(exp))
+
+static uint8_t _test_work_buffer[AZ_ZLIB_CODEC_WORK_BUFFER_SIZE];
+
+// A body which compresses well, like the JSON documents of the services.
+static az_span _test_body(uint8_t* buffer, int32_t size)
+{
+  static char const pattern[] = "{\"name\":\"blob\",\"size\":1024,\"tags\":[\"a\",\"b\"]},";
+  for (int32_t i = 0; i < size; i++)
+  {
+    buffer[i] = (uint8_t)pattern[i % (int32_t)(sizeof(pattern) - 1)];
+  }
+
+  return az_span_create(buffer, size);
+}
+
+static az_span _test_compress(
+    az_http_content_codec const* codec,
+    az_http_content_coding coding,
+    az_span body,
+    az_span destination)
+{
+  TEST_EXPECT_SUCCESS(codec->begin(codec->user_context, coding, true));
+
+  int32_t body_used = 0;
+  int32_t destination_used = 0;
+  bool is_end = false;
+  TEST_EXPECT_SUCCESS(codec->process(
+      codec->user_context, body, destination, true, &body_used, &destination_used, &is_end));
+  assert_true(is_end);
+  assert_int_equal(body_used, az_span_size(body));
+  codec->end(codec->user_context);
+
+  return az_span_slice(destination, 0, destination_used);
+}
+
+void test_az_zlib_codec_round_trip(void** state);
+void test_az_zlib_codec_round_trip(void** state)
+{
+  (void)state;
+
+  az_http_content_codec codec = { 0 };
+  TEST_EXPECT_SUCCESS(az_zlib_codec_init(&codec, AZ_SPAN_FROM_BUFFER(_test_work_buffer)));
+
+  uint8_t body_buffer[4096];
+  az_span const body = _test_body(body_buffer, sizeof(body_buffer));
+
+  az_http_content_coding const codings[]
+      = { AZ_HTTP_CONTENT_CODING_GZIP, AZ_HTTP_CONTENT_CODING_DEFLATE };
+  for (size_t i = 0; i < sizeof(codings) / sizeof(codings[0]); i++)
+  {
+    uint8_t compressed_buffer[1024];
+    az_span const compressed
+        = _test_compress(&codec, codings[i], body, AZ_SPAN_FROM_BUFFER(compressed_buffer));
+    assert_true(az_span_size(compressed) < az_span_size(body) / 4);
+    if (codings[i] == AZ_HTTP_CONTENT_CODING_GZIP)
+    {
+      assert_int_equal(az_span_ptr(compressed)[0], 0x1F);
+      assert_int_equal(az_span_ptr(compressed)[1], 0x8B);
+    }
+
+    // Decompress from fragments of a few bytes, into a small destination.
+    uint8_t decompressed[sizeof(body_buffer)] = { 0 };
+    int32_t decompressed_size = 0;
+    bool is_end = false;
+    TEST_EXPECT_SUCCESS(codec.begin(codec.user_context, codings[i], false));
+    for (int32_t offset = 0; !is_end;)
+    {
+      int32_t const fragment_size
+          = offset + 7 < az_span_size(compressed) ? 7 : az_span_size(compressed) - offset;
+      int32_t const destination_size = decompressed_size + 100 < (int32_t)sizeof(decompressed)
+          ? 100
+          : (int32_t)sizeof(decompressed) - decompressed_size;
+
+      int32_t source_used = 0;
+      int32_t destination_used = 0;
+      TEST_EXPECT_SUCCESS(codec.process(
+          codec.user_context,
+          az_span_slice(compressed, offset, offset + fragment_size),
+          az_span_create(decompressed + decompressed_size, destination_size),
+          false,
+          &source_used,
+          &destination_used,
+          &is_end));
+      offset += source_used;
+      decompressed_size += destination_used;
+    }
+
+    codec.end(codec.user_context);
+    assert_true(
+        az_span_is_content_equal(az_span_create(decompressed, decompressed_size), body));
+  }
+
+  // The work buffer is too small.
+  assert_int_equal(
+      az_zlib_codec_init(
+          &codec, az_span_slice(AZ_SPAN_FROM_BUFFER(_test_work_buffer), 0, 1024)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+static az_span _test_response_body;
+static char const* _test_response_headers;
+static az_span _test_request_body;
+static az_span _test_request_content_length;
+static az_span _test_request_content_encoding;
+
+// Receives the response in fragments, as a transport adapter would, and records the request.
+static az_result _test_transport(
+    _az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_policies;
+  (void)ref_options;
+
+  TEST_EXPECT_SUCCESS(az_http_request_get_body(ref_request, &_test_request_body));
+  _test_request_content_length = AZ_SPAN_EMPTY;
+  _test_request_content_encoding = AZ_SPAN_EMPTY;
+  for (int32_t i = 0; i < az_http_request_headers_count(ref_request); i++)
+  {
+    az_span name = { 0 };
+    az_span value = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_request_get_header(ref_request, i, &name, &value));
+    if (az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Content-Length")))
+    {
+      _test_request_content_length = value;
+    }
+    else if (az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Content-Encoding")))
+    {
+      _test_request_content_encoding = value;
+    }
+    else if (az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Accept-Encoding")))
+    {
+      assert_true(az_span_is_content_equal(value, AZ_SPAN_FROM_STR("gzip, deflate")));
+    }
+  }
+
+  _az_RETURN_IF_FAILED(az_http_response_append(
+      ref_response, az_span_create_from_str((char*)(uintptr_t)_test_response_headers)));
+  for (int32_t offset = 0; offset < az_span_size(_test_response_body); offset += 13)
+  {
+    int32_t const end = offset + 13 < az_span_size(_test_response_body)
+        ? offset + 13
+        : az_span_size(_test_response_body);
+    _az_RETURN_IF_FAILED(az_http_response_append_body(
+        ref_response, az_span_slice(_test_response_body, offset, end)));
+  }
+
+  return AZ_OK;
+}
+
+static az_result _test_send(
+    az_http_policy_compression_options* options,
+    az_span request_body,
+    az_http_response* ref_response,
+    az_span response_buffer)
+{
+  _az_http_policy policies[] = {
+    { ._internal = { .process = az_http_pipeline_policy_compression, .options = options } },
+    { ._internal = { .process = az_http_pipeline_policy_decompression, .options = options } },
+    { ._internal = { .process = _test_transport, .options = NULL } },
+  };
+
+  uint8_t headers[4 * sizeof(_az_http_request_header)] = { 0 };
+  az_http_request request = { 0 };
+  az_span const url = AZ_SPAN_FROM_STR("https://www.example.com");
+  TEST_EXPECT_SUCCESS(az_http_request_init(
+      &request,
+      &az_context_application,
+      az_http_method_put(),
+      url,
+      az_span_size(url),
+      AZ_SPAN_FROM_BUFFER(headers),
+      request_body));
+
+  uint8_t content_length[16] = { 0 };
+  az_span remainder = { 0 };
+  TEST_EXPECT_SUCCESS(
+      az_span_i32toa(AZ_SPAN_FROM_BUFFER(content_length), az_span_size(request_body), &remainder));
+  TEST_EXPECT_SUCCESS(az_http_request_set_header(
+      &request,
+      AZ_HTTP_HEADER_ID_CONTENT_LENGTH,
+      az_span_slice(
+          AZ_SPAN_FROM_BUFFER(content_length),
+          0,
+          (int32_t)(az_span_ptr(remainder) - content_length))));
+
+  TEST_EXPECT_SUCCESS(az_http_response_init(ref_response, response_buffer));
+  az_result const result
+      = az_http_pipeline_policy_compression(policies, options, &request, ref_response);
+
+  // The request is given back with the body and the headers it was sent with.
+  az_span body = { 0 };
+  az_span length = { 0 };
+  TEST_EXPECT_SUCCESS(az_http_request_get_body(&request, &body));
+  assert_true(az_span_ptr(body) == az_span_ptr(request_body));
+  assert_int_equal(az_span_size(body), az_span_size(request_body));
+  for (int32_t i = 0; i < az_http_request_headers_count(&request); i++)
+  {
+    az_span name = { 0 };
+    az_span value = { 0 };
+    TEST_EXPECT_SUCCESS(az_http_request_get_header(&request, i, &name, &value));
+    assert_false(az_span_is_content_equal(name, AZ_SPAN_FROM_STR("Content-Encoding")));
+  }
+
+  TEST_EXPECT_SUCCESS(
+      az_http_request_get_header_by_id(&request, AZ_HTTP_HEADER_ID_CONTENT_LENGTH, &length));
+  assert_true(az_span_ptr(length) == content_length);
+
+  return result;
+}
+
+void test_az_zlib_policy_decompression(void** state);
+void test_az_zlib_policy_decompression(void** state)
+{
+  (void)state;
+
+  az_http_content_codec codec = { 0 };
+  TEST_EXPECT_SUCCESS(az_zlib_codec_init(&codec, AZ_SPAN_FROM_BUFFER(_test_work_buffer)));
+  az_http_policy_compression_options options = _az_http_policy_compression_options_default();
+  options.codec = &codec;
+
+  uint8_t body_buffer[2000];
+  az_span const body = _test_body(body_buffer, sizeof(body_buffer));
+  uint8_t compressed_buffer[512];
+  uint8_t response_buffer[2200];
+  az_http_response response = { 0 };
+  az_span response_body = { 0 };
+
+  // The body is decompressed into the response buffer as it is received.
+  _test_response_headers = "HTTP/1.1 200 OK\r\nContent-Encoding: gzip\r\n\r\n";
+  _test_response_body = _test_compress(
+      &codec, AZ_HTTP_CONTENT_CODING_GZIP, body, AZ_SPAN_FROM_BUFFER(compressed_buffer));
+  TEST_EXPECT_SUCCESS(
+      _test_send(&options, AZ_SPAN_EMPTY, &response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &response_body));
+  assert_true(az_span_is_content_equal(
+      az_span_slice(
+          response_body,
+          0,
+          response._internal.written
+              - (int32_t)(az_span_ptr(response_body) - response_buffer)),
+      body));
+
+  // The response doesn't fit in the buffer once decompressed.
+  _test_response_headers = "HTTP/1.1 200 OK\r\nContent-Encoding: deflate\r\n\r\n";
+  _test_response_body = _test_compress(
+      &codec, AZ_HTTP_CONTENT_CODING_DEFLATE, body, AZ_SPAN_FROM_BUFFER(compressed_buffer));
+  assert_int_equal(
+      _test_send(
+          &options,
+          AZ_SPAN_EMPTY,
+          &response,
+          az_span_slice(AZ_SPAN_FROM_BUFFER(response_buffer), 0, 1000)),
+      AZ_ERROR_NOT_ENOUGH_SPACE);
+
+  // The compressed body is cut short.
+  _test_response_body
+      = az_span_slice(_test_response_body, 0, az_span_size(_test_response_body) / 2);
+  assert_int_equal(
+      _test_send(&options, AZ_SPAN_EMPTY, &response, AZ_SPAN_FROM_BUFFER(response_buffer)),
+      AZ_ERROR_HTTP_CORRUPT_RESPONSE_BODY);
+
+  // Bodies which aren't compressed are left as they are.
+  _test_response_headers = "HTTP/1.1 200 OK\r\nContent-Encoding: identity\r\n\r\n";
+  _test_response_body = AZ_SPAN_FROM_STR("plain");
+  TEST_EXPECT_SUCCESS(
+      _test_send(&options, AZ_SPAN_EMPTY, &response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+  TEST_EXPECT_SUCCESS(az_http_response_get_body(&response, &response_body));
+  assert_true(
+      az_span_is_content_equal(az_span_slice(response_body, 0, 5), AZ_SPAN_FROM_STR("plain")));
+}
+
+void test_az_zlib_policy_compression(void** state);
+void test_az_zlib_policy_compression(void** state)
+{
+  (void)state;
+
+  az_http_content_codec codec = { 0 };
+  TEST_EXPECT_SUCCESS(az_zlib_codec_init(&codec, AZ_SPAN_FROM_BUFFER(_test_work_buffer)));
+  uint8_t request_compression_buffer[256];
+  az_http_policy_compression_options options = _az_http_policy_compression_options_default();
+  options.codec = &codec;
+  options.decompress_responses = false;
+  options.request_compression_threshold = 100;
+  options.request_compression_buffer = AZ_SPAN_FROM_BUFFER(request_compression_buffer);
+
+  _test_response_headers = "HTTP/1.1 201 Created\r\n\r\n";
+  _test_response_body = AZ_SPAN_EMPTY;
+  uint8_t response_buffer[256];
+  az_http_response response = { 0 };
+
+  // The body is sent compressed, with its compressed length.
+  uint8_t body_buffer[2000];
+  az_span const body = _test_body(body_buffer, sizeof(body_buffer));
+  TEST_EXPECT_SUCCESS(_test_send(&options, body, &response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+  assert_true(az_span_is_content_equal(_test_request_content_encoding, AZ_SPAN_FROM_STR("gzip")));
+  assert_true(az_span_size(_test_request_body) < az_span_size(body) / 4);
+  uint32_t content_length = 0;
+  TEST_EXPECT_SUCCESS(az_span_atou32(_test_request_content_length, &content_length));
+  assert_int_equal(content_length, az_span_size(_test_request_body));
+
+  uint8_t decompressed[sizeof(body_buffer)] = { 0 };
+  int32_t source_used = 0;
+  int32_t decompressed_size = 0;
+  bool is_end = false;
+  TEST_EXPECT_SUCCESS(codec.begin(codec.user_context, AZ_HTTP_CONTENT_CODING_GZIP, false));
+  TEST_EXPECT_SUCCESS(codec.process(
+      codec.user_context,
+      _test_request_body,
+      AZ_SPAN_FROM_BUFFER(decompressed),
+      false,
+      &source_used,
+      &decompressed_size,
+      &is_end));
+  codec.end(codec.user_context);
+  assert_true(is_end);
+  assert_true(az_span_is_content_equal(az_span_create(decompressed, decompressed_size), body));
+
+  // Bodies below the threshold, or which don't fit in the buffer once compressed, are sent as they
+  // are.
+  az_span const small_body = az_span_slice(body, 0, 99);
+  TEST_EXPECT_SUCCESS(
+      _test_send(&options, small_body, &response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+  assert_true(az_span_is_content_equal(_test_request_body, small_body));
+  assert_int_equal(az_span_size(_test_request_content_encoding), 0);
+
+  options.request_compression_buffer
+      = az_span_slice(AZ_SPAN_FROM_BUFFER(request_compression_buffer), 0, 16);
+  TEST_EXPECT_SUCCESS(_test_send(&options, body, &response, AZ_SPAN_FROM_BUFFER(response_buffer)));
+  assert_true(az_span_is_content_equal(_test_request_body, body));
+  assert_true(az_span_is_content_equal(_test_request_content_length, AZ_SPAN_FROM_STR("2000")));
+}
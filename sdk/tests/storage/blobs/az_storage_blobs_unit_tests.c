@@ -8,6 +8,8 @@
 
 #include <cmocka.h>
 
+#include <azure/core/az_http_transport.h>
+#include <azure/core/internal/az_http_internal.h>
 #include <azure/storage/az_storage_blobs.h>
 
 #include <azure/core/_az_cfg.h>
@@ -24,3 +26,131 @@ void test_storage_blobs_init(void** state)
           &client, AZ_SPAN_FROM_STR("url"), AZ_CREDENTIAL_ANONYMOUS, &opts)
       == AZ_OK);
 }
+
+static az_result _test_storage_blobs_custom_policy(
+    az_http_policy* ref_policies,
+    void* ref_options,
+    az_http_request* ref_request,
+    az_http_response* ref_response)
+{
+  (void)ref_options;
+  return az_http_pipeline_next_policy(ref_policies, ref_request, ref_response);
+}
+
+static int32_t _test_storage_blobs_find_policy(
+    az_storage_blobs_blob_client const* client,
+    _az_http_policy_process_fn process,
+    void const* options)
+{
+  for (int32_t i = 0; i < _az_MAXIMUM_NUMBER_OF_POLICIES; i++)
+  {
+    _az_http_policy const* const policy = &client->_internal.pipeline._internal.policies[i];
+    if (policy->_internal.process == process && policy->_internal.options == options)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+void test_storage_blobs_init_custom_policies(void** state);
+void test_storage_blobs_init_custom_policies(void** state)
+{
+  (void)state;
+  int per_call_options = 0;
+  int per_retry_options = 0;
+  az_http_custom_policy const custom_policies[] = {
+    { .process = _test_storage_blobs_custom_policy,
+      .options = &per_retry_options,
+      .position = AZ_HTTP_POLICY_POSITION_PER_RETRY },
+    { .process = _test_storage_blobs_custom_policy,
+      .options = &per_call_options,
+      .position = AZ_HTTP_POLICY_POSITION_PER_CALL },
+  };
+
+  az_storage_blobs_blob_client client = { 0 };
+  az_storage_blobs_blob_client_options opts = az_storage_blobs_blob_client_options_default();
+  opts.custom_policies = custom_policies;
+  opts.custom_policies_length = 2;
+
+  assert_true(
+      az_storage_blobs_blob_client_init(
+          &client, AZ_SPAN_FROM_STR("url"), AZ_CREDENTIAL_ANONYMOUS, &opts)
+      == AZ_OK);
+
+  // Per call: right before the retry policy. Per retry: right after the attempt tracing policy.
+  int32_t const retry = _test_storage_blobs_find_policy(
+      &client, az_http_pipeline_policy_retry, &client._internal.options.retry_options);
+  int32_t const tracing_attempt
+      = _test_storage_blobs_find_policy(&client, az_http_pipeline_policy_tracing_attempt, NULL);
+  assert_true(retry > 0);
+  assert_true(tracing_attempt > retry);
+  assert_int_equal(
+      _test_storage_blobs_find_policy(
+          &client, _test_storage_blobs_custom_policy, &per_call_options),
+      retry - 1);
+  assert_int_equal(
+      _test_storage_blobs_find_policy(
+          &client, _test_storage_blobs_custom_policy, &per_retry_options),
+      tracing_attempt + 1);
+}
+
+void test_storage_blobs_init_too_many_custom_policies(void** state);
+void test_storage_blobs_init_too_many_custom_policies(void** state)
+{
+  (void)state;
+  az_http_custom_policy custom_policies[AZ_HTTP_PIPELINE_POLICY_COUNT];
+  for (int32_t i = 0; i < AZ_HTTP_PIPELINE_POLICY_COUNT; i++)
+  {
+    custom_policies[i] = (az_http_custom_policy){ .process = _test_storage_blobs_custom_policy,
+                                                  .options = NULL,
+                                                  .position = AZ_HTTP_POLICY_POSITION_PER_CALL };
+  }
+
+  az_storage_blobs_blob_client client = { 0 };
+  az_storage_blobs_blob_client_options opts = az_storage_blobs_blob_client_options_default();
+  opts.custom_policies = custom_policies;
+  opts.custom_policies_length = AZ_HTTP_PIPELINE_POLICY_COUNT;
+
+  assert_true(
+      az_storage_blobs_blob_client_init(
+          &client, AZ_SPAN_FROM_STR("url"), AZ_CREDENTIAL_ANONYMOUS, &opts)
+      == AZ_ERROR_NOT_ENOUGH_SPACE);
+}
+
+void test_storage_blobs_init_hedging(void** state);
+void test_storage_blobs_init_hedging(void** state)
+{
+  (void)state;
+  int per_retry_options = 0;
+  az_http_custom_policy const custom_policies[] = {
+    { .process = _test_storage_blobs_custom_policy,
+      .options = &per_retry_options,
+      .position = AZ_HTTP_POLICY_POSITION_PER_RETRY },
+  };
+  az_http_policy_hedging_options hedging = az_http_policy_hedging_options_default();
+
+  az_storage_blobs_blob_client client = { 0 };
+  az_storage_blobs_blob_client_options opts = az_storage_blobs_blob_client_options_default();
+  opts.custom_policies = custom_policies;
+  opts.custom_policies_length = 1;
+  opts.hedging = &hedging;
+
+  assert_true(
+      az_storage_blobs_blob_client_init(
+          &client, AZ_SPAN_FROM_STR("url"), AZ_CREDENTIAL_ANONYMOUS, &opts)
+      == AZ_OK);
+
+  // The hedging policy sends the requests itself, so it comes after all the other policies, right
+  // ahead of the transport.
+  int32_t const hedging_index
+      = _test_storage_blobs_find_policy(&client, az_http_pipeline_policy_hedging, &hedging);
+  assert_true(
+      hedging_index
+      > _test_storage_blobs_find_policy(
+          &client, _test_storage_blobs_custom_policy, &per_retry_options));
+  assert_int_equal(
+      _test_storage_blobs_find_policy(&client, az_http_pipeline_policy_transport, NULL),
+      hedging_index + 1);
+}
@@ -11,11 +11,17 @@
 #include <azure/core/_az_cfg.h>
 
 void test_storage_blobs_init(void** state);
+void test_storage_blobs_init_custom_policies(void** state);
+void test_storage_blobs_init_too_many_custom_policies(void** state);
+void test_storage_blobs_init_hedging(void** state);
 
 int main(void)
 {
   const struct CMUnitTest tests[] = {
     cmocka_unit_test(test_storage_blobs_init),
+    cmocka_unit_test(test_storage_blobs_init_custom_policies),
+    cmocka_unit_test(test_storage_blobs_init_too_many_custom_policies),
+    cmocka_unit_test(test_storage_blobs_init_hedging),
   };
 
   return cmocka_run_group_tests_name("az_storage_blobs", tests, NULL, NULL);